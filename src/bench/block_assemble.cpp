@@ -50,4 +50,60 @@ static void AssembleBlock(benchmark::Bench& bench)
     });
 }
 
+/** Assemble blocks from a mempool of transaction chains at the ancestor limit,
+ *  with a varying fee per chain link. */
+static void AssembleBlockDeepChains(benchmark::Bench& bench, bool cluster_mode)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    test_setup->m_node.mempool->SetClusterMode(cluster_mode);
+
+    CScriptWitness witness;
+    witness.stack.push_back(WITNESS_STACK_ELEM_OP_TRUE);
+
+    constexpr size_t NUM_BLOCKS{2100};
+    constexpr size_t coinbaseMaturity = 2000;
+    std::vector<CTxIn> mature_coinbases;
+    for (size_t b{0}; b < NUM_BLOCKS; ++b) {
+        CTxIn coinbase = MineBlock(test_setup->m_node, P2WSH_OP_TRUE);
+        if (NUM_BLOCKS - b >= coinbaseMaturity)
+            mature_coinbases.push_back(coinbase);
+    }
+    {
+        LOCK(::cs_main);
+
+        for (const CTxIn& coinbase : mature_coinbases) {
+            CMutableTransaction tx;
+            tx.vin.push_back(coinbase);
+            tx.vin.back().scriptWitness = witness;
+            tx.vout.emplace_back(100 * COIN, P2WSH_OP_TRUE);
+            for (unsigned int depth{0}; depth < DEFAULT_ANCESTOR_LIMIT; ++depth) {
+                const CTransactionRef txr = MakeTransactionRef(tx);
+                const MempoolAcceptResult res = test_setup->m_node.chainman->ProcessTransaction(txr);
+                assert(res.m_result_type == MempoolAcceptResult::ResultType::VALID);
+
+                const CAmount fee = (depth % 5 + 1) * 100000;
+                tx.vin.at(0) = CTxIn(txr->GetHash(), 0);
+                tx.vin.back().scriptWitness = witness;
+                tx.vout.at(0).nValue = txr->vout.at(0).nValue - fee;
+            }
+        }
+    }
+
+    bench.run([&] {
+        PrepareBlock(test_setup->m_node, P2WSH_OP_TRUE);
+    });
+}
+
+static void AssembleBlockDeepChainsPackages(benchmark::Bench& bench)
+{
+    AssembleBlockDeepChains(bench, /* cluster_mode */ false);
+}
+
+static void AssembleBlockDeepChainsClusters(benchmark::Bench& bench)
+{
+    AssembleBlockDeepChains(bench, /* cluster_mode */ true);
+}
+
 BENCHMARK(AssembleBlock);
+BENCHMARK(AssembleBlockDeepChainsPackages);
+BENCHMARK(AssembleBlockDeepChainsClusters);
@@ -5,6 +5,8 @@
 #include <bench/bench.h>
 #include <interfaces/chain.h>
 #include <node/context.h>
+#include <test/util/setup_common.h>
+#include <util/translation.h>
 #include <wallet/coinselection.h>
 #include <wallet/spend.h>
 #include <wallet/wallet.h>
@@ -13,6 +15,7 @@
 
 using node::NodeContext;
 using wallet::AttemptSelection;
+using wallet::AvailableCoins;
 using wallet::CInputCoin;
 using wallet::COutput;
 using wallet::CWallet;
@@ -20,9 +23,13 @@ using wallet::CWalletTx;
 using wallet::CoinEligibilityFilter;
 using wallet::CoinSelectionParams;
 using wallet::CreateDummyWalletDatabase;
+using wallet::CreateMockWalletDatabase;
+using wallet::DBErrors;
 using wallet::OutputGroup;
 using wallet::SelectCoinsBnB;
+using wallet::TxStateConfirmed;
 using wallet::TxStateInactive;
+using wallet::WALLET_FLAG_DESCRIPTORS;
 
 static void addCoin(const CAmount& nValue, const CWallet& wallet, std::vector<std::unique_ptr<CWalletTx>>& wtxs)
 {
@@ -74,6 +81,47 @@ static void CoinSelection(benchmark::Bench& bench)
     });
 }
 
+// Look up the spendable coins of a large wallet. Half of the outputs of the
+// wallet transactions are paid to others, like the payments of a payment
+// processor, and are never visited by AvailableCoins.
+static void WalletAvailableCoins(benchmark::Bench& bench, int num_coins)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    CWallet wallet{test_setup->m_node.chain.get(), "", gArgs, CreateMockWalletDatabase()};
+    LOCK(wallet.cs_wallet);
+    wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+    wallet.SetupDescriptorScriptPubKeyMans();
+    if (wallet.LoadWallet() != DBErrors::LOAD_OK) assert(false);
+    wallet.SetLastBlockProcessed(200, uint256::ONE);
+
+    CTxDestination dest;
+    bilingual_str error;
+    if (!wallet.GetNewDestination(OutputType::BECH32, "", dest, error)) assert(false);
+    const CScript script_mine = GetScriptForDestination(dest);
+    const CScript script_other = CScript() << OP_TRUE;
+
+    static constexpr int OUTPUTS_PER_TX{200};
+    for (int i = 0; i < num_coins * 2 / OUTPUTS_PER_TX; ++i) {
+        CMutableTransaction tx;
+        tx.nLockTime = i; // so all transactions get different hashes
+        tx.vout.resize(OUTPUTS_PER_TX);
+        for (int n = 0; n < OUTPUTS_PER_TX; ++n) {
+            tx.vout[n].nValue = (1 + n) * COIN;
+            tx.vout[n].scriptPubKey = n % 2 ? script_other : script_mine;
+        }
+        wallet.AddToWallet(MakeTransactionRef(std::move(tx)), TxStateConfirmed{uint256::ONE, 100, i, false});
+    }
+
+    std::vector<COutput> coins;
+    bench.run([&] {
+        AvailableCoins(wallet, coins);
+        assert(coins.size() == size_t(num_coins));
+    });
+}
+
+static void WalletAvailableCoins100k(benchmark::Bench& bench) { WalletAvailableCoins(bench, 100000); }
+static void WalletAvailableCoins1M(benchmark::Bench& bench) { WalletAvailableCoins(bench, 1000000); }
+
 typedef std::set<CInputCoin> CoinSet;
 
 // Copied from src/wallet/test/coinselector_tests.cpp
@@ -115,4 +163,6 @@ static void BnBExhaustion(benchmark::Bench& bench)
 }
 
 BENCHMARK(CoinSelection);
+BENCHMARK(WalletAvailableCoins100k);
+BENCHMARK(WalletAvailableCoins1M);
 BENCHMARK(BnBExhaustion);
@@ -10,14 +10,14 @@
 
 #include <vector>
 
-static void AddTx(const CTransactionRef& tx, CTxMemPool& pool) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool, CAmount fee = 1000) EXCLUSIVE_LOCKS_REQUIRED(cs_main, pool.cs)
 {
     int64_t nTime = 0;
     unsigned int nHeight = 1;
     bool spendsCoinbase = false;
     unsigned int sigOpCost = 4;
     LockPoints lp;
-    pool.addUnchecked(CTxMemPoolEntry(tx, 1000, nTime, nHeight, spendsCoinbase, sigOpCost, lp));
+    pool.addUnchecked(CTxMemPoolEntry(tx, fee, nTime, nHeight, spendsCoinbase, sigOpCost, lp));
 }
 
 struct Available {
@@ -99,6 +99,55 @@ static void ComplexMemPool(benchmark::Bench& bench)
     });
 }
 
+/** Long chains of single input transactions, like a dApp submitting a series of
+ *  dependent contract calls, paired with a random fee per transaction. */
+static std::vector<std::pair<CTransactionRef, CAmount>> CreateDeepChains(FastRandomContext& det_rand, int num_chains, int depth)
+{
+    std::vector<std::pair<CTransactionRef, CAmount>> ordered_txs;
+    for (int chain = 0; chain < num_chains; ++chain) {
+        CMutableTransaction tx = CMutableTransaction();
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << CScriptNum(chain);
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << CScriptNum(chain) << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        for (int i = 0; i < depth; ++i) {
+            ordered_txs.emplace_back(MakeTransactionRef(tx), 100 + det_rand.randrange(10000));
+            tx.vin[0].prevout = COutPoint(ordered_txs.back().first->GetHash(), 0);
+            tx.vin[0].scriptSig = CScript() << CScriptNum(i);
+        }
+    }
+    return ordered_txs;
+}
+
+static void DeepChainMemPool(benchmark::Bench& bench, bool cluster_mode)
+{
+    FastRandomContext det_rand{true};
+    const int depth = bench.complexityN() > 1 ? static_cast<int>(bench.complexityN()) : 100;
+    const std::vector<std::pair<CTransactionRef, CAmount>> ordered_txs = CreateDeepChains(det_rand, /* num_chains */ 20, depth);
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>(CBaseChainParams::MAIN);
+    CTxMemPool pool;
+    pool.SetClusterMode(cluster_mode);
+    LOCK2(cs_main, pool.cs);
+    bench.run([&]() NO_THREAD_SAFETY_ANALYSIS {
+        for (const auto& [tx, fee] : ordered_txs) {
+            AddTx(tx, pool, fee);
+        }
+        pool.TrimToSize(pool.DynamicMemoryUsage() * 3 / 4);
+        pool.TrimToSize(0);
+    });
+}
+
+static void DeepChainMemPoolPackages(benchmark::Bench& bench)
+{
+    DeepChainMemPool(bench, /* cluster_mode */ false);
+}
+
+static void DeepChainMemPoolClusters(benchmark::Bench& bench)
+{
+    DeepChainMemPool(bench, /* cluster_mode */ true);
+}
+
 static void MempoolCheck(benchmark::Bench& bench)
 {
     FastRandomContext det_rand{true};
@@ -116,4 +165,6 @@ static void MempoolCheck(benchmark::Bench& bench)
 }
 
 BENCHMARK(ComplexMemPool);
+BENCHMARK(DeepChainMemPoolPackages);
+BENCHMARK(DeepChainMemPoolClusters);
 BENCHMARK(MempoolCheck);
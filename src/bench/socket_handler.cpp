@@ -0,0 +1,108 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addrman.h>
+#include <bench/bench.h>
+#include <compat.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <random.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+#include <util/sock.h>
+#include <util/system.h>
+#include <version.h>
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Enough connected peers for the cost of waiting on every socket to show
+static constexpr int NUM_PEERS{1000};
+
+/**
+ * Measure how long it takes from a message arriving on one random peer's
+ * socket until SocketHandler has handed it to the message processor, with
+ * all other peers idle.
+ */
+static void SocketHandlerLatency(benchmark::Bench& bench, bool use_epoll)
+{
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+
+    // Each peer takes two descriptors, one for each end of its socket pair.
+    const int num_peers = std::min(NUM_PEERS, (RaiseFileDescriptorLimit(2 * NUM_PEERS + 64) - 64) / 2);
+    assert(num_peers > 0);
+
+    AddrMan addrman{/*asmap=*/{}, /*deterministic=*/true, /*consistency_check_ratio=*/0};
+    ConnmanTestMsg connman{0x1337, 0x1337, addrman};
+    if (use_epoll) assert(connman.InitEpoll());
+
+    std::vector<CNode*> nodes;
+    std::vector<int> remote_ends;
+    for (int i = 0; i < num_peers; ++i) {
+        int fds[2];
+        assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+        CNode* node = new CNode{/*id=*/i,
+                                NODE_NONE,
+                                std::make_shared<Sock>(fds[0]),
+                                CAddress{},
+                                /*nKeyedNetGroupIn=*/0,
+                                /*nLocalHostNonceIn=*/0,
+                                CAddress{},
+                                /*addrNameIn=*/"",
+                                ConnectionType::INBOUND,
+                                /*inbound_onion=*/false};
+        connman.AddTestNode(*node);
+        nodes.push_back(node);
+        remote_ends.push_back(fds[1]);
+    }
+
+    CSerializedNetMsg msg = CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, uint64_t{0});
+    std::vector<unsigned char> bytes;
+    V1TransportSerializer{}.prepareForTransport(msg, bytes);
+    bytes.insert(bytes.end(), msg.data.begin(), msg.data.end());
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    bench.unit("message").run([&] {
+        const int i = rng.randrange(num_peers);
+        assert(write(remote_ends[i], bytes.data(), bytes.size()) == (ssize_t)bytes.size());
+
+        bool received{false};
+        while (!received) {
+            connman.SocketHandlerOnce();
+            LOCK(nodes[i]->cs_vProcessMsg);
+            received = !nodes[i]->vProcessMsg.empty();
+            nodes[i]->vProcessMsg.clear();
+            nodes[i]->nProcessQueueSize = 0;
+        }
+    });
+
+    connman.ClearTestNodes();
+    for (const int fd : remote_ends) {
+        close(fd);
+    }
+}
+
+static void SocketHandlerPoll(benchmark::Bench& bench)
+{
+    SocketHandlerLatency(bench, /*use_epoll=*/false);
+}
+
+BENCHMARK(SocketHandlerPoll);
+
+#ifdef USE_EPOLL
+static void SocketHandlerEpoll(benchmark::Bench& bench)
+{
+    SocketHandlerLatency(bench, /*use_epoll=*/true);
+}
+
+BENCHMARK(SocketHandlerEpoll);
+#endif
+#endif // WIN32
@@ -0,0 +1,114 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <univalue.h>
+
+#include <cassert>
+#include <string>
+
+/** A batch of JSON-RPC requests as sent by an exchange or explorer */
+static std::string BatchRequest()
+{
+    UniValue batch(UniValue::VARR);
+    for (int i = 0; i < 500; ++i) {
+        UniValue params(UniValue::VARR);
+        if (i % 2) {
+            params.push_back(std::string(64, "0123456789abcdef"[i % 16]));
+            params.push_back(true);
+        } else {
+            params.push_back("b4ae05e6a6a4d5e2a2f8a12bc63e5f7a9ec3e2ed");
+            params.push_back("70a08231000000000000000000000000" + std::string(40, 'f'));
+        }
+        UniValue request(UniValue::VOBJ);
+        request.pushKV("jsonrpc", "1.0");
+        request.pushKV("id", i);
+        request.pushKV("method", i % 2 ? "getrawtransaction" : "callcontract");
+        request.pushKV("params", params);
+        batch.push_back(request);
+    }
+    return batch.write();
+}
+
+/** A block as returned by getblock with verbosity 2 */
+static UniValue VerboseBlock()
+{
+    UniValue txs(UniValue::VARR);
+    for (int i = 0; i < 200; ++i) {
+        UniValue sig(UniValue::VOBJ);
+        sig.pushKV("asm", std::string(140, 'd') + "[ALL] " + std::string(66, 'e'));
+        sig.pushKV("hex", std::string(214, 'f'));
+        UniValue in(UniValue::VOBJ);
+        in.pushKV("txid", std::string(64, 'c'));
+        in.pushKV("vout", 1);
+        in.pushKV("scriptSig", sig);
+        in.pushKV("sequence", int64_t{4294967295});
+        UniValue vin(UniValue::VARR);
+        vin.push_back(in);
+
+        UniValue vout(UniValue::VARR);
+        for (int n = 0; n < 2; ++n) {
+            UniValue spk(UniValue::VOBJ);
+            spk.pushKV("asm", "OP_DUP OP_HASH160 " + std::string(40, '1') + " OP_EQUALVERIFY OP_CHECKSIG");
+            spk.pushKV("hex", std::string(50, '2'));
+            spk.pushKV("address", "qUbxboqjBRp96j3La8D1RYkyqx5uQbJPoW");
+            spk.pushKV("type", "pubkeyhash");
+            UniValue out(UniValue::VOBJ);
+            out.pushKV("value", UniValue(UniValue::VNUM, "12.34567890"));
+            out.pushKV("n", n);
+            out.pushKV("scriptPubKey", spk);
+            vout.push_back(out);
+        }
+
+        UniValue tx(UniValue::VOBJ);
+        tx.pushKV("txid", std::string(64, 'a'));
+        tx.pushKV("hash", std::string(64, 'b'));
+        tx.pushKV("version", 2);
+        tx.pushKV("size", 225);
+        tx.pushKV("locktime", 0);
+        tx.pushKV("vin", vin);
+        tx.pushKV("vout", vout);
+        tx.pushKV("hex", std::string(450, '3'));
+        txs.push_back(tx);
+    }
+    UniValue block(UniValue::VOBJ);
+    block.pushKV("hash", std::string(64, '0'));
+    block.pushKV("height", 123456);
+    block.pushKV("difficulty", 1234.5678);
+    block.pushKV("tx", txs);
+    return block;
+}
+
+static void UniValueParseBatch(benchmark::Bench& bench)
+{
+    const std::string json = BatchRequest();
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        bool ok = value.read(json);
+        assert(ok);
+    });
+}
+
+static void UniValueParseBlock(benchmark::Bench& bench)
+{
+    const std::string json = VerboseBlock().write();
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        bool ok = value.read(json);
+        assert(ok);
+    });
+}
+
+static void UniValueWriteBlock(benchmark::Bench& bench)
+{
+    const UniValue block = VerboseBlock();
+    bench.run([&] {
+        ankerl::nanobench::doNotOptimizeAway(block.write());
+    });
+}
+
+BENCHMARK(UniValueParseBatch);
+BENCHMARK(UniValueParseBlock);
+BENCHMARK(UniValueWriteBlock);
@@ -0,0 +1,55 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <key.h>
+#include <key_io.h>
+#include <script/descriptor.h>
+#include <test/util/setup_common.h>
+#include <wallet/scriptpubkeyman.h>
+#include <wallet/wallet.h>
+#include <wallet/walletutil.h>
+
+#include <vector>
+
+using wallet::CreateMockWalletDatabase;
+using wallet::CWallet;
+using wallet::DescriptorScriptPubKeyMan;
+using wallet::WALLET_FLAG_DESCRIPTORS;
+using wallet::WalletDescriptor;
+
+// Loading a descriptor wallet derives every cached index of its ranged
+// descriptors from the cached parent xpub and fills the scriptPubKey map.
+static void WalletLoadDescriptor(benchmark::Bench& bench, int32_t num_scripts)
+{
+    const auto test_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+
+    CWallet wallet{/*chain=*/nullptr, "", gArgs, CreateMockWalletDatabase()};
+    wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+
+    CExtKey master;
+    master.SetSeed(std::vector<uint8_t>(32, 0x01));
+    FlatSigningProvider keys;
+    std::string error;
+    auto descriptor = Parse("wpkh(" + EncodeExtPubKey(master.Neuter()) + "/0/*)", keys, error, /*require_checksum=*/false);
+    assert(descriptor);
+    WalletDescriptor w_desc(std::move(descriptor), /*creation_time=*/0, /*range_start=*/0, /*range_end=*/0, /*next_index=*/0);
+    DescriptorScriptPubKeyMan spk_man(wallet, w_desc);
+    const bool topped_up = spk_man.TopUp(num_scripts);
+    assert(topped_up);
+    const WalletDescriptor loaded_desc = spk_man.GetWalletDescriptor();
+
+    bench.run([&] {
+        WalletDescriptor desc = loaded_desc;
+        DescriptorScriptPubKeyMan loaded(wallet, desc);
+        loaded.SetCache(loaded_desc.cache);
+        assert(loaded.GetEndRange() == num_scripts);
+    });
+}
+
+static void WalletLoadDescriptor100k(benchmark::Bench& bench) { WalletLoadDescriptor(bench, 100000); }
+static void WalletLoadDescriptor1M(benchmark::Bench& bench) { WalletLoadDescriptor(bench, 1000000); }
+
+BENCHMARK(WalletLoadDescriptor100k);
+BENCHMARK(WalletLoadDescriptor1M);
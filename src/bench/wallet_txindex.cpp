@@ -0,0 +1,86 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <wallet/transaction.h>
+#include <wallet/wallettxindex.h>
+
+#include <memory>
+#include <vector>
+
+using wallet::CWalletTx;
+using wallet::TxStateConfirmed;
+using wallet::TxStateInMempool;
+using wallet::WalletTxIndex;
+
+static constexpr int NUM_ADDRESSES{1000};
+static constexpr int TXS_PER_BLOCK{100};
+
+static PKHash Address(int n)
+{
+    std::vector<unsigned char> bytes(20, 0);
+    bytes[0] = n & 0xff;
+    bytes[1] = (n >> 8) & 0xff;
+    return PKHash(uint160(bytes));
+}
+
+// A wallet of num_txs transactions spread over blocks and addresses, the last
+// block of transactions being in the mempool.
+static void BuildWalletTxs(int num_txs, std::vector<std::unique_ptr<CWalletTx>>& wtxs, WalletTxIndex& index, int& tip_height)
+{
+    tip_height = num_txs / TXS_PER_BLOCK - 1;
+    for (int i = 0; i < num_txs; ++i) {
+        CMutableTransaction tx;
+        tx.nLockTime = i; // so all transactions get different hashes
+        tx.vout.resize(1);
+        tx.vout[0].nValue = COIN;
+        tx.vout[0].scriptPubKey = GetScriptForDestination(Address(i % NUM_ADDRESSES));
+        const int height = i / TXS_PER_BLOCK;
+        if (height < tip_height) {
+            wtxs.push_back(std::make_unique<CWalletTx>(MakeTransactionRef(std::move(tx)), TxStateConfirmed{uint256::ONE, height, i % TXS_PER_BLOCK, false}));
+        } else {
+            wtxs.push_back(std::make_unique<CWalletTx>(MakeTransactionRef(std::move(tx)), TxStateInMempool{}));
+        }
+        index.AddTx(*wtxs.back());
+    }
+}
+
+// The transactions listsinceblock returns for a block six blocks below the tip.
+static void WalletTxsSinceBlock(benchmark::Bench& bench, int num_txs)
+{
+    std::vector<std::unique_ptr<CWalletTx>> wtxs;
+    WalletTxIndex index;
+    int tip_height;
+    BuildWalletTxs(num_txs, wtxs, index, tip_height);
+
+    bench.run([&] {
+        const auto txids = index.GetTxsAbove(tip_height - 6);
+        assert(txids.size() == 6 * TXS_PER_BLOCK);
+    });
+}
+
+// The transactions getreceivedbyaddress tallies for one address.
+static void WalletTxsPayingTo(benchmark::Bench& bench, int num_txs)
+{
+    std::vector<std::unique_ptr<CWalletTx>> wtxs;
+    WalletTxIndex index;
+    int tip_height;
+    BuildWalletTxs(num_txs, wtxs, index, tip_height);
+
+    const CTxDestination dest = Address(0);
+    bench.run([&] {
+        const auto txids = index.GetTxsPayingTo(dest);
+        assert(txids.size() == size_t(num_txs / NUM_ADDRESSES));
+    });
+}
+
+static void WalletTxsSinceBlock100k(benchmark::Bench& bench) { WalletTxsSinceBlock(bench, 100000); }
+static void WalletTxsSinceBlock1M(benchmark::Bench& bench) { WalletTxsSinceBlock(bench, 1000000); }
+static void WalletTxsPayingTo100k(benchmark::Bench& bench) { WalletTxsPayingTo(bench, 100000); }
+static void WalletTxsPayingTo1M(benchmark::Bench& bench) { WalletTxsPayingTo(bench, 1000000); }
+
+BENCHMARK(WalletTxsSinceBlock100k);
+BENCHMARK(WalletTxsSinceBlock1M);
+BENCHMARK(WalletTxsPayingTo100k);
+BENCHMARK(WalletTxsPayingTo1M);
@@ -0,0 +1,55 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <test/util/setup_common.h>
+#include <util/translation.h>
+#include <wallet/db.h>
+#include <wallet/sqlite.h>
+
+#include <optional>
+#include <string>
+#include <vector>
+
+using wallet::DatabaseOptions;
+using wallet::DatabaseStatus;
+using wallet::DatabaseWriteGroup;
+using wallet::MakeSQLiteDatabase;
+
+// Number of records written by one wallet event, e.g. a block paying to the
+// wallet or a keypool refill.
+static constexpr int WRITES_PER_EVENT{100};
+
+static void WalletWrite(benchmark::Bench& bench, bool write_group, const std::vector<const char*>& extra_args = {})
+{
+    const auto test_setup = MakeNoLogFileContext<const BasicTestingSetup>(CBaseChainParams::REGTEST, extra_args);
+
+    DatabaseOptions options;
+    options.require_create = true;
+    DatabaseStatus status;
+    bilingual_str error;
+    const auto database = MakeSQLiteDatabase(test_setup->m_path_root / "wallet_write", options, status, error);
+    assert(database);
+
+    const std::vector<unsigned char> value(100, 0x42);
+    int64_t key{0};
+    bench.run([&] {
+        std::optional<DatabaseWriteGroup> group;
+        if (write_group) group.emplace(*database);
+        for (int i = 0; i < WRITES_PER_EVENT; ++i) {
+            // A fresh batch per write, as made by WalletBatch for most wallet updates
+            const bool written = database->MakeBatch()->Write(std::make_pair(std::string{"bench"}, key++), value);
+            assert(written);
+        }
+        if (group) group->Commit();
+    });
+}
+
+static void WalletWriteSQLite(benchmark::Bench& bench) { WalletWrite(bench, /*write_group=*/false); }
+static void WalletWriteSQLiteGroup(benchmark::Bench& bench) { WalletWrite(bench, /*write_group=*/true); }
+static void WalletWriteSQLiteGroupWAL(benchmark::Bench& bench) { WalletWrite(bench, /*write_group=*/true, {"-walletsqlitejournal=wal", "-walletsqlitesync=normal"}); }
+
+BENCHMARK(WalletWriteSQLite);
+BENCHMARK(WalletWriteSQLiteGroup);
+BENCHMARK(WalletWriteSQLiteGroupWAL);
@@ -12,13 +12,17 @@
 #include <chainparamsbase.h>
 #include <clientversion.h>
 #include <core_io.h>
+#include <qtum/vmtrace.h>
 #include <streams.h>
+#include <univalue.h>
+#include <util/strencodings.h>
 #include <util/system.h>
 #include <util/translation.h>
 
 #include <atomic>
 #include <cstdio>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <thread>
 
@@ -35,6 +39,7 @@ static void SetupBitcoinUtilArgs(ArgsManager &argsman)
     argsman.AddArg("-version", "Print version and exit", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 
     argsman.AddCommand("grind", "Perform proof of work on hex header string");
+    argsman.AddCommand("vmtrace", "Print the contract executions recorded with -record-log-opcodes, one JSON object per line. Arguments: <vmtrace directory> <txid> or <vmtrace directory> <fromblock> [<toblock>]");
 
     SetupChainParamsBaseOptions(argsman);
 }
@@ -143,6 +148,37 @@ static int Grind(const std::vector<std::string>& args, std::string& strPrint)
     return EXIT_SUCCESS;
 }
 
+static int VMTraceDecode(const std::vector<std::string>& args, std::string& strPrint)
+{
+    if (args.size() < 2 || args.size() > 3) {
+        strPrint = "Must specify the vmtrace directory and a txid or block range";
+        return EXIT_FAILURE;
+    }
+
+    VMTrace trace(fs::PathFromString(args[0]));
+    if (!trace.Open(/*read_only=*/true)) {
+        strPrint = "Could not open the VM trace in " + args[0];
+        return EXIT_FAILURE;
+    }
+
+    std::vector<VMTraceRecord> records;
+    int from{0};
+    int to{std::numeric_limits<int>::max()};
+    if (args.size() == 2 && IsHex(args[1]) && args[1].size() == 64) {
+        records = trace.ReadTx(uint256S(args[1]));
+    } else if (ParseInt32(args[1], &from) && (args.size() == 2 || ParseInt32(args[2], &to)) && from >= 0 && from <= to) {
+        records = trace.ReadRange(from, to, std::numeric_limits<size_t>::max());
+    } else {
+        strPrint = "Invalid txid or block range";
+        return EXIT_FAILURE;
+    }
+
+    for (const VMTraceRecord& record : records) {
+        tfm::format(std::cout, "%s\n", VMTraceRecordToJSON(record).write());
+    }
+    return EXIT_SUCCESS;
+}
+
 #ifdef WIN32
 // Export main() and ensure working ASLR on Windows.
 // Exporting a symbol will prevent the linker from stripping
@@ -181,6 +217,8 @@ int main(int argc, char* argv[])
     try {
         if (cmd->command == "grind") {
             ret = Grind(cmd->args, strPrint);
+        } else if (cmd->command == "vmtrace") {
+            ret = VMTraceDecode(cmd->args, strPrint);
         } else {
             assert(false); // unknown command should be caught earlier
         }
@@ -13,21 +13,40 @@
 #include <txmempool.h>
 #include <validation.h>
 #include <util/system.h>
+#include <util/time.h>
 
 #include <unordered_map>
 
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool fUseWTXID) :
         nonce(GetRand(std::numeric_limits<uint64_t>::max())),
-        shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
+        header(block) {
     FillShortTxIDSelector();
-    //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
-    prefilledtxn[0] = {0, block.vtx[0]};
-    for (size_t i = 1; i < block.vtx.size(); i++) {
+    //TODO: Use our mempool prior to block acceptance to predictively fill more than just the transactions no peer can have
+    shorttxids.reserve(block.vtx.size() - 1);
+    int32_t last_prefilled = -1;
+    for (size_t i = 0; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        shorttxids[i - 1] = GetShortID(fUseWTXID ? tx.GetWitnessHash() : tx.GetHash());
+        if (i == 0 || IsCompactBlockPrefilled(tx)) {
+            // Indexes are sent relative to the previous prefilled transaction
+            prefilledtxn.push_back({uint16_t(i - last_prefilled - 1), block.vtx[i]});
+            last_prefilled = i;
+        } else {
+            shorttxids.push_back(GetShortID(fUseWTXID ? tx.GetWitnessHash() : tx.GetHash()));
+        }
     }
 }
 
+bool IsCompactBlockPrefilled(const CTransaction& tx)
+{
+    return tx.IsCoinBase() || tx.IsCoinStake() || tx.HasOpSpend();
+}
+
+CompactBlockStats& GetCompactBlockStats()
+{
+    static CompactBlockStats stats;
+    return stats;
+}
+
 void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
     CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
     stream << header << nonce;
@@ -53,6 +72,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         return READ_STATUS_INVALID;
 
     assert(header.IsNull() && txn_available.empty());
+    m_init_time_us = GetTimeMicros();
     header = cmpctblock.header;
     txn_available.resize(cmpctblock.BlockTxCount());
 
@@ -94,13 +114,17 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
         // Thus: P(max_elements_per_bucket > N) <= S * (1 - cdf(binomial(n=S,p=1/S), N)).
         // If we assume blocks of up to 16000, allowing 12 elements per bucket should
         // only fail once per ~1 million block transfers (per peer and connection).
-        if (shorttxids.bucket_size(shorttxids.bucket(cmpctblock.shorttxids[i])) > 12)
+        if (shorttxids.bucket_size(shorttxids.bucket(cmpctblock.shorttxids[i])) > 12) {
+            GetCompactBlockStats().failed++;
             return READ_STATUS_FAILED;
+        }
     }
     // TODO: in the shortid-collision case, we should instead request both transactions
     // which collided. Falling back to full-block-request here is overkill.
-    if (shorttxids.size() != cmpctblock.shorttxids.size())
+    if (shorttxids.size() != cmpctblock.shorttxids.size()) {
+        GetCompactBlockStats().failed++;
         return READ_STATUS_FAILED; // Short ID collision
+    }
 
     std::vector<bool> have_txn(txn_available.size());
     {
@@ -162,6 +186,7 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
             break;
     }
 
+    GetCompactBlockStats().received++;
     LogPrint(BCLog::CMPCTBLOCK, "Initialized PartiallyDownloadedBlock for block %s using a cmpctblock of size %lu\n", cmpctblock.header.GetHash().ToString(), GetSerializeSize(cmpctblock, PROTOCOL_VERSION));
 
     return READ_STATUS_OK;
@@ -202,11 +227,20 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
         // but that is expensive, and CheckBlock caches a block's
         // "checked-status" (in the CBlock?). CBlock should be able to
         // check its own merkle root and cache that check.
-        if (state.GetResult() == BlockValidationResult::BLOCK_MUTATED)
+        if (state.GetResult() == BlockValidationResult::BLOCK_MUTATED) {
+            GetCompactBlockStats().failed++;
             return READ_STATUS_FAILED; // Possible Short ID collision
+        }
         return READ_STATUS_CHECKBLOCK_FAILED;
     }
 
+    CompactBlockStats& stats = GetCompactBlockStats();
+    (vtx_missing.empty() ? stats.reconstructed : stats.reconstructed_after_request)++;
+    stats.txn_prefilled += prefilled_count;
+    stats.txn_from_mempool += mempool_count;
+    stats.txn_requested += vtx_missing.size();
+    stats.reconstruct_time_us += GetTimeMicros() - m_init_time_us;
+
     LogPrint(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing) {
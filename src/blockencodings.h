@@ -7,6 +7,7 @@
 
 #include <primitives/block.h>
 
+#include <atomic>
 
 class CTxMemPool;
 class ChainstateManager;
@@ -84,6 +85,33 @@ typedef enum ReadStatus_t
                                    // failure in CheckBlock.
 } ReadStatus;
 
+/**
+ * Whether a block transaction is sent in full in compact blocks. Besides the
+ * coinbase this is the coinstake and the condensing transactions created
+ * while executing contracts: none of them is ever relayed on its own, so no
+ * peer can have them in its mempool.
+ */
+bool IsCompactBlockPrefilled(const CTransaction& tx);
+
+/** Counters for how compact blocks were turned back into full blocks. */
+struct CompactBlockStats {
+    //! Compact blocks that were accepted for reconstruction.
+    std::atomic<uint64_t> received{0};
+    //! Blocks reconstructed without asking the peer for transactions.
+    std::atomic<uint64_t> reconstructed{0};
+    //! Blocks reconstructed after a getblocktxn round trip.
+    std::atomic<uint64_t> reconstructed_after_request{0};
+    //! Reconstructions that fell back to downloading the full block.
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> txn_prefilled{0};
+    std::atomic<uint64_t> txn_from_mempool{0};
+    std::atomic<uint64_t> txn_requested{0};
+    //! Total time from receiving a compact block to having the full block, for successful reconstructions.
+    std::atomic<uint64_t> reconstruct_time_us{0};
+};
+
+CompactBlockStats& GetCompactBlockStats();
+
 class CBlockHeaderAndShortTxIDs {
 private:
     mutable uint64_t shorttxidk0, shorttxidk1;
@@ -127,6 +155,7 @@ class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
     size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    int64_t m_init_time_us{0};
     const CTxMemPool* pool;
     const ChainstateManager* chainman;
 public:
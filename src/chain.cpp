@@ -7,6 +7,8 @@
 #include <util/time.h>
 #include <pubkey.h>
 
+#include <algorithm>
+
 std::string CBlockFileInfo::ToString() const
 {
     return strprintf("CBlockFileInfo(blocks=%u, size=%u, heights=%u...%u, time=%s...%s)", nBlocks, nSize, nHeightFirst, nHeightLast, FormatISO8601Date(nTimeFirst), FormatISO8601Date(nTimeLast));
@@ -174,28 +176,73 @@ const CBlockIndex* LastCommonAncestor(const CBlockIndex* pa, const CBlockIndex*
     return pa;
 }
 
+const unsigned char* BlockSigArena::Store(Span<const unsigned char> data)
+{
+    if (data.empty()) return nullptr;
+
+    LOCK(m_mutex);
+    unsigned char* ret;
+    if (data.size() > CHUNK_SIZE) {
+        // Oversized entries get a dedicated chunk, the open chunk stays the last one
+        auto chunk = std::make_unique<unsigned char[]>(data.size());
+        ret = chunk.get();
+        m_chunks.insert(m_chunks.empty() ? m_chunks.end() : m_chunks.end() - 1, std::move(chunk));
+        m_allocated += data.size();
+    } else {
+        if (m_chunk_pos + data.size() > CHUNK_SIZE) {
+            m_chunks.push_back(std::make_unique<unsigned char[]>(CHUNK_SIZE));
+            m_allocated += CHUNK_SIZE;
+            m_chunk_pos = 0;
+        }
+        ret = m_chunks.back().get() + m_chunk_pos;
+        m_chunk_pos += data.size();
+    }
+    std::copy(data.begin(), data.end(), ret);
+    m_used += data.size();
+    ++m_entries;
+    return ret;
+}
+
+void BlockSigArena::Clear()
+{
+    LOCK(m_mutex);
+    m_chunks.clear();
+    m_chunk_pos = CHUNK_SIZE;
+    m_used = 0;
+    m_allocated = 0;
+    m_entries = 0;
+}
+
+BlockSigArena::Stats BlockSigArena::GetStats() const
+{
+    LOCK(m_mutex);
+    return Stats{m_used, m_allocated, m_chunks.size(), m_entries};
+}
+
 std::vector<unsigned char> CBlockIndex::GetBlockSignature() const
 {
-    if(vchBlockSigDlgt.size() < 2 * CPubKey::COMPACT_SIGNATURE_SIZE)
+    Span<const unsigned char> sig = GetBlockSigDlgt();
+    if(sig.size() < 2 * CPubKey::COMPACT_SIGNATURE_SIZE)
     {
-        return vchBlockSigDlgt;
+        return std::vector<unsigned char>(sig.begin(), sig.end());
     }
 
-    return std::vector<unsigned char>(vchBlockSigDlgt.begin(), vchBlockSigDlgt.end() - CPubKey::COMPACT_SIGNATURE_SIZE );
+    return std::vector<unsigned char>(sig.begin(), sig.end() - CPubKey::COMPACT_SIGNATURE_SIZE );
 }
 
 std::vector<unsigned char> CBlockIndex::GetProofOfDelegation() const
 {
-    if(vchBlockSigDlgt.size() < 2 * CPubKey::COMPACT_SIGNATURE_SIZE)
+    Span<const unsigned char> sig = GetBlockSigDlgt();
+    if(sig.size() < 2 * CPubKey::COMPACT_SIGNATURE_SIZE)
     {
         return std::vector<unsigned char>();
     }
 
-    return std::vector<unsigned char>(vchBlockSigDlgt.begin() + vchBlockSigDlgt.size() - CPubKey::COMPACT_SIGNATURE_SIZE, vchBlockSigDlgt.end());
+    return std::vector<unsigned char>(sig.end() - CPubKey::COMPACT_SIGNATURE_SIZE, sig.end());
 
 }
 
 bool CBlockIndex::HasProofOfDelegation() const
 {
-    return vchBlockSigDlgt.size() >= 2 * CPubKey::COMPACT_SIGNATURE_SIZE;
+    return m_sig_dlgt_size >= 2 * CPubKey::COMPACT_SIGNATURE_SIZE;
 }
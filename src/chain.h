@@ -10,10 +10,12 @@
 #include <consensus/params.h>
 #include <flatfile.h>
 #include <primitives/block.h>
+#include <span.h>
 #include <sync.h>
 #include <tinyformat.h>
 #include <uint256.h>
 
+#include <memory>
 #include <vector>
 
 /**
@@ -143,6 +145,46 @@ enum BlockStatus : uint32_t {
     BLOCK_ASSUMED_VALID      =   256,
 };
 
+/**
+ * Append-only storage for the block signature and proof of delegation bytes
+ * referenced by CBlockIndex entries. The bytes are packed back to back in
+ * large chunks, so an index entry only carries a pointer and a length instead
+ * of an individually heap allocated vector. Bytes are not released one by one:
+ * the arena is owned by the BlockManager and cleared together with its block
+ * index. Temporary index entries must not store their signature here, see
+ * CBlockIndex::RefBlockSigDlgt().
+ */
+class BlockSigArena
+{
+public:
+    struct Stats
+    {
+        size_t used;
+        size_t allocated;
+        size_t chunks;
+        size_t entries;
+    };
+
+    /** Copy data into the arena and return a pointer to the stored bytes, or nullptr if data is empty. */
+    const unsigned char* Store(Span<const unsigned char> data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Release all stored bytes. No index entry may reference them anymore. */
+    void Clear() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    mutable Mutex m_mutex;
+    std::vector<std::unique_ptr<unsigned char[]>> m_chunks GUARDED_BY(m_mutex);
+    //! Number of bytes handed out from the last chunk
+    size_t m_chunk_pos GUARDED_BY(m_mutex){CHUNK_SIZE};
+    size_t m_used GUARDED_BY(m_mutex){0};
+    size_t m_allocated GUARDED_BY(m_mutex){0};
+    size_t m_entries GUARDED_BY(m_mutex){0};
+};
+
 /** The block chain is a tree shaped structure starting with the
  * genesis block at the root, with each block potentially having multiple
  * candidates to be the next block. A blockindex may have multiple pprev pointing
@@ -211,8 +253,6 @@ public:
     uint32_t nNonce{0};
     uint256 hashStateRoot{}; // qtum
     uint256 hashUTXORoot{}; // qtum
-    // block signature - proof-of-stake protect the block by signing the block using a stake holder private key
-    std::vector<unsigned char> vchBlockSigDlgt{};
     uint256 nStakeModifier{};
     // proof-of-stake specific fields
     COutPoint prevoutStake{};
@@ -225,6 +265,13 @@ public:
     //! (memory only) Maximum nTime in the chain up to and including this block.
     unsigned int nTimeMax{0};
 
+private:
+    // block signature - proof-of-stake protect the block by signing the block using a stake holder private key
+    // The bytes are owned by a BlockSigArena, or by the caller for temporary entries
+    const unsigned char* m_sig_dlgt{nullptr};
+    uint32_t m_sig_dlgt_size{0};
+
+public:
     CBlockIndex()
     {
     }
@@ -237,7 +284,6 @@ public:
           nNonce{block.nNonce},
           hashStateRoot{block.hashStateRoot},
           hashUTXORoot{block.hashUTXORoot},
-          vchBlockSigDlgt{block.vchBlockSigDlgt},
           prevoutStake{block.prevoutStake}
     {
     }
@@ -276,11 +322,32 @@ public:
         block.nNonce = nNonce;
         block.hashStateRoot = hashStateRoot; // qtum
         block.hashUTXORoot = hashUTXORoot; // qtum
-        block.vchBlockSigDlgt = vchBlockSigDlgt;
+        block.vchBlockSigDlgt.assign(m_sig_dlgt, m_sig_dlgt + m_sig_dlgt_size);
         block.prevoutStake = prevoutStake;
         return block;
     }
 
+    //! Block signature followed by the optional proof of delegation
+    Span<const unsigned char> GetBlockSigDlgt() const
+    {
+        return Span<const unsigned char>{m_sig_dlgt, m_sig_dlgt_size};
+    }
+
+    //! Copy the signature into arena, for entries of the block index
+    void SetBlockSigDlgt(Span<const unsigned char> sig, BlockSigArena& arena)
+    {
+        m_sig_dlgt = arena.Store(sig);
+        m_sig_dlgt_size = sig.size();
+    }
+
+    //! Reference the signature without copying it, for temporary entries. The
+    //! caller keeps the bytes alive for as long as this entry uses them.
+    void RefBlockSigDlgt(Span<const unsigned char> sig)
+    {
+        m_sig_dlgt = sig.data();
+        m_sig_dlgt_size = sig.size();
+    }
+
     uint256 GetBlockHash() const
     {
         return *phashBlock;
@@ -405,6 +472,7 @@ class CDiskBlockIndex : public CBlockIndex
 {
 public:
     uint256 hashPrev;
+    std::vector<unsigned char> vchBlockSigDlgt; // qtum
 
     CDiskBlockIndex()
     {
@@ -414,6 +482,8 @@ public:
     explicit CDiskBlockIndex(const CBlockIndex* pindex) : CBlockIndex(*pindex)
     {
         hashPrev = (pprev ? pprev->GetBlockHash() : uint256());
+        Span<const unsigned char> sig = pindex->GetBlockSigDlgt();
+        vchBlockSigDlgt.assign(sig.begin(), sig.end());
     }
 
     SERIALIZE_METHODS(CDiskBlockIndex, obj)
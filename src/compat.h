@@ -97,6 +97,11 @@ typedef char* sockopt_arg_type;
 #define USE_POLL
 #endif
 
+// epoll is only used when selected with -socketevents=epoll
+#if defined(__linux__) && defined(HAVE_SYS_EPOLL_H)
+#define USE_EPOLL
+#endif
+
 bool static inline IsSelectableSocket(const SOCKET& s) {
 #if defined(USE_POLL) || defined(WIN32)
     return true;
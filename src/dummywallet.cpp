@@ -51,6 +51,8 @@ void DummyWalletInit::AddWalletOptions(ArgsManager& argsman) const
         "-privdb",
         "-walletrejectlongchains",
         "-unsafesqlitesync",
+        "-walletsqlitejournal=<mode>",
+        "-walletsqlitesync=<level>",
     });
 }
 
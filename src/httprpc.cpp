@@ -22,12 +22,16 @@
 #include <stdio.h>
 #include <set>
 #include <string>
+#include <string_view>
 
 #include <boost/algorithm/string.hpp>
 
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/* Methods handled on the slow work queue. Set before the handlers are registered */
+static std::set<std::string> g_rpc_slow_methods;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -211,6 +215,10 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 jreq.PollReply(result);
                 return true;
             }
+            if (jreq.isStreaming) {
+                // The result was sent as it was written
+                return true;
+            }
 
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
@@ -250,6 +258,62 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
     return true;
 }
 
+/** Larger request bodies are not scanned for slow methods and run on the default work queue */
+static constexpr size_t MAX_CLASSIFY_BODY_BYTES{256 << 10};
+
+/**
+ * Whether a JSON-RPC request or batch calls a slow method. The body is scanned
+ * for "method": "<name>" pairs on the event loop thread without parsing it, so
+ * names spelled with escapes are missed and "method" keys inside the params
+ * count too. Either only changes the queue the request waits on; invalid
+ * requests are rejected by the handler, wherever it runs.
+ */
+static bool CallsSlowMethod(std::string_view body)
+{
+    enum class Expect { ANY, COLON, NAME } expect{Expect::ANY};
+    size_t pos{0};
+    while (pos < body.size()) {
+        const char c{body[pos]};
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++pos;
+        } else if (c == ':') {
+            expect = expect == Expect::COLON ? Expect::NAME : Expect::ANY;
+            ++pos;
+        } else if (c == '"') {
+            size_t end{pos + 1};
+            while (end < body.size() && body[end] != '"') {
+                end += body[end] == '\\' ? 2 : 1;
+            }
+            if (end >= body.size()) return false;
+            const std::string_view token{body.substr(pos + 1, end - pos - 1)};
+            if (expect == Expect::NAME) {
+                if (g_rpc_slow_methods.count(std::string{token}) > 0) return true;
+                expect = Expect::ANY;
+            } else {
+                expect = token == "method" ? Expect::COLON : Expect::ANY;
+            }
+            pos = end + 1;
+        } else {
+            expect = Expect::ANY;
+            ++pos;
+        }
+    }
+    return false;
+}
+
+/** Handle requests calling any slow method, alone or in a batch, on the slow work queue */
+static HTTPWorkQueueClass ClassifyJSONRPC(HTTPRequest* req)
+{
+    if (g_rpc_slow_methods.empty() || req->GetRequestMethod() != HTTPRequest::POST) {
+        return HTTPWorkQueueClass::DEFAULT;
+    }
+    const std::string_view body = req->PeekBody();
+    if (body.size() > MAX_CLASSIFY_BODY_BYTES || !CallsSlowMethod(body)) {
+        return HTTPWorkQueueClass::DEFAULT;
+    }
+    return HTTPWorkQueueClass::SLOW;
+}
+
 static bool InitRPCAuthentication()
 {
     if (gArgs.GetArg("-rpcpassword", "") == "")
@@ -306,10 +370,23 @@ bool StartHTTPRPC(const std::any& context)
     if (!InitRPCAuthentication())
         return false;
 
+    g_rpc_slow_methods.clear();
+    std::vector<std::string> slow_methods{DEFAULT_RPC_SLOW_METHODS};
+    if (gArgs.IsArgSet("-rpcslowmethod")) {
+        slow_methods = gArgs.GetArgs("-rpcslowmethod");
+    }
+    for (const std::string& methods : slow_methods) {
+        std::set<std::string> split;
+        boost::split(split, methods, boost::is_any_of(", "));
+        split.erase("");
+        g_rpc_slow_methods.insert(split.begin(), split.end());
+    }
+
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
-    RegisterHTTPHandler("/", true, handle_rpc);
+    auto classify_rpc = [](HTTPRequest* req, const std::string&) { return ClassifyJSONRPC(req); };
+    RegisterHTTPHandler("/", true, handle_rpc, classify_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, handle_rpc);
+        RegisterHTTPHandler("/wallet/", false, handle_rpc, classify_rpc);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
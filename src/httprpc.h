@@ -7,6 +7,9 @@
 
 #include <any>
 
+/** RPC methods handled on the slow HTTP work queue unless -rpcslowmethod is set */
+static const char* const DEFAULT_RPC_SLOW_METHODS = "searchlogs,getaddressdeltas,getaddresstxids,getaddressutxos,scantxoutset,gettxoutsetinfo,rescanblockchain,listvmtraces";
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -22,6 +22,7 @@
 #include <util/threadnames.h>
 #include <util/translation.h>
 
+#include <array>
 #include <deque>
 #include <memory>
 #include <stdio.h>
@@ -69,16 +70,21 @@ template <typename WorkItem>
 class WorkQueue
 {
 private:
+    using Clock = std::chrono::steady_clock;
+
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
+    std::deque<std::pair<Clock::time_point, std::unique_ptr<WorkItem>>> queue GUARDED_BY(cs);
     bool running GUARDED_BY(cs);
     const size_t maxDepth;
+    HTTPWorkQueueInfo info GUARDED_BY(cs);
 
 public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
+    WorkQueue(const std::string& name, size_t _maxDepth) : running(true),
                                  maxDepth(_maxDepth)
     {
+        info.name = name;
+        info.max_depth = maxDepth;
     }
     /** Precondition: worker threads have all stopped (they have been joined).
      */
@@ -90,28 +96,50 @@ public:
     {
         LOCK(cs);
         if (!running || queue.size() >= maxDepth) {
+            ++info.rejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queue.emplace_back(Clock::now(), std::unique_ptr<WorkItem>(item));
         cond.notify_one();
         return true;
     }
     /** Thread function */
     void Run()
     {
+        WITH_LOCK(cs, ++info.threads);
         while (true) {
             std::unique_ptr<WorkItem> i;
+            Clock::time_point start;
             {
                 WAIT_LOCK(cs, lock);
                 while (running && queue.empty())
                     cond.wait(lock);
                 if (!running && queue.empty())
                     break;
-                i = std::move(queue.front());
+                start = Clock::now();
+                const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(start - queue.front().first);
+                info.total_wait += wait;
+                info.max_wait = std::max(info.max_wait, wait);
+                ++info.active;
+                i = std::move(queue.front().second);
                 queue.pop_front();
             }
             (*i)();
+            const auto run = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+            LOCK(cs);
+            info.total_run += run;
+            info.max_run = std::max(info.max_run, run);
+            --info.active;
+            ++info.processed;
         }
+        WITH_LOCK(cs, --info.threads);
+    }
+    HTTPWorkQueueInfo GetInfo()
+    {
+        LOCK(cs);
+        HTTPWorkQueueInfo result = info;
+        result.depth = queue.size();
+        return result;
     }
     /** Interrupt and exit loops */
     void Interrupt()
@@ -124,13 +152,14 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
 };
 
 /** HTTP module state */
@@ -141,8 +170,8 @@ static struct event_base* eventBase = nullptr;
 static struct evhttp* eventHTTP = nullptr;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static std::unique_ptr<WorkQueue<HTTPClosure>> g_work_queue{nullptr};
+//! Work queues for handling longer requests off the event loop thread, by HTTPWorkQueueClass
+static std::array<std::unique_ptr<WorkQueue<HTTPClosure>>, 2> g_work_queues;
 //! Handlers for (sub)paths
 static Mutex g_httppathhandlers_mutex;
 static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_mutex);
@@ -209,6 +238,22 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+/** Re-enable reading from the socket of a request once it is replied to. This
+ * is the second part of the libevent workaround in http_request_cb.
+ */
+static void EnableReading(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -263,12 +308,17 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        HTTPWorkQueueClass work_class = i->classifier ? i->classifier(hreq.get(), path) : HTTPWorkQueueClass::DEFAULT;
+        // Without slow workers every request is handled by the default ones
+        if (!g_work_queues[size_t(work_class)]) work_class = HTTPWorkQueueClass::DEFAULT;
+        const auto& work_queue = g_work_queues[size_t(work_class)];
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(g_work_queue);
-        if (g_work_queue->Enqueue(item.get())) {
+        assert(work_queue);
+        if (work_queue->Enqueue(item.get())) {
             item.release(); /* if true, queue took ownership */
         } else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the %s= setting\n",
+                      work_class == HTTPWorkQueueClass::SLOW ? "-rpcslowworkqueue" : "-rpcworkqueue");
             item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
         }
     } else {
@@ -338,9 +388,9 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, const std::string& thread_name)
 {
-    util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    util::ThreadRename(std::string{thread_name});
     SetSyscallSandboxPolicy(SyscallSandboxPolicy::NET_HTTP_SERVER_WORKER);
     queue->Run();
 }
@@ -397,8 +447,14 @@ bool InitHTTPServer()
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)gArgs.GetIntArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
     LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    g_work_queues[size_t(HTTPWorkQueueClass::DEFAULT)] = std::make_unique<WorkQueue<HTTPClosure>>("default", workQueueDepth);
+
+    if (gArgs.GetIntArg("-rpcslowthreads", DEFAULT_HTTP_SLOW_THREADS) > 0) {
+        int slowQueueDepth = std::max((long)gArgs.GetIntArg("-rpcslowworkqueue", DEFAULT_HTTP_SLOW_WORKQUEUE), 1L);
+        LogPrintf("HTTP: creating slow work queue of depth %d\n", slowQueueDepth);
+        g_work_queues[size_t(HTTPWorkQueueClass::SLOW)] = std::make_unique<WorkQueue<HTTPClosure>>("slow", slowQueueDepth);
+    }
 
-    g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -430,8 +486,24 @@ void StartHTTPServer()
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
     for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queue.get(), i);
+        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, g_work_queues[size_t(HTTPWorkQueueClass::DEFAULT)].get(), strprintf("httpworker.%i", i));
+    }
+    if (const auto& slow_queue = g_work_queues[size_t(HTTPWorkQueueClass::SLOW)]) {
+        int slowThreads = gArgs.GetIntArg("-rpcslowthreads", DEFAULT_HTTP_SLOW_THREADS);
+        LogPrintf("HTTP: starting %d slow worker threads\n", slowThreads);
+        for (int i = 0; i < slowThreads; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, slow_queue.get(), strprintf("httpslow.%i", i));
+        }
+    }
+}
+
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo()
+{
+    std::vector<HTTPWorkQueueInfo> result;
+    for (const auto& work_queue : g_work_queues) {
+        if (work_queue) result.push_back(work_queue->GetInfo());
     }
+    return result;
 }
 
 void InterruptHTTPServer()
@@ -441,15 +513,15 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (g_work_queue) {
-        g_work_queue->Interrupt();
+    for (const auto& work_queue : g_work_queues) {
+        if (work_queue) work_queue->Interrupt();
     }
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (g_work_queue) {
+    if (g_work_queues[size_t(HTTPWorkQueueClass::DEFAULT)]) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
         for (auto& thread : g_thread_http_workers) {
             thread.join();
@@ -474,7 +546,9 @@ void StopHTTPServer()
         event_base_free(eventBase);
         eventBase = nullptr;
     }
-    g_work_queue.reset();
+    for (auto& work_queue : g_work_queues) {
+        work_queue.reset();
+    }
     LogPrint(BCLog::HTTP, "Stopped HTTP server\n");
 }
 
@@ -512,13 +586,16 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
-HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_req), replySent(_replySent), startedChunkTransfer(false), connClosed(false)
+HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_req), replySent(_replySent), startedChunkTransfer(false), startedStream(false), connClosed(false), streamClosed(std::make_shared<std::atomic<bool>>(false))
 {
 }
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent && !startedChunkTransfer) {
+    if (startedStream && !replySent) {
+        LogPrintf("%s: Unfinished streamed reply\n", __func__);
+        StreamAbort();
+    } else if (!replySent && !startedChunkTransfer) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -586,6 +663,10 @@ bool HTTPRequest::isChunkMode() {
     return startedChunkTransfer;
 }
 
+bool HTTPRequest::isStreamMode() {
+    return startedStream;
+}
+
 std::pair<bool, std::string> HTTPRequest::GetHeader(const std::string& hdr) const
 {
     const struct evkeyvalq* headers = evhttp_request_get_input_headers(req);
@@ -617,6 +698,18 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string_view HTTPRequest::PeekBody()
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return {};
+    size_t size = evbuffer_get_length(buf);
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return {};
+    return {data, size};
+}
+
 bool HTTPRequest::ReplySent() {
     return replySent;
 }
@@ -671,6 +764,89 @@ void HTTPRequest::Chunk(const std::string& chunk) {
     }
 }
 
+void HTTPRequest::StreamChunk(const std::string& chunk)
+{
+    assert(!replySent && req && !startedChunkTransfer);
+    if (!startedStream) {
+        if (ShutdownRequested()) {
+            WriteHeader("Connection", "close");
+        }
+        auto req_copy = req;
+        auto closed = streamClosed;
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, nullptr, [req_copy, closed] {
+            // A client going away is only noticed once a write fails. libevent then frees
+            // the connection, and the request is detached from it and left for us to free,
+            // so start watching before writing. The flag outlives the callback, as
+            // StreamEnd or StreamAbort always follow and unset it.
+            evhttp_connection_set_closecb(evhttp_request_get_connection(req_copy), [](evhttp_connection*, void* data) {
+                static_cast<std::atomic<bool>*>(data)->store(true);
+            }, closed.get());
+            evhttp_send_reply_start(req_copy, HTTP_OK, nullptr);
+        });
+        ev->trigger(nullptr);
+        startedStream = true;
+    }
+    if (chunk.empty() || StreamClosed()) return;
+    // Events are handled in the order they are triggered, so chunks are sent in order
+    auto databuf = evbuffer_new(); // HTTPEvent will free this buffer
+    evbuffer_add(databuf, chunk.data(), chunk.size());
+    auto req_copy = req;
+    auto closed = streamClosed;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, databuf, [req_copy, closed, databuf] {
+        if (!*closed) evhttp_send_reply_chunk(req_copy, databuf);
+    });
+    ev->trigger(nullptr);
+}
+
+void HTTPRequest::StreamEnd()
+{
+    assert(startedStream && !replySent && req);
+    auto req_copy = req;
+    auto closed = streamClosed;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, nullptr, [req_copy, closed] {
+        if (*closed) {
+            evhttp_request_free(req_copy);
+            return;
+        }
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        // The connection is kept open for the next request
+        evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        // Ending the reply may free the request, so re-enable reading first
+        EnableReading(req_copy);
+        evhttp_send_reply_end(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+void HTTPRequest::StreamAbort()
+{
+    assert(startedStream && !replySent && req);
+    auto req_copy = req;
+    auto closed = streamClosed;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, nullptr, [req_copy, closed] {
+        if (*closed) {
+            evhttp_request_free(req_copy);
+            return;
+        }
+        // Freeing the connection also frees the request, and the client
+        // never gets the chunk that ends the reply
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (!conn) return;
+        evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        evhttp_connection_free(conn);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+bool HTTPRequest::StreamClosed() const
+{
+    return *streamClosed;
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -689,17 +865,7 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, nullptr, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
-        }
+        EnableReading(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
@@ -752,11 +918,11 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
     LOCK(g_httppathhandlers_mutex);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -5,13 +5,21 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
+static const int DEFAULT_HTTP_SLOW_THREADS=2;
+static const int DEFAULT_HTTP_SLOW_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
 struct evhttp_request;
@@ -37,13 +45,48 @@ void StopHTTPServer();
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
 
+/** Work queues of the HTTP server. Each has its own worker threads and
+ * depth limit, so requests on one queue never wait for the workers of
+ * another.
+ */
+enum class HTTPWorkQueueClass {
+    DEFAULT, //!< -rpcthreads workers, -rpcworkqueue depth
+    SLOW,    //!< -rpcslowthreads workers, -rpcslowworkqueue depth
+};
+
+/** Metrics of an HTTP work queue */
+struct HTTPWorkQueueInfo {
+    std::string name;
+    int threads{0};
+    size_t max_depth{0};
+    //! Requests waiting for a worker
+    size_t depth{0};
+    //! Requests being handled by a worker
+    size_t active{0};
+    uint64_t processed{0};
+    //! Requests rejected because the queue was full
+    uint64_t rejected{0};
+    //! Time requests waited for a worker
+    std::chrono::microseconds total_wait{0};
+    std::chrono::microseconds max_wait{0};
+    //! Time workers spent handling requests
+    std::chrono::microseconds total_run{0};
+    std::chrono::microseconds max_run{0};
+};
+
+/** Return the metrics of the HTTP work queues */
+std::vector<HTTPWorkQueueInfo> GetHTTPWorkQueueInfo();
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Pick the work queue of a request. Called on the event loop thread, so it must be cheap. */
+typedef std::function<HTTPWorkQueueClass(HTTPRequest* req, const std::string &)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are handled on the work queue chosen by classifier,
+ * or on the default one if there is none.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -61,7 +104,11 @@ private:
     struct evhttp_request* req;
     bool replySent;
     bool startedChunkTransfer;
+    bool startedStream;
     bool connClosed;
+    //! Set on the main http thread once the connection of a streamed reply is closed,
+    //! after which libevent has freed req. Shared with the events that use req.
+    std::shared_ptr<std::atomic<bool>> streamClosed;
 
     std::mutex cs;
     std::condition_variable closeCv;
@@ -84,6 +131,7 @@ public:
     void setConnClosed();
     bool isConnClosed();
     bool isChunkMode();
+    bool isStreamMode();
 
     /** Get requested URI.
      */
@@ -111,6 +159,13 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Return the request body without consuming it.
+     *
+     * @note The result is valid until the body is read.
+     */
+    std::string_view PeekBody();
+
     /**
      * Write output header.
      *
@@ -138,6 +193,34 @@ public:
 	 */
     void ChunkEnd();
 
+    /**
+     * Send part of a reply with status 200, in chunked transfer encoding.
+     * Unlike Chunk, this keeps the connection open once the reply is done.
+     *
+     * @note Write the headers before the first part.
+     */
+    void StreamChunk(const std::string& chunk);
+
+    /**
+     * End a reply sent with StreamChunk. Do not call any other HTTPRequest
+     * methods after calling this.
+     */
+    void StreamEnd();
+
+    /**
+     * Close the connection of a reply sent with StreamChunk without ending
+     * it, so the client sees an incomplete reply rather than a truncated
+     * one. Do not call any other HTTPRequest methods after calling this.
+     */
+    void StreamAbort();
+
+    /**
+     * Whether the client closed the connection of a reply sent with
+     * StreamChunk. The parts sent after that are dropped, so the reply
+     * may as well be given up.
+     */
+    bool StreamClosed() const;
+
     /**
      * Is reply sent?
      */
@@ -19,6 +19,7 @@
 #include <util/translation.h>
 #include <libdevcore/Log.h>
 
+#include <algorithm>
 #include <memory>
 
 static std::unique_ptr<ECCVerifyHandle> globalVerifyHandle;
@@ -74,6 +75,8 @@ void AddLoggingArgs(ArgsManager& argsman)
     argsman.AddHiddenArgs({"-logthreadnames"});
 #endif
     argsman.AddArg("-logsourcelocations", strprintf("Prepend debug output with name of the originating source location (source file, line number and function name) (default: %u)", DEFAULT_LOGSOURCELOCATIONS), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logasync", strprintf("Write debug output of categories and EVM logs from a background thread, which batches writes. Other messages are written right away. Queued output is flushed when the process terminates on an unhandled exception, but lost when it is killed by a signal (default: %u)", DEFAULT_LOGASYNC), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-lograte=<n>", strprintf("Log at most <n> messages per second for each -debug category, 0 for no limit (default: %u)", DEFAULT_LOGRATELIMIT), ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)", DEFAULT_LOGTIMEMICROS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-printtoconsole", "Send trace/debug info to console (default: 1 when no -daemon. To disable logging to file, set -nodebuglogfile)", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-shrinkdebugfile", "Shrink debug.log file on client startup (default: 1 when no -debug)", ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
@@ -92,6 +95,8 @@ void SetLoggingOptions(const ArgsManager& args)
 #endif
     LogInstance().m_log_sourcelocations = args.GetBoolArg("-logsourcelocations", DEFAULT_LOGSOURCELOCATIONS);
     LogInstance().m_show_evm_logs = args.GetBoolArg("-showevmlogs", DEFAULT_SHOWEVMLOGS);
+    LogInstance().m_log_async = args.GetBoolArg("-logasync", DEFAULT_LOGASYNC);
+    LogInstance().m_rate_limit = std::max<int64_t>(0, args.GetIntArg("-lograte", DEFAULT_LOGRATELIMIT));
     dev::g_logPost = [&](std::string const& s, char const* c){ LogInstance().LogPrintStr(s + '\n', c ? c : "", "", 0, true); };
 
     fLogIPs = args.GetBoolArg("-logips", DEFAULT_LOGIPS);
@@ -5,6 +5,7 @@
 #ifndef BITCOIN_INTERFACES_CHAIN_H
 #define BITCOIN_INTERFACES_CHAIN_H
 
+#include <blockfilter.h>
 #include <primitives/transaction.h> // For CTransactionRef
 #include <util/settings.h>          // For util::SettingsValue
 #include <netbase.h>                // For ConnectionDirection
@@ -87,6 +88,16 @@ public:
     mutable bool found = false;
 };
 
+//! Event log of a contract executed by a block, as stored in the transaction
+//! receipts. Address and topics are in EVM byte order.
+struct ContractLog
+{
+    uint256 tx_hash;
+    uint160 address;
+    std::vector<uint256> topics;
+    std::vector<unsigned char> data;
+};
+
 //! Interface giving clients (wallet processes, maybe other analysis tools in
 //! the future) ability to access to the chain state, receive notifications,
 //! estimate fees, and submit transactions.
@@ -148,6 +159,17 @@ public:
     //! or contents.
     virtual bool findBlock(const uint256& hash, const FoundBlock& block={}) = 0;
 
+    //! Return whether a block filter index of the given type is enabled.
+    virtual bool hasBlockFilterIndex(BlockFilterType filter_type) = 0;
+
+    //! Return whether any of the elements match the BIP 157 filter of a
+    //! block, or std::nullopt if the filter for the block is not available.
+    virtual std::optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) = 0;
+
+    //! Get the event logs of the contracts executed by a connected block, in
+    //! block order. Return false if the receipts are not indexed (-logevents).
+    virtual bool getBlockContractLogs(const CBlock& block, std::vector<ContractLog>& logs) = 0;
+
     //! Find first block in the chain with timestamp >= the given time
     //! and height >= than the given height, return false if there is no block
     //! with a high enough timestamp and height. Optionally return block
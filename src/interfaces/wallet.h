@@ -334,6 +334,12 @@ public:
     //! Clean token transaction entries in the wallet
     virtual bool cleanTokenTxEntries() = 0;
 
+    //! Get the token balance kept up to date from the token transfers of connected blocks, if known.
+    virtual bool getTokenBalance(const uint256& id, std::string& balance) = 0;
+
+    //! Set the token balance as of the block at height, so the wallet keeps it up to date.
+    virtual bool setTokenBalance(const uint256& id, const std::string& balance, int height) = 0;
+
     //! Check if token transaction is mine
     virtual bool isTokenTxMine(const TokenTx &wtx) = 0;
 
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <array>
+#include <exception>
 #include <mutex>
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
@@ -44,13 +45,35 @@ static int FileWriteStr(const std::string &str, FILE *fp)
     return fwrite(str.data(), 1, str.size(), fp);
 }
 
+static void SetFileBuffering(FILE* file, bool async)
+{
+    if (async) {
+        // The writer thread flushes once per batch of messages
+        setvbuf(file, nullptr, _IOFBF, 1 << 16);
+    } else {
+        setbuf(file, nullptr); // unbuffered
+    }
+}
+
+static std::terminate_handler g_prev_terminate_handler{nullptr};
+
+//! Only covers std::terminate; debug messages queued when a signal kills the process are lost
+static void FlushLogOnTerminate()
+{
+    LogInstance().Flush(std::chrono::seconds{1});
+    if (g_prev_terminate_handler) g_prev_terminate_handler();
+    std::abort();
+}
+
 bool BCLog::Logger::StartLogging()
 {
     StdLockGuard scoped_lock(m_cs);
+    StdLockGuard file_lock(m_file_cs);
 
     assert(m_buffering);
     assert(m_fileout == nullptr);
     assert(m_fileoutVM == nullptr); // qtum
+    assert(!m_writer.joinable());
 
     if (m_print_to_file) {
         assert(!m_file_path.empty());
@@ -61,8 +84,9 @@ bool BCLog::Logger::StartLogging()
             return false;
         }
 
-        setbuf(m_fileout, nullptr); // unbuffered
-        setbuf(m_fileoutVM, nullptr); // unbuffered
+        m_file_buffered = m_log_async;
+        SetFileBuffering(m_fileout, m_file_buffered);
+        SetFileBuffering(m_fileoutVM, m_file_buffered);
 
         // Add newlines to the logfile to distinguish this execution from the
         // last one.
@@ -72,27 +96,96 @@ bool BCLog::Logger::StartLogging()
     // dump buffered messages from before we opened the log
     m_buffering = false;
     while (!m_msgs_before_open.empty()) {
-        LogMsg logmsg= m_msgs_before_open.front();
+        const LogMsg& logmsg = m_msgs_before_open.front();
 
-        FILE* file = logmsg.useVMLog ? m_fileoutVM : m_fileout;
-        if (file && m_print_to_file) FileWriteStr(logmsg.msg, file);
-        bool print_to_console = m_print_to_console;
-        if(print_to_console && logmsg.useVMLog && !m_show_evm_logs) print_to_console = false;
-        if (print_to_console) fwrite(logmsg.msg.data(), 1, logmsg.msg.size(), stdout);
+        WriteMsg(logmsg);
         for (const auto& cb : m_print_callbacks) {
             cb(logmsg.msg);
         }
 
         m_msgs_before_open.pop_front();
     }
-    if (m_print_to_console) fflush(stdout);
+    FlushFiles();
+
+    if (m_log_async) {
+        m_async = true;
+        m_writer_stop = false;
+        m_writer = std::thread(&BCLog::Logger::WriterThread, this);
+        if (!g_prev_terminate_handler) g_prev_terminate_handler = std::set_terminate(FlushLogOnTerminate);
+    }
 
     return true;
 }
 
+void BCLog::Logger::StopLogging()
+{
+    {
+        StdLockGuard scoped_lock(m_cs);
+        if (!m_writer.joinable()) return;
+        m_writer_stop = true;
+    }
+    m_queue_cv.notify_all();
+    m_writer.join();
+
+    // Messages logged while the writer was exiting are written directly
+    StdLockGuard scoped_lock(m_cs);
+    StdLockGuard file_lock(m_file_cs);
+    m_async = false;
+    for (const LogMsg& logmsg : m_queue) {
+        WriteMsg(logmsg);
+    }
+    m_queue.clear();
+    m_queue_bytes = 0;
+    FlushFiles();
+}
+
+void BCLog::Logger::Flush(std::chrono::milliseconds timeout) NO_THREAD_SAFETY_ANALYSIS
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<StdMutex> lock(m_cs, std::defer_lock);
+    // The calling thread may hold m_cs when it terminates while logging, so do not block on it
+    while (!lock.try_lock()) {
+        if (std::chrono::steady_clock::now() >= deadline) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    if (!m_async) return;
+    m_queue_cv.notify_all();
+    m_queue_cv.wait_until(lock, deadline, [&]() NO_THREAD_SAFETY_ANALYSIS { return m_queue.empty() && !m_writer_busy; });
+}
+
+void BCLog::Logger::WriterThread() NO_THREAD_SAFETY_ANALYSIS
+{
+    util::ThreadRename("logwriter");
+
+    std::vector<LogMsg> batch;
+    std::unique_lock<StdMutex> lock(m_cs);
+    while (true) {
+        m_queue_cv.wait(lock, [&]() NO_THREAD_SAFETY_ANALYSIS { return !m_queue.empty() || m_writer_stop; });
+        if (m_queue.empty()) break;
+
+        batch.swap(m_queue);
+        m_queue_bytes = 0;
+        m_writer_busy = true;
+        lock.unlock();
+        {
+            StdLockGuard file_lock(m_file_cs);
+            for (const LogMsg& logmsg : batch) {
+                WriteMsg(logmsg);
+            }
+            FlushFiles();
+        }
+        batch.clear();
+        lock.lock();
+        m_writer_busy = false;
+        m_queue_cv.notify_all();
+    }
+}
+
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopLogging();
     StdLockGuard scoped_lock(m_cs);
+    StdLockGuard file_lock(m_file_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
     m_fileout = nullptr;
@@ -262,9 +355,48 @@ namespace BCLog {
     }
 } // namespace BCLog
 
-void BCLog::Logger::LogPrintStr(const std::string& str, const std::string& logging_function, const std::string& source_file, const int source_line, bool useVMLog)
+static std::string LogCategoryToStr(BCLog::LogFlags category)
+{
+    for (const CLogCategoryDesc& category_desc : LogCategories) {
+        if (category_desc.flag == category) return category_desc.category;
+    }
+    return "";
+}
+
+bool BCLog::Logger::WithinRateLimit(LogFlags category, uint64_t& suppressed)
+{
+    const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    RateLimit& limit = m_rate_limits[category];
+    if (limit.window != now) {
+        suppressed = limit.suppressed;
+        limit = RateLimit{now, 0, 0};
+    }
+    if (limit.count >= m_rate_limit) {
+        ++limit.suppressed;
+        return false;
+    }
+    ++limit.count;
+    return true;
+}
+
+void BCLog::Logger::LogPrintStr(const std::string& str, const std::string& logging_function, const std::string& source_file, const int source_line, bool useVMLog, LogFlags category)
 {
     StdLockGuard scoped_lock(m_cs);
+
+    // Notes about suppressed and dropped messages go on their own lines before the message
+    std::string notes;
+    if (m_rate_limit > 0 && category != NONE && m_started_new_line) {
+        uint64_t suppressed{0};
+        if (!WithinRateLimit(category, suppressed)) return;
+        if (suppressed > 0) {
+            notes += LogTimestampStr(strprintf("Suppressed %u %s log messages above -lograte=%u\n", suppressed, LogCategoryToStr(category), m_rate_limit));
+        }
+    }
+    const bool note_dropped = m_dropped_pending > 0 && m_started_new_line && !useVMLog;
+    if (note_dropped) {
+        notes += LogTimestampStr(strprintf("Dropped %u log messages because the log writer fell behind\n", m_dropped_pending));
+    }
+
     std::string str_prefixed = LogEscapeMessage(str);
 
     if (m_log_sourcelocations && m_started_new_line) {
@@ -280,51 +412,92 @@ void BCLog::Logger::LogPrintStr(const std::string& str, const std::string& loggi
         str_prefixed.insert(0, "[" + util::ThreadGetInternalName() + "] ");
     }
 
-    str_prefixed = LogTimestampStr(str_prefixed);
+    str_prefixed = notes + LogTimestampStr(str_prefixed);
 
     m_started_new_line = !str.empty() && str[str.size()-1] == '\n';
 
     if (m_buffering) {
         // buffer if we haven't started logging yet
-        LogMsg logmsg(str_prefixed, useVMLog);
-        m_msgs_before_open.push_back(logmsg);
+        m_msgs_before_open.emplace_back(std::move(str_prefixed), useVMLog);
         return;
     }
 
+    for (const auto& cb : m_print_callbacks) {
+        cb(str_prefixed);
+    }
+
+    if (m_async) {
+        // Leave the writing of debug output, i.e. categorized messages and EVM
+        // logs, to the writer thread, and drop it if the writer fell too far behind
+        if (category != NONE || useVMLog) {
+            if (m_queue_bytes + str_prefixed.size() > m_max_queue_bytes) {
+                ++m_dropped_pending;
+                ++m_dropped;
+                return;
+            }
+            if (note_dropped) m_dropped_pending = 0;
+            m_queue_bytes += str_prefixed.size();
+            m_queue.emplace_back(std::move(str_prefixed), useVMLog);
+            m_queue_cv.notify_one();
+            return;
+        }
+        if (note_dropped) m_dropped_pending = 0;
+    }
+
+    StdLockGuard file_lock(m_file_cs);
+    // Uncategorized messages are logged unconditionally and may be the last
+    // ones before the process is killed, so they are written right away,
+    // after the queued messages to keep the logging order
+    for (const LogMsg& logmsg : m_queue) {
+        WriteMsg(logmsg);
+    }
+    m_queue.clear();
+    m_queue_bytes = 0;
+    WriteMsg(LogMsg(std::move(str_prefixed), useVMLog));
+    FlushFiles();
+}
+
+void BCLog::Logger::FlushFiles()
+{
+    if (m_print_to_console) fflush(stdout);
+    // Unbuffered files need no flush
+    if (!m_file_buffered) return;
+    if (m_fileout) fflush(m_fileout);
+    if (m_fileoutVM) fflush(m_fileoutVM);
+}
+
+static void ReopenFile(FILE*& file, const fs::path& file_path, bool async)
+{
+    FILE* new_fileout = fsbridge::fopen(file_path, "a");
+    if (new_fileout) {
+        SetFileBuffering(new_fileout, async);
+        fclose(file);
+        file = new_fileout;
+    }
+}
+
+void BCLog::Logger::WriteMsg(const LogMsg& logmsg)
+{
     bool print_to_console = m_print_to_console;
-    if(print_to_console && useVMLog && !m_show_evm_logs) print_to_console = false;
+    if(print_to_console && logmsg.useVMLog && !m_show_evm_logs) print_to_console = false;
 
     if (print_to_console) {
         // print to console
-        fwrite(str_prefixed.data(), 1, str_prefixed.size(), stdout);
-        fflush(stdout);
-    }
-    for (const auto& cb : m_print_callbacks) {
-        cb(str_prefixed);
+        fwrite(logmsg.msg.data(), 1, logmsg.msg.size(), stdout);
     }
     if (m_print_to_file) {
         //////////////////////////////// // qtum
-        FILE* file = m_fileout;
-        if(useVMLog){
-            file = m_fileoutVM;
-        }
+        FILE* file = logmsg.useVMLog ? m_fileoutVM : m_fileout;
         ////////////////////////////////
-        assert(file != nullptr);
-
-        // reopen the log file, if requested
-        if (m_reopen_file) {
-            m_reopen_file = false;
-            fs::path file_path = m_file_path;
-            if(useVMLog)
-                file_path = m_file_pathVM;
-            FILE* new_fileout = fsbridge::fopen(file_path, "a");
-            if (new_fileout) {
-                setbuf(new_fileout, nullptr); // unbuffered
-                fclose(file);
-                file = new_fileout;
-            }
+        if (file == nullptr) return;
+
+        // reopen the log files, if requested
+        if (m_reopen_file.exchange(false)) {
+            ReopenFile(m_fileout, m_file_path, m_file_buffered);
+            ReopenFile(m_fileoutVM, m_file_pathVM, m_file_buffered);
+            file = logmsg.useVMLog ? m_fileoutVM : m_fileout;
         }
-        FileWriteStr(str_prefixed, file);
+        FileWriteStr(logmsg.msg, file);
     }
 }
 
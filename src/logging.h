@@ -12,11 +12,15 @@
 #include <util/string.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 static const bool DEFAULT_LOGTIMEMICROS = false;
@@ -25,6 +29,10 @@ static const bool DEFAULT_LOGTIMESTAMPS = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
 static const bool DEFAULT_LOGSOURCELOCATIONS = false;
 static const bool DEFAULT_SHOWEVMLOGS   = false;
+static const bool DEFAULT_LOGASYNC      = true;
+static const unsigned int DEFAULT_LOGRATELIMIT = 0;
+//! Bytes of messages that may wait for the log writer thread before new ones are dropped
+static constexpr size_t DEFAULT_LOG_QUEUE_BYTES{16 << 20};
 extern const char * const DEFAULT_DEBUGLOGFILE;
 extern const char * const DEFAULT_DEBUGVMLOGFILE;
 
@@ -75,8 +83,8 @@ namespace BCLog {
 
     struct LogMsg
     {
-        LogMsg(const std::string& _msg, bool _useVMLog) :
-            msg(_msg),
+        LogMsg(std::string _msg, bool _useVMLog) :
+            msg(std::move(_msg)),
             useVMLog(_useVMLog)
         {}
 
@@ -88,12 +96,34 @@ namespace BCLog {
     {
     private:
         mutable StdMutex m_cs; // Can not use Mutex from sync.h because in debug mode it would cause a deadlock when a potential deadlock was detected
+        //! Held while writing to the outputs. Taken after m_cs when both are needed.
+        mutable StdMutex m_file_cs;
 
-        FILE* m_fileout GUARDED_BY(m_cs) = nullptr;
-        FILE* m_fileoutVM GUARDED_BY(m_cs) = nullptr;
+        FILE* m_fileout GUARDED_BY(m_file_cs) = nullptr;
+        FILE* m_fileoutVM GUARDED_BY(m_file_cs) = nullptr;
+        bool m_file_buffered GUARDED_BY(m_file_cs) = false; //!< Whether the files were opened for the writer thread, which flushes them once per batch
         std::list<LogMsg> m_msgs_before_open GUARDED_BY(m_cs);
         bool m_buffering GUARDED_BY(m_cs) = true; //!< Buffer messages before logging can be started.
 
+        /** Messages waiting for the writer thread, in logging order. */
+        std::vector<LogMsg> m_queue GUARDED_BY(m_cs);
+        size_t m_queue_bytes GUARDED_BY(m_cs){0};
+        //! Messages dropped since the last queued one, reported with the next queued one
+        uint64_t m_dropped_pending GUARDED_BY(m_cs){0};
+        std::atomic<uint64_t> m_dropped{0};
+        bool m_async GUARDED_BY(m_cs) = false;
+        bool m_writer_busy GUARDED_BY(m_cs) = false;
+        bool m_writer_stop GUARDED_BY(m_cs) = false;
+        std::condition_variable_any m_queue_cv;
+        std::thread m_writer;
+
+        struct RateLimit {
+            int64_t window{0};
+            unsigned int count{0};
+            uint64_t suppressed{0};
+        };
+        std::map<LogFlags, RateLimit> m_rate_limits GUARDED_BY(m_cs);
+
         /**
          * m_started_new_line is a state variable that will suppress printing of
          * the timestamp when multiple calls are made that don't end in a
@@ -106,6 +136,16 @@ namespace BCLog {
 
         std::string LogTimestampStr(const std::string& str);
 
+        /**
+         * Whether a message of a category stays within m_rate_limit for the current second.
+         * Sets suppressed to the number of messages suppressed in the previous second when a new one starts.
+         */
+        bool WithinRateLimit(LogFlags category, uint64_t& suppressed) EXCLUSIVE_LOCKS_REQUIRED(m_cs);
+        /** Write a message to the console and the log files. */
+        void WriteMsg(const LogMsg& msg) EXCLUSIVE_LOCKS_REQUIRED(m_file_cs);
+        void FlushFiles() EXCLUSIVE_LOCKS_REQUIRED(m_file_cs);
+        void WriterThread();
+
         /** Slots that connect to the print signal */
         std::list<std::function<void(const std::string&)>> m_print_callbacks GUARDED_BY(m_cs) {};
 
@@ -118,13 +158,18 @@ namespace BCLog {
         bool m_log_threadnames = DEFAULT_LOGTHREADNAMES;
         bool m_log_sourcelocations = DEFAULT_LOGSOURCELOCATIONS;
         bool m_show_evm_logs = DEFAULT_SHOWEVMLOGS;
+        //! Write to the outputs from a background thread instead of the logging thread
+        bool m_log_async = DEFAULT_LOGASYNC;
+        //! Messages per second and debug category to log, or 0 for no limit
+        unsigned int m_rate_limit = DEFAULT_LOGRATELIMIT;
+        size_t m_max_queue_bytes = DEFAULT_LOG_QUEUE_BYTES;
 
         fs::path m_file_path;
         fs::path m_file_pathVM;
         std::atomic<bool> m_reopen_file{false};
 
         /** Send a string to the log output */
-        void LogPrintStr(const std::string& str, const std::string& logging_function, const std::string& source_file, const int source_line, bool useVMLog = false);
+        void LogPrintStr(const std::string& str, const std::string& logging_function, const std::string& source_file, const int source_line, bool useVMLog = false, LogFlags category = NONE);
 
         /** Returns whether logs will be written to any output */
         bool Enabled() const
@@ -150,9 +195,16 @@ namespace BCLog {
 
         /** Start logging (and flush all buffered messages) */
         bool StartLogging();
+        /** Write all queued messages and stop the writer thread. Later messages are written directly. */
+        void StopLogging();
+        /** Wait until the writer thread has written all queued messages, for at most timeout. */
+        void Flush(std::chrono::milliseconds timeout = std::chrono::seconds{5});
         /** Only for testing */
         void DisconnectTestLogger();
 
+        /** Number of messages dropped because the writer thread fell behind */
+        uint64_t GetDroppedMessages() const { return m_dropped.load(); }
+
         void ShrinkDebugFile();
 
         uint32_t GetCategoryMask() const { return m_categories.load(); }
@@ -192,7 +244,7 @@ bool GetLogCategory(BCLog::LogFlags& flag, const std::string& str);
 // peer can fill up a user's disk with debug.log entries.
 
 template <typename... Args>
-static inline void LogPrintf_(const std::string& logging_function, const std::string& source_file, const int source_line, const char* fmt, const Args&... args)
+static inline void LogPrintf_(const std::string& logging_function, const std::string& source_file, const int source_line, BCLog::LogFlags category, const char* fmt, const Args&... args)
 {
     if (LogInstance().Enabled()) {
         std::string log_msg;
@@ -202,18 +254,18 @@ static inline void LogPrintf_(const std::string& logging_function, const std::st
             /* Original format string will have newline so don't add one here */
             log_msg = "Error \"" + std::string(fmterr.what()) + "\" while formatting log message: " + fmt;
         }
-        LogInstance().LogPrintStr(log_msg, logging_function, source_file, source_line);
+        LogInstance().LogPrintStr(log_msg, logging_function, source_file, source_line, false, category);
     }
 }
 
-#define LogPrintf(...) LogPrintf_(__func__, __FILE__, __LINE__, __VA_ARGS__)
+#define LogPrintf(...) LogPrintf_(__func__, __FILE__, __LINE__, BCLog::NONE, __VA_ARGS__)
 
 // Use a macro instead of a function for conditional logging to prevent
 // evaluating arguments when logging for the category is not enabled.
 #define LogPrint(category, ...)              \
     do {                                     \
         if (LogAcceptCategory((category))) { \
-            LogPrintf(__VA_ARGS__);          \
+            LogPrintf_(__func__, __FILE__, __LINE__, (category), __VA_ARGS__); \
         }                                    \
     } while (0)
 
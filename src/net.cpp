@@ -50,6 +50,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #include <algorithm>
 #include <array>
 #include <cstdint>
@@ -106,6 +110,12 @@ enum BindFlags {
 // The sleep time needs to be small to avoid new sockets stalling
 static const uint64_t SELECT_TIMEOUT_MILLISECONDS = 50;
 
+// Maximum number of queued buffers handed to the kernel in one send call
+static constexpr size_t MAX_SEND_BUFFERS = 64;
+
+// Maximum number of readiness events taken from epoll per iteration
+static constexpr int EPOLL_MAX_EVENTS = 1024;
+
 const std::string NET_MESSAGE_COMMAND_OTHER = "*other*";
 
 static const uint64_t RANDOMIZER_ID_NETGROUP = 0x6c0edd8036ef4036ULL; // SHA256("netgroup")[0:8]
@@ -840,6 +850,15 @@ CNetMessage V1TransportDeserializer::GetMessage(const std::chrono::microseconds
     return msg;
 }
 
+CSharedNetMsg::CSharedNetMsg(CSerializedNetMsg&& msg)
+    : m_type(msg.m_type)
+{
+    std::vector<unsigned char> header;
+    V1TransportSerializer{}.prepareForTransport(msg, header);
+    m_header = std::make_shared<const std::vector<unsigned char>>(std::move(header));
+    m_data = std::make_shared<const std::vector<unsigned char>>(std::move(msg.data));
+}
+
 void V1TransportSerializer::prepareForTransport(CSerializedNetMsg& msg, std::vector<unsigned char>& header) {
     // create dbl-sha256 checksum
     uint256 hash = Hash(msg.data);
@@ -859,28 +878,46 @@ size_t CConnman::SocketSendData(CNode& node) const
     size_t nSentSize = 0;
 
     while (it != node.vSendMsg.end()) {
-        const auto& data = *it;
-        assert(data.size() > node.nSendOffset);
+        // Hand as many queued buffers as possible to the kernel in one call,
+        // the first one from where the last partial send stopped.
+        std::array<Span<const unsigned char>, MAX_SEND_BUFFERS> bufs;
+        size_t num_bufs = 0;
+        size_t queued = 0;
+        for (auto buf_it = it; buf_it != node.vSendMsg.end() && num_bufs < bufs.size(); ++buf_it) {
+            const std::vector<unsigned char>& data = **buf_it;
+            const size_t offset = buf_it == it ? node.nSendOffset : 0;
+            assert(data.size() > offset);
+            bufs[num_bufs++] = Span{data}.subspan(offset);
+            queued += data.size() - offset;
+        }
         int nBytes = 0;
         {
             LOCK(node.m_sock_mutex);
             if (!node.m_sock) {
                 break;
             }
-            nBytes = node.m_sock->Send(reinterpret_cast<const char*>(data.data()) + node.nSendOffset, data.size() - node.nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            nBytes = node.m_sock->SendMany(Span{bufs.data(), num_bufs}, MSG_NOSIGNAL | MSG_DONTWAIT);
         }
         if (nBytes > 0) {
             node.m_last_send = GetTime<std::chrono::seconds>();
             node.nSendBytes += nBytes;
-            node.nSendOffset += nBytes;
             nSentSize += nBytes;
-            if (node.nSendOffset == data.size()) {
+            // Drop the buffers that went out completely.
+            size_t remaining = nBytes;
+            while (remaining > 0) {
+                const size_t left = (*it)->size() - node.nSendOffset;
+                if (remaining < left) {
+                    node.nSendOffset += remaining;
+                    break;
+                }
+                remaining -= left;
                 node.nSendOffset = 0;
-                node.nSendSize -= data.size();
-                node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
+                node.nSendSize -= (*it)->size();
                 it++;
-            } else {
-                // could not send full message; stop sending more
+            }
+            node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
+            if ((size_t)nBytes < queued) {
+                // could not send everything; stop sending more
                 break;
             }
         } else {
@@ -1329,6 +1366,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock>&& sock,
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
+    RegisterSocketEvents(*pnode);
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -1528,12 +1566,164 @@ bool CConnman::GenerateSelectSet(const std::vector<CNode*>& nodes,
     return !recv_set.empty() || !send_set.empty() || !error_set.empty();
 }
 
+bool CConnman::InitSocketEvents()
+{
+#ifdef USE_EPOLL
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd < 0) {
+        LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    if (pipe2(m_wakeup_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        LogPrintf("Failed to create wakeup pipe: %s\n", NetworkErrorString(errno));
+        CloseSocketEvents();
+        return false;
+    }
+
+    // The wakeup pipe and listening sockets are level-triggered: the pipe is
+    // drained in one go and only one connection is accepted per iteration.
+    std::vector<int> level_triggered{m_wakeup_pipe[0]};
+    for (const ListenSocket& listen_socket : vhListenSocket) {
+        level_triggered.push_back(listen_socket.sock->Get());
+    }
+    for (const int fd : level_triggered) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            LogPrintf("epoll_ctl failed: %s\n", NetworkErrorString(errno));
+            CloseSocketEvents();
+            return false;
+        }
+    }
+    LogPrintf("Using epoll for socket events\n");
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CConnman::CloseSocketEvents()
+{
+#ifdef USE_EPOLL
+    for (int* fd : {&m_epoll_fd, &m_wakeup_pipe[0], &m_wakeup_pipe[1]}) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+    m_epoll_readable.clear();
+#endif
+}
+
+void CConnman::RegisterSocketEvents(CNode& node)
+{
+#ifdef USE_EPOLL
+    if (m_epoll_fd < 0) return;
+
+    LOCK(node.m_sock_mutex);
+    if (!node.m_sock) return;
+
+    // The kernel drops the registration when the socket is closed, so there
+    // is no matching removal in CloseSocketDisconnect().
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.fd = node.m_sock->Get();
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, event.data.fd, &event) != 0) {
+        LogPrint(BCLog::NET, "epoll_ctl failed for peer=%d: %s\n", node.GetId(), NetworkErrorString(errno));
+        node.fDisconnect = true;
+    }
+#endif
+}
+
+void CConnman::WakeSelect()
+{
+#ifdef USE_EPOLL
+    if (m_wakeup_pipe[1] < 0) return;
+    const char buf{0};
+    // A full pipe already guarantees a wakeup, so a failed write is fine.
+    if (write(m_wakeup_pipe[1], &buf, sizeof(buf)) != 1) return;
+#endif
+}
+
+#ifdef USE_EPOLL
+void CConnman::SocketEventsEpoll(const std::vector<CNode*>& nodes,
+                                 std::set<SOCKET>& recv_set,
+                                 std::set<SOCKET>& send_set,
+                                 std::set<SOCKET>& error_set)
+{
+    // Carry over sockets that still hold data. Nodes that are gone are
+    // dropped here, and as in GenerateSelectSet() a node whose receive queue
+    // is full is not read from.
+    std::unordered_map<SOCKET, bool> node_pause_recv;
+    std::set<SOCKET> readable;
+    for (CNode* pnode : nodes) {
+        const bool pause_recv = pnode->fPauseRecv;
+        LOCK(pnode->m_sock_mutex);
+        if (!pnode->m_sock) continue;
+        const SOCKET socket_id = pnode->m_sock->Get();
+        node_pause_recv.emplace(socket_id, pause_recv);
+        if (m_epoll_readable.count(socket_id)) {
+            readable.insert(socket_id);
+            if (!pause_recv) recv_set.insert(socket_id);
+        }
+    }
+    m_epoll_readable.swap(readable);
+
+    // Don't block while there is still something to read.
+    std::array<epoll_event, EPOLL_MAX_EVENTS> events;
+    const int timeout = recv_set.empty() ? SELECT_TIMEOUT_MILLISECONDS : 0;
+    const int num_events = epoll_wait(m_epoll_fd, events.data(), events.size(), timeout);
+
+    if (interruptNet) return;
+
+    if (num_events < 0) {
+        if (errno != EINTR) LogPrintf("epoll_wait error %s\n", NetworkErrorString(errno));
+        return;
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+        const SOCKET socket_id = events[i].data.fd;
+        const uint32_t flags = events[i].events;
+
+        if (socket_id == m_wakeup_pipe[0]) {
+            char buf[128];
+            while (read(m_wakeup_pipe[0], buf, sizeof(buf)) > 0) {}
+            continue;
+        }
+
+        const auto it = node_pause_recv.find(socket_id);
+        if (it == node_pause_recv.end()) {
+            // A listening socket, or a node that connected after the snapshot
+            // was taken. Remember the latter for the next iteration, which
+            // also drops the entry again if it was a listening socket.
+            if (flags & EPOLLIN) {
+                recv_set.insert(socket_id);
+                m_epoll_readable.insert(socket_id);
+            }
+            continue;
+        }
+        if (flags & EPOLLIN) {
+            m_epoll_readable.insert(socket_id);
+            if (!it->second) recv_set.insert(socket_id);
+        }
+        if (flags & EPOLLOUT) send_set.insert(socket_id);
+        if (flags & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) error_set.insert(socket_id);
+    }
+}
+#endif
+
 #ifdef USE_POLL
 void CConnman::SocketEvents(const std::vector<CNode*>& nodes,
                             std::set<SOCKET>& recv_set,
                             std::set<SOCKET>& send_set,
                             std::set<SOCKET>& error_set)
 {
+#ifdef USE_EPOLL
+    if (m_epoll_fd >= 0) {
+        SocketEventsEpoll(nodes, recv_set, send_set, error_set);
+        return;
+    }
+#endif
+
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(nodes, recv_select_set, send_select_set, error_select_set)) {
         interruptNet.sleep_for(std::chrono::milliseconds(SELECT_TIMEOUT_MILLISECONDS));
@@ -1690,11 +1880,13 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
         bool recvSet = false;
         bool sendSet = false;
         bool errorSet = false;
+        SOCKET socket_id;
         {
             LOCK(pnode->m_sock_mutex);
             if (!pnode->m_sock) {
                 continue;
             }
+            socket_id = pnode->m_sock->Get();
             recvSet = recv_set.count(pnode->m_sock->Get()) > 0;
             sendSet = send_set.count(pnode->m_sock->Get()) > 0;
             errorSet = error_set.count(pnode->m_sock->Get()) > 0;
@@ -1711,6 +1903,9 @@ void CConnman::SocketHandlerConnected(const std::vector<CNode*>& nodes,
                 }
                 nBytes = pnode->m_sock->Recv(pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
             }
+            // A short read drained the socket; with epoll it will be reported
+            // again once more data arrives.
+            if (nBytes < (int)sizeof(pchBuf)) m_epoll_readable.erase(socket_id);
             if (nBytes > 0)
             {
                 bool notify = false;
@@ -1794,9 +1989,9 @@ void CConnman::WakeMessageHandler()
 {
     {
         LOCK(mutexMsgProc);
-        fMsgProcWake = true;
+        ++m_msgproc_wake_seq;
     }
-    condMsgProc.notify_one();
+    condMsgProc.notify_all();
 }
 
 void CConnman::ThreadDNSAddressSeed()
@@ -2652,6 +2847,7 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
         pnode->m_masternode_probe_connection = true;
 
     m_msgproc->InitializeNode(pnode);
+    RegisterSocketEvents(*pnode);
     {
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
@@ -2664,9 +2860,10 @@ void CConnman::OpenMasternodeConnection(const CAddress &addrConnect, MasternodeP
     OpenNetworkConnection(addrConnect, false, nullptr, nullptr, ConnectionType::OUTBOUND_FULL_RELAY, MasternodeConn::Is_Connection, probe);
 }
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(int shard)
 {
     int64_t nLastSendMessagesTimeMasternodes = 0;
+    uint64_t wake_seq{WITH_LOCK(mutexMsgProc, return m_msgproc_wake_seq)};
     SetSyscallSandboxPolicy(SyscallSandboxPolicy::MESSAGE_HANDLER);
     while (!flagInterruptMsgProc)
     {
@@ -2688,6 +2885,19 @@ void CConnman::ThreadMessageHandler()
                 if (pnode->fDisconnect)
                     continue;
 
+                if (pnode->GetId() % m_msghand_threads != shard)
+                    continue;
+
+                // Answer e.g. pings without waiting for another thread's
+                // slow message to finish.
+                if (m_msghand_threads > 1) {
+                    m_msgproc->ProcessPeerLocalMessages(pnode, flagInterruptMsgProc);
+                    if (flagInterruptMsgProc)
+                        return;
+                }
+
+                LOCK(m_msgproc_lane);
+
                 // Receive messages
                 bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
                 fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
@@ -2709,9 +2919,9 @@ void CConnman::ThreadMessageHandler()
 
         WAIT_LOCK(mutexMsgProc, lock);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return fMsgProcWake; });
+            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [&]() EXCLUSIVE_LOCKS_REQUIRED(mutexMsgProc) { return m_msgproc_wake_seq != wake_seq; });
         }
-        fMsgProcWake = false;
+        wake_seq = m_msgproc_wake_seq;
     }
 }
 
@@ -2954,6 +3164,15 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+    if (m_use_epoll && !InitSocketEvents()) {
+        if (m_client_interface) {
+            m_client_interface->ThreadSafeMessageBox(
+                _("Failed to set up epoll for socket events. Use -socketevents=poll instead."),
+                "", CClientUIInterface::MSG_ERROR);
+        }
+        return false;
+    }
+
     Proxy i2p_sam;
     if (GetProxy(NET_I2P, i2p_sam)) {
         m_i2p_sam_session = std::make_unique<i2p::sam::Session>(gArgs.GetDataDirNet() / "i2p_private_key",
@@ -2996,11 +3215,6 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     interruptNet.reset();
     flagInterruptMsgProc = false;
 
-    {
-        LOCK(mutexMsgProc);
-        fMsgProcWake = false;
-    }
-
     // Send and receive from sockets, accept connections
     threadSocketHandler = std::thread(&util::TraceThread, "net", [this] { ThreadSocketHandler(); });
 
@@ -3030,7 +3244,13 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     }
 
     // Process messages
-    threadMessageHandler = std::thread(&util::TraceThread, "msghand", [this] { ThreadMessageHandler(); });
+    for (int shard = 0; shard < m_msghand_threads; ++shard) {
+        const std::string thread_name = m_msghand_threads == 1 ? "msghand" : strprintf("msghand.%d", shard);
+        threadMessageHandlers.emplace_back(&util::TraceThread, thread_name, [this, shard] { ThreadMessageHandler(shard); });
+    }
+    if (m_msghand_threads > 1) {
+        LogPrintf("Using %d message handler threads\n", m_msghand_threads);
+    }
 
     if (connOptions.m_i2p_accept_incoming && m_i2p_sam_session.get() != nullptr) {
         threadI2PAcceptIncoming =
@@ -3067,6 +3287,7 @@ void CConnman::Interrupt()
     condMsgProc.notify_all();
 
     interruptNet();
+    WakeSelect();
     InterruptSocks5(true);
 
     if (semOutbound) {
@@ -3087,8 +3308,10 @@ void CConnman::StopThreads()
     if (threadI2PAcceptIncoming.joinable()) {
         threadI2PAcceptIncoming.join();
     }
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (std::thread& thread : threadMessageHandlers) {
+        if (thread.joinable()) thread.join();
+    }
+    threadMessageHandlers.clear();
     if (threadOpenMasternodeConnections.joinable())
         threadOpenMasternodeConnections.join(); 
     if (threadOpenConnections.joinable())
@@ -3129,6 +3352,7 @@ void CConnman::StopNodes()
         DeleteNode(pnode);
     }
     m_nodes_disconnected.clear();
+    CloseSocketEvents();
     vhListenSocket.clear();
     semOutbound.reset();
     semAddnode.reset();
@@ -3614,7 +3838,36 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
     // make sure we use the appropriate network transport format
     std::vector<unsigned char> serializedHeader;
     pnode->m_serializer->prepareForTransport(msg, serializedHeader);
-    size_t nTotalSize = nMessageSize + serializedHeader.size();
+
+    PushMessageBytes(pnode, msg.m_type,
+                     std::make_shared<const std::vector<unsigned char>>(std::move(serializedHeader)),
+                     nMessageSize ? std::make_shared<const std::vector<unsigned char>>(std::move(msg.data)) : nullptr);
+}
+
+void CConnman::PushMessage(CNode* pnode, const CSharedNetMsg& msg)
+{
+    const std::vector<unsigned char>& data = *msg.m_data;
+    LogPrint(BCLog::NET, "sending %s (%d bytes, shared) peer=%d\n", msg.m_type, data.size(), pnode->GetId());
+    if (gArgs.GetBoolArg("-capturemessages", false)) {
+        CaptureMessage(pnode->addr, msg.m_type, data, /*is_incoming=*/false);
+    }
+
+    TRACE6(net, outbound_message,
+        pnode->GetId(),
+        pnode->m_addr_name.c_str(),
+        pnode->ConnectionTypeAsString().c_str(),
+        msg.m_type.c_str(),
+        data.size(),
+        data.data()
+    );
+
+    // All peers use the v1 transport, so the prebuilt header fits every one of them.
+    PushMessageBytes(pnode, msg.m_type, msg.m_header, data.empty() ? nullptr : msg.m_data);
+}
+
+void CConnman::PushMessageBytes(CNode* pnode, const std::string& msg_type, SharedNetMsgBytes header, SharedNetMsgBytes data)
+{
+    size_t nTotalSize = header->size() + (data ? data->size() : 0);
 
     size_t nBytesSent = 0;
     {
@@ -3622,12 +3875,12 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         bool optimisticSend(pnode->vSendMsg.empty());
 
         //log total amount of bytes per message type
-        pnode->mapSendBytesPerMsgCmd[msg.m_type] += nTotalSize;
+        pnode->mapSendBytesPerMsgCmd[msg_type] += nTotalSize;
         pnode->nSendSize += nTotalSize;
 
         if (pnode->nSendSize > nSendBufferMaxSize) pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize) pnode->vSendMsg.push_back(std::move(msg.data));
+        pnode->vSendMsg.push_back(std::move(header));
+        if (data) pnode->vSendMsg.push_back(std::move(data));
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend) nBytesSent = SocketSendData(*pnode);
@@ -28,6 +28,7 @@
 #include <util/check.h>
 #include <util/sock.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -87,6 +88,15 @@ static constexpr bool DEFAULT_DNSSEED{true};
 static constexpr bool DEFAULT_FIXEDSEEDS{true};
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
+/** Default number of message handler threads */
+static constexpr int DEFAULT_MSGHAND_THREADS{1};
+/** Maximum number of message handler threads */
+static constexpr int MAX_MSGHAND_THREADS{16};
+#ifdef USE_POLL
+static const std::string DEFAULT_SOCKETEVENTS{"poll"};
+#else
+static const std::string DEFAULT_SOCKETEVENTS{"select"};
+#endif
 
 typedef int64_t NodeId;
 
@@ -114,6 +124,24 @@ struct CSerializedNetMsg
     std::string m_type;
 };
 
+/** Immutable serialized bytes that may sit in the send queues of several peers at once. */
+using SharedNetMsgBytes = std::shared_ptr<const std::vector<unsigned char>>;
+
+/**
+ * A message that is serialized, checksummed and framed once and then pushed
+ * to many peers, e.g. a block announcement. Every send queue references the
+ * same header and payload instead of holding its own copy.
+ */
+struct CSharedNetMsg
+{
+    /** Takes the payload of msg and builds its (v1 transport) header. */
+    explicit CSharedNetMsg(CSerializedNetMsg&& msg);
+
+    std::string m_type;
+    SharedNetMsgBytes m_header;
+    SharedNetMsgBytes m_data;
+};
+
 /** Different types of connections to a peer. This enum encapsulates the
  * information we have available at the time of opening or accepting the
  * connection. Aside from INBOUND, all types are initiated by us.
@@ -302,6 +330,7 @@ public:
     uint32_t m_message_size{0};          //!< size of the payload
     uint32_t m_raw_message_size{0};      //!< used wire size of the message (including header/checksum)
     std::string m_type;
+    bool m_preverified{false};           //!< (tx only) whether its scripts were checked ahead of processing
 
     CNetMessage(CDataStream&& recv_in) : m_recv(std::move(recv_in)) {}
 
@@ -433,7 +462,7 @@ public:
     /** Offset inside the first vSendMsg already sent */
     size_t nSendOffset GUARDED_BY(cs_vSend){0};
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<unsigned char>> vSendMsg GUARDED_BY(cs_vSend);
+    std::deque<SharedNetMsgBytes> vSendMsg GUARDED_BY(cs_vSend);
     Mutex cs_vSend;
     Mutex m_sock_mutex;
     Mutex cs_vRecv;
@@ -813,6 +842,19 @@ public:
     */
     virtual bool SendMessages(CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(pnode->cs_sendProcessing) = 0;
 
+    /**
+    * Process the messages at the front of a node's queue that only touch
+    * state owned by that peer, serve the blocks it requested and verify the
+    * scripts of its queued transactions.
+    * Unlike ProcessMessages() and SendMessages(), this may run concurrently
+    * for different peers on several message handler threads, but never
+    * concurrently for the same peer.
+    *
+    * @param[in]   pnode           The node which we have received messages from.
+    * @param[in]   interrupt       Interrupt condition for processing threads
+    */
+    virtual void ProcessPeerLocalMessages(CNode* pnode, std::atomic<bool>& interrupt) {}
+
 
 protected:
     /**
@@ -853,6 +895,8 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         bool m_i2p_accept_incoming;
+        bool m_use_epoll = false;
+        int m_msghand_threads = DEFAULT_MSGHAND_THREADS;
     };
 
     void Init(const Options& connOptions) {
@@ -880,6 +924,8 @@ public:
             m_added_nodes = connOptions.m_added_nodes;
         }
         m_onion_binds = connOptions.onion_binds;
+        m_use_epoll = connOptions.m_use_epoll;
+        m_msghand_threads = std::clamp(connOptions.m_msghand_threads, 1, MAX_MSGHAND_THREADS);
     }
 
     CConnman(uint64_t seed0, uint64_t seed1, AddrMan& addrman, bool network_active = true);
@@ -914,6 +960,8 @@ public:
     bool ForNode(NodeId id, std::function<bool(CNode* pnode)> func);
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg);
+    /** Queue a message that was serialized once for many peers, without copying it. */
+    void PushMessage(CNode* pnode, const CSharedNetMsg& msg);
 
     using NodeFn = std::function<void(CNode*)>;
     void ForEachNode(const NodeFn& func)
@@ -1044,9 +1092,13 @@ public:
     CSipHasher GetDeterministicRandomizer(uint64_t id) const;
 
     unsigned int GetReceiveFloodSize() const;
+    /** Whether ProcessPeerLocalMessages() runs, i.e. there is more than one message handler thread. */
+    bool HasPeerLocalProcessing() const { return m_msghand_threads > 1; }
     // Quagba
     bool IsMasternodeOrDisconnectRequested(const CService& addr);
     void WakeMessageHandler();
+    /** Interrupt a SocketHandler wait, e.g. because a peer may be read from again. */
+    void WakeSelect();
 
     /** Return true if we should disconnect the peer for failing an inactivity check. */
     bool ShouldRunInactivityChecks(const CNode& node, std::chrono::seconds now) const;
@@ -1073,7 +1125,13 @@ private:
     void AddAddrFetch(const std::string& strDest);
     void ProcessAddrFetch();
     void ThreadOpenConnections(std::vector<std::string> connect);
-    void ThreadMessageHandler();
+    /**
+     * Process messages of the peers assigned to one message handler thread.
+     * A peer always stays on the same thread, so its messages are handled in
+     * order; everything except ProcessPeerLocalMessages() is serialized
+     * across threads by m_msgproc_lane.
+     */
+    void ThreadMessageHandler(int shard);
     void ThreadI2PAcceptIncoming();
     void AcceptConnection(const ListenSocket& hListenSocket);
 
@@ -1121,6 +1179,26 @@ private:
                       std::set<SOCKET>& send_set,
                       std::set<SOCKET>& error_set);
 
+    /**
+     * Create the epoll instance and register the listening sockets with it.
+     * Only used with -socketevents=epoll.
+     */
+    bool InitSocketEvents();
+    void CloseSocketEvents();
+
+    /** Register a newly connected node's socket with the epoll instance, if any. */
+    void RegisterSocketEvents(CNode& node);
+
+    /**
+     * Like `SocketEvents()`, but waits on the epoll instance. Sockets stay
+     * registered for their whole lifetime and are edge-triggered, so nothing
+     * is rebuilt or passed to the kernel per iteration.
+     */
+    void SocketEventsEpoll(const std::vector<CNode*>& nodes,
+                           std::set<SOCKET>& recv_set,
+                           std::set<SOCKET>& send_set,
+                           std::set<SOCKET>& error_set);
+
     /**
      * Check connected and listening sockets for IO readiness and process them accordingly.
      */
@@ -1170,6 +1248,9 @@ private:
 
     NodeId GetNewNodeId();
 
+    /** Common part of the PushMessage() overloads: account for and queue the header and payload. */
+    void PushMessageBytes(CNode* pnode, const std::string& msg_type, SharedNetMsgBytes header, SharedNetMsgBytes data);
+
     size_t SocketSendData(CNode& node) const EXCLUSIVE_LOCKS_REQUIRED(node.cs_vSend);
     void DumpAddresses();
 
@@ -1206,6 +1287,19 @@ private:
     unsigned int nReceiveFloodSize{0};
 
     std::vector<ListenSocket> vhListenSocket;
+
+    /** Whether to wait on an epoll instance instead of poll()/select(). */
+    bool m_use_epoll{false};
+    int m_epoll_fd{-1};
+    /** Read and write end of the pipe used to interrupt epoll_wait(). */
+    int m_wakeup_pipe[2]{-1, -1};
+    /**
+     * Sockets that epoll reported readable and that have not been drained
+     * yet. An edge-triggered socket is not reported again until new data
+     * arrives, so these are carried over between iterations, e.g. while the
+     * peer's receive queue is full. Used only by SocketHandler thread.
+     */
+    std::set<SOCKET> m_epoll_readable;
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     AddrMan& addrman;
@@ -1294,8 +1388,17 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake GUARDED_BY(mutexMsgProc);
+    /** Counter for waking the message processors; each thread remembers the value it has seen. */
+    uint64_t m_msgproc_wake_seq GUARDED_BY(mutexMsgProc){0};
+
+    /** Number of message handler threads that peers are spread over. */
+    int m_msghand_threads{DEFAULT_MSGHAND_THREADS};
+
+    /**
+     * Lane that serializes ProcessMessages() and SendMessages() between the
+     * message handler threads, as net_processing expects a single caller.
+     */
+    Mutex m_msgproc_lane;
 
     std::condition_variable condMsgProc;
     Mutex mutexMsgProc;
@@ -1319,7 +1422,7 @@ private:
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
+    std::vector<std::thread> threadMessageHandlers;
     std::thread threadI2PAcceptIncoming;
     std::thread threadOpenMasternodeConnections;
 
@@ -19,6 +19,7 @@
 #include <netbase.h>
 #include <netmessagemaker.h>
 #include <node/blockstorage.h>
+#include <node/txreconciliation.h>
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <primitives/block.h>
@@ -70,6 +71,9 @@ using node::ReadRawBlockFromDisk;
 using node::fImporting;
 using node::fPruneMode;
 using node::fReindex;
+using node::ReconciliationRegisterResult;
+using node::ReconciliationResult;
+using node::TxReconciliationTracker;
 
 /** How long to cache transactions in mapRelay for normal relay */
 static constexpr auto RELAY_TX_CACHE_TIME = 15min;
@@ -192,6 +196,8 @@ static constexpr double MAX_ADDR_RATE_PER_SECOND{0.1};
  *  based increments won't go above this, but the MAX_ADDR_TO_SEND increment following GETADDR
  *  is exempt from this limit). */
 static constexpr size_t MAX_ADDR_PROCESSING_TOKEN_BUCKET{MAX_ADDR_TO_SEND};
+/** Maximum number of queued transactions of a peer whose scripts are verified off the lane per pass */
+static constexpr size_t MAX_PREVERIFY_TX_MESSAGES{32};
 
 struct COrphanBlock {
     uint256 hashBlock;
@@ -343,6 +349,7 @@ public:
     void InitializeNode(CNode* pnode) override;
     void FinalizeNode(const CNode& node) override;
     bool ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt) override;
+    void ProcessPeerLocalMessages(CNode* pfrom, std::atomic<bool>& interrupt) override;
     bool SendMessages(CNode* pto) override EXCLUSIVE_LOCKS_REQUIRED(pto->cs_sendProcessing);
 
     /** Implement PeerManager */
@@ -484,6 +491,12 @@ private:
     /** Whether this node is running in blocks only mode */
     const bool m_ignore_incoming_txs;
 
+    /** Set reconciliation state of peers we relay transactions with by Erlay; null if -txreconciliation is off. */
+    std::unique_ptr<TxReconciliationTracker> m_txreconciliation;
+
+    /** Announce transactions a reconciliation round found the peer to be missing. */
+    void AnnounceReconciledTxs(CNode& node, const std::vector<uint256>& wtxids) LOCKS_EXCLUDED(cs_main);
+
     /** Whether we've completed initial sync yet, for determining when to turn
       * on extra block-relay-only peers. */
     bool m_initial_sync_finished{false};
@@ -616,6 +629,24 @@ private:
 
     void ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc) EXCLUSIVE_LOCKS_REQUIRED(peer.m_getdata_requests_mutex) LOCKS_EXCLUDED(::cs_main);
 
+    /**
+     * Move the next message from pfrom's process queue into msgs and update
+     * its receive pause state. With peer_local_only, only a message that
+     * ProcessPeerLocalMessages() may handle is taken.
+     * @return whether a message was taken
+     */
+    bool TakeNextMessage(CNode& pfrom, std::list<CNetMessage>& msgs, bool peer_local_only, bool& more);
+
+    /** Trace, capture and process a message taken off a peer's queue. */
+    void HandleMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc);
+
+    /**
+     * Verify the scripts of transactions waiting in pfrom's process queue
+     * without holding the lane, so that accepting them later on the lane only
+     * hits the script execution cache.
+     */
+    void PreVerifyQueuedTransactions(CNode& pfrom, const std::atomic<bool>& interruptMsgProc);
+
     /** Process a new block. Perform any post-processing housekeeping */
     void ProcessBlock(CNode& node, const std::shared_ptr<const CBlock>& block, bool force_processing);
 
@@ -1429,6 +1460,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
     }
     WITH_LOCK(g_cs_orphans, m_orphanage.EraseForPeer(nodeid));
     m_txrequest.DisconnectedPeer(nodeid);
+    if (m_txreconciliation) m_txreconciliation->ForgetPeer(nodeid);
     nPreferredDownload -= state->fPreferredDownload;
     m_peers_downloading_from -= (state->nBlocksInFlight != 0);
     assert(m_peers_downloading_from >= 0);
@@ -1701,6 +1733,9 @@ PeerManagerImpl::PeerManagerImpl(const CChainParams& chainparams, CConnman& conn
       m_mempool(pool),
       m_ignore_incoming_txs(ignore_incoming_txs)
 {
+    if (gArgs.GetBoolArg("-txreconciliation", node::DEFAULT_TXRECONCILIATION_ENABLE)) {
+        m_txreconciliation = std::make_unique<TxReconciliationTracker>(node::TXRECONCILIATION_VERSION);
+    }
 }
 
 void PeerManagerImpl::StartScheduledTasks(CScheduler& scheduler)
@@ -1772,6 +1807,26 @@ static std::shared_ptr<const CBlock> most_recent_block GUARDED_BY(cs_most_recent
 static std::shared_ptr<const CBlockHeaderAndShortTxIDs> most_recent_compact_block GUARDED_BY(cs_most_recent_block);
 static uint256 most_recent_block_hash GUARDED_BY(cs_most_recent_block);
 static bool fWitnessesPresentInMostRecentCompactBlock GUARDED_BY(cs_most_recent_block);
+/** most_recent_block serialized for relay, with and without witness; built on first request. */
+static std::shared_ptr<const CSharedNetMsg> most_recent_block_msg GUARDED_BY(cs_most_recent_block);
+static std::shared_ptr<const CSharedNetMsg> most_recent_block_msg_no_witness GUARDED_BY(cs_most_recent_block);
+
+/**
+ * Return a block message for pblock that is serialized only once for all
+ * peers asking for it, as long as pblock is the most recent block.
+ */
+static std::shared_ptr<const CSharedNetMsg> GetRecentBlockMessage(const std::shared_ptr<const CBlock>& pblock, bool witness)
+{
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    const int send_flags = witness ? 0 : SERIALIZE_TRANSACTION_NO_WITNESS;
+    LOCK(cs_most_recent_block);
+    if (pblock != most_recent_block) {
+        return std::make_shared<const CSharedNetMsg>(msgMaker.Make(send_flags, NetMsgType::BLOCK, *pblock));
+    }
+    std::shared_ptr<const CSharedNetMsg>& msg = witness ? most_recent_block_msg : most_recent_block_msg_no_witness;
+    if (!msg) msg = std::make_shared<const CSharedNetMsg>(msgMaker.Make(send_flags, NetMsgType::BLOCK, *pblock));
+    return msg;
+}
 
 /**
  * Maintain state about the best-seen block and fast-announce a compact block
@@ -1798,12 +1853,16 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         most_recent_block = pblock;
         most_recent_compact_block = pcmpctblock;
         fWitnessesPresentInMostRecentCompactBlock = fWitnessEnabled;
+        most_recent_block_msg.reset();
+        most_recent_block_msg_no_witness.reset();
     }
 
-    m_connman.ForEachNode([this, &pcmpctblock, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    // Serialized on the first peer it is announced to and shared with the rest.
+    std::optional<CSharedNetMsg> cmpctblock_msg;
+
+    m_connman.ForEachNode([this, &pcmpctblock, &cmpctblock_msg, pindex, &msgMaker, fWitnessEnabled, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
-        // TODO: Avoid the repeated-serialization here
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
             return;
         ProcessBlockAvailability(pnode->GetId());
@@ -1815,7 +1874,8 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
 
             LogPrint(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
-            m_connman.PushMessage(pnode, msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            if (!cmpctblock_msg) cmpctblock_msg.emplace(msgMaker.Make(NetMsgType::CMPCTBLOCK, *pcmpctblock));
+            m_connman.PushMessage(pnode, *cmpctblock_msg);
             state.pindexBestHeaderSent = pindex;
         }
     });
@@ -2121,7 +2181,10 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         pblock = pblockRead;
     }
     if (pblock) {
-        if (inv.IsMsgBlk()) {
+        if (pblock == a_recent_block && (inv.IsMsgBlk() || inv.IsMsgWitnessBlk())) {
+            // Many peers ask for a new block at about the same time.
+            m_connman.PushMessage(&pfrom, *GetRecentBlockMessage(pblock, inv.IsMsgWitnessBlk()));
+        } else if (inv.IsMsgBlk()) {
             m_connman.PushMessage(&pfrom, msgMaker.Make(SERIALIZE_TRANSACTION_NO_WITNESS, NetMsgType::BLOCK, *pblock));
         } else if (inv.IsMsgWitnessBlk()) {
             m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
@@ -2184,6 +2247,26 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
     }
 }
 
+void PeerManagerImpl::AnnounceReconciledTxs(CNode& node, const std::vector<uint256>& wtxids)
+{
+    if (wtxids.empty() || node.m_tx_relay == nullptr) return;
+    const CNetMsgMaker msgMaker(node.GetCommonVersion());
+    std::vector<CInv> invs;
+    LOCK2(cs_main, node.m_tx_relay->cs_tx_inventory);
+    for (const uint256& wtxid : wtxids) {
+        // The transaction may have been mined or evicted since it was queued.
+        if (!m_mempool.exists(GenTxid::Wtxid(wtxid))) continue;
+        State(node.GetId())->m_recently_announced_invs.insert(wtxid);
+        node.m_tx_relay->filterInventoryKnown.insert(wtxid);
+        invs.emplace_back(MSG_WTX, wtxid);
+        if (invs.size() == MAX_INV_SZ) {
+            m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, invs));
+            invs.clear();
+        }
+    }
+    if (!invs.empty()) m_connman.PushMessage(&node, msgMaker.Make(NetMsgType::INV, invs));
+}
+
 CTransactionRef PeerManagerImpl::FindTxForGetData(const CNode& peer, const GenTxid& gtxid, const std::chrono::seconds mempool_req, const std::chrono::seconds now)
 {
     auto txinfo = m_mempool.info(gtxid);
@@ -2383,14 +2466,18 @@ void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic
 
 
     // Only process one BLOCK item per call, since they're uncommon and can be
-    // expensive to process.
+    // expensive to process. With several message handler threads, blocks are
+    // served by ProcessPeerLocalMessages() instead, so that reading them from
+    // disk does not hold up the messages of other peers.
     if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
-        const CInv &inv = *it++;
-        if (inv.IsGenBlkMsg()) {
+        if (!it->IsGenBlkMsg()) {
+            // If the first item on the queue is an unknown type, we erase it
+            // and continue processing the queue on the next call.
+            ++it;
+        } else if (!m_connman.HasPeerLocalProcessing()) {
+            const CInv &inv = *it++;
             ProcessGetBlockData(pfrom, peer, inv);
         }
-        // else: If the first item on the queue is an unknown type, we erase it
-        // and continue processing the queue on the next call.
     }
 
     peer.m_getdata_requests.erase(peer.m_getdata_requests.begin(), it);
@@ -3037,6 +3124,14 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::SENDADDRV2));
         }
 
+        // Signal support for transaction reconciliation (BIP330) to peers that
+        // want transactions from us. It relies on wtxid relay.
+        if (m_txreconciliation && !m_ignore_incoming_txs && fRelay && pfrom.m_tx_relay != nullptr &&
+            !pfrom.IsFeelerConn() && greatest_common_version >= WTXID_RELAY_VERSION) {
+            const uint64_t recon_salt = m_txreconciliation->PreRegisterPeer(pfrom.GetId());
+            m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::SENDTXRCNCL, node::TXRECONCILIATION_VERSION, recon_salt));
+        }
+
         m_connman.PushMessage(&pfrom, msg_maker.Make(NetMsgType::VERACK));
 
         pfrom.nServices = nServices;
@@ -3291,6 +3386,47 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    // BIP330 defines feature negotiation of transaction reconciliation, which
+    // must happen between VERSION and VERACK.
+    if (msg_type == NetMsgType::SENDTXRCNCL) {
+        if (!m_txreconciliation) {
+            LogPrint(BCLog::NET, "sendtxrcncl from peer=%d ignored, as txreconciliation is not enabled\n", pfrom.GetId());
+            return;
+        }
+        if (pfrom.fSuccessfullyConnected) {
+            // Disconnect peers that send a SENDTXRCNCL message after VERACK.
+            LogPrint(BCLog::NET, "sendtxrcncl received after verack from peer=%d; disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Peers announce wtxidrelay before sendtxrcncl; reconciliation needs it.
+        if (!WITH_LOCK(cs_main, return State(pfrom.GetId())->m_wtxid_relay)) {
+            LogPrint(BCLog::NET, "sendtxrcncl from peer=%d ignored, as it does not use wtxid relay\n", pfrom.GetId());
+            return;
+        }
+
+        uint32_t peer_txreconcl_version;
+        uint64_t remote_salt;
+        vRecv >> peer_txreconcl_version >> remote_salt;
+
+        const ReconciliationRegisterResult result = m_txreconciliation->RegisterPeer(pfrom.GetId(), pfrom.IsInboundConn(),
+                                                                                     peer_txreconcl_version, remote_salt);
+        switch (result) {
+        case ReconciliationRegisterResult::SUCCESS:
+            break;
+        case ReconciliationRegisterResult::NOT_FOUND:
+            // We did not offer reconciliation to this peer, e.g. because it does not relay transactions.
+            LogPrint(BCLog::NET, "Ignore unexpected txreconciliation signal from peer=%d\n", pfrom.GetId());
+            break;
+        case ReconciliationRegisterResult::ALREADY_REGISTERED:
+        case ReconciliationRegisterResult::PROTOCOL_VIOLATION:
+            LogPrint(BCLog::NET, "txreconciliation protocol violation from peer=%d; disconnecting\n", pfrom.GetId());
+            pfrom.fDisconnect = true;
+            break;
+        }
+        return;
+    }
+
     if (!pfrom.fSuccessfullyConnected) {
         LogPrint(BCLog::NET, "Unsupported message \"%s\" prior to verack from peer=%d\n", SanitizeString(msg_type), pfrom.GetId());
         return;
@@ -3405,6 +3541,41 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::REQRECON || msg_type == NetMsgType::SKETCH || msg_type == NetMsgType::RECONCILDIFF) {
+        if (!m_txreconciliation || !m_txreconciliation->IsPeerRegistered(pfrom.GetId())) {
+            LogPrint(BCLog::NET, "%s from peer=%d ignored, as it is not a reconciliation peer\n", msg_type, pfrom.GetId());
+            return;
+        }
+
+        bool valid{false};
+        ReconciliationResult result;
+        if (msg_type == NetMsgType::REQRECON) {
+            // The peer starts a round; we answer with a sketch from SendMessages.
+            uint16_t peer_set_size, peer_q;
+            vRecv >> peer_set_size >> peer_q;
+            valid = m_txreconciliation->HandleReconciliationRequest(pfrom.GetId(), peer_set_size, peer_q);
+        } else if (msg_type == NetMsgType::SKETCH) {
+            std::vector<uint8_t> skdata;
+            vRecv >> skdata;
+            valid = m_txreconciliation->HandleSketch(pfrom.GetId(), skdata, result);
+            if (valid) {
+                m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::RECONCILDIFF, result.success, result.ask_shortids));
+            }
+        } else {
+            bool success;
+            std::vector<uint32_t> ask_shortids;
+            vRecv >> success >> ask_shortids;
+            valid = m_txreconciliation->HandleReconciliationDifference(pfrom.GetId(), success, ask_shortids, result);
+        }
+        if (!valid) {
+            LogPrint(BCLog::NET, "unexpected %s from peer=%d; disconnecting\n", msg_type, pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        AnnounceReconciledTxs(pfrom, result.txs_to_announce);
+        return;
+    }
+
     if (msg_type == NetMsgType::INV) {
         std::vector<CInv> vInv;
         vRecv >> vInv;
@@ -3464,6 +3635,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
                 LogPrint(BCLog::NET, "got inv: %s  %s peer=%d\n", inv.ToString(), fAlreadyHave ? "have" : "new", pfrom.GetId());
 
                 pfrom.AddKnownTx(inv.hash);
+                if (m_txreconciliation && gtxid.IsWtxid()) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), inv.hash);
                 if (!fAlreadyHave && !m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
                     AddTxAnnouncement(pfrom, gtxid, current_time);
                 // Quagba
@@ -3727,6 +3899,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
 
         const uint256& hash = nodestate->m_wtxid_relay ? wtxid : txid;
         pfrom.AddKnownTx(hash);
+        if (m_txreconciliation && nodestate->m_wtxid_relay) m_txreconciliation->TryRemovingFromSet(pfrom.GetId(), wtxid);
         if (nodestate->m_wtxid_relay && txid != wtxid) {
             // Insert txid into filterInventoryKnown, even for
             // wtxidrelay peers. This prevents re-adding of
@@ -4657,46 +4830,137 @@ bool PeerManagerImpl::ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt
     if (pfrom->fPauseSend) return false;
 
     std::list<CNetMessage> msgs;
+    if (!TakeNextMessage(*pfrom, msgs, /*peer_local_only=*/false, fMoreWork)) return false;
+
+    HandleMessage(*pfrom, msgs.front(), interruptMsgProc);
+    if (interruptMsgProc) return false;
     {
-        LOCK(pfrom->cs_vProcessMsg);
-        if (pfrom->vProcessMsg.empty()) return false;
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().m_raw_message_size;
-        pfrom->fPauseRecv = pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
-        fMoreWork = !pfrom->vProcessMsg.empty();
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty()) fMoreWork = true;
     }
-    CNetMessage& msg(msgs.front());
 
+    return fMoreWork;
+}
+
+/** Messages whose handlers only use atomics of the peer and PushMessage(). */
+static bool IsPeerLocalMessage(const std::string& msg_type)
+{
+    return msg_type == NetMsgType::PING ||
+           msg_type == NetMsgType::PONG ||
+           msg_type == NetMsgType::FEEFILTER;
+}
+
+bool PeerManagerImpl::TakeNextMessage(CNode& pfrom, std::list<CNetMessage>& msgs, bool peer_local_only, bool& more)
+{
+    bool resume_recv{false};
+    {
+        LOCK(pfrom.cs_vProcessMsg);
+        if (pfrom.vProcessMsg.empty()) return false;
+        if (peer_local_only && !IsPeerLocalMessage(pfrom.vProcessMsg.front().m_type)) return false;
+        // Just take one message
+        msgs.splice(msgs.begin(), pfrom.vProcessMsg, pfrom.vProcessMsg.begin());
+        pfrom.nProcessQueueSize -= msgs.front().m_raw_message_size;
+        const bool was_paused = pfrom.fPauseRecv;
+        pfrom.fPauseRecv = pfrom.nProcessQueueSize > m_connman.GetReceiveFloodSize();
+        resume_recv = was_paused && !pfrom.fPauseRecv;
+        more = !pfrom.vProcessMsg.empty();
+    }
+    // The socket may still hold data that won't be reported again.
+    if (resume_recv) m_connman.WakeSelect();
+    return true;
+}
+
+void PeerManagerImpl::HandleMessage(CNode& pfrom, CNetMessage& msg, const std::atomic<bool>& interruptMsgProc)
+{
     TRACE6(net, inbound_message,
-        pfrom->GetId(),
-        pfrom->m_addr_name.c_str(),
-        pfrom->ConnectionTypeAsString().c_str(),
+        pfrom.GetId(),
+        pfrom.m_addr_name.c_str(),
+        pfrom.ConnectionTypeAsString().c_str(),
         msg.m_type.c_str(),
         msg.m_recv.size(),
         msg.m_recv.data()
     );
 
     if (gArgs.GetBoolArg("-capturemessages", false)) {
-        CaptureMessage(pfrom->addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
+        CaptureMessage(pfrom.addr, msg.m_type, MakeUCharSpan(msg.m_recv), /*is_incoming=*/true);
     }
 
-    msg.SetVersion(pfrom->GetCommonVersion());
+    msg.SetVersion(pfrom.GetCommonVersion());
 
     try {
-        ProcessMessage(*pfrom, msg.m_type, msg.m_recv, msg.m_time, interruptMsgProc);
-        if (interruptMsgProc) return false;
-        {
-            LOCK(peer->m_getdata_requests_mutex);
-            if (!peer->m_getdata_requests.empty()) fMoreWork = true;
-        }
+        ProcessMessage(pfrom, msg.m_type, msg.m_recv, msg.m_time, interruptMsgProc);
     } catch (const std::exception& e) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size, e.what(), typeid(e).name());
     } catch (...) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(msg.m_type), msg.m_message_size);
     }
+}
 
-    return fMoreWork;
+void PeerManagerImpl::ProcessPeerLocalMessages(CNode* pfrom, std::atomic<bool>& interruptMsgProc)
+{
+    // The handshake and the first message after it are handled on the lane.
+    if (!pfrom->fSuccessfullyConnected || pfrom->nTimeFirstMessageReceived == 0) return;
+
+    PeerRef peer = GetPeerRef(pfrom->GetId());
+    if (peer == nullptr) return;
+
+    // Serve one block request from the front of the getdata queue, like
+    // ProcessGetData() on the lane does. Everything it touches is protected
+    // by cs_main or its own mutex.
+    if (!pfrom->fPauseSend) {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (!peer->m_getdata_requests.empty() && peer->m_getdata_requests.front().IsGenBlkMsg()) {
+            const CInv inv = peer->m_getdata_requests.front();
+            peer->m_getdata_requests.pop_front();
+            ProcessGetBlockData(*pfrom, *peer, inv);
+        }
+    }
+
+    while (!pfrom->fDisconnect && !pfrom->fPauseSend && !interruptMsgProc) {
+        // Keep replies behind outstanding getdata responses, as in ProcessMessages().
+        if (WITH_LOCK(peer->m_getdata_requests_mutex, return !peer->m_getdata_requests.empty())) break;
+
+        std::list<CNetMessage> msgs;
+        bool more{false};
+        if (!TakeNextMessage(*pfrom, msgs, /*peer_local_only=*/true, more)) break;
+        HandleMessage(*pfrom, msgs.front(), interruptMsgProc);
+    }
+
+    if (!pfrom->fDisconnect && !interruptMsgProc) PreVerifyQueuedTransactions(*pfrom, interruptMsgProc);
+}
+
+void PeerManagerImpl::PreVerifyQueuedTransactions(CNode& pfrom, const std::atomic<bool>& interruptMsgProc)
+{
+    if (pfrom.m_tx_relay == nullptr || m_ignore_incoming_txs) return;
+    if (m_chainman.ActiveChainstate().IsInitialBlockDownload()) return;
+
+    // Messages only leave the queue on this thread, and the socket thread only
+    // appends to it, so the entries stay valid after the lock is released.
+    std::vector<CNetMessage*> pending;
+    {
+        LOCK(pfrom.cs_vProcessMsg);
+        for (CNetMessage& msg : pfrom.vProcessMsg) {
+            if (pending.size() >= MAX_PREVERIFY_TX_MESSAGES) break;
+            if (msg.m_type == NetMsgType::TX && !msg.m_preverified) pending.push_back(&msg);
+        }
+    }
+
+    for (CNetMessage* msg : pending) {
+        if (interruptMsgProc) return;
+        msg->m_preverified = true;
+
+        CTransactionRef ptx;
+        try {
+            CDataStream stream{msg->m_recv};
+            stream.SetVersion(pfrom.GetCommonVersion());
+            stream >> ptx;
+        } catch (const std::exception&) {
+            // Reported when the message is processed.
+            continue;
+        }
+        if (WITH_LOCK(cs_main, return AlreadyHaveTx(GenTxid::Wtxid(ptx->GetWitnessHash())))) continue;
+        PreVerifyTransactionScripts(m_chainman.ActiveChainstate(), m_mempool, *ptx);
+    }
 }
 
 void PeerManagerImpl::ConsiderEviction(CNode& pto, std::chrono::seconds time_in_seconds)
@@ -5408,10 +5672,14 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                             continue;
                         }
                         if (pto->m_tx_relay->pfilter && !pto->m_tx_relay->pfilter->IsRelevantAndUpdate(*txinfo.tx)) continue;
-                        // Send
-                        State(pto->GetId())->m_recently_announced_invs.insert(hash);
-                        vInv.push_back(inv);
-                        nRelayedTransactions++;
+                        // Send, unless a reconciling peer learns about the transaction in the next
+                        // reconciliation round instead. It becomes requestable once it is announced
+                        // there, see AnnounceReconciledTxs().
+                        if (!state.m_wtxid_relay || !m_txreconciliation || !m_txreconciliation->AddToSet(pto->GetId(), wtxid)) {
+                            State(pto->GetId())->m_recently_announced_invs.insert(hash);
+                            vInv.push_back(inv);
+                            nRelayedTransactions++;
+                        }
                         {
                             // Expire old relay messages
                             while (!g_relay_expiration.empty() && g_relay_expiration.front().first < current_time)
@@ -5449,6 +5717,17 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (!vInv.empty())
             m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::INV, vInv));
 
+        // Start reconciliation rounds with peers we initiate with, and answer
+        // the rounds our other reconciliation peers started.
+        if (m_txreconciliation) {
+            if (const auto request = m_txreconciliation->InitiateReconciliationRequest(pto->GetId(), current_time)) {
+                m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::REQRECON, request->first, request->second));
+            }
+            if (const auto sketch = m_txreconciliation->RespondToReconciliationRequest(pto->GetId())) {
+                m_connman.PushMessage(pto, msgMaker.Make(NetMsgType::SKETCH, *sketch));
+            }
+        }
+
         // Detect whether we're stalling
         if (state.m_stalling_since.count() && state.m_stalling_since < current_time - BLOCK_STALLING_TIMEOUT) {
             // Stalling only triggers when the block download window cannot move. During normal steady state,
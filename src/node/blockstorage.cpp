@@ -26,6 +26,7 @@
 #include <walletinitinterface.h>
 #include <primitives/block.h>
 #include <node/context.h>
+#include <node/mempool_journal.h>
 #include <masternode/activemasternode.h>
 
 namespace node {
@@ -59,6 +60,7 @@ CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block)
 
     // Construct new block index object
     CBlockIndex* pindexNew = new CBlockIndex(block);
+    pindexNew->SetBlockSigDlgt(block.vchBlockSigDlgt, m_sig_arena);
     // We assign the sequence id to blocks only when the full data is available,
     // to avoid miners withholding blocks but broadcasting headers, to get a
     // competitive advantage.
@@ -227,7 +229,7 @@ bool BlockManager::LoadBlockIndex(
     const Consensus::Params& consensus_params,
     ChainstateManager& chainman)
 {
-    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); })) {
+    if (!m_block_tree_db->LoadBlockIndexGuts(consensus_params, [this](const uint256& hash) EXCLUSIVE_LOCKS_REQUIRED(cs_main) { return this->InsertBlockIndex(hash); }, m_sig_arena)) {
         return false;
     }
 
@@ -342,6 +344,7 @@ void BlockManager::Unload()
     }
 
     m_block_index.clear();
+    m_sig_arena.Clear();
 
     m_blockfile_info.clear();
     m_last_blockfile = 0;
@@ -1001,5 +1004,11 @@ void ThreadImport(ChainstateManager& chainman, std::vector<fs::path> vImportFile
         }
     } // End scope of CImportingNow
     chainman.ActiveChainstate().LoadMempool(args);
+    if (node.mempool_journal) {
+        // Start the journal from a fresh mempool.dat that includes what was
+        // just reloaded, rather than appending all of it again.
+        node.mempool_journal->StartRecording();
+        node.mempool_journal->Compact(/*force=*/true);
+    }
 }
 } // namespace node
@@ -114,6 +114,9 @@ private:
 public:
     BlockMap m_block_index GUARDED_BY(cs_main);
 
+    /** Signatures of the entries of m_block_index */
+    BlockSigArena m_sig_arena;
+
     /**
      * All pairs A->B, where A (or one of its ancestors) misses transactions, but B has transactions.
      * Pruned nodes may have entries where B is missing data.
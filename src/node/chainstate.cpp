@@ -179,7 +179,17 @@ std::optional<ChainstateLoadingError> LoadChainstate(bool fReset,
     }
 
     fRecordLogOpcodes = args.IsArgSet("-record-log-opcodes");
-    fIsVMlogFile = fs::exists(gArgs.GetDataDirNet() / "vmExecLogs.json");
+    g_vm_trace.reset();
+    if (fRecordLogOpcodes) {
+        auto vm_trace = std::make_unique<VMTrace>(args.GetDataDirNet() / "vmtrace");
+        if (vm_trace->Open()) {
+            vm_trace->Start();
+            g_vm_trace = std::move(vm_trace);
+        } else {
+            LogPrintf("Error: Failed to open the VM trace in %s, contract executions are not recorded\n", fs::PathToString(args.GetDataDirNet() / "vmtrace"));
+            fRecordLogOpcodes = false;
+        }
+    }
     ///////////////////////////////////////////////////////////
 
     /////////////////////////////////////////////////////////////// // qtum
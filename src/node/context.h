@@ -27,6 +27,8 @@ class WalletLoader;
 } // namespace interfaces
 
 namespace node {
+class MempoolJournal;
+
 //! NodeContext struct containing references to chain state and connection
 //! state.
 //!
@@ -43,6 +45,7 @@ struct NodeContext {
     std::unique_ptr<AddrMan> addrman;
     std::unique_ptr<CConnman> connman;
     std::unique_ptr<CTxMemPool> mempool;
+    std::unique_ptr<MempoolJournal> mempool_journal;
     std::unique_ptr<CBlockPolicyEstimator> fee_estimator;
     std::unique_ptr<PeerManager> peerman;
     std::unique_ptr<ChainstateManager> chainman;
@@ -8,6 +8,7 @@
 #include <chainparams.h>
 #include <deploymentstatus.h>
 #include <external_signer.h>
+#include <index/blockfilterindex.h>
 #include <init.h>
 #include <interfaces/chain.h>
 #include <interfaces/handler.h>
@@ -40,6 +41,7 @@
 #include <uint256.h>
 #include <univalue.h>
 #include <util/check.h>
+#include <util/convert.h>
 #include <util/system.h>
 #include <util/translation.h>
 #include <validation.h>
@@ -636,6 +638,43 @@ public:
         const CChain& active = Assert(m_node.chainman)->ActiveChain();
         return FillBlock(m_node.chainman->m_blockman.LookupBlockIndex(hash), block, lock, active);
     }
+    bool hasBlockFilterIndex(BlockFilterType filter_type) override
+    {
+        return GetBlockFilterIndex(filter_type) != nullptr;
+    }
+    std::optional<bool> blockFilterMatchesAny(BlockFilterType filter_type, const uint256& block_hash, const GCSFilter::ElementSet& filter_set) override
+    {
+        const BlockFilterIndex* block_filter_index{GetBlockFilterIndex(filter_type)};
+        if (!block_filter_index) return std::nullopt;
+
+        BlockFilter filter;
+        const CBlockIndex* index{WITH_LOCK(::cs_main, return chainman().m_blockman.LookupBlockIndex(block_hash))};
+        if (index == nullptr || !block_filter_index->LookupFilter(index, filter)) return std::nullopt;
+        return filter.GetFilter().MatchAny(filter_set);
+    }
+    bool getBlockContractLogs(const CBlock& block, std::vector<ContractLog>& logs) override
+    {
+        if (!fLogEvents) return false;
+        const uint256 block_hash = block.GetHash();
+        LOCK(::cs_main);
+        for (const CTransactionRef& tx : block.vtx) {
+            if (!tx->HasCreateOrCall()) continue;
+            for (const TransactionReceiptInfo& receipt : pstorageresult->getResult(uintToh256(tx->GetHash()))) {
+                // Receipts of the transaction in blocks of other branches
+                if (receipt.blockHash != block_hash) continue;
+                for (const dev::eth::LogEntry& entry : receipt.logs) {
+                    ContractLog& log = logs.emplace_back();
+                    log.tx_hash = receipt.transactionHash;
+                    log.address = h160Touint(entry.address);
+                    for (const dev::h256& topic : entry.topics) {
+                        log.topics.push_back(h256Touint(topic));
+                    }
+                    log.data = entry.data;
+                }
+            }
+        }
+        return true;
+    }
     bool findFirstBlockWithTimeAndHeight(int64_t min_time, int min_height, const FoundBlock& block) override
     {
         WAIT_LOCK(cs_main, lock);
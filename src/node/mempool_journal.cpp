@@ -0,0 +1,327 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/mempool_journal.h>
+
+#include <clientversion.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <streams.h>
+#include <txmempool.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <algorithm>
+
+namespace node {
+namespace {
+static const uint64_t MEMPOOL_JOURNAL_VERSION = 1;
+
+enum class JournalRecord : uint8_t {
+    ADD = 1,     //!< tx, nTime, nFeeDelta
+    REMOVE = 2,  //!< txid
+    BLOCK = 3,   //!< txids of a connected block
+    COMMIT = 4,  //!< fee deltas and unbroadcast txids at shutdown
+};
+
+uint64_t FileSize(const fs::path& path)
+{
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    return ec ? 0 : size;
+}
+} // namespace
+
+fs::path MempoolJournalPath()
+{
+    return gArgs.GetDataDirNet() / "mempool.journal";
+}
+
+bool MempoolJournalReplay::Consume(const uint256& txid)
+{
+    return m_pending.erase(txid) > 0;
+}
+
+bool ReadMempoolJournal(const fs::path& path, MempoolJournalReplay& replay)
+{
+    CAutoFile file(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) return false;
+
+    const auto remove = [&](const uint256& txid) {
+        replay.m_pending.erase(txid);
+        replay.removed.insert(txid);
+    };
+
+    try {
+        uint64_t version;
+        file >> version;
+        if (version != MEMPOOL_JOURNAL_VERSION) {
+            LogPrintf("Ignoring mempool journal with unknown version %d\n", version);
+            return false;
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to read mempool journal header: %s\n", e.what());
+        return false;
+    }
+
+    size_t records = 0;
+    try {
+        while (true) {
+            uint8_t type;
+            try {
+                file >> type;
+            } catch (const std::ios_base::failure&) {
+                break; // clean end of file
+            }
+            switch (JournalRecord{type}) {
+            case JournalRecord::ADD: {
+                MempoolJournalReplay::Entry entry;
+                file >> entry.tx >> entry.nTime >> entry.nFeeDelta;
+                const uint256& txid = entry.tx->GetHash();
+                replay.removed.erase(txid);
+                replay.m_pending[txid] = replay.added.size();
+                replay.added.push_back(std::move(entry));
+                break;
+            }
+            case JournalRecord::REMOVE: {
+                uint256 txid;
+                file >> txid;
+                remove(txid);
+                break;
+            }
+            case JournalRecord::BLOCK: {
+                std::vector<uint256> txids;
+                file >> txids;
+                for (const uint256& txid : txids) remove(txid);
+                break;
+            }
+            case JournalRecord::COMMIT: {
+                std::map<uint256, CAmount> deltas;
+                std::set<uint256> unbroadcast_txids;
+                file >> deltas >> unbroadcast_txids;
+                replay.deltas = std::move(deltas);
+                replay.unbroadcast_txids = std::move(unbroadcast_txids);
+                break;
+            }
+            default:
+                throw std::ios_base::failure(strprintf("unknown record type %d", type));
+            }
+            ++records;
+        }
+    } catch (const std::exception& e) {
+        // Most likely the last record was only partially written before an
+        // unclean shutdown; everything before it is still usable.
+        LogPrintf("Mempool journal ends after %d records: %s\n", records, e.what());
+    }
+
+    // Compact the added list so it only holds transactions that are still pending.
+    std::vector<MempoolJournalReplay::Entry> added;
+    added.reserve(replay.m_pending.size());
+    for (size_t i = 0; i < replay.added.size(); ++i) {
+        const auto it = replay.m_pending.find(replay.added[i].tx->GetHash());
+        if (it == replay.m_pending.end() || it->second != i) continue;
+        it->second = added.size();
+        added.push_back(std::move(replay.added[i]));
+    }
+    replay.added = std::move(added);
+
+    LogPrint(BCLog::MEMPOOL, "Read %d mempool journal records: %d added, %d removed\n", records, replay.added.size(), replay.removed.size());
+    return true;
+}
+
+MempoolJournal::MempoolJournal(const CTxMemPool& pool, fs::path path)
+    : m_pool(pool), m_path(std::move(path))
+{
+}
+
+MempoolJournal::~MempoolJournal()
+{
+    LOCK(m_mutex);
+    Close();
+}
+
+bool MempoolJournal::Open()
+{
+    LOCK(m_mutex);
+    Close();
+    m_snapshot_size = FileSize(gArgs.GetDataDirNet() / "mempool.dat");
+    m_size = FileSize(m_path);
+    if (m_size == 0) return Reset();
+
+    m_file = fsbridge::fopen(m_path, "ab");
+    if (!m_file) {
+        LogPrintf("Failed to open mempool journal %s\n", fs::PathToString(m_path));
+        return false;
+    }
+    return true;
+}
+
+bool MempoolJournal::Reset()
+{
+    AssertLockHeld(m_mutex);
+    Close();
+    m_size = 0;
+    m_file = fsbridge::fopen(m_path, "wb");
+    CDataStream header(SER_DISK, CLIENT_VERSION);
+    header << MEMPOOL_JOURNAL_VERSION;
+    if (!m_file || !Append(header)) {
+        LogPrintf("Failed to create mempool journal %s\n", fs::PathToString(m_path));
+        // Don't leave records behind that predate mempool.dat.
+        std::error_code ec;
+        fs::remove(m_path, ec);
+        return false;
+    }
+    return true;
+}
+
+void MempoolJournal::Close()
+{
+    AssertLockHeld(m_mutex);
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+bool MempoolJournal::Append(const CDataStream& record)
+{
+    AssertLockHeld(m_mutex);
+    if (!m_file) return false;
+    if (fwrite(record.data(), 1, record.size(), m_file) != record.size() || fflush(m_file) != 0) {
+        LogPrintf("Failed to write mempool journal %s, not recording until mempool.dat is rewritten\n", fs::PathToString(m_path));
+        Close();
+        return false;
+    }
+    m_size += record.size();
+    return true;
+}
+
+void MempoolJournal::Record(const CDataStream& record)
+{
+    LOCK(m_mutex);
+    if (!m_recording) return;
+    if (m_compacting) m_compaction_records.push_back(record);
+    Append(record);
+}
+
+void MempoolJournal::StartRecording()
+{
+    // Changes made while the mempool was loaded are folded into mempool.dat
+    // by the next compaction instead.
+    SyncWithValidationInterfaceQueue();
+    LOCK(m_mutex);
+    m_recording = true;
+}
+
+bool MempoolJournal::Compact(bool force)
+{
+    if (!m_pool.IsLoaded()) return false;
+
+    uint64_t journal_size;
+    {
+        LOCK(m_mutex);
+        if (m_compacting) return false;
+        // A journal that failed to write is missing records, so always compact it.
+        if (!force && m_file && m_size < std::max(m_snapshot_size, MEMPOOL_JOURNAL_MIN_COMPACT_SIZE)) return false;
+        m_compacting = true;
+        journal_size = m_size;
+    }
+
+    // Dump without holding m_mutex, so that the validation interface callbacks
+    // are not held up. What they record meanwhile is carried over into the
+    // reset journal; replaying the part that the dump already covers is harmless.
+    const int64_t start = GetTimeMicros();
+    const bool dumped = DumpMempool(m_pool);
+
+    LOCK(m_mutex);
+    m_compacting = false;
+    std::vector<CDataStream> records;
+    records.swap(m_compaction_records);
+    if (!dumped) return false;
+    if (!Reset()) return false;
+    for (const CDataStream& record : records) {
+        if (!Append(record)) return false;
+    }
+    m_snapshot_size = FileSize(gArgs.GetDataDirNet() / "mempool.dat");
+    LogPrint(BCLog::MEMPOOL, "Compacted %d byte mempool journal into %d byte mempool.dat in %dms\n",
+             journal_size, m_snapshot_size, (GetTimeMicros() - start) / 1000);
+    return true;
+}
+
+bool MempoolJournal::Commit()
+{
+    std::map<uint256, CAmount> deltas;
+    std::set<uint256> unbroadcast_txids;
+    const bool loaded = m_pool.IsLoaded();
+    if (loaded) {
+        LOCK(m_pool.cs);
+        deltas = m_pool.mapDeltas;
+        unbroadcast_txids = m_pool.GetUnbroadcastTxs();
+    }
+
+    {
+        LOCK(m_mutex);
+        // Fee deltas of transactions that have not been reloaded yet are only
+        // known to mempool.dat, so don't shadow them with an incomplete set.
+        CDataStream record(SER_DISK, CLIENT_VERSION);
+        record << uint8_t(JournalRecord::COMMIT) << deltas << unbroadcast_txids;
+        if (m_file && (!loaded || Append(record))) {
+            if (FileCommit(m_file)) {
+                LogPrintf("Committed mempool journal (%d bytes)\n", m_size);
+                return true;
+            }
+            LogPrintf("Failed to commit mempool journal\n");
+            Close();
+        }
+    }
+    // The journal is incomplete, so rewrite mempool.dat instead.
+    return Compact(/*force=*/true);
+}
+
+uint64_t MempoolJournal::Size() const
+{
+    LOCK(m_mutex);
+    return m_size;
+}
+
+void MempoolJournal::TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence)
+{
+    // The entry may already be gone by the time this callback runs; a
+    // removal record follows in that case and the values don't matter.
+    const TxMempoolInfo info = m_pool.info(GenTxid::Txid(tx->GetHash()));
+    const int64_t nTime = info.tx ? count_seconds(info.m_time) : GetTime();
+    const int64_t nFeeDelta = info.tx ? int64_t{info.nFeeDelta} : 0;
+
+    CDataStream record(SER_DISK, CLIENT_VERSION);
+    record << uint8_t(JournalRecord::ADD) << *tx << nTime << nFeeDelta;
+
+    Record(record);
+}
+
+void MempoolJournal::TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence)
+{
+    CDataStream record(SER_DISK, CLIENT_VERSION);
+    record << uint8_t(JournalRecord::REMOVE) << tx->GetHash();
+
+    Record(record);
+}
+
+void MempoolJournal::BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    // Transactions removed for inclusion in a block are not reported through
+    // TransactionRemovedFromMempool.
+    std::vector<uint256> txids;
+    txids.reserve(block->vtx.size());
+    for (const auto& tx : block->vtx) {
+        if (!tx->IsCoinBase() && !tx->IsCoinStake()) txids.push_back(tx->GetHash());
+    }
+
+    CDataStream record(SER_DISK, CLIENT_VERSION);
+    record << uint8_t(JournalRecord::BLOCK) << txids;
+
+    Record(record);
+}
+} // namespace node
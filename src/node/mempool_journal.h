@@ -0,0 +1,123 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_MEMPOOL_JOURNAL_H
+#define BITCOIN_NODE_MEMPOOL_JOURNAL_H
+
+#include <consensus/amount.h>
+#include <fs.h>
+#include <primitives/transaction.h>
+#include <streams.h>
+#include <sync.h>
+#include <uint256.h>
+#include <validationinterface.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+class CTxMemPool;
+
+namespace node {
+/** Default for -mempooljournal */
+static constexpr bool DEFAULT_MEMPOOL_JOURNAL{false};
+/** How often the journal is checked for compaction */
+static constexpr std::chrono::minutes MEMPOOL_JOURNAL_COMPACT_INTERVAL{15};
+/** The journal is never compacted while it is smaller than this */
+static constexpr uint64_t MEMPOOL_JOURNAL_MIN_COMPACT_SIZE{4 << 20};
+
+/** Location of the mempool journal, next to mempool.dat. */
+fs::path MempoolJournalPath();
+
+/** Transactions and fee deltas recovered from a mempool journal. */
+struct MempoolJournalReplay {
+    struct Entry {
+        CTransactionRef tx;
+        int64_t nTime;
+        int64_t nFeeDelta;
+    };
+
+    //! Transactions whose last journal record added them, in the order they were added.
+    std::vector<Entry> added;
+    //! Transactions whose last journal record removed them.
+    std::set<uint256> removed;
+    //! Full set of fee deltas as of the last clean shutdown, if one was recorded.
+    std::optional<std::map<uint256, CAmount>> deltas;
+    //! Unbroadcast transactions as of the last clean shutdown, if one was recorded.
+    std::optional<std::set<uint256>> unbroadcast_txids;
+
+    //! Drop a transaction from the added list, e.g. because mempool.dat already covered it.
+    bool Consume(const uint256& txid);
+    bool IsPending(const uint256& txid) const { return m_pending.count(txid); }
+
+    //! Index into added for every transaction that is still pending.
+    std::map<uint256, size_t> m_pending;
+};
+
+/** Read a mempool journal. A truncated final record (e.g. after a crash) is ignored. */
+bool ReadMempoolJournal(const fs::path& path, MempoolJournalReplay& replay);
+
+/**
+ * Append-only log of mempool changes since mempool.dat was last written.
+ *
+ * Additions and removals are written as they are reported through the
+ * validation interface, so shutdown only has to flush the journal instead of
+ * serializing the whole mempool. The journal is folded back into mempool.dat
+ * from the scheduler once it grows past the size of the last snapshot.
+ *
+ * Records are idempotent: replaying any suffix of the event stream on top of a
+ * snapshot taken after those events yields the same mempool, so callbacks that
+ * were still queued while a compaction ran are harmless.
+ *
+ * Nothing is recorded until StartRecording(), so that reloading the mempool
+ * at startup does not append it to the journal again. If a write fails, the
+ * journal stops recording until a compaction has rewritten mempool.dat.
+ */
+class MempoolJournal final : public CValidationInterface
+{
+public:
+    explicit MempoolJournal(const CTxMemPool& pool, fs::path path = MempoolJournalPath());
+    ~MempoolJournal();
+
+    bool Open() LOCKS_EXCLUDED(m_mutex);
+    //! Record changes from now on, after the callbacks queued so far have run.
+    void StartRecording() LOCKS_EXCLUDED(m_mutex);
+    //! Rewrite mempool.dat and reset the journal if it has grown too large, or unconditionally if force is set.
+    bool Compact(bool force = false) LOCKS_EXCLUDED(m_mutex);
+    //! Record fee deltas and unbroadcast transactions and sync the journal to disk.
+    bool Commit() LOCKS_EXCLUDED(m_mutex);
+    uint64_t Size() const LOCKS_EXCLUDED(m_mutex);
+
+protected:
+    void TransactionAddedToMempool(const CTransactionRef& tx, uint64_t mempool_sequence) override;
+    void TransactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) override;
+    void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+
+private:
+    bool Reset() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    //! Write a record, or stop recording if it can't be written in full.
+    bool Append(const CDataStream& record) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void Record(const CDataStream& record) LOCKS_EXCLUDED(m_mutex);
+
+    const CTxMemPool& m_pool;
+    const fs::path m_path;
+
+    mutable Mutex m_mutex;
+    FILE* m_file GUARDED_BY(m_mutex){nullptr};
+    uint64_t m_size GUARDED_BY(m_mutex){0};
+    //! Size of mempool.dat when the journal was last reset.
+    uint64_t m_snapshot_size GUARDED_BY(m_mutex){0};
+    bool m_recording GUARDED_BY(m_mutex){false};
+    //! Set while a compaction is writing mempool.dat without holding m_mutex.
+    bool m_compacting GUARDED_BY(m_mutex){false};
+    //! Records written during the running compaction, to carry over into the reset journal.
+    std::vector<CDataStream> m_compaction_records GUARDED_BY(m_mutex);
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_MEMPOOL_JOURNAL_H
@@ -41,6 +41,7 @@
 #include <llmq/quorums_commitment.h>
 #include <validationinterface.h>
 #include <algorithm>
+#include <queue>
 #include <utility>
 
 namespace node {
@@ -304,7 +305,11 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
     /////////////////////////////////////////////////
     int nPackagesSelected = 0;
     int nDescendantsUpdated = 0;
-    addPackageTxs(nPackagesSelected, nDescendantsUpdated, minGasPrice, pblock);
+    if (m_mempool.IsClusterMode()) {
+        addClusterTxs(nPackagesSelected, minGasPrice, pblock);
+    } else {
+        addPackageTxs(nPackagesSelected, nDescendantsUpdated, minGasPrice, pblock);
+    }
     pblock->hashStateRoot = uint256(h256Touint(dev::h256(globalState->rootHash())));
     pblock->hashUTXORoot = uint256(h256Touint(dev::h256(globalState->rootHashUTXO())));
     globalState->setRoot(oldHashStateRoot);
@@ -929,6 +934,161 @@ void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpda
     }
 }
 
+// Cluster mode selection: every mempool cluster is linearized into chunks of
+// non-increasing feerate, so the best remaining chunk overall is always the
+// best next chunk of one of the clusters. Keep the next chunk of each cluster
+// in a heap and add chunks until the block is full or the feerates drop below
+// the minimum.
+void BlockAssembler::addClusterTxs(int& nPackagesSelected, uint64_t minGasPrice, CBlock* pblock)
+{
+    AssertLockHeld(m_mempool.cs);
+
+    // The linearizations are cached by the mempool, only clusters that changed
+    // since the last template are linearized again
+    const std::vector<const std::vector<CTxMemPool::ClusterChunk>*> clusters = m_mempool.GetLinearizedClusters();
+
+    // Next chunk to consider for each cluster, as (cluster index, chunk index)
+    using ChunkPos = std::pair<size_t, size_t>;
+    auto compare_feerate = [&clusters](const ChunkPos& a, const ChunkPos& b) {
+        const CTxMemPool::ClusterChunk& chunk_a = (*clusters[a.first])[a.second];
+        const CTxMemPool::ClusterChunk& chunk_b = (*clusters[b.first])[b.second];
+        return (double)chunk_a.fee * chunk_b.size < (double)chunk_b.fee * chunk_a.size;
+    };
+    std::priority_queue<ChunkPos, std::vector<ChunkPos>, decltype(compare_feerate)> next_chunks(compare_feerate);
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        next_chunks.emplace(i, 0);
+    }
+
+    // Limit the number of attempts to add transactions to the block when it is
+    // close to full; this is just a simple heuristic to finish quickly if the
+    // mempool has a lot of entries.
+    const int64_t MAX_CONSECUTIVE_FAILURES = 1000;
+    int64_t nConsecutiveFailed = 0;
+
+    while (!next_chunks.empty()) {
+        if(nTimeLimit != 0 && GetAdjustedTime() >= nTimeLimit){
+            //no more time to add transactions, just exit
+            return;
+        }
+        const ChunkPos pos = next_chunks.top();
+        next_chunks.pop();
+        const CTxMemPool::ClusterChunk& chunk = (*clusters[pos.first])[pos.second];
+
+        // Skip transactions that are already in the block
+        CTxMemPool::setEntries package;
+        uint64_t packageSize = 0;
+        CAmount packageFees = 0;
+        int64_t packageSigOpsCost = 0;
+        for (CTxMemPool::txiter it : chunk.txs) {
+            if (inBlock.count(it)) continue;
+            package.insert(it);
+            packageSize += it->GetTxSize();
+            packageFees += it->GetModifiedFee();
+            packageSigOpsCost += it->GetSigOpCost();
+        }
+
+        if (!package.empty()) {
+            if (packageFees < blockMinFeeRate.GetFee(packageSize)) {
+                // Everything else we might consider has a lower fee rate
+                return;
+            }
+
+            // The remaining chunks of a cluster may depend on this one, so
+            // a chunk that does not make it in drops the rest of its cluster.
+            if (!TestPackage(packageSize, packageSigOpsCost)) {
+                ++nConsecutiveFailed;
+
+                if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES && nBlockWeight >
+                        nBlockMaxWeight - 4000) {
+                    // Give up if we're close to full and haven't succeeded in a while
+                    break;
+                }
+                continue;
+            }
+
+            if (!TestPackageTransactions(package)) {
+                continue;
+            }
+
+            // The chunk is already in a valid order for block inclusion. Whether
+            // its contracts execute is only known once they run, so a chunk is
+            // taken out again when any of them fails, leaving no partial chunk
+            // behind.
+            const BlockCheckpoint checkpoint = SaveCheckpoint(pblock);
+            std::vector<CTxMemPool::txiter> added;
+            bool wasAdded = true;
+            for (CTxMemPool::txiter it : chunk.txs) {
+                if (inBlock.count(it)) continue;
+                if (nTimeLimit != 0 && GetAdjustedTime() >= nTimeLimit) {
+                    RestoreCheckpoint(checkpoint, added, pblock);
+                    return;
+                }
+                if (it->GetTx().HasCreateOrCall()) {
+                    wasAdded = AttemptToAddContractToBlock(it, minGasPrice, pblock);
+                    if (!wasAdded) break;
+                } else {
+                    AddToBlock(it);
+                }
+                added.push_back(it);
+            }
+
+            if (!wasAdded) {
+                RestoreCheckpoint(checkpoint, added, pblock);
+                continue;
+            }
+
+            // This chunk made it in; reset the failed counter.
+            nConsecutiveFailed = 0;
+            ++nPackagesSelected;
+        }
+
+        if (pos.second + 1 < clusters[pos.first]->size()) {
+            next_chunks.emplace(pos.first, pos.second + 1);
+        }
+    }
+}
+
+BlockAssembler::BlockCheckpoint BlockAssembler::SaveCheckpoint(const CBlock* pblock) const
+{
+    BlockCheckpoint checkpoint;
+    checkpoint.nTxCount = pblock->vtx.size();
+    checkpoint.nTxFeesCount = pblocktemplate->vTxFees.size();
+    checkpoint.rewardTx = pblock->vtx[pblock->IsProofOfStake() ? 1 : 0];
+    checkpoint.nBlockWeight = nBlockWeight;
+    checkpoint.nBlockTx = nBlockTx;
+    checkpoint.nBlockSigOpsCost = nBlockSigOpsCost;
+    checkpoint.nFees = nFees;
+    checkpoint.usedGas = bceResult.usedGas;
+    checkpoint.refundSender = bceResult.refundSender;
+    checkpoint.refundOutputs = bceResult.refundOutputs;
+    checkpoint.hashStateRoot = globalState->rootHash();
+    checkpoint.hashUTXORoot = globalState->rootHashUTXO();
+    return checkpoint;
+}
+
+void BlockAssembler::RestoreCheckpoint(const BlockCheckpoint& checkpoint, const std::vector<CTxMemPool::txiter>& added, CBlock* pblock)
+{
+    // Value transfers of contracts were added to the block too, so the number
+    // of transactions is restored instead of the entries popped one by one
+    pblock->vtx.resize(checkpoint.nTxCount);
+    pblock->vtx[pblock->IsProofOfStake() ? 1 : 0] = checkpoint.rewardTx;
+    pblocktemplate->vTxFees.resize(checkpoint.nTxFeesCount);
+    pblocktemplate->vTxSigOpsCost.resize(checkpoint.nTxFeesCount);
+    nBlockWeight = checkpoint.nBlockWeight;
+    nBlockTx = checkpoint.nBlockTx;
+    nBlockSigOpsCost = checkpoint.nBlockSigOpsCost;
+    nFees = checkpoint.nFees;
+    bceResult.usedGas = checkpoint.usedGas;
+    bceResult.refundSender = checkpoint.refundSender;
+    bceResult.refundOutputs = checkpoint.refundOutputs;
+    bceResult.valueTransfers.clear();
+    globalState->setRoot(checkpoint.hashStateRoot);
+    globalState->setRootUTXO(checkpoint.hashUTXORoot);
+    for (CTxMemPool::txiter it : added) {
+        inBlock.erase(it);
+    }
+}
+
 void IncrementExtraNonce(CBlock* pblock, const CBlockIndex* pindexPrev, unsigned int& nExtraNonce)
 {
     // Update nExtraNonce
@@ -1824,10 +1984,11 @@ protected:
     bool UpdateData()
     {
         if(d->pwallet->IsStakeClosing()) return false;
+        // The published balances are read without cs_wallet, so they don't wait for a rescan
+        const wallet::Balance bal = wallet::GetBalanceSnapshot(*d->pwallet)->balance;
         LOCK(d->pwallet->cs_wallet);
 
         d->clearCache();
-        const auto bal = wallet::GetBalance(*d->pwallet);
         CAmount nBalance = bal.m_mine_trusted;
         if(d->privateKeysDisabled) nBalance += bal.m_watchonly_trusted;
         d->nTargetValue = nBalance - d->pwallet->m_reserve_balance;
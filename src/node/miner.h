@@ -305,6 +305,30 @@ private:
       * Increments nPackagesSelected / nDescendantsUpdated with corresponding
       * statistics from the package selection (for logging statistics). */
     void addPackageTxs(int& nPackagesSelected, int& nDescendantsUpdated, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs);
+    /** Add transactions chunk by chunk from the linearized mempool clusters, best
+      * chunk feerate first. Used instead of addPackageTxs in cluster mode.
+      * Increments nPackagesSelected with the number of chunks selected. */
+    void addClusterTxs(int& nPackagesSelected, uint64_t minGasPrice, CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(m_mempool.cs);
+
+    /** State of the block being assembled, saved before a chunk is added so that
+      * a chunk that only partly makes it in can be taken out again */
+    struct BlockCheckpoint {
+        size_t nTxCount;
+        size_t nTxFeesCount;
+        CTransactionRef rewardTx;
+        uint64_t nBlockWeight;
+        uint64_t nBlockTx;
+        uint64_t nBlockSigOpsCost;
+        CAmount nFees;
+        uint64_t usedGas;
+        CAmount refundSender;
+        std::vector<CTxOut> refundOutputs;
+        dev::h256 hashStateRoot;
+        dev::h256 hashUTXORoot;
+    };
+    BlockCheckpoint SaveCheckpoint(const CBlock* pblock) const;
+    /** Restore the checkpoint, removing the given entries added since from the block */
+    void RestoreCheckpoint(const BlockCheckpoint& checkpoint, const std::vector<CTxMemPool::txiter>& added, CBlock* pblock);
 
     /** Rebuild the coinbase/coinstake transaction to account for new gas refunds **/
     void RebuildRefundTransaction(CBlock* pblock);
@@ -0,0 +1,254 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txreconciliation.h>
+
+#include <crypto/siphash.h>
+#include <hash.h>
+#include <logging.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace node {
+namespace {
+/** Static salt component used to compute short txids for sketch construction, see BIP330. */
+const std::string RECON_STATIC_SALT = "Tx Relay Salting";
+/** Bytes per sketch element (32-bit short ids), so a serialized sketch has 4 bytes per unit of capacity. */
+constexpr size_t RECON_FIELD_BYTES{4};
+} // namespace
+
+uint32_t TxReconciliationTracker::PeerState::ComputeShortID(const uint256& wtxid) const
+{
+    const uint64_t s = SipHashUint256(m_k0, m_k1, wtxid);
+    return 1 + (s % 0xFFFFFFFF);
+}
+
+TxReconciliationTracker::TxReconciliationTracker(uint32_t recon_version)
+    : m_recon_version(recon_version)
+{
+}
+
+uint64_t TxReconciliationTracker::PreRegisterPeer(NodeId peer_id)
+{
+    const uint64_t local_salt = GetRand(std::numeric_limits<uint64_t>::max());
+    LOCK(m_mutex);
+    LogPrint(BCLog::NET, "Pre-register peer=%d for reconciling\n", peer_id);
+    m_pre_registered[peer_id] = local_salt;
+    return local_salt;
+}
+
+ReconciliationRegisterResult TxReconciliationTracker::RegisterPeer(NodeId peer_id, bool is_peer_inbound, uint32_t peer_recon_version,
+                                                                   uint64_t remote_salt)
+{
+    LOCK(m_mutex);
+    if (m_states.count(peer_id)) return ReconciliationRegisterResult::ALREADY_REGISTERED;
+    const auto pre = m_pre_registered.find(peer_id);
+    if (pre == m_pre_registered.end()) return ReconciliationRegisterResult::NOT_FOUND;
+    const uint64_t local_salt = pre->second;
+    m_pre_registered.erase(pre);
+
+    // Both sides use the lowest version they support.
+    if (std::min(peer_recon_version, m_recon_version) < 1) return ReconciliationRegisterResult::PROTOCOL_VIOLATION;
+
+    // Both sides derive the same short ID keys, regardless of who sent which salt.
+    const uint256 full_salt = (TaggedHash(RECON_STATIC_SALT) << std::min(local_salt, remote_salt)
+                                                             << std::max(local_salt, remote_salt)).GetSHA256();
+    PeerState state;
+    state.m_we_initiate = !is_peer_inbound;
+    state.m_k0 = full_salt.GetUint64(0);
+    state.m_k1 = full_salt.GetUint64(1);
+    m_states.emplace(peer_id, std::move(state));
+
+    LogPrint(BCLog::NET, "Register peer=%d for reconciling, we %s requests\n", peer_id, is_peer_inbound ? "respond to" : "send");
+    return ReconciliationRegisterResult::SUCCESS;
+}
+
+void TxReconciliationTracker::ForgetPeer(NodeId peer_id)
+{
+    LOCK(m_mutex);
+    m_pre_registered.erase(peer_id);
+    if (m_states.erase(peer_id)) {
+        LogPrint(BCLog::NET, "Forget reconciliation state of peer=%d\n", peer_id);
+    }
+}
+
+bool TxReconciliationTracker::IsPeerRegistered(NodeId peer_id) const
+{
+    LOCK(m_mutex);
+    return m_states.count(peer_id);
+}
+
+bool TxReconciliationTracker::AddToSet(NodeId peer_id, const uint256& wtxid)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return false;
+    std::set<uint256>& local_set = it->second.m_local_set;
+    if (local_set.size() >= MAX_RECON_SET_SIZE && !local_set.count(wtxid)) return false;
+    local_set.insert(wtxid);
+    return true;
+}
+
+void TxReconciliationTracker::TryRemovingFromSet(NodeId peer_id, const uint256& wtxid)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return;
+    it->second.m_local_set.erase(wtxid);
+}
+
+uint32_t TxReconciliationTracker::EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, uint16_t q)
+{
+    const size_t set_size_diff = std::max(local_set_size, remote_set_size) - std::min(local_set_size, remote_set_size);
+    const size_t min_set_size = std::min(local_set_size, remote_set_size);
+    // The difference is at least the size difference, plus q times the smaller
+    // set for transactions that only one side has; one more for rounding.
+    const size_t capacity = set_size_diff + min_set_size * q / RECON_Q_PRECISION + 1;
+    return std::min<size_t>(capacity, MAX_SKETCH_CAPACITY);
+}
+
+std::optional<std::pair<uint16_t, uint16_t>> TxReconciliationTracker::InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return std::nullopt;
+    PeerState& state = it->second;
+    if (!state.m_we_initiate || state.m_awaiting_sketch) return std::nullopt;
+    if (state.m_next_request == 0us) {
+        // Give the peer one interval to collect transactions before the first round.
+        state.m_next_request = now + RECON_REQUEST_INTERVAL;
+        return std::nullopt;
+    }
+    if (now < state.m_next_request) return std::nullopt;
+
+    state.m_next_request = now + RECON_REQUEST_INTERVAL;
+    state.m_awaiting_sketch = true;
+    // Request a round even with an empty set: the peer may have transactions for us.
+    const uint16_t set_size = std::min<size_t>(state.m_local_set.size(), std::numeric_limits<uint16_t>::max());
+    return std::make_pair(set_size, uint16_t(RECON_Q * RECON_Q_PRECISION));
+}
+
+bool TxReconciliationTracker::HandleSketch(NodeId peer_id, const std::vector<uint8_t>& skdata, ReconciliationResult& result)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return false;
+    PeerState& state = it->second;
+    if (!state.m_we_initiate || !state.m_awaiting_sketch) return false;
+    state.m_awaiting_sketch = false;
+
+    if (skdata.size() % RECON_FIELD_BYTES != 0) return false;
+    const size_t capacity = skdata.size() / RECON_FIELD_BYTES;
+    if (capacity > MAX_SKETCH_CAPACITY) return false;
+
+    std::map<uint32_t, uint256> local_short_ids;
+    for (const uint256& wtxid : state.m_local_set) {
+        local_short_ids.emplace(state.ComputeShortID(wtxid), wtxid);
+    }
+    state.m_local_set.clear();
+
+    std::optional<std::vector<uint64_t>> differences;
+    if (capacity > 0) {
+        Minisketch remote_sketch = MakeMinisketch32(capacity);
+        remote_sketch.Deserialize(skdata);
+        Minisketch local_sketch = MakeMinisketch32(capacity);
+        for (const auto& [short_id, wtxid] : local_short_ids) {
+            local_sketch.Add(short_id);
+        }
+        // Elements both sketches contain cancel out.
+        differences = local_sketch.Merge(remote_sketch).Decode(capacity);
+    }
+
+    result = ReconciliationResult{};
+    if (!differences) {
+        // The difference is too large for the sketch; fall back to announcing everything.
+        LogPrint(BCLog::NET, "Reconciliation with peer=%d failed, announcing %d transactions\n", peer_id, local_short_ids.size());
+        for (const auto& [short_id, wtxid] : local_short_ids) {
+            result.txs_to_announce.push_back(wtxid);
+        }
+        return true;
+    }
+
+    result.success = true;
+    for (const uint64_t diff : *differences) {
+        const auto local = local_short_ids.find(diff);
+        if (local != local_short_ids.end()) {
+            result.txs_to_announce.push_back(local->second);
+        } else {
+            result.ask_shortids.push_back(diff);
+        }
+    }
+    LogPrint(BCLog::NET, "Reconciliation with peer=%d succeeded: announcing %d and requesting %d of %d transactions\n",
+             peer_id, result.txs_to_announce.size(), result.ask_shortids.size(), local_short_ids.size());
+    return true;
+}
+
+bool TxReconciliationTracker::HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return false;
+    PeerState& state = it->second;
+    // Only one round may be in progress at a time.
+    if (state.m_we_initiate || state.m_pending_request || state.m_sketched_set) return false;
+    state.m_pending_request = std::make_pair(peer_set_size, peer_q);
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> TxReconciliationTracker::RespondToReconciliationRequest(NodeId peer_id)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return std::nullopt;
+    PeerState& state = it->second;
+    if (!state.m_pending_request) return std::nullopt;
+    const auto [peer_set_size, peer_q] = *state.m_pending_request;
+    state.m_pending_request.reset();
+
+    // Transactions queued from here on go into the next round.
+    std::map<uint32_t, uint256> sketched_set;
+    for (const uint256& wtxid : state.m_local_set) {
+        sketched_set.emplace(state.ComputeShortID(wtxid), wtxid);
+    }
+    state.m_local_set.clear();
+
+    const uint32_t capacity = EstimateSketchCapacity(sketched_set.size(), peer_set_size, peer_q);
+    Minisketch sketch = MakeMinisketch32(capacity);
+    for (const auto& [short_id, wtxid] : sketched_set) {
+        sketch.Add(short_id);
+    }
+    state.m_sketched_set = std::move(sketched_set);
+    return sketch.Serialize();
+}
+
+bool TxReconciliationTracker::HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids,
+                                                             ReconciliationResult& result)
+{
+    LOCK(m_mutex);
+    const auto it = m_states.find(peer_id);
+    if (it == m_states.end()) return false;
+    PeerState& state = it->second;
+    if (state.m_we_initiate || !state.m_sketched_set) return false;
+    const std::map<uint32_t, uint256> sketched_set = std::move(*state.m_sketched_set);
+    state.m_sketched_set.reset();
+
+    result = ReconciliationResult{};
+    result.success = success;
+    if (success) {
+        for (const uint32_t short_id : ask_shortids) {
+            const auto tx = sketched_set.find(short_id);
+            if (tx != sketched_set.end()) result.txs_to_announce.push_back(tx->second);
+        }
+    } else {
+        for (const auto& [short_id, wtxid] : sketched_set) {
+            result.txs_to_announce.push_back(wtxid);
+        }
+    }
+    return true;
+}
+} // namespace node
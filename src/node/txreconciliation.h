@@ -0,0 +1,148 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_TXRECONCILIATION_H
+#define BITCOIN_NODE_TXRECONCILIATION_H
+
+#include <net.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace node {
+/** Default for -txreconciliation */
+static constexpr bool DEFAULT_TXRECONCILIATION_ENABLE{false};
+/** Supported transaction reconciliation protocol version */
+static constexpr uint32_t TXRECONCILIATION_VERSION{1};
+/** How often we start a reconciliation round with each peer we initiate reconciliation with. */
+static constexpr std::chrono::seconds RECON_REQUEST_INTERVAL{8};
+/** Sketches are never built with more capacity than this, to bound decoding work. */
+static constexpr uint32_t MAX_SKETCH_CAPACITY{2 << 12};
+/** Transactions queued for reconciliation with a single peer beyond this are announced by INV instead. */
+static constexpr size_t MAX_RECON_SET_SIZE{3000};
+/**
+ * Estimated fraction of the smaller set that differs between two peers,
+ * sent scaled by RECON_Q_PRECISION. The responder uses it to size its sketch.
+ */
+static constexpr double RECON_Q{0.25};
+static constexpr uint16_t RECON_Q_PRECISION{(2 << 14) - 1};
+
+enum class ReconciliationRegisterResult {
+    NOT_FOUND,
+    SUCCESS,
+    ALREADY_REGISTERED,
+    PROTOCOL_VIOLATION,
+};
+
+/** Outcome of a reconciliation round, from the point of view of one side. */
+struct ReconciliationResult {
+    //! Whether the set difference could be computed from the sketches.
+    bool success{false};
+    //! Transactions we have and the peer lacks; to be announced to it with INV.
+    std::vector<uint256> txs_to_announce;
+    //! Short IDs of transactions the peer has and we lack (initiator only).
+    std::vector<uint32_t> ask_shortids;
+};
+
+/**
+ * Set reconciliation based transaction relay (Erlay, BIP330).
+ *
+ * Instead of announcing every transaction to every peer, transactions for a
+ * reconciling peer are collected in a per-peer set. Periodically the side
+ * that opened the connection asks the other for a sketch (minisketch) of its
+ * set; combining it with a sketch of its own set yields the symmetric
+ * difference, so only transactions one of the two sides is missing are
+ * announced. Transactions that both sides already know cancel out.
+ *
+ * If the difference turns out larger than the sketch capacity, both sides
+ * fall back to announcing their whole set.
+ *
+ * This class only keeps per-peer reconciliation state; message handling lives
+ * in net_processing. All methods are thread safe.
+ */
+class TxReconciliationTracker
+{
+public:
+    explicit TxReconciliationTracker(uint32_t recon_version);
+
+    /**
+     * Generate the salt for a peer we are going to send SENDTXRCNCL to. The
+     * peer only becomes a reconciliation peer once RegisterPeer() is called
+     * with its own salt.
+     */
+    uint64_t PreRegisterPeer(NodeId peer_id) LOCKS_EXCLUDED(m_mutex);
+
+    /** Complete the negotiation after receiving SENDTXRCNCL from a pre-registered peer. */
+    ReconciliationRegisterResult RegisterPeer(NodeId peer_id, bool is_peer_inbound, uint32_t peer_recon_version,
+                                              uint64_t remote_salt) LOCKS_EXCLUDED(m_mutex);
+
+    void ForgetPeer(NodeId peer_id) LOCKS_EXCLUDED(m_mutex);
+    bool IsPeerRegistered(NodeId peer_id) const LOCKS_EXCLUDED(m_mutex);
+
+    /**
+     * Queue a transaction to be reconciled with the peer instead of announcing
+     * it. Returns false if the peer is not registered or its set is full, in
+     * which case the caller should announce the transaction as usual.
+     */
+    bool AddToSet(NodeId peer_id, const uint256& wtxid) LOCKS_EXCLUDED(m_mutex);
+    /** The peer announced the transaction to us, so there is no need to reconcile it. */
+    void TryRemovingFromSet(NodeId peer_id, const uint256& wtxid) LOCKS_EXCLUDED(m_mutex);
+
+    /**
+     * Initiator: if a new round with the peer is due, return the parameters
+     * of a REQRECON message (local set size and scaled q).
+     */
+    std::optional<std::pair<uint16_t, uint16_t>> InitiateReconciliationRequest(NodeId peer_id, std::chrono::microseconds now) LOCKS_EXCLUDED(m_mutex);
+    /** Initiator: compute the set difference from the peer's sketch. Returns false on a protocol violation. */
+    bool HandleSketch(NodeId peer_id, const std::vector<uint8_t>& skdata, ReconciliationResult& result) LOCKS_EXCLUDED(m_mutex);
+
+    /** Responder: remember a REQRECON to answer. Returns false on a protocol violation. */
+    bool HandleReconciliationRequest(NodeId peer_id, uint16_t peer_set_size, uint16_t peer_q) LOCKS_EXCLUDED(m_mutex);
+    /** Responder: build the SKETCH for a pending request, if there is one. */
+    std::optional<std::vector<uint8_t>> RespondToReconciliationRequest(NodeId peer_id) LOCKS_EXCLUDED(m_mutex);
+    /** Responder: handle RECONCILDIFF for the last sketch sent. Returns false on a protocol violation. */
+    bool HandleReconciliationDifference(NodeId peer_id, bool success, const std::vector<uint32_t>& ask_shortids,
+                                        ReconciliationResult& result) LOCKS_EXCLUDED(m_mutex);
+
+    /** Sketch capacity needed for sets of the given sizes, as estimated by the responder. */
+    static uint32_t EstimateSketchCapacity(size_t local_set_size, size_t remote_set_size, uint16_t q);
+
+private:
+    struct PeerState {
+        //! Whether we opened the connection and therefore send the reconciliation requests.
+        bool m_we_initiate;
+        //! SipHash keys for short IDs, derived from both salts.
+        uint64_t m_k0, m_k1;
+        //! Transactions waiting for the next reconciliation round.
+        std::set<uint256> m_local_set;
+
+        //! Initiator: next time to request a round, and whether a sketch is outstanding.
+        std::chrono::microseconds m_next_request{0};
+        bool m_awaiting_sketch{false};
+
+        //! Responder: a REQRECON that has not been answered yet.
+        std::optional<std::pair<uint16_t, uint16_t>> m_pending_request;
+        //! Responder: the set a sketch was sent for, by short ID, until RECONCILDIFF arrives.
+        std::optional<std::map<uint32_t, uint256>> m_sketched_set;
+
+        uint32_t ComputeShortID(const uint256& wtxid) const;
+    };
+
+    const uint32_t m_recon_version;
+
+    mutable Mutex m_mutex;
+    //! Our salt for peers that have been sent SENDTXRCNCL but have not answered yet.
+    std::map<NodeId, uint64_t> m_pre_registered GUARDED_BY(m_mutex);
+    std::map<NodeId, PeerState> m_states GUARDED_BY(m_mutex);
+};
+} // namespace node
+
+#endif // BITCOIN_NODE_TXRECONCILIATION_H
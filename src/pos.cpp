@@ -498,16 +498,54 @@ struct BlockScript{
     {}
 };
 
-struct ScriptsElement{
-    BlockScript script;
-    uint256 hash;
-};
-
 /**
- * Cache of the recent mpos scripts for the block reward recipients
- * The max size of the map is 2 * nCacheScripts - nMPoSRewardRecipients, so in this case it is 20
+ * Height indexed cache of the mpos scripts for the block reward recipients.
+ * The slot of a block is its height modulo the cache size, so lookups and updates are O(1)
+ * and entries that were overwritten or reorganized away are detected by the block hash.
+ * The scripts are added when the block is connected, so the cache size must exceed the coinbase
+ * maturity plus the number of reward recipients for them to still be present when used.
  */
-std::map<int, ScriptsElement> scriptsMap;
+class MPoSScriptCache
+{
+public:
+    bool Read(BlockScript& script, const CBlockIndex* pblockindex) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if(m_slots.empty())
+            return false;
+
+        const Slot& slot = m_slots[pblockindex->nHeight % CACHE_SIZE];
+        if(slot.hash != pblockindex->GetBlockHash())
+            return false;
+
+        script = slot.script;
+        return true;
+    }
+
+    void Write(const BlockScript& script, const CBlockIndex* pblockindex) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if(m_slots.empty())
+            m_slots.resize(CACHE_SIZE);
+
+        Slot& slot = m_slots[pblockindex->nHeight % CACHE_SIZE];
+        slot.hash = pblockindex->GetBlockHash();
+        slot.script = script;
+    }
+
+private:
+    static constexpr int CACHE_SIZE = 4096;
+
+    struct Slot{
+        uint256 hash;
+        BlockScript script;
+    };
+
+    Mutex m_mutex;
+    std::vector<Slot> m_slots GUARDED_BY(m_mutex);
+};
+
+MPoSScriptCache mposScriptCache;
 
 unsigned int GetStakeMaxCombineInputs() { return 100; }
 
@@ -559,64 +597,41 @@ bool GetDelegationFeeFromContract(const uint160& address, uint8_t& fee, CChainSt
     return ret;
 }
 
-bool NeedToEraseScriptFromCache(int nBlockHeight, int nCacheScripts, int nScriptHeight, const ScriptsElement& scriptElement, CChain& chain)
+BlockScript MakeMPoSScript(const uint160& stakeAddress, bool hasDelegate, const uint160& delegateAddress, uint8_t fee)
 {
-    // Erase element from cache if not in range [nBlockHeight - nCacheScripts, nBlockHeight + nCacheScripts]
-    if(nScriptHeight < (nBlockHeight - nCacheScripts) ||
-            nScriptHeight > (nBlockHeight + nCacheScripts))
-        return true;
-
-    // Erase element from cache if hash different
-    CBlockIndex* pblockindex = chain[nScriptHeight];
-    if(pblockindex && pblockindex->GetBlockHash() != scriptElement.hash)
-        return true;
-
-    return false;
-}
-
-void CleanScriptCache(int nHeight, const Consensus::Params &consensusParams, CChain& chain)
-{
-    int nCacheScripts = consensusParams.nMPoSRewardRecipients * 1.5;
-
-    // Remove the scripts from cache that are not used
-    for (std::map<int, ScriptsElement>::iterator it=scriptsMap.begin(); it!=scriptsMap.end();){
-        if(NeedToEraseScriptFromCache(nHeight, nCacheScripts, it->first, it->second, chain))
-        {
-            it = scriptsMap.erase(it);
-        }
-        else{
-            it++;
-        }
+    BlockScript blockScript;
+    if(stakeAddress == uint160())
+    {
+        LogPrint(BCLog::COINSTAKE, "Fail to solve script for mpos reward recipient\n");
+        //This should never fail, but in case it somehow did we don't want it to bring the network to a halt
+        //So, use an OP_RETURN script to burn the coins for the unknown staker
+        blockScript = CScript() << OP_RETURN;
+    }else{
+        // Make public key hash script
+        blockScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(stakeAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
     }
-}
-
-bool ReadFromScriptCache(BlockScript &script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params &consensusParams, CChain& chain)
-{
-    CleanScriptCache(nHeight, consensusParams, chain);
 
-    // Find the script in the cache
-    std::map<int, ScriptsElement>::iterator it = scriptsMap.find(nHeight);
-    if(it != scriptsMap.end())
+    if(hasDelegate)
     {
-        if(it->second.hash == pblockindex->GetBlockHash())
+        if(delegateAddress == uint160())
         {
-            script = it->second.script;
-            return true;
+            LogPrint(BCLog::COINSTAKE, "Fail to solve script for mpos delegate reward recipient\n");
+            blockScript.delegateScript = CScript() << OP_RETURN;
+        }else{
+            // Make public key hash script
+            blockScript.delegateScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(delegateAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
         }
+
+        blockScript.fee = fee;
+        blockScript.hasDelegate = true;
     }
 
-    return false;
+    return blockScript;
 }
 
-void AddToScriptCache(BlockScript script, CBlockIndex* pblockindex, int nHeight, const Consensus::Params &consensusParams, CChain& chain)
+void CacheMPoSScript(const CBlockIndex* pblockindex, const uint160& stakeAddress, bool hasDelegate, const uint160& delegateAddress, uint8_t fee)
 {
-    CleanScriptCache(nHeight, consensusParams, chain);
-
-    // Add the script into the cache
-    ScriptsElement listElement;
-    listElement.script = script;
-    listElement.hash = pblockindex->GetBlockHash();
-    scriptsMap.insert(std::pair<int, ScriptsElement>(nHeight, listElement));
+    mposScriptCache.Write(MakeMPoSScript(stakeAddress, hasDelegate, delegateAddress, fee), pblockindex);
 }
 
 bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const Consensus::Params &consensusParams, CChain& chain, node::BlockManager& blockman)
@@ -631,13 +646,13 @@ bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const
 
     // Try find the script from the cache
     BlockScript blockScript;
-    if(ReadFromScriptCache(blockScript, pblockindex, nHeight, consensusParams, chain))
+    if(mposScriptCache.Read(blockScript, pblockindex))
     {
         mposScriptList.push_back(blockScript);
         return true;
     }
 
-    // Read the block
+    // Read the recipient from the stake index
     uint160 stakeAddress;
     if(!blockman.m_block_tree_db->ReadStakeIndex(nHeight, stakeAddress)){
         return false;
@@ -646,43 +661,19 @@ bool AddMPoSScript(std::vector<BlockScript> &mposScriptList, int nHeight, const
     // The block reward for PoS is in the second transaction (coinstake) and the second or third output
     if(pblockindex->IsProofOfStake())
     {
-        if(stakeAddress == uint160())
-        {
-            LogPrint(BCLog::COINSTAKE, "Fail to solve script for mpos reward recipient\n");
-            //This should never fail, but in case it somehow did we don't want it to bring the network to a halt
-            //So, use an OP_RETURN script to burn the coins for the unknown staker
-            blockScript = CScript() << OP_RETURN;
-        }else{
-            // Make public key hash script
-            blockScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(stakeAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
-        }
-
-        if(pblockindex->HasProofOfDelegation())
-        {
-            uint160 delegateAddress;
-            uint8_t fee;
-            if(!blockman.m_block_tree_db->ReadDelegateIndex(nHeight, delegateAddress, fee)){
-                return false;
-            }
-
-            if(delegateAddress == uint160())
-            {
-                LogPrint(BCLog::COINSTAKE, "Fail to solve script for mpos delegate reward recipient\n");
-                blockScript.delegateScript = CScript() << OP_RETURN;
-            }else{
-                // Make public key hash script
-                blockScript.delegateScript = CScript() << OP_DUP << OP_HASH160 << ToByteVector(delegateAddress) << OP_EQUALVERIFY << OP_CHECKSIG;
-            }
-
-            blockScript.fee = fee;
-            blockScript.hasDelegate = true;
+        bool hasDelegate = pblockindex->HasProofOfDelegation();
+        uint160 delegateAddress;
+        uint8_t fee = 0;
+        if(hasDelegate && !blockman.m_block_tree_db->ReadDelegateIndex(nHeight, delegateAddress, fee)){
+            return false;
         }
+        blockScript = MakeMPoSScript(stakeAddress, hasDelegate, delegateAddress, fee);
 
         // Add the script into the list
         mposScriptList.push_back(blockScript);
 
         // Update script cache
-        AddToScriptCache(blockScript, pblockindex, nHeight, consensusParams, chain);
+        mposScriptCache.Write(blockScript, pblockindex);
     }
     else
     {
@@ -69,6 +69,9 @@ unsigned int GetStakeSplitOutputs();
 
 int64_t GetStakeSplitThreshold();
 
+// Record the mpos reward recipient of a connected block, so later reward outputs can be built without reading the stake index
+void CacheMPoSScript(const CBlockIndex* pblockindex, const uint160& stakeAddress, bool hasDelegate, const uint160& delegateAddress, uint8_t fee);
+
 bool GetMPoSOutputs(std::vector<CTxOut>& mposOutputList, int64_t nRewardPiece, int nHeight, const Consensus::Params& consensusParams, CChain& chain, node::BlockManager& blockman);
 
 bool CreateMPoSOutputs(CMutableTransaction& txNew, int64_t nRewardPiece, int nHeight, const Consensus::Params& consensusParams, CChain& chain, node::BlockManager& blockman);
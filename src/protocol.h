@@ -262,6 +262,26 @@ extern const char* CFCHECKPT;
  * @since protocol version 70016 as described by BIP 339.
  */
 extern const char* WTXIDRELAY;
+/**
+ * Contains a 4-byte version number and an 8-byte salt.
+ * The salt is used to compute short txids needed for efficient
+ * txreconciliation, as described by BIP 330.
+ */
+extern const char* SENDTXRCNCL;
+/**
+ * Requests a reconciliation round. Contains the size of the sender's
+ * reconciliation set and a coefficient used to size the sketch (BIP 330).
+ */
+extern const char* REQRECON;
+/**
+ * A sketch of the sender's reconciliation set, in response to reqrecon.
+ */
+extern const char* SKETCH;
+/**
+ * Concludes a reconciliation round: whether the set difference could be
+ * decoded and the short txids of transactions the sender is missing.
+ */
+extern const char* RECONCILDIFF;
 }; // namespace NetMsgType
 
 /* Get a vector of all valid message types (see above) */
@@ -95,6 +95,10 @@ private Q_SLOTS:
             found = tokenInfo.hash == tokenHash;
             if(found)
             {
+                // The wallet records the token transactions of the connected blocks
+                if(tokenInfo.block_number == toBlock && tokenInfo.block_hash == blockHash)
+                    return;
+
                 // Get the start location for search the event log
                 if(tokenInfo.block_number < toBlock)
                 {
@@ -158,11 +162,24 @@ private Q_SLOTS:
         if(walletModel && walletModel->node().shutdownRequested())
             return;
 
+        // Use the balance the wallet keeps up to date from the token transfers
+        uint256 tokenHash = uint256S(hash.toStdString());
+        std::string strBalance;
+        if(walletModel->wallet().getTokenBalance(tokenHash, strBalance))
+        {
+            Q_EMIT balanceChanged(hash, QString::fromStdString(strBalance));
+            return;
+        }
+
         tokenAbi.setAddress(contractAddress.toStdString());
         tokenAbi.setSender(senderAddress.toStdString());
-        std::string strBalance;
+        int height = walletModel->node().getNumBlocks();
         if(tokenAbi.balanceOf(strBalance))
         {
+            // Let the wallet update the balance from the next blocks
+            if(height == walletModel->node().getNumBlocks())
+                walletModel->wallet().setTokenBalance(tokenHash, strBalance, height);
+
             QString balance = QString::fromStdString(strBalance);
             Q_EMIT balanceChanged(hash, balance);
         }
@@ -0,0 +1,310 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qtum/vmtrace.h>
+
+#include <clientversion.h>
+#include <crypto/common.h>
+#include <logging.h>
+#include <streams.h>
+#include <univalue.h>
+#include <util/strencodings.h>
+#include <util/thread.h>
+
+#include <ios>
+
+UniValue VMTraceRecordToJSON(const VMTraceRecord& record)
+{
+    UniValue result(UniValue::VOBJ);
+    if (!record.txid.IsNull()) result.pushKV("txid", record.txid.GetHex());
+    result.pushKV("address", HexStr(record.created_address));
+    result.pushKV("time", record.time);
+    if (!record.block_hash.IsNull()) result.pushKV("blockhash", record.block_hash.GetHex());
+    result.pushKV("blockheight", record.height);
+    result.pushKV("gasUsed", record.gas_used);
+    result.pushKV("exception", (uint64_t)record.exception);
+    UniValue entries(UniValue::VARR);
+    for (const VMTraceLog& log : record.logs) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("address", HexStr(log.address));
+        UniValue topics(UniValue::VARR);
+        for (const uint256& topic : log.topics) {
+            UniValue raw(UniValue::VOBJ);
+            raw.pushKV("raw", HexStr(topic));
+            topics.push_back(raw);
+        }
+        UniValue data(UniValue::VOBJ);
+        data.pushKV("raw", HexStr(log.data));
+        entry.pushKV("data", data);
+        entry.pushKV("topics", topics);
+        entries.push_back(entry);
+    }
+    result.pushKV("entries", entries);
+    return result;
+}
+
+VMTrace::VMTrace(fs::path dir) : m_dir(std::move(dir)) {}
+
+VMTrace::~VMTrace()
+{
+    Stop();
+    LOCK(m_file_mutex);
+    Close();
+}
+
+void VMTrace::Close()
+{
+    if (m_data) fclose(m_data);
+    if (m_index) fclose(m_index);
+    m_data = nullptr;
+    m_index = nullptr;
+}
+
+bool VMTrace::Open(bool read_only)
+{
+    LOCK(m_file_mutex);
+    assert(!m_data && !m_index);
+
+    const fs::path data_path = m_dir / "trace.dat";
+    const fs::path index_path = m_dir / "trace.idx";
+    if (!read_only) {
+        try {
+            fs::create_directories(m_dir);
+        } catch (const fs::filesystem_error& e) {
+            LogPrintf("%s: %s\n", __func__, fsbridge::get_filesystem_error_message(e));
+            return false;
+        }
+        for (const fs::path& path : {data_path, index_path}) {
+            FILE* file = fsbridge::fopen(path, "ab");
+            if (!file) return false;
+            fclose(file);
+        }
+    }
+
+    m_data = fsbridge::fopen(data_path, "rb");
+    m_index = fsbridge::fopen(index_path, "rb");
+    if (!m_data || !m_index) {
+        Close();
+        return false;
+    }
+
+    // Load the index entries. Appends are sequential, so a record ends where
+    // the next one starts, and only the last records may be incomplete.
+    std::vector<IndexEntry> entries;
+    std::vector<unsigned char> buf(INDEX_ENTRY_SIZE);
+    while (fread(buf.data(), 1, buf.size(), m_index) == buf.size()) {
+        IndexEntry entry;
+        SpanReader{SER_DISK, CLIENT_VERSION, buf} >> entry;
+        if (entries.empty() ? entry.offset != 0 : entry.offset <= entries.back().offset) break;
+        entries.push_back(entry);
+    }
+    uint64_t file_size{0};
+    try {
+        file_size = fs::file_size(data_path);
+    } catch (const fs::filesystem_error&) {}
+    while (!entries.empty()) {
+        uint64_t size;
+        if (ReadSize(entries.back().offset, size) && entries.back().offset + size <= file_size) {
+            m_data_size = entries.back().offset + size;
+            break;
+        }
+        entries.pop_back();
+    }
+    m_entries.reserve(entries.size());
+    for (const IndexEntry& entry : entries) {
+        AddEntry(entry);
+    }
+    const size_t indexed = m_entries.size();
+
+    // Index the complete records that were written without their entry
+    VMTraceRecord record;
+    uint64_t size;
+    while (ReadRecord(m_data_size, record, size)) {
+        AddEntry({record.txid, record.height, m_data_size});
+        m_data_size += size;
+    }
+    if (read_only) return true;
+
+    Close();
+    try {
+        fs::resize_file(data_path, m_data_size);
+        fs::resize_file(index_path, indexed * INDEX_ENTRY_SIZE);
+    } catch (const fs::filesystem_error& e) {
+        LogPrintf("%s: %s\n", __func__, fsbridge::get_filesystem_error_message(e));
+        return false;
+    }
+    m_data = fsbridge::fopen(data_path, "a+b");
+    m_index = fsbridge::fopen(index_path, "a+b");
+    if (!m_data || !m_index) {
+        Close();
+        return false;
+    }
+    if (indexed < m_entries.size()) {
+        LogPrintf("VM trace: indexed %u records of %s\n", m_entries.size() - indexed, fs::PathToString(data_path));
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        for (size_t i = indexed; i < m_entries.size(); ++i) {
+            ss << m_entries[i];
+        }
+        if (fwrite(ss.data(), 1, ss.size(), m_index) != ss.size() || fflush(m_index) != 0) {
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void VMTrace::AddEntry(const IndexEntry& entry)
+{
+    m_by_txid.emplace(entry.txid, m_entries.size());
+    m_entries.push_back(entry);
+}
+
+bool VMTrace::ReadSize(uint64_t offset, uint64_t& size) const
+{
+    unsigned char size_bytes[4];
+    if (fseek(m_data, offset, SEEK_SET) != 0 || fread(size_bytes, 1, sizeof(size_bytes), m_data) != sizeof(size_bytes)) return false;
+    size = sizeof(size_bytes) + ReadLE32(size_bytes);
+    return true;
+}
+
+bool VMTrace::ReadRecord(uint64_t offset, VMTraceRecord& record, uint64_t& size) const
+{
+    if (!ReadSize(offset, size)) return false;
+    std::vector<unsigned char> buf(size - 4);
+    if (fread(buf.data(), 1, buf.size(), m_data) != buf.size()) return false;
+    try {
+        SpanReader{SER_DISK, CLIENT_VERSION, buf} >> record;
+    } catch (const std::ios_base::failure&) {
+        return false;
+    }
+    return true;
+}
+
+bool VMTrace::Append(const std::vector<VMTraceRecord>& records)
+{
+    if (m_failed || !m_data || !m_index) return false;
+
+    // Write all records with one call, then their index entries
+    CDataStream data(SER_DISK, CLIENT_VERSION);
+    CDataStream index(SER_DISK, CLIENT_VERSION);
+    std::vector<IndexEntry> entries;
+    uint64_t offset = m_data_size;
+    for (const VMTraceRecord& record : records) {
+        const size_t start = data.size();
+        data << uint32_t{0} << record;
+        WriteLE32(reinterpret_cast<unsigned char*>(&data[start]), data.size() - start - 4);
+        entries.push_back({record.txid, record.height, offset});
+        index << entries.back();
+        offset += data.size() - start;
+    }
+
+    if (fseek(m_data, 0, SEEK_END) != 0 || fwrite(data.data(), 1, data.size(), m_data) != data.size() || fflush(m_data) != 0 ||
+        fseek(m_index, 0, SEEK_END) != 0 || fwrite(index.data(), 1, index.size(), m_index) != index.size() || fflush(m_index) != 0) {
+        // Later records would not follow the last complete one, so stop recording
+        LogPrintf("Failed to write the VM trace in %s, no further executions are recorded\n", fs::PathToString(m_dir));
+        m_failed = true;
+        return false;
+    }
+    for (const IndexEntry& entry : entries) {
+        AddEntry(entry);
+    }
+    m_data_size = offset;
+    return true;
+}
+
+void VMTrace::Start()
+{
+    assert(!m_thread.joinable());
+    {
+        LOCK(m_queue_mutex);
+        m_stop = false;
+    }
+    m_thread = std::thread(&util::TraceThread, "vmtrace", [this] { ThreadWrite(); });
+}
+
+void VMTrace::Stop()
+{
+    {
+        LOCK(m_queue_mutex);
+        m_stop = true;
+    }
+    m_queue_cv.notify_all();
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void VMTrace::ThreadWrite()
+{
+    WAIT_LOCK(m_queue_mutex, lock);
+    while (true) {
+        m_queue_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_queue_mutex) { return !m_queue.empty() || m_stop; });
+        if (m_queue.empty()) break;
+
+        std::vector<VMTraceRecord> records;
+        records.swap(m_queue);
+        m_writing = true;
+        {
+            REVERSE_LOCK(lock);
+            LOCK(m_file_mutex);
+            Append(records);
+        }
+        m_writing = false;
+        m_written_cv.notify_all();
+    }
+}
+
+void VMTrace::Add(std::vector<VMTraceRecord> records)
+{
+    if (records.empty()) return;
+    if (!m_thread.joinable()) {
+        LOCK(m_file_mutex);
+        Append(records);
+        return;
+    }
+    {
+        LOCK(m_queue_mutex);
+        m_queue.insert(m_queue.end(), std::make_move_iterator(records.begin()), std::make_move_iterator(records.end()));
+    }
+    m_queue_cv.notify_one();
+}
+
+void VMTrace::Flush()
+{
+    WAIT_LOCK(m_queue_mutex, lock);
+    m_written_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_queue_mutex) { return m_queue.empty() && !m_writing; });
+}
+
+std::vector<VMTraceRecord> VMTrace::ReadTx(const uint256& txid) const
+{
+    LOCK(m_file_mutex);
+    std::vector<VMTraceRecord> records;
+    const auto [begin, end] = m_by_txid.equal_range(txid);
+    for (auto it = begin; it != end; ++it) {
+        uint64_t size;
+        if (!ReadRecord(m_entries[it->second].offset, records.emplace_back(), size)) {
+            records.pop_back();
+        }
+    }
+    return records;
+}
+
+std::vector<VMTraceRecord> VMTrace::ReadRange(int from, int to, size_t limit) const
+{
+    LOCK(m_file_mutex);
+    std::vector<VMTraceRecord> records;
+    for (const IndexEntry& entry : m_entries) {
+        if (records.size() >= limit) break;
+        if (entry.height < from || entry.height > to) continue;
+        uint64_t size;
+        if (!ReadRecord(entry.offset, records.emplace_back(), size)) {
+            records.pop_back();
+        }
+    }
+    return records;
+}
+
+size_t VMTrace::Size() const
+{
+    LOCK(m_file_mutex);
+    return m_entries.size();
+}
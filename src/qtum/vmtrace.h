@@ -0,0 +1,131 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_VMTRACE_H
+#define QTUM_VMTRACE_H
+
+#include <fs.h>
+#include <serialize.h>
+#include <sync.h>
+#include <uint256.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <thread>
+#include <vector>
+
+class UniValue;
+
+/** A log entry of a contract execution. Addresses and topics hold the raw EVM bytes. */
+struct VMTraceLog {
+    uint160 address;
+    std::vector<uint256> topics;
+    std::vector<unsigned char> data;
+
+    SERIALIZE_METHODS(VMTraceLog, obj) { READWRITE(obj.address, obj.topics, obj.data); }
+};
+
+/** The result of one contract execution, as recorded with -record-log-opcodes */
+struct VMTraceRecord {
+    //! Null for executions outside a transaction, like callcontract
+    uint256 txid;
+    //! Null for executions outside a block
+    uint256 block_hash;
+    int32_t height{0};
+    int64_t time{0};
+    uint64_t gas_used{0};
+    //! dev::eth::TransactionException of the execution, 0 if it succeeded
+    uint32_t exception{0};
+    //! Raw EVM address of the contract created by the execution, or null
+    uint160 created_address;
+    std::vector<VMTraceLog> logs;
+
+    SERIALIZE_METHODS(VMTraceRecord, obj)
+    {
+        READWRITE(obj.txid, obj.block_hash, VARINT_MODE(obj.height, VarIntMode::NONNEGATIVE_SIGNED), VARINT_MODE(obj.time, VarIntMode::NONNEGATIVE_SIGNED),
+                  VARINT(obj.gas_used), VARINT(obj.exception), obj.created_address, obj.logs);
+    }
+};
+
+UniValue VMTraceRecordToJSON(const VMTraceRecord& record);
+
+/**
+ * Append-only store of the VM execution records.
+ *
+ * trace.dat holds the serialized records, each preceded by its size.
+ * trace.idx holds one fixed size entry with the txid, height and offset of
+ * each record, so lookups by txid or height do not read every record.
+ *
+ * Records are appended by a background thread once it is started, so the
+ * validation thread only pays for building them. A record is written to
+ * trace.dat before its index entry, and opening the store repairs what an
+ * interrupted write left behind.
+ */
+class VMTrace
+{
+public:
+    explicit VMTrace(fs::path dir);
+    ~VMTrace();
+
+    /** Open the files, creating them unless read_only. Unless read_only, cut off a partially written record and index the records that miss an entry. */
+    bool Open(bool read_only = false);
+    /** Start the thread that appends the queued records. */
+    void Start();
+    /** Append the queued records and stop the thread. */
+    void Stop();
+
+    /** Queue records for the writer thread, or append them directly if it is not running. */
+    void Add(std::vector<VMTraceRecord> records);
+    /** Wait until all queued records are appended. */
+    void Flush();
+
+    /** The records of a transaction, in the order they were recorded. */
+    std::vector<VMTraceRecord> ReadTx(const uint256& txid) const;
+    /** At most limit records with a height in [from, to], in the order they were recorded. */
+    std::vector<VMTraceRecord> ReadRange(int from, int to, size_t limit) const;
+    size_t Size() const;
+
+private:
+    struct IndexEntry {
+        uint256 txid;
+        int32_t height;
+        uint64_t offset;
+
+        SERIALIZE_METHODS(IndexEntry, obj) { READWRITE(obj.txid, obj.height, obj.offset); }
+    };
+    static constexpr size_t INDEX_ENTRY_SIZE{32 + 4 + 8};
+
+    /** Read the size on disk of the record at offset. */
+    bool ReadSize(uint64_t offset, uint64_t& size) const EXCLUSIVE_LOCKS_REQUIRED(m_file_mutex);
+    /** Read the record at offset and set size to its size on disk. */
+    bool ReadRecord(uint64_t offset, VMTraceRecord& record, uint64_t& size) const EXCLUSIVE_LOCKS_REQUIRED(m_file_mutex);
+    bool Append(const std::vector<VMTraceRecord>& records) EXCLUSIVE_LOCKS_REQUIRED(m_file_mutex);
+    void AddEntry(const IndexEntry& entry) EXCLUSIVE_LOCKS_REQUIRED(m_file_mutex);
+    void Close() EXCLUSIVE_LOCKS_REQUIRED(m_file_mutex);
+    void ThreadWrite();
+
+    const fs::path m_dir;
+
+    mutable Mutex m_file_mutex;
+    FILE* m_data GUARDED_BY(m_file_mutex){nullptr};
+    FILE* m_index GUARDED_BY(m_file_mutex){nullptr};
+    uint64_t m_data_size GUARDED_BY(m_file_mutex){0};
+    bool m_failed GUARDED_BY(m_file_mutex){false};
+    std::vector<IndexEntry> m_entries GUARDED_BY(m_file_mutex);
+    std::multimap<uint256, size_t> m_by_txid GUARDED_BY(m_file_mutex);
+
+    Mutex m_queue_mutex;
+    //! Wakes the writer thread when records are queued or it should stop
+    std::condition_variable m_queue_cv;
+    //! Wakes Flush() when the writer thread appended a batch
+    std::condition_variable m_written_cv;
+    std::vector<VMTraceRecord> m_queue GUARDED_BY(m_queue_mutex);
+    bool m_writing GUARDED_BY(m_queue_mutex){false};
+    bool m_stop GUARDED_BY(m_queue_mutex){false};
+    std::thread m_thread;
+};
+
+#endif // QTUM_VMTRACE_H
@@ -15,6 +15,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
@@ -27,6 +28,7 @@
 #include <version.h>
 
 #include <any>
+#include <functional>
 
 #include <boost/algorithm/string.hpp>
 
@@ -78,6 +80,35 @@ static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string me
     return false;
 }
 
+/** Reply with the JSON written by write, sending it in chunks while it is written once it outgrows the writer's buffer */
+static bool RESTStreamJSON(HTTPRequest* req, const std::function<void(JSONStreamWriter&)>& write)
+{
+    JSONStreamWriter writer([req](const std::string& chunk) {
+        if (!req->isStreamMode()) {
+            req->WriteHeader("Content-Type", "application/json");
+        } else if (req->StreamClosed()) {
+            throw std::runtime_error("client closed the connection");
+        }
+        req->StreamChunk(chunk);
+    });
+    try {
+        write(writer);
+    } catch (const std::runtime_error&) {
+        // The unfinished reply is given up on when req is destroyed
+        if (req->StreamClosed()) return true;
+        throw;
+    }
+    const std::string rest = writer.TakeBuffered() + "\n";
+    if (writer.Flushed() == 0) {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, rest);
+    } else {
+        req->StreamChunk(rest);
+        req->StreamEnd();
+    }
+    return true;
+}
+
 /**
  * Get the node context.
  *
@@ -323,11 +354,7 @@ static bool rest_block(const std::any& context,
     }
 
     case RetFormat::JSON: {
-        UniValue objBlock = blockToJSON(block, tip, pblockindex, tx_verbosity);
-        std::string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return RESTStreamJSON(req, [&](JSONStreamWriter& writer) { blockToJSON(writer, block, tip, pblockindex, tx_verbosity); });
     }
 
     default: {
@@ -610,12 +637,7 @@ static bool rest_mempool_contents(const std::any& context, HTTPRequest* req, con
 
     switch (rf) {
     case RetFormat::JSON: {
-        UniValue mempoolObject = MempoolToJSON(*mempool, true);
-
-        std::string strJSON = mempoolObject.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return RESTStreamJSON(req, [mempool](JSONStreamWriter& writer) { MempoolToJSON(writer, *mempool); });
     }
     default: {
         return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
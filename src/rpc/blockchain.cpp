@@ -25,6 +25,7 @@
 #include <node/blockstorage.h>
 #include <node/coinstats.h>
 #include <node/context.h>
+#include <node/mempool_journal.h>
 #include <node/utxo_snapshot.h>
 #include <key_io.h>
 #include <policy/feerate.h>
@@ -287,19 +288,24 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
     return result;
 }
 
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+/** Block description without its transactions */
+static UniValue blockInfoToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main)
 {
     UniValue result = blockheaderToJSON(tip, blockindex);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(block, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
     result.pushKV("size", (int)::GetSerializeSize(block, PROTOCOL_VERSION));
     result.pushKV("weight", (int)::GetBlockWeight(block));
-    UniValue txs(UniValue::VARR);
+    return result;
+}
 
+/** Pass the transactions of a block to push one by one */
+static void blockTxsToJSON(const CBlock& block, const CBlockIndex* blockindex, TxVerbosity verbosity, const std::function<void(const UniValue&)>& push) LOCKS_EXCLUDED(cs_main)
+{
     switch (verbosity) {
         case TxVerbosity::SHOW_TXID:
             for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
+                push(tx->GetHash().GetHex());
             }
             break;
 
@@ -314,16 +320,33 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
                 const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
                 UniValue objTx(UniValue::VOBJ);
                 TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags(), txundo, verbosity);
-                txs.push_back(objTx);
+                push(objTx);
             }
             break;
     }
+}
 
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    UniValue result = blockInfoToJSON(block, tip, blockindex);
+    UniValue txs(UniValue::VARR);
+    blockTxsToJSON(block, blockindex, verbosity, [&txs](const UniValue& tx) { txs.push_back(tx); });
     result.pushKV("tx", txs);
 
     return result;
 }
 
+void blockToJSON(JSONStreamWriter& writer, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    writer.BeginObject();
+    writer.PushKVs(blockInfoToJSON(block, tip, blockindex));
+    writer.Key("tx");
+    writer.BeginArray();
+    blockTxsToJSON(block, blockindex, verbosity, [&writer](const UniValue& tx) { writer.Push(tx); });
+    writer.EndArray();
+    writer.EndObject();
+}
+
 static RPCHelpMan getestimatedannualroi()
 {
     return RPCHelpMan{"getestimatedannualroi",
@@ -725,6 +748,18 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+void MempoolToJSON(JSONStreamWriter& writer, const CTxMemPool& pool)
+{
+    LOCK(pool.cs);
+    writer.BeginObject();
+    for (const CTxMemPoolEntry& e : pool.mapTx) {
+        UniValue info(UniValue::VOBJ);
+        entryToJSON(pool, info, e);
+        writer.PushKV(e.GetTx().GetHash().ToString(), info);
+    }
+    writer.EndObject();
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{"getrawmempool",
@@ -770,6 +805,10 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
+    if (fVerbose && !include_mempool_sequence) {
+        const CTxMemPool& mempool = EnsureAnyMemPool(request.context);
+        return StreamResult(request, [&mempool](JSONStreamWriter& writer) { MempoolToJSON(writer, mempool); });
+    }
     return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose, include_mempool_sequence);
 },
     };
@@ -1400,7 +1439,7 @@ static RPCHelpMan getblock()
         tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
     }
 
-    return blockToJSON(block, tip, pblockindex, tx_verbosity);
+    return StreamResult(request, [&](JSONStreamWriter& writer) { blockToJSON(writer, block, tip, pblockindex, tx_verbosity); });
 },
     };
 }
@@ -1461,6 +1500,41 @@ RPCHelpMan callcontract()
     };
 }
 
+RPCHelpMan estimategas()
+{
+    return RPCHelpMan{"estimategas",
+                "\nEstimate the gas limit needed to call a contract method, or to deploy a contract.\n"
+                "The call is executed on top of the chain tip with the block gas limit, and then with the gas it used\n"
+                "before refunds. Only calls which need more gas than that, e.g. because nested calls forward 63/64 of\n"
+                "the remaining gas, are executed several times to bisect the gas limit.\n",
+                {
+                    {"address", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The contract address, or empty address \"\""},
+                    {"data", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The data hex string"},
+                    {"senderaddress", RPCArg::Type::STR, RPCArg::Optional::OMITTED_NAMED_ARG, "The sender address string"},
+                    {"amount", RPCArg::Type::AMOUNT, RPCArg::Optional::OMITTED_NAMED_ARG, "The amount in " + CURRENCY_UNIT + " to send. eg 0.1, default: 0"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR, "address", "The address of the contract"},
+                        {RPCResult::Type::NUM, "gasLimit", "The lowest gas limit the execution succeeds with"},
+                        {RPCResult::Type::NUM, "gasUsed", "The gas used with the block gas limit"},
+                        {RPCResult::Type::NUM, "gasRefunded", "The gas refunded with the block gas limit"},
+                        {RPCResult::Type::NUM, "executions", "The number of executions needed for the estimate"},
+                        {RPCResult::Type::BOOL, "bisected", "Whether the execution depends on the gas limit, so the gas limit was bisected"},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("estimategas", "eb23c0b3e6042821da281a2e2364feb22dd543e3 06fdde03")
+            + HelpExampleRpc("estimategas", "eb23c0b3e6042821da281a2e2364feb22dd543e3 06fdde03")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    return EstimateGasForContract(request.params, chainman);
+},
+    };
+}
+
 class WaitForLogsParams {
 public:
     int fromBlock;
@@ -1747,7 +1821,105 @@ RPCHelpMan searchlogs()
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
-    return SearchLogs(request.params, chainman);
+    return StreamResult(request, [&](JSONStreamWriter& writer) {
+        writer.BeginArray();
+        SearchLogs(request.params, chainman, [&writer](const UniValue& entry) { writer.Push(entry); });
+        writer.EndArray();
+    });
+},
+    };
+}
+
+static const std::vector<RPCResult> VM_TRACE_RESULT_FIELDS{
+    {RPCResult::Type::STR_HEX, "txid", /*optional=*/true, "The transaction id, omitted for calls outside a transaction"},
+    {RPCResult::Type::STR_HEX, "address", "The address of the created contract, or zero"},
+    {RPCResult::Type::NUM_TIME, "time", "The block time, or the time of the call outside a block"},
+    {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "The block hash, omitted for calls outside a block"},
+    {RPCResult::Type::NUM, "blockheight", "The block height"},
+    {RPCResult::Type::NUM, "gasUsed", "The gas used"},
+    {RPCResult::Type::NUM, "exception", "The code of the thrown exception, 0 if none"},
+    {RPCResult::Type::ARR, "entries", "The logs of the execution",
+        {
+            {RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::STR_HEX, "address", "The contract address"},
+                    {RPCResult::Type::OBJ, "data", "", {{RPCResult::Type::STR_HEX, "raw", "The logged data"}}},
+                    {RPCResult::Type::ARR, "topics", "",
+                        {{RPCResult::Type::OBJ, "", "", {{RPCResult::Type::STR_HEX, "raw", "The topic"}}}}},
+                }},
+        }},
+};
+
+static VMTrace& EnsureVMTrace()
+{
+    if (!g_vm_trace) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Contract executions are not recorded, start the node with -record-log-opcodes");
+    }
+    // Make the records still queued for the writer thread visible
+    g_vm_trace->Flush();
+    return *g_vm_trace;
+}
+
+static RPCHelpMan getvmtrace()
+{
+    return RPCHelpMan{"getvmtrace",
+                "\nReturns the recorded contract executions of a transaction, requires -record-log-opcodes.\n",
+                {
+                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The transaction id"},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "The executions in the order they were recorded, including the ones of blocks that were disconnected",
+                    {{RPCResult::Type::OBJ, "", "", VM_TRACE_RESULT_FIELDS}}},
+                RPCExamples{
+                    HelpExampleCli("getvmtrace", "\"mytxid\"")
+            + HelpExampleRpc("getvmtrace", "\"mytxid\"")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const uint256 txid = ParseHashV(request.params[0], "txid");
+    UniValue result(UniValue::VARR);
+    for (const VMTraceRecord& record : EnsureVMTrace().ReadTx(txid)) {
+        result.push_back(VMTraceRecordToJSON(record));
+    }
+    return result;
+},
+    };
+}
+
+static RPCHelpMan listvmtraces()
+{
+    return RPCHelpMan{"listvmtraces",
+                "\nReturns the recorded contract executions in a range of blocks, requires -record-log-opcodes.\n",
+                {
+                    {"fromblock", RPCArg::Type::NUM, RPCArg::Optional::NO, "The height of the first block"},
+                    {"toblock", RPCArg::Type::NUM, RPCArg::Default{-1}, "The height of the last block, -1 for the tip"},
+                    {"count", RPCArg::Type::NUM, RPCArg::Default{1000}, "The maximum number of executions to return"},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "The executions in the order they were recorded",
+                    {{RPCResult::Type::OBJ, "", "", VM_TRACE_RESULT_FIELDS}}},
+                RPCExamples{
+                    HelpExampleCli("listvmtraces", "1000 1100")
+            + HelpExampleRpc("listvmtraces", "1000, 1100")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const int from = request.params[0].get_int();
+    int to = request.params[1].isNull() ? -1 : request.params[1].get_int();
+    if (to == -1) to = std::numeric_limits<int>::max();
+    const int count = request.params[2].isNull() ? 1000 : request.params[2].get_int();
+    if (from < 0 || to < from) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid block range");
+    }
+    if (count < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const VMTraceRecord& record : EnsureVMTrace().ReadRange(from, to, count)) {
+        result.push_back(VMTraceRecordToJSON(record));
+    }
+    return result;
 },
     };
 }
@@ -3324,12 +3496,15 @@ static RPCHelpMan savemempool()
 {
     const ArgsManager& args{EnsureAnyArgsman(request.context)};
     const CTxMemPool& mempool = EnsureAnyMemPool(request.context);
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
 
     if (!mempool.IsLoaded()) {
         throw JSONRPCError(RPC_MISC_ERROR, "The mempool was not loaded yet");
     }
 
-    if (!DumpMempool(mempool)) {
+    // With a journal, mempool.dat must only be rewritten together with resetting it.
+    const bool dumped = node.mempool_journal ? node.mempool_journal->Compact(/*force=*/true) : DumpMempool(mempool);
+    if (!dumped) {
         throw JSONRPCError(RPC_MISC_ERROR, "Unable to dump mempool to disk");
     }
 
@@ -4122,6 +4297,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         &getblockfilter,                     },
 
     { "blockchain",         &callcontract,                       },
+    { "blockchain",         &estimategas,                        },
 
     { "blockchain",         &qrc20name,                          },
     { "blockchain",         &qrc20symbol,                        },
@@ -4134,6 +4310,8 @@ static const CRPCCommand commands[] =
     { "blockchain",         &listcontracts,                      },
     { "blockchain",         &gettransactionreceipt,              },
     { "blockchain",         &searchlogs,                         },
+    { "blockchain",         &getvmtrace,                         },
+    { "blockchain",         &listvmtraces,                       },
 
     { "blockchain",         &waitforlogs,                        },
     { "blockchain",         &getestimatedannualroi,              },
@@ -112,6 +112,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "searchlogs", 2, "addressfilter"},
     { "searchlogs", 3, "topicfilter"},
     { "searchlogs", 4, "minconf"},
+    { "listvmtraces", 0, "fromblock"},
+    { "listvmtraces", 1, "toblock"},
+    { "listvmtraces", 2, "count"},
     { "waitforlogs", 0, "fromblock"},
     { "waitforlogs", 1, "toblock"},
     { "waitforlogs", 2, "filter"},
@@ -246,6 +249,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "qrc20burnfrom", 6, "checkoutputs" },
     { "callcontract", 3, "gaslimit" },
     { "callcontract", 4, "amount" },
+    { "estimategas", 3, "amount" },
     { "reservebalance", 0, "reserve"},
     { "reservebalance", 1, "amount"},
     { "listcontracts", 0, "start" },
@@ -3,6 +3,7 @@
 #include <util/system.h>
 #include <key_io.h>
 #include <rpc/server.h>
+#include <timedata.h>
 #include <txdb.h>
 
 UniValue executionResultToJSON(const dev::eth::ExecutionResult& exRes)
@@ -46,17 +47,14 @@ UniValue transactionReceiptToJSON(const QtumTransactionReceipt& txRec)
     return result;
 }
 
-UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
+static void ParseContractCall(const UniValue& params, dev::Address& addrAccount, std::string& data, dev::Address& senderAddress)
 {
-    LOCK(cs_main);
-
     std::string strAddr = params[0].get_str();
-    std::string data = params[1].get_str();
+    data = params[1].get_str();
 
     if(data.size() % 2 != 0 || !CheckHex(data))
         throw JSONRPCError(RPC_TYPE_ERROR, "Invalid data (data not hex)");
 
-    dev::Address addrAccount;
     if(strAddr.size() > 0)
     {
         if(strAddr.size() != 40 || !CheckHex(strAddr))
@@ -67,7 +65,6 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Address does not exist");
     }
 
-    dev::Address senderAddress;
     if(!params[2].isNull()){
         CTxDestination qtumSenderAddress = DecodeDestination(params[2].get_str());
         if (IsValidDestination(qtumSenderAddress)) {
@@ -78,33 +75,86 @@ UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
         }
 
     }
-    uint64_t gasLimit=0;
-    if(!params[3].isNull()){
-        gasLimit = params[3].get_int64();
-    }
+}
 
+static CAmount ParseContractCallAmount(const UniValue& param)
+{
     CAmount nAmount = 0;
-    if (!params[4].isNull()){
-        nAmount = AmountFromValue(params[4]);
+    if (!param.isNull()){
+        nAmount = AmountFromValue(param);
         if (nAmount < 0)
             throw JSONRPCError(RPC_TYPE_ERROR, "Invalid amount for send");
     }
+    return nAmount;
+}
 
+UniValue CallToContract(const UniValue& params, ChainstateManager &chainman)
+{
+    LOCK(cs_main);
+
+    dev::Address addrAccount;
+    std::string data;
+    dev::Address senderAddress;
+    ParseContractCall(params, addrAccount, data, senderAddress);
+
+    uint64_t gasLimit=0;
+    if(!params[3].isNull()){
+        gasLimit = params[3].get_int64();
+    }
+
+    CAmount nAmount = ParseContractCallAmount(params[4]);
 
     std::vector<ResultExecute> execResults = CallContract(addrAccount, ParseHex(data), chainman.ActiveChainstate(), senderAddress, gasLimit, nAmount);
 
     if(fRecordLogOpcodes){
-        writeVMlog(execResults, chainman.ActiveChain());
+        RecordVMTrace(execResults, chainman.ActiveChain().Height(), GetAdjustedTime());
     }
 
     UniValue result(UniValue::VOBJ);
-    result.pushKV("address", strAddr);
+    result.pushKV("address", params[0].get_str());
     result.pushKV("executionResult", executionResultToJSON(execResults[0].execRes));
     result.pushKV("transactionReceipt", transactionReceiptToJSON(execResults[0].txRec));
 
     return result;
 }
 
+UniValue EstimateGasForContract(const UniValue& params, ChainstateManager &chainman)
+{
+    LOCK(cs_main);
+
+    dev::Address addrAccount;
+    std::string data;
+    dev::Address senderAddress;
+    ParseContractCall(params, addrAccount, data, senderAddress);
+    CAmount nAmount = ParseContractCallAmount(params[3]);
+
+    ContractCallContext context(addrAccount, ParseHex(data), chainman.ActiveChainstate(), senderAddress, nAmount);
+    ContractGasEstimate estimate;
+    bool success = EstimateContractGas(context, estimate);
+
+    if(fRecordLogOpcodes && !estimate.result.empty()){
+        RecordVMTrace(estimate.result, chainman.ActiveChain().Height(), GetAdjustedTime());
+    }
+
+    if(!success){
+        if(estimate.result.empty())
+            throw JSONRPCError(RPC_MISC_ERROR, "Contract execution failed");
+        const dev::eth::ExecutionResult& execRes = estimate.result[0].execRes;
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Contract execution failed with the block gas limit: %s", exceptedMessage(execRes.excepted, execRes.output)));
+    }
+
+    const dev::eth::ExecutionResult& execRes = estimate.result[0].execRes;
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("address", params[0].get_str());
+    result.pushKV("gasLimit", estimate.gasLimit);
+    result.pushKV("gasUsed", CAmount(execRes.gasUsed));
+    result.pushKV("gasRefunded", CAmount(execRes.gasRefunded));
+    result.pushKV("executions", estimate.executions);
+    result.pushKV("bisected", estimate.bisected);
+
+    return result;
+}
+
 void assignJSON(UniValue& entry, const TransactionReceiptInfo& resExec) {
     entry.pushKV("blockHash", resExec.blockHash.GetHex());
     entry.pushKV("blockNumber", uint64_t(resExec.blockNumber));
@@ -310,7 +360,14 @@ private:
 
 };
 
-UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
+UniValue SearchLogs(const UniValue& params, ChainstateManager &chainman)
+{
+    UniValue result(UniValue::VARR);
+    SearchLogs(params, chainman, [&result](const UniValue& entry) { result.push_back(entry); });
+    return result;
+}
+
+void SearchLogs(const UniValue& _params, ChainstateManager &chainman, const std::function<void(const UniValue&)>& push)
 {
     if(!fLogEvents)
         throw JSONRPCError(RPC_INTERNAL_ERROR, "Events indexing disabled");
@@ -329,8 +386,6 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Incorrect params");
     }
 
-    UniValue result(UniValue::VARR);
-
     auto topics = params.topics;
 
     std::set<uint256> dupes;
@@ -381,12 +436,10 @@ UniValue SearchLogs(const UniValue& _params, ChainstateManager &chainman)
 
                 UniValue tri(UniValue::VOBJ);
                 transactionReceiptInfoToJSON(receipt, tri);
-                result.push_back(tri);
+                push(tri);
             }
         }
     }
-
-    return result;
 }
 
 CallToken::CallToken(ChainstateManager &_chainman):
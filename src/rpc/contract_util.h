@@ -5,12 +5,19 @@
 #include <validation.h>
 #include <qtum/qtumtoken.h>
 
+#include <functional>
+
 class ChainstateManager;
 
 UniValue CallToContract(const UniValue& params, ChainstateManager &chainman);
 
+UniValue EstimateGasForContract(const UniValue& params, ChainstateManager &chainman);
+
 UniValue SearchLogs(const UniValue& params, ChainstateManager &chainman);
 
+/** Pass the matching receipts to push one by one instead of collecting them */
+void SearchLogs(const UniValue& params, ChainstateManager &chainman, const std::function<void(const UniValue&)>& push);
+
 void assignJSON(UniValue& entry, const TransactionReceiptInfo& resExec);
 
 void assignJSON(UniValue& logEntry, const dev::eth::LogEntry& log,
@@ -0,0 +1,113 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+
+#include <univalue.h>
+
+#include <cassert>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t flush_size) : m_sink(std::move(sink)), m_flush_size(flush_size)
+{
+    m_buf.reserve(m_flush_size);
+}
+
+void JSONStreamWriter::BeginValue()
+{
+    if (!m_objects.empty() && m_objects.back()) {
+        // The separator was written with the key
+        assert(m_after_key);
+        m_after_key = false;
+    } else if (m_has_element) {
+        assert(!m_objects.empty());
+        m_buf += ',';
+    }
+}
+
+void JSONStreamWriter::EndValue()
+{
+    m_has_element = true;
+    if (m_buf.size() >= m_flush_size) Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    BeginValue();
+    m_buf += '{';
+    m_objects.push_back(true);
+    m_has_element = false;
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!m_objects.empty() && m_objects.back() && !m_after_key);
+    m_objects.pop_back();
+    m_buf += '}';
+    EndValue();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    BeginValue();
+    m_buf += '[';
+    m_objects.push_back(false);
+    m_has_element = false;
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!m_objects.empty() && !m_objects.back());
+    m_objects.pop_back();
+    m_buf += ']';
+    EndValue();
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!m_objects.empty() && m_objects.back() && !m_after_key);
+    if (m_has_element) m_buf += ',';
+    m_buf += UniValue(key).write();
+    m_buf += ':';
+    m_has_element = true;
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Push(const UniValue& value)
+{
+    BeginValue();
+    m_buf += value.write();
+    EndValue();
+}
+
+void JSONStreamWriter::PushKV(const std::string& key, const UniValue& value)
+{
+    Key(key);
+    Push(value);
+}
+
+void JSONStreamWriter::PushKVs(const UniValue& obj)
+{
+    assert(obj.isObject());
+    const std::vector<std::string>& keys = obj.getKeys();
+    const std::vector<UniValue>& values = obj.getValues();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        PushKV(keys[i], values[i]);
+    }
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buf.empty()) return;
+    m_sink(m_buf);
+    m_flushed += m_buf.size();
+    m_buf.clear();
+}
+
+std::string JSONStreamWriter::TakeBuffered()
+{
+    std::string buf;
+    buf.swap(m_buf);
+    m_buf.reserve(m_flush_size);
+    return buf;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONSTREAM_H
+#define BITCOIN_RPC_JSONSTREAM_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Writes a JSON document element by element, without building it as a
+ * UniValue first.
+ *
+ * Output is buffered and handed to the sink whenever the buffer grows past
+ * flush_size, so large documents can be sent while they are written and
+ * only the element being written is held in memory.
+ */
+class JSONStreamWriter
+{
+public:
+    using Sink = std::function<void(const std::string& chunk)>;
+
+    static constexpr size_t DEFAULT_FLUSH_SIZE{64 << 10};
+
+    explicit JSONStreamWriter(Sink sink, size_t flush_size = DEFAULT_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Write the key of the next value of the current object. */
+    void Key(const std::string& key);
+    /** Write a value to the current array, after a key, or as the whole document. */
+    void Push(const UniValue& value);
+    void PushKV(const std::string& key, const UniValue& value);
+    /** Write every key and value of the object obj to the current object. */
+    void PushKVs(const UniValue& obj);
+
+    /** Hand the buffered output to the sink. */
+    void Flush();
+    /** Return the buffered output instead of handing it to the sink. */
+    std::string TakeBuffered();
+    /** The number of bytes handed to the sink so far. */
+    size_t Flushed() const { return m_flushed; }
+
+private:
+    /** Write the separator before a value and check it is allowed here. */
+    void BeginValue();
+    void EndValue();
+
+    const Sink m_sink;
+    const size_t m_flush_size;
+    std::string m_buf;
+    size_t m_flushed{0};
+    //! The open containers, true for objects
+    std::vector<bool> m_objects;
+    //! Whether the innermost open container has an element already
+    bool m_has_element{false};
+    bool m_after_key{false};
+};
+
+#endif // BITCOIN_RPC_JSONSTREAM_H
@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chain.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
@@ -12,6 +13,7 @@
 #include <interfaces/init.h>
 #include <interfaces/ipc.h>
 #include <key_io.h>
+#include <memusage.h>
 #include <node/context.h>
 #include <outputtype.h>
 #include <rpc/blockchain.h>
@@ -481,28 +483,11 @@ RPCHelpMan getaddressdeltas()
         }
     }
 
-    UniValue deltas(UniValue::VARR);
-
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        std::string address;
-        if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
-        }
-
-        UniValue delta(UniValue::VOBJ);
-        delta.pushKV("satoshis", it->second);
-        delta.pushKV("txid", it->first.txhash.GetHex());
-        delta.pushKV("index", (int)it->first.index);
-        delta.pushKV("blockindex", (int)it->first.txindex);
-        delta.pushKV("height", it->first.blockHeight);
-        delta.pushKV("address", address);
-        deltas.push_back(delta);
-    }
-
-    UniValue result(UniValue::VOBJ);
-
-    if (includeChainInfo && start > 0 && end > 0) {
-        ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    // Look up the chain info first, so its errors are replied as usual
+    const bool withChainInfo = includeChainInfo && start > 0 && end > 0;
+    UniValue startInfo(UniValue::VOBJ);
+    UniValue endInfo(UniValue::VOBJ);
+    if (withChainInfo) {
         LOCK(cs_main);
 
         CChain& active_chain = chainman.ActiveChain();
@@ -513,23 +498,41 @@ RPCHelpMan getaddressdeltas()
         CBlockIndex* startIndex = active_chain[start];
         CBlockIndex* endIndex = active_chain[end];
 
-        UniValue startInfo(UniValue::VOBJ);
-        UniValue endInfo(UniValue::VOBJ);
-
         startInfo.pushKV("hash", startIndex->GetBlockHash().GetHex());
         startInfo.pushKV("height", start);
 
         endInfo.pushKV("hash", endIndex->GetBlockHash().GetHex());
         endInfo.pushKV("height", end);
+    }
 
-        result.pushKV("deltas", deltas);
-        result.pushKV("start", startInfo);
-        result.pushKV("end", endInfo);
+    return StreamResult(request, [&](JSONStreamWriter& writer) {
+        if (withChainInfo) {
+            writer.BeginObject();
+            writer.Key("deltas");
+        }
+        writer.BeginArray();
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+            std::string address;
+            if (!getAddressFromIndex(it->first.type, it->first.hashBytes, address)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+            }
 
-        return result;
-    } else {
-        return deltas;
-    }
+            UniValue delta(UniValue::VOBJ);
+            delta.pushKV("satoshis", it->second);
+            delta.pushKV("txid", it->first.txhash.GetHex());
+            delta.pushKV("index", (int)it->first.index);
+            delta.pushKV("blockindex", (int)it->first.txindex);
+            delta.pushKV("height", it->first.blockHeight);
+            delta.pushKV("address", address);
+            writer.Push(delta);
+        }
+        writer.EndArray();
+        if (withChainInfo) {
+            writer.PushKV("start", startInfo);
+            writer.PushKV("end", endInfo);
+            writer.EndObject();
+        }
+    });
 },
     };
 }
@@ -1442,6 +1445,28 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCBlockIndexMemoryInfo(ChainstateManager& chainman)
+{
+    size_t entries;
+    size_t map_usage;
+    {
+        LOCK(cs_main);
+        entries = chainman.BlockIndex().size();
+        map_usage = memusage::DynamicUsage(chainman.BlockIndex());
+    }
+    const BlockSigArena::Stats sig_stats = chainman.m_blockman.m_sig_arena.GetStats();
+    const size_t entries_usage = entries * memusage::MallocUsage(sizeof(CBlockIndex));
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(entries));
+    obj.pushKV("entry_size", uint64_t(sizeof(CBlockIndex)));
+    obj.pushKV("entries_usage", uint64_t(entries_usage + map_usage));
+    obj.pushKV("signatures_used", uint64_t(sig_stats.used));
+    obj.pushKV("signatures_allocated", uint64_t(sig_stats.allocated));
+    obj.pushKV("total", uint64_t(entries_usage + map_usage + sig_stats.allocated));
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -1486,6 +1511,15 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "blockindex", /*optional=*/true, "Information about the in-memory block index",
+                            {
+                                {RPCResult::Type::NUM, "entries", "Number of block index entries"},
+                                {RPCResult::Type::NUM, "entry_size", "Size in bytes of one block index entry"},
+                                {RPCResult::Type::NUM, "entries_usage", "Number of bytes used by the block index entries and their lookup map"},
+                                {RPCResult::Type::NUM, "signatures_used", "Number of bytes used by block signatures"},
+                                {RPCResult::Type::NUM, "signatures_allocated", "Number of bytes allocated for block signatures"},
+                                {RPCResult::Type::NUM, "total", "Total number of bytes used by the block index"},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -1502,6 +1536,10 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        const NodeContext* node = util::AnyPtr<NodeContext>(request.context);
+        if (node && node->chainman) {
+            obj.pushKV("blockindex", RPCBlockIndexMemoryInfo(*node->chainman));
+        }
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -6,6 +6,7 @@
 
 #include <addrman.h>
 #include <banman.h>
+#include <blockencodings.h>
 #include <chainparams.h>
 #include <clientversion.h>
 #include <core_io.h>
@@ -530,6 +531,17 @@ static RPCHelpMan getnettotals()
                            {RPCResult::Type::NUM, "bytes_left_in_cycle", "Bytes left in current time cycle"},
                            {RPCResult::Type::NUM, "time_left_in_cycle", "Seconds left in current time cycle"},
                         }},
+                       {RPCResult::Type::OBJ, "compactblocks", "Reconstruction of blocks received as compact blocks",
+                       {
+                           {RPCResult::Type::NUM, "received", "Compact blocks accepted for reconstruction"},
+                           {RPCResult::Type::NUM, "reconstructed", "Blocks reconstructed without requesting transactions"},
+                           {RPCResult::Type::NUM, "reconstructed_after_request", "Blocks reconstructed after a getblocktxn round trip"},
+                           {RPCResult::Type::NUM, "failed", "Reconstructions that fell back to downloading the full block"},
+                           {RPCResult::Type::NUM, "txn_prefilled", "Transactions that were sent in full in the compact block"},
+                           {RPCResult::Type::NUM, "txn_from_mempool", "Transactions found in the mempool or extra transaction pool"},
+                           {RPCResult::Type::NUM, "txn_requested", "Transactions requested with getblocktxn"},
+                           {RPCResult::Type::NUM, "avg_reconstruct_time_us", "Average time in microseconds from receiving a compact block to having the full block"},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -554,6 +566,19 @@ static RPCHelpMan getnettotals()
     outboundLimit.pushKV("bytes_left_in_cycle", connman.GetOutboundTargetBytesLeft());
     outboundLimit.pushKV("time_left_in_cycle", count_seconds(connman.GetMaxOutboundTimeLeftInCycle()));
     obj.pushKV("uploadtarget", outboundLimit);
+
+    const CompactBlockStats& stats = GetCompactBlockStats();
+    const uint64_t reconstructed = stats.reconstructed + stats.reconstructed_after_request;
+    UniValue compact_blocks(UniValue::VOBJ);
+    compact_blocks.pushKV("received", stats.received.load());
+    compact_blocks.pushKV("reconstructed", stats.reconstructed.load());
+    compact_blocks.pushKV("reconstructed_after_request", stats.reconstructed_after_request.load());
+    compact_blocks.pushKV("failed", stats.failed.load());
+    compact_blocks.pushKV("txn_prefilled", stats.txn_prefilled.load());
+    compact_blocks.pushKV("txn_from_mempool", stats.txn_from_mempool.load());
+    compact_blocks.pushKV("txn_requested", stats.txn_requested.load());
+    compact_blocks.pushKV("avg_reconstruct_time_us", reconstructed ? stats.reconstruct_time_us / reconstructed : 0);
+    obj.pushKV("compactblocks", compact_blocks);
     return obj;
 },
     };
@@ -197,3 +197,13 @@ void JSONRPCRequest::PollPing() {}
 void JSONRPCRequest::PollCancel() {}
 
 void JSONRPCRequest::PollReply(const UniValue& result) {}
+
+bool JSONRPCRequest::CanStream() { return false; }
+
+void JSONRPCRequest::StreamChunk(const std::string& chunk) {}
+
+void JSONRPCRequest::StreamEnd(const std::string& chunk) {}
+
+void JSONRPCRequest::StreamAbort() {}
+
+bool JSONRPCRequest::StreamClosed() { return false; }
@@ -37,6 +37,8 @@ public:
     std::string peerAddr;
     std::any context;
     bool isLongPolling = false;
+    //! Set once part of the reply was sent with StreamChunk or StreamEnd
+    bool isStreaming = false;
     void *httpreq = nullptr;
 
     void parse(const UniValue& valRequest);
@@ -65,6 +67,31 @@ public:
      * Return the JSON result of a long poll request
      */
     virtual void PollReply(const UniValue& result);
+
+    /**
+     * Returns whether the reply can be sent in parts with StreamChunk and StreamEnd.
+     */
+    virtual bool CanStream();
+
+    /**
+     * Send the next part of the reply.
+     */
+    virtual void StreamChunk(const std::string& chunk);
+
+    /**
+     * Send the last part of the reply.
+     */
+    virtual void StreamEnd(const std::string& chunk);
+
+    /**
+     * Give up on a reply that was sent in part, so the client can tell it is incomplete.
+     */
+    virtual void StreamAbort();
+
+    /**
+     * Returns whether the client went away while the reply was sent in parts.
+     */
+    virtual bool StreamClosed();
 };
 
 #endif // BITCOIN_RPC_REQUEST_H
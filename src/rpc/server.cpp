@@ -220,6 +220,23 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::ARR, "work_queues", "The HTTP work queues",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::STR, "name", "default, or slow for the -rpcslowmethod calls"},
+                                {RPCResult::Type::NUM, "threads", "The number of workers"},
+                                {RPCResult::Type::NUM, "max_depth", "The maximum number of waiting requests"},
+                                {RPCResult::Type::NUM, "depth", "The number of waiting requests"},
+                                {RPCResult::Type::NUM, "active", "The number of requests being handled"},
+                                {RPCResult::Type::NUM, "processed", "The number of handled requests"},
+                                {RPCResult::Type::NUM, "rejected", "The number of requests rejected because the queue was full"},
+                                {RPCResult::Type::NUM, "avg_wait", "The average time handled requests waited for a worker, in microseconds"},
+                                {RPCResult::Type::NUM, "max_wait", "The longest time a request waited for a worker, in microseconds"},
+                                {RPCResult::Type::NUM, "avg_duration", "The average handling time, in microseconds"},
+                                {RPCResult::Type::NUM, "max_duration", "The longest handling time, in microseconds"},
+                            }},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -243,6 +260,25 @@ static RPCHelpMan getrpcinfo()
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
 
+    UniValue work_queues(UniValue::VARR);
+    for (const HTTPWorkQueueInfo& info : GetHTTPWorkQueueInfo()) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("name", info.name);
+        entry.pushKV("threads", info.threads);
+        entry.pushKV("max_depth", (uint64_t)info.max_depth);
+        entry.pushKV("depth", (uint64_t)info.depth);
+        entry.pushKV("active", (uint64_t)info.active);
+        entry.pushKV("processed", info.processed);
+        entry.pushKV("rejected", info.rejected);
+        const uint64_t started = info.processed + info.active;
+        entry.pushKV("avg_wait", started ? info.total_wait.count() / (int64_t)started : 0);
+        entry.pushKV("max_wait", info.max_wait.count());
+        entry.pushKV("avg_duration", info.processed ? info.total_run.count() / (int64_t)info.processed : 0);
+        entry.pushKV("max_duration", info.max_run.count());
+        work_queues.push_back(entry);
+    }
+    result.pushKV("work_queues", work_queues);
+
     return result;
 }
     };
@@ -383,6 +419,38 @@ void JSONRPCRequestLong::PollReply(const UniValue& result) {
     req()->ChunkEnd();
 }
 
+bool JSONRPCRequestLong::CanStream() {
+    return httpreq && !isLongPolling;
+}
+
+void JSONRPCRequestLong::StreamChunk(const std::string& chunk) {
+    if (!isStreaming) {
+        req()->WriteHeader("Content-Type", "application/json");
+        isStreaming = true;
+    }
+    req()->StreamChunk(chunk);
+}
+
+void JSONRPCRequestLong::StreamEnd(const std::string& chunk) {
+    if (!isStreaming) {
+        // Small replies fit the writer's buffer and are sent as usual
+        req()->WriteHeader("Content-Type", "application/json");
+        req()->WriteReply(HTTP_OK, chunk);
+        isStreaming = true;
+        return;
+    }
+    req()->StreamChunk(chunk);
+    req()->StreamEnd();
+}
+
+void JSONRPCRequestLong::StreamAbort() {
+    req()->StreamAbort();
+}
+
+bool JSONRPCRequestLong::StreamClosed() {
+    return isStreaming && req()->StreamClosed();
+}
+
 HTTPRequest* JSONRPCRequestLong::req() {
     return (HTTPRequest*)httpreq;
 }
@@ -63,6 +63,31 @@ public:
      */
     void PollReply(const UniValue& result) override;
 
+    /**
+     * Returns whether the reply can be sent in chunks, which it can unless long-polling.
+     */
+    bool CanStream() override;
+
+    /**
+     * Send the next part of the reply as a chunk.
+     */
+    void StreamChunk(const std::string& chunk) override;
+
+    /**
+     * Send the last part of the reply, as the whole reply if nothing was sent yet.
+     */
+    void StreamEnd(const std::string& chunk) override;
+
+    /**
+     * Close the connection without ending the chunked reply.
+     */
+    void StreamAbort() override;
+
+    /**
+     * Returns whether the client closed the connection of the chunked reply.
+     */
+    bool StreamClosed() override;
+
     /**
      * Return the http request
      */
@@ -4,6 +4,7 @@
 
 #include <consensus/amount.h>
 #include <key_io.h>
+#include <logging.h>
 #include <outputtype.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
@@ -594,6 +595,8 @@ UniValue RPCHelpMan::HandleRequest(const JSONRPCRequest& request) const
         throw std::runtime_error(ToString());
     }
     const UniValue ret = m_fun(*this, request);
+    // A streamed result was sent already and is returned as null
+    if (request.isStreaming) return ret;
     CHECK_NONFATAL(std::any_of(m_results.m_results.begin(), m_results.m_results.end(), [&ret](const RPCResult& res) { return res.MatchesType(ret); }));
     return ret;
 }
@@ -1070,3 +1073,46 @@ UniValue GetServicesNames(ServiceFlags services)
 
     return servicesNames;
 }
+
+UniValue StreamResult(const JSONRPCRequest& request_, const std::function<void(JSONStreamWriter&)>& write)
+{
+    // The reply is sent by the request. force cast to non const like the long poll functions
+    JSONRPCRequest& request = (JSONRPCRequest&) request_;
+    if (!request.CanStream()) {
+        std::string json;
+        JSONStreamWriter writer([&json](const std::string& chunk) { json += chunk; });
+        write(writer);
+        writer.Flush();
+        UniValue result;
+        CHECK_NONFATAL(result.read(json));
+        return result;
+    }
+
+    JSONStreamWriter writer([&request](const std::string& chunk) {
+        // Stop writing a reply nobody is reading any more
+        if (request.StreamClosed()) throw std::runtime_error("client closed the connection");
+        request.StreamChunk(chunk);
+    });
+    try {
+        writer.BeginObject();
+        writer.Key("result");
+        write(writer);
+        writer.PushKV("error", NullUniValue);
+        writer.PushKV("id", request.id);
+        writer.EndObject();
+    } catch (...) {
+        // Before anything is sent the error is replied as usual
+        if (!request.isStreaming) throw;
+        // The JSON sent so far can't be completed, so leave the reply
+        // unterminated instead of ending it as if it were whole
+        if (request.StreamClosed()) {
+            LogPrint(BCLog::RPC, "%s: client of %s closed the connection\n", __func__, request.strMethod);
+        } else {
+            LogPrintf("%s: %s failed after part of its reply was sent\n", __func__, request.strMethod);
+        }
+        request.StreamAbort();
+        return NullUniValue;
+    }
+    request.StreamEnd(writer.TakeBuffered() + "\n");
+    return NullUniValue;
+}
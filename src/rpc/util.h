@@ -10,6 +10,7 @@
 #include <outputtype.h>
 #include <protocol.h>
 #include <pubkey.h>
+#include <rpc/jsonstream.h>
 #include <rpc/protocol.h>
 #include <rpc/request.h>
 #include <script/script.h>
@@ -134,6 +135,13 @@ std::vector<CScript> EvalDescriptorStringOrObject(const UniValue& scanobject, Fl
 /** Returns, given services flags, a list of humanly readable (known) network services */
 UniValue GetServicesNames(ServiceFlags services);
 
+/**
+ * Write the result of request with write. If the server can send the reply
+ * in parts, the reply is sent while it is written and null is returned.
+ * Otherwise the written result is returned.
+ */
+UniValue StreamResult(const JSONRPCRequest& request, const std::function<void(JSONStreamWriter&)>& write);
+
 /**
  * Serializing JSON objects depends on the outer type. Only arrays and
  * dictionaries can be nested in json. The top-level outer type is "NONE".
@@ -7,6 +7,7 @@
 #include <stdlib.h>
 
 #include <chain.h>
+#include <pubkey.h>
 #include <rpc/blockchain.h>
 #include <test/util/setup_common.h>
 #include <util/string.h>
@@ -74,4 +75,48 @@ BOOST_AUTO_TEST_CASE(get_difficulty_for_very_high_target)
     TestDifficulty(0x12345678, 5913134931067755359633408.0);
 }
 
+BOOST_AUTO_TEST_CASE(block_index_signature_roundtrip)
+{
+    CBlockHeader header;
+    header.nTime = 1269211443;
+    header.prevoutStake = COutPoint(uint256::ONE, 1);
+    header.vchBlockSigDlgt.assign(2 * CPubKey::COMPACT_SIGNATURE_SIZE, 0x5a);
+    header.vchBlockSigDlgt.back() = 0x01;
+
+    BlockSigArena arena;
+    CBlockIndex index(header);
+    BOOST_CHECK(index.GetBlockSigDlgt().empty());
+    index.SetBlockSigDlgt(header.vchBlockSigDlgt, arena);
+    BOOST_CHECK_EQUAL(arena.GetStats().entries, 1U);
+    BOOST_CHECK_EQUAL(arena.GetStats().used, header.vchBlockSigDlgt.size());
+
+    BOOST_CHECK(index.HasProofOfDelegation());
+    BOOST_CHECK(index.GetBlockHeader().vchBlockSigDlgt == header.vchBlockSigDlgt);
+    BOOST_CHECK(index.GetProofOfDelegation() == header.GetProofOfDelegation());
+    BOOST_CHECK(index.GetBlockSignature() == header.GetBlockSignature());
+
+    // The disk representation carries its own copy of the signature
+    CDiskBlockIndex disk_index(&index);
+    BOOST_CHECK(disk_index.vchBlockSigDlgt == header.vchBlockSigDlgt);
+
+    // Empty signatures (proof-of-work blocks) do not touch the arena
+    CBlockIndex pow_index(CBlockHeader{});
+    pow_index.SetBlockSigDlgt(CBlockHeader{}.vchBlockSigDlgt, arena);
+    BOOST_CHECK(pow_index.GetBlockSigDlgt().empty());
+    BOOST_CHECK_EQUAL(arena.GetStats().entries, 1U);
+
+    // Temporary entries reference the header's bytes instead
+    CBlockIndex temp_index(header);
+    temp_index.RefBlockSigDlgt(header.vchBlockSigDlgt);
+    BOOST_CHECK(temp_index.GetBlockSigDlgt().data() == header.vchBlockSigDlgt.data());
+    BOOST_CHECK(temp_index.GetProofOfDelegation() == header.GetProofOfDelegation());
+    BOOST_CHECK_EQUAL(arena.GetStats().entries, 1U);
+
+    arena.Clear();
+    const BlockSigArena::Stats cleared = arena.GetStats();
+    BOOST_CHECK_EQUAL(cleared.entries, 0U);
+    BOOST_CHECK_EQUAL(cleared.allocated, 0U);
+    BOOST_CHECK_EQUAL(cleared.chunks, 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
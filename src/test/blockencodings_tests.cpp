@@ -300,6 +300,44 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(CoinstakePrefilledRoundTripTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    CBlock block(BuildBlockTestCase());
+
+    // Turn the second transaction into a coinstake, which no peer can have in its mempool
+    CMutableTransaction coinstake(*block.vtx[1]);
+    coinstake.vout.resize(2);
+    coinstake.vout[0].SetEmpty();
+    coinstake.vout[1].nValue = 42;
+    block.vtx[1] = MakeTransactionRef(coinstake);
+    BOOST_REQUIRE(block.vtx[1]->IsCoinStake());
+
+    LOCK2(cs_main, pool.cs);
+    pool.addUnchecked(entry.FromTx(block.vtx[2]));
+
+    TestHeaderAndShortIDs shortIDs(block);
+    BOOST_REQUIRE_EQUAL(shortIDs.prefilledtxn.size(), 2U);
+    BOOST_CHECK_EQUAL(shortIDs.prefilledtxn[0].index, 0);
+    BOOST_CHECK_EQUAL(shortIDs.prefilledtxn[1].index, 0);
+    BOOST_CHECK_EQUAL(shortIDs.shorttxids.size(), 1U);
+
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << shortIDs;
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    const uint64_t received = GetCompactBlockStats().received;
+    PartiallyDownloadedBlock partialBlock(&pool, m_node.chainman.get());
+    BOOST_CHECK(partialBlock.InitData(shortIDs2, extra_txn) == READ_STATUS_OK);
+    // Nothing needs to be requested from the peer
+    BOOST_CHECK(partialBlock.IsTxAvailable(0));
+    BOOST_CHECK(partialBlock.IsTxAvailable(1));
+    BOOST_CHECK(partialBlock.IsTxAvailable(2));
+    BOOST_CHECK_EQUAL(GetCompactBlockStats().received, received + 1);
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
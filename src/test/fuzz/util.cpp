@@ -73,6 +73,13 @@ ssize_t FuzzedSock::Send(const void* data, size_t len, int flags) const
     return r;
 }
 
+ssize_t FuzzedSock::SendMany(Span<const Span<const unsigned char>> bufs, int flags) const
+{
+    // Only the first buffer, as on platforms without scatter/gather.
+    if (bufs.empty()) return 0;
+    return Send(bufs[0].data(), bufs[0].size(), flags);
+}
+
 ssize_t FuzzedSock::Recv(void* buf, size_t len, int flags) const
 {
     // Have a permanent error at recv_errnos[0] because when the fuzzed data is exhausted
@@ -0,0 +1,128 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonstream.h>
+#include <rpc/util.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+BOOST_FIXTURE_TEST_SUITE(jsonstream_tests, BasicTestingSetup)
+
+static UniValue Document()
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("text", "quote \" and\nnewline");
+    inner.pushKV("amount", UniValue(UniValue::VNUM, "0.10000000"));
+    inner.pushKV("empty", UniValue(UniValue::VARR));
+    UniValue items(UniValue::VARR);
+    items.push_back(inner);
+    items.push_back(NullUniValue);
+    items.push_back(true);
+    UniValue doc(UniValue::VOBJ);
+    doc.pushKV("height", 42);
+    doc.pushKV("items", items);
+    doc.pushKV("none", UniValue(UniValue::VOBJ));
+    return doc;
+}
+
+/** Write the document element by element */
+static void WriteDocument(JSONStreamWriter& writer)
+{
+    const UniValue doc = Document();
+    writer.BeginObject();
+    writer.PushKV("height", doc["height"]);
+    writer.Key("items");
+    writer.BeginArray();
+    writer.BeginObject();
+    writer.PushKVs(doc["items"][0]);
+    writer.EndObject();
+    writer.Push(NullUniValue);
+    writer.Push(true);
+    writer.EndArray();
+    writer.Key("none");
+    writer.BeginObject();
+    writer.EndObject();
+    writer.EndObject();
+}
+
+BOOST_AUTO_TEST_CASE(writer)
+{
+    for (size_t flush_size : {size_t{1}, size_t{16}, JSONStreamWriter::DEFAULT_FLUSH_SIZE}) {
+        std::string json;
+        size_t chunks{0};
+        JSONStreamWriter writer([&](const std::string& chunk) {
+            json += chunk;
+            ++chunks;
+        }, flush_size);
+        WriteDocument(writer);
+        const std::string rest = writer.TakeBuffered();
+        BOOST_CHECK_EQUAL(writer.Flushed(), json.size());
+        BOOST_CHECK_EQUAL(json + rest, Document().write());
+        if (flush_size == 1) BOOST_CHECK_GT(chunks, 5U);
+        if (flush_size == JSONStreamWriter::DEFAULT_FLUSH_SIZE) BOOST_CHECK_EQUAL(chunks, 0U);
+    }
+}
+
+/** A request that collects its streamed reply */
+class StreamingRequest : public JSONRPCRequest
+{
+public:
+    std::vector<std::string> chunks;
+    bool ended{false};
+    bool aborted{false};
+
+    bool CanStream() override { return true; }
+    void StreamChunk(const std::string& chunk) override
+    {
+        isStreaming = true;
+        chunks.push_back(chunk);
+    }
+    void StreamEnd(const std::string& chunk) override
+    {
+        isStreaming = true;
+        chunks.push_back(chunk);
+        ended = true;
+    }
+    void StreamAbort() override { aborted = true; }
+};
+
+BOOST_AUTO_TEST_CASE(stream_result)
+{
+    // Without streaming the written result is returned
+    JSONRPCRequest request;
+    BOOST_CHECK_EQUAL(StreamResult(request, WriteDocument).write(), Document().write());
+    BOOST_CHECK(!request.isStreaming);
+
+    // With streaming the reply is sent, and null returned
+    StreamingRequest streaming;
+    streaming.id = 7;
+    BOOST_CHECK(StreamResult(streaming, WriteDocument).isNull());
+    BOOST_CHECK(streaming.ended);
+    BOOST_REQUIRE_EQUAL(streaming.chunks.size(), 1U);
+    BOOST_CHECK_EQUAL(streaming.chunks[0], JSONRPCReply(Document(), NullUniValue, 7));
+
+    // Errors before anything is sent are thrown
+    StreamingRequest failing;
+    BOOST_CHECK_THROW(StreamResult(failing, [](JSONStreamWriter& writer) {
+        writer.BeginArray();
+        throw JSONRPCError(RPC_MISC_ERROR, "failed");
+    }), UniValue);
+    BOOST_CHECK(!failing.isStreaming);
+
+    // Errors after part of the reply was sent abort it, rather than end it truncated
+    StreamingRequest truncated;
+    BOOST_CHECK(StreamResult(truncated, [](JSONStreamWriter& writer) {
+        writer.BeginArray();
+        writer.Push(std::string(JSONStreamWriter::DEFAULT_FLUSH_SIZE, 'a'));
+        throw JSONRPCError(RPC_MISC_ERROR, "failed");
+    }).isNull());
+    BOOST_CHECK(truncated.aborted);
+    BOOST_CHECK(!truncated.ended);
+    BOOST_CHECK_EQUAL(truncated.chunks.size(), 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
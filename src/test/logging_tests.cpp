@@ -7,6 +7,9 @@
 #include <test/util/setup_common.h>
 
 #include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -30,4 +33,106 @@ BOOST_AUTO_TEST_CASE(logging_timer)
     BOOST_CHECK_EQUAL(sec_timer.LogMsg("test secs"), "tests: test secs (1.00s)");
 }
 
+static std::vector<std::string> ReadLines(const fs::path& path)
+{
+    std::ifstream file{path};
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line);) {
+        if (!line.empty()) lines.push_back(line);
+    }
+    return lines;
+}
+
+BOOST_AUTO_TEST_CASE(logging_async_writer)
+{
+    BCLog::Logger logger;
+    logger.m_print_to_file = true;
+    logger.m_file_path = m_args.GetDataDirBase() / "async.log";
+    logger.m_file_pathVM = m_args.GetDataDirBase() / "async_vm.log";
+    logger.m_log_timestamps = false;
+    logger.m_log_async = true;
+    logger.m_rate_limit = 0;
+    BOOST_REQUIRE(logger.StartLogging());
+
+    for (int i = 0; i < 1000; ++i) {
+        logger.LogPrintStr(strprintf("line %d\n", i), __func__, __FILE__, __LINE__, false, BCLog::NET);
+        if (i % 100 == 0) logger.LogPrintStr(strprintf("vm %d\n", i), __func__, __FILE__, __LINE__, /*useVMLog=*/true);
+    }
+    // Flushed messages are in the files while the writer keeps running
+    logger.Flush();
+    BOOST_CHECK_EQUAL(ReadLines(logger.m_file_path).size(), 1000U);
+
+    // Uncategorized messages are written right away, after the queued ones
+    logger.LogPrintStr("queued\n", __func__, __FILE__, __LINE__, false, BCLog::NET);
+    logger.LogPrintStr("last\n", __func__, __FILE__, __LINE__);
+    std::vector<std::string> lines = ReadLines(logger.m_file_path);
+    BOOST_REQUIRE_EQUAL(lines.size(), 1002U);
+    BOOST_CHECK_EQUAL(lines[1000], "queued");
+    BOOST_CHECK_EQUAL(lines[1001], "last");
+    logger.StopLogging();
+
+    // The messages are written in logging order
+    lines = ReadLines(logger.m_file_path);
+    BOOST_REQUIRE_EQUAL(lines.size(), 1002U);
+    for (int i = 0; i < 1000; ++i) {
+        BOOST_CHECK_EQUAL(lines[i], strprintf("line %d", i));
+    }
+    BOOST_CHECK_EQUAL(lines.back(), "last");
+    BOOST_CHECK_EQUAL(ReadLines(logger.m_file_pathVM).size(), 10U);
+    BOOST_CHECK_EQUAL(logger.GetDroppedMessages(), 0U);
+
+    // Messages after the writer stopped are written directly
+    logger.LogPrintStr("after stop\n", __func__, __FILE__, __LINE__);
+    BOOST_CHECK_EQUAL(ReadLines(logger.m_file_path).back(), "after stop");
+    logger.DisconnectTestLogger();
+}
+
+BOOST_AUTO_TEST_CASE(logging_queue_limit)
+{
+    BCLog::Logger logger;
+    logger.m_log_timestamps = false;
+    logger.m_log_async = true;
+    // A queue that fits no message drops all debug messages
+    logger.m_max_queue_bytes = 0;
+    BOOST_REQUIRE(logger.StartLogging());
+    for (int i = 0; i < 10; ++i) {
+        logger.LogPrintStr("dropped\n", __func__, __FILE__, __LINE__, false, BCLog::NET);
+    }
+    logger.LogPrintStr("dropped vm\n", __func__, __FILE__, __LINE__, /*useVMLog=*/true);
+    BOOST_CHECK_EQUAL(logger.GetDroppedMessages(), 11U);
+
+    // but still writes the uncategorized ones
+    std::vector<std::string> printed;
+    logger.PushBackCallback([&](const std::string& s) { printed.push_back(s); });
+    logger.LogPrintStr("written\n", __func__, __FILE__, __LINE__);
+    BOOST_REQUIRE_EQUAL(printed.size(), 1U);
+    BOOST_CHECK_EQUAL(printed[0], "Dropped 11 log messages because the log writer fell behind\nwritten\n");
+    BOOST_CHECK_EQUAL(logger.GetDroppedMessages(), 11U);
+    logger.DisconnectTestLogger();
+}
+
+BOOST_AUTO_TEST_CASE(logging_rate_limit)
+{
+    BCLog::Logger logger;
+    logger.m_log_timestamps = false;
+    logger.m_log_async = false;
+    logger.m_rate_limit = 5;
+    BOOST_REQUIRE(logger.StartLogging());
+    size_t net{0};
+    size_t other{0};
+    logger.PushBackCallback([&](const std::string& s) {
+        if (s == "net\n") ++net;
+        if (s == "other\n") ++other;
+    });
+    for (int i = 0; i < 100; ++i) {
+        logger.LogPrintStr("net\n", __func__, __FILE__, __LINE__, false, BCLog::NET);
+        logger.LogPrintStr("other\n", __func__, __FILE__, __LINE__);
+    }
+    // Each category has its own limit per second, uncategorized messages have none
+    BOOST_CHECK_GE(net, 5U);
+    BOOST_CHECK_LT(net, 100U);
+    BOOST_CHECK_EQUAL(other, 100U);
+    logger.DisconnectTestLogger();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
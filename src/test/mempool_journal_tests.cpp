@@ -0,0 +1,152 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <node/mempool_journal.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <validationinterface.h>
+
+#include <boost/test/unit_test.hpp>
+
+using node::MempoolJournal;
+using node::MempoolJournalReplay;
+using node::ReadMempoolJournal;
+
+BOOST_FIXTURE_TEST_SUITE(mempool_journal_tests, TestingSetup)
+
+static CTransactionRef MakeTx(uint32_t n)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint(uint256::ONE, n);
+    mtx.vout.resize(1);
+    mtx.vout[0].nValue = n;
+    return MakeTransactionRef(mtx);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_journal_replay)
+{
+    const fs::path path = m_args.GetDataDirNet() / "mempool.journal.test";
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    pool.SetIsLoaded(true);
+
+    const CTransactionRef tx_kept = MakeTx(1);
+    const CTransactionRef tx_removed = MakeTx(2);
+    const CTransactionRef tx_mined = MakeTx(3);
+    const CTransactionRef tx_readded = MakeTx(4);
+
+    {
+        MempoolJournal journal(pool, path);
+        BOOST_REQUIRE(journal.Open());
+        RegisterValidationInterface(&journal);
+
+        // Nothing is recorded while the mempool is being loaded.
+        GetMainSignals().TransactionAddedToMempool(tx_removed, 0);
+        journal.StartRecording();
+        const uint64_t header_size = journal.Size();
+
+        GetMainSignals().TransactionAddedToMempool(tx_kept, 0);
+        GetMainSignals().TransactionAddedToMempool(tx_readded, 0);
+        GetMainSignals().TransactionAddedToMempool(tx_removed, 0);
+        GetMainSignals().TransactionAddedToMempool(tx_mined, 0);
+        GetMainSignals().TransactionRemovedFromMempool(tx_removed, MemPoolRemovalReason::EXPIRY, 0);
+        GetMainSignals().TransactionRemovedFromMempool(tx_readded, MemPoolRemovalReason::REORG, 0);
+        GetMainSignals().TransactionAddedToMempool(tx_readded, 0);
+
+        auto block = std::make_shared<CBlock>();
+        block->vtx.push_back(tx_mined);
+        CBlockIndex index;
+        GetMainSignals().BlockConnected(block, &index);
+
+        SyncWithValidationInterfaceQueue();
+        BOOST_CHECK_GT(journal.Size(), header_size);
+        pool.PrioritiseTransaction(tx_kept->GetHash(), 1000);
+        BOOST_CHECK(journal.Commit());
+        UnregisterValidationInterface(&journal);
+    }
+
+    MempoolJournalReplay replay;
+    BOOST_REQUIRE(ReadMempoolJournal(path, replay));
+
+    BOOST_REQUIRE_EQUAL(replay.added.size(), 2U);
+    BOOST_CHECK(replay.added[0].tx->GetHash() == tx_kept->GetHash());
+    BOOST_CHECK(replay.added[1].tx->GetHash() == tx_readded->GetHash());
+    BOOST_CHECK(replay.IsPending(tx_kept->GetHash()));
+    BOOST_CHECK(!replay.IsPending(tx_removed->GetHash()));
+
+    BOOST_CHECK_EQUAL(replay.removed.size(), 2U);
+    BOOST_CHECK(replay.removed.count(tx_removed->GetHash()));
+    BOOST_CHECK(replay.removed.count(tx_mined->GetHash()));
+
+    BOOST_REQUIRE(replay.deltas);
+    BOOST_CHECK_EQUAL(replay.deltas->at(tx_kept->GetHash()), 1000);
+
+    // Transactions that mempool.dat already covered are not replayed again.
+    BOOST_CHECK(replay.Consume(tx_kept->GetHash()));
+    BOOST_CHECK(!replay.Consume(tx_kept->GetHash()));
+    BOOST_CHECK(!replay.IsPending(tx_kept->GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(mempool_journal_truncated)
+{
+    const fs::path path = m_args.GetDataDirNet() / "mempool.journal.test";
+    CTxMemPool& pool = *Assert(m_node.mempool);
+
+    {
+        MempoolJournal journal(pool, path);
+        BOOST_REQUIRE(journal.Open());
+        RegisterValidationInterface(&journal);
+        journal.StartRecording();
+        GetMainSignals().TransactionAddedToMempool(MakeTx(1), 0);
+        GetMainSignals().TransactionAddedToMempool(MakeTx(2), 0);
+        SyncWithValidationInterfaceQueue();
+        UnregisterValidationInterface(&journal);
+    }
+
+    // Cut the last record short, as an unclean shutdown might.
+    fs::resize_file(path, fs::file_size(path) - 3);
+
+    MempoolJournalReplay replay;
+    BOOST_REQUIRE(ReadMempoolJournal(path, replay));
+    BOOST_REQUIRE_EQUAL(replay.added.size(), 1U);
+    BOOST_CHECK(replay.added[0].tx->GetHash() == MakeTx(1)->GetHash());
+    BOOST_CHECK(!replay.deltas);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_journal_compact)
+{
+    const fs::path path = m_args.GetDataDirNet() / "mempool.journal.test";
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    pool.SetIsLoaded(true);
+
+    MempoolJournal journal(pool, path);
+    BOOST_REQUIRE(journal.Open());
+    RegisterValidationInterface(&journal);
+    journal.StartRecording();
+    const uint64_t header_size = journal.Size();
+
+    GetMainSignals().TransactionAddedToMempool(MakeTx(1), 0);
+    SyncWithValidationInterfaceQueue();
+    BOOST_CHECK(!journal.Compact());
+    BOOST_CHECK_GT(journal.Size(), header_size);
+
+    // mempool.dat now covers everything, so the journal starts over.
+    BOOST_CHECK(journal.Compact(/*force=*/true));
+    BOOST_CHECK_EQUAL(journal.Size(), header_size);
+    BOOST_CHECK_EQUAL(fs::file_size(path), header_size);
+
+    GetMainSignals().TransactionAddedToMempool(MakeTx(2), 0);
+    SyncWithValidationInterfaceQueue();
+    UnregisterValidationInterface(&journal);
+
+    MempoolJournalReplay replay;
+    BOOST_REQUIRE(ReadMempoolJournal(path, replay));
+    BOOST_REQUIRE_EQUAL(replay.added.size(), 1U);
+    BOOST_CHECK(replay.added[0].tx->GetHash() == MakeTx(2)->GetHash());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -786,4 +786,79 @@ BOOST_AUTO_TEST_CASE(MempoolAncestryTests)
     BOOST_CHECK_EQUAL(descendants, 4ULL);
 }
 
+BOOST_AUTO_TEST_CASE(MempoolClusterTests)
+{
+    CTxMemPool pool;
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    // [tx1] <- [tx2]
+    //      \-- [tx3]
+    // [tx4]
+    CTransactionRef tx1 = make_tx(/*output_values=*/{10 * COIN, 10 * COIN});
+    CTransactionRef tx2 = make_tx(/*output_values=*/{10 * COIN}, /*inputs=*/{tx1}, /*input_indices=*/{0});
+    CTransactionRef tx3 = make_tx(/*output_values=*/{10 * COIN}, /*inputs=*/{tx1}, /*input_indices=*/{1});
+    CTransactionRef tx4 = make_tx(/*output_values=*/{10 * COIN});
+    pool.addUnchecked(entry.Fee(100LL).FromTx(tx1));
+    pool.addUnchecked(entry.Fee(100000LL).FromTx(tx2));
+    pool.addUnchecked(entry.Fee(0LL).FromTx(tx3));
+    pool.addUnchecked(entry.Fee(10000LL).FromTx(tx4));
+
+    std::vector<CTxMemPool::txiter> cluster;
+    pool.CalculateCluster(*pool.GetIter(tx3->GetHash()), cluster);
+    BOOST_CHECK_EQUAL(cluster.size(), 3U);
+    pool.CalculateCluster(*pool.GetIter(tx4->GetHash()), cluster);
+    BOOST_CHECK_EQUAL(cluster.size(), 1U);
+
+    // The high fee child pays for its parent, the zero fee child is left on its own
+    pool.CalculateCluster(*pool.GetIter(tx1->GetHash()), cluster);
+    std::vector<CTxMemPool::ClusterChunk> chunks = pool.LinearizeCluster(cluster);
+    BOOST_REQUIRE_EQUAL(chunks.size(), 2U);
+    BOOST_REQUIRE_EQUAL(chunks[0].txs.size(), 2U);
+    BOOST_CHECK(chunks[0].txs[0]->GetTx().GetHash() == tx1->GetHash());
+    BOOST_CHECK(chunks[0].txs[1]->GetTx().GetHash() == tx2->GetHash());
+    BOOST_CHECK_EQUAL(chunks[0].fee, 100100);
+    BOOST_REQUIRE_EQUAL(chunks[1].txs.size(), 1U);
+    BOOST_CHECK(chunks[1].txs[0]->GetTx().GetHash() == tx3->GetHash());
+
+    // Linearizations are only kept in cluster mode
+    BOOST_CHECK(pool.GetLinearizedClusters().empty());
+    pool.SetClusterMode(true);
+    BOOST_CHECK_EQUAL(pool.GetLinearizedClusters().size(), 2U);
+    const uint64_t cluster1 = pool.GetIter(tx1->GetHash()).value()->m_cluster_id;
+    const uint64_t cluster4 = pool.GetIter(tx4->GetHash()).value()->m_cluster_id;
+    BOOST_CHECK(cluster1 != 0 && cluster4 != 0 && cluster1 != cluster4);
+    BOOST_CHECK_EQUAL(pool.GetIter(tx3->GetHash()).value()->m_cluster_id, cluster1);
+
+    // A new child drops only the linearization of its parent's cluster
+    CTransactionRef tx5 = make_tx(/*output_values=*/{10 * COIN}, /*inputs=*/{tx4}, /*input_indices=*/{0});
+    pool.addUnchecked(entry.Fee(50000LL).FromTx(tx5));
+    BOOST_CHECK_EQUAL(pool.GetIter(tx4->GetHash()).value()->m_cluster_id, 0U);
+    BOOST_CHECK_EQUAL(pool.GetIter(tx1->GetHash()).value()->m_cluster_id, cluster1);
+    const std::vector<const std::vector<CTxMemPool::ClusterChunk>*> clusters = pool.GetLinearizedClusters();
+    BOOST_CHECK_EQUAL(clusters.size(), 2U);
+    BOOST_CHECK_EQUAL(pool.GetIter(tx1->GetHash()).value()->m_cluster_id, cluster1);
+    const uint64_t cluster5 = pool.GetIter(tx5->GetHash()).value()->m_cluster_id;
+    BOOST_CHECK(cluster5 != 0 && cluster5 != cluster4);
+    BOOST_CHECK_EQUAL(pool.GetIter(tx4->GetHash()).value()->m_cluster_id, cluster5);
+    // The child pays for its parent
+    for (const auto* chunks : clusters) {
+        if (chunks->front().txs.front()->GetTx().GetHash() != tx4->GetHash()) continue;
+        BOOST_REQUIRE_EQUAL(chunks->size(), 1U);
+        BOOST_CHECK_EQUAL(chunks->front().fee, 60000);
+    }
+
+    // Removing the child drops the cluster again
+    pool.removeRecursive(*tx5, MemPoolRemovalReason::CONFLICT);
+    BOOST_CHECK_EQUAL(pool.GetIter(tx4->GetHash()).value()->m_cluster_id, 0U);
+    BOOST_CHECK_EQUAL(pool.GetLinearizedClusters().size(), 2U);
+
+    // Cluster mode evicts only the lowest feerate chunk
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(pool.exists(GenTxid::Txid(tx1->GetHash())));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(tx2->GetHash())));
+    BOOST_CHECK(!pool.exists(GenTxid::Txid(tx3->GetHash())));
+    BOOST_CHECK(pool.exists(GenTxid::Txid(tx4->GetHash())));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
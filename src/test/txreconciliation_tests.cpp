@@ -0,0 +1,165 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/txreconciliation.h>
+
+#include <test/util/setup_common.h>
+
+#include <algorithm>
+#include <set>
+
+#include <boost/test/unit_test.hpp>
+
+using node::ReconciliationRegisterResult;
+using node::ReconciliationResult;
+using node::TxReconciliationTracker;
+
+BOOST_FIXTURE_TEST_SUITE(txreconciliation_tests, BasicTestingSetup)
+
+namespace {
+constexpr NodeId PEER{0};
+
+/** Connect two trackers: initiator opened the connection to responder. */
+void Connect(TxReconciliationTracker& initiator, TxReconciliationTracker& responder)
+{
+    const uint64_t initiator_salt = initiator.PreRegisterPeer(PEER);
+    const uint64_t responder_salt = responder.PreRegisterPeer(PEER);
+    BOOST_REQUIRE(initiator.RegisterPeer(PEER, /*is_peer_inbound=*/false, 1, responder_salt) == ReconciliationRegisterResult::SUCCESS);
+    BOOST_REQUIRE(responder.RegisterPeer(PEER, /*is_peer_inbound=*/true, 1, initiator_salt) == ReconciliationRegisterResult::SUCCESS);
+}
+
+/** Run one reconciliation round at the next scheduled time and return the results of both sides. */
+std::pair<ReconciliationResult, ReconciliationResult> Reconcile(TxReconciliationTracker& initiator, TxReconciliationTracker& responder,
+                                                                std::chrono::microseconds& now)
+{
+    // Nothing happens before the round is due.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(PEER, now));
+    now += node::RECON_REQUEST_INTERVAL;
+    const auto request = initiator.InitiateReconciliationRequest(PEER, now);
+    BOOST_REQUIRE(request);
+    // Only one round at a time.
+    BOOST_CHECK(!initiator.InitiateReconciliationRequest(PEER, now + node::RECON_REQUEST_INTERVAL));
+
+    BOOST_REQUIRE(responder.HandleReconciliationRequest(PEER, request->first, request->second));
+    const auto sketch = responder.RespondToReconciliationRequest(PEER);
+    BOOST_REQUIRE(sketch);
+
+    ReconciliationResult initiator_result, responder_result;
+    BOOST_REQUIRE(initiator.HandleSketch(PEER, *sketch, initiator_result));
+    BOOST_REQUIRE(responder.HandleReconciliationDifference(PEER, initiator_result.success, initiator_result.ask_shortids, responder_result));
+    return {initiator_result, responder_result};
+}
+
+std::set<uint256> ToSet(const std::vector<uint256>& v) { return {v.begin(), v.end()}; }
+} // namespace
+
+BOOST_AUTO_TEST_CASE(register_peer)
+{
+    TxReconciliationTracker tracker(node::TXRECONCILIATION_VERSION);
+    BOOST_CHECK(tracker.RegisterPeer(PEER, true, 1, 1) == ReconciliationRegisterResult::NOT_FOUND);
+    BOOST_CHECK(!tracker.AddToSet(PEER, uint256::ONE));
+
+    tracker.PreRegisterPeer(PEER);
+    BOOST_CHECK(tracker.RegisterPeer(PEER, true, 0, 1) == ReconciliationRegisterResult::PROTOCOL_VIOLATION);
+    BOOST_CHECK(!tracker.IsPeerRegistered(PEER));
+
+    tracker.PreRegisterPeer(PEER);
+    BOOST_CHECK(tracker.RegisterPeer(PEER, true, 2, 1) == ReconciliationRegisterResult::SUCCESS);
+    BOOST_CHECK(tracker.IsPeerRegistered(PEER));
+    BOOST_CHECK(tracker.RegisterPeer(PEER, true, 1, 1) == ReconciliationRegisterResult::ALREADY_REGISTERED);
+    BOOST_CHECK(tracker.AddToSet(PEER, uint256::ONE));
+
+    tracker.ForgetPeer(PEER);
+    BOOST_CHECK(!tracker.IsPeerRegistered(PEER));
+}
+
+BOOST_AUTO_TEST_CASE(reconcile_difference)
+{
+    TxReconciliationTracker initiator(node::TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(node::TXRECONCILIATION_VERSION);
+    Connect(initiator, responder);
+    std::chrono::microseconds now{1s};
+
+    std::vector<uint256> initiator_only, responder_only;
+    for (int i = 0; i < 100; ++i) {
+        const uint256 shared = InsecureRand256();
+        BOOST_CHECK(initiator.AddToSet(PEER, shared));
+        BOOST_CHECK(responder.AddToSet(PEER, shared));
+    }
+    for (int i = 0; i < 5; ++i) {
+        initiator_only.push_back(InsecureRand256());
+        BOOST_CHECK(initiator.AddToSet(PEER, initiator_only.back()));
+    }
+    for (int i = 0; i < 7; ++i) {
+        responder_only.push_back(InsecureRand256());
+        BOOST_CHECK(responder.AddToSet(PEER, responder_only.back()));
+    }
+    // A transaction the peer announced itself is not reconciled.
+    const uint256 announced = InsecureRand256();
+    BOOST_CHECK(initiator.AddToSet(PEER, announced));
+    initiator.TryRemovingFromSet(PEER, announced);
+
+    const auto [initiator_result, responder_result] = Reconcile(initiator, responder, now);
+    BOOST_CHECK(initiator_result.success);
+    BOOST_CHECK(ToSet(initiator_result.txs_to_announce) == ToSet(initiator_only));
+    BOOST_CHECK_EQUAL(initiator_result.ask_shortids.size(), responder_only.size());
+    BOOST_CHECK(responder_result.success);
+    BOOST_CHECK(ToSet(responder_result.txs_to_announce) == ToSet(responder_only));
+
+    // Both sets were drained, so the next round finds nothing.
+    const auto [next_initiator_result, next_responder_result] = Reconcile(initiator, responder, now);
+    BOOST_CHECK(next_initiator_result.success);
+    BOOST_CHECK(next_initiator_result.txs_to_announce.empty());
+    BOOST_CHECK(next_responder_result.txs_to_announce.empty());
+}
+
+BOOST_AUTO_TEST_CASE(reconcile_failure_falls_back)
+{
+    TxReconciliationTracker initiator(node::TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(node::TXRECONCILIATION_VERSION);
+    Connect(initiator, responder);
+    std::chrono::microseconds now{1s};
+
+    // Equally sized but disjoint sets exceed the capacity the responder estimates.
+    std::vector<uint256> initiator_set, responder_set;
+    for (int i = 0; i < 40; ++i) {
+        initiator_set.push_back(InsecureRand256());
+        responder_set.push_back(InsecureRand256());
+        BOOST_CHECK(initiator.AddToSet(PEER, initiator_set.back()));
+        BOOST_CHECK(responder.AddToSet(PEER, responder_set.back()));
+    }
+
+    const auto [initiator_result, responder_result] = Reconcile(initiator, responder, now);
+    BOOST_CHECK(!initiator_result.success);
+    BOOST_CHECK(ToSet(initiator_result.txs_to_announce) == ToSet(initiator_set));
+    BOOST_CHECK(!responder_result.success);
+    BOOST_CHECK(ToSet(responder_result.txs_to_announce) == ToSet(responder_set));
+}
+
+BOOST_AUTO_TEST_CASE(protocol_violations)
+{
+    TxReconciliationTracker initiator(node::TXRECONCILIATION_VERSION);
+    TxReconciliationTracker responder(node::TXRECONCILIATION_VERSION);
+    Connect(initiator, responder);
+
+    ReconciliationResult result;
+    // Sketches and differences must answer a request.
+    BOOST_CHECK(!initiator.HandleSketch(PEER, {}, result));
+    BOOST_CHECK(!responder.HandleReconciliationDifference(PEER, true, {}, result));
+    // Only the side that opened the connection sends requests.
+    BOOST_CHECK(!initiator.HandleReconciliationRequest(PEER, 0, 0));
+    BOOST_CHECK(responder.HandleReconciliationRequest(PEER, 0, 0));
+    BOOST_CHECK(!responder.HandleReconciliationRequest(PEER, 0, 0));
+}
+
+BOOST_AUTO_TEST_CASE(sketch_capacity)
+{
+    const uint16_t q = node::RECON_Q * node::RECON_Q_PRECISION;
+    BOOST_CHECK_EQUAL(TxReconciliationTracker::EstimateSketchCapacity(0, 0, q), 1U);
+    BOOST_CHECK_EQUAL(TxReconciliationTracker::EstimateSketchCapacity(10, 0, q), 11U);
+    BOOST_CHECK_EQUAL(TxReconciliationTracker::EstimateSketchCapacity(100, 100, q), 25U);
+    BOOST_CHECK_EQUAL(TxReconciliationTracker::EstimateSketchCapacity(100000, 0, q), node::MAX_SKETCH_CAPACITY);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
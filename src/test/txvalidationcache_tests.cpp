@@ -13,6 +13,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <thread>
+
 struct Dersig100Setup : public TestChain100Setup {
     Dersig100Setup()
         : TestChain100Setup{{"-testactivationheight=dersig@2002"}} {}
@@ -383,4 +386,89 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(mempool_script_preverify, Dersig100Setup)
+{
+    // Independent transactions are verified concurrently without cs_main or
+    // the mempool lock, and are then accepted from the script execution cache.
+    {
+        LOCK(cs_main);
+        InitScriptExecutionCache();
+    }
+    CChainState& chainstate = m_node.chainman->ActiveChainstate();
+    CTxMemPool& mempool = *m_node.mempool;
+
+    CScript scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    const auto Spend = [&](const COutPoint& prevout, bool valid_sig) {
+        CMutableTransaction spend;
+        spend.nVersion = 1;
+        spend.vin.resize(1);
+        spend.vin[0].prevout = prevout;
+        spend.vout.resize(1);
+        spend.vout[0].nValue = 11*CENT;
+        spend.vout[0].scriptPubKey = scriptPubKey;
+
+        std::vector<unsigned char> vchSig;
+        uint256 hash = SignatureHash(scriptPubKey, spend, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+        BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+        if (!valid_sig) vchSig[vchSig.size() / 2] ^= 0x01;
+        vchSig.push_back((unsigned char)SIGHASH_ALL);
+        spend.vin[0].scriptSig << vchSig;
+        return MakeTransactionRef(spend);
+    };
+    const auto ScriptChecksLeft = [&](const CTransaction& tx) {
+        LOCK(cs_main);
+        TxValidationState state;
+        PrecomputedTransactionData txdata;
+        std::vector<CScriptCheck> checks;
+        BOOST_CHECK(CheckInputScripts(tx, state, &chainstate.CoinsTip(), STANDARD_SCRIPT_VERIFY_FLAGS, true, true, txdata, &checks));
+        return checks.size();
+    };
+
+    // Parallel path
+    std::vector<CTransactionRef> spends;
+    for (int i = 0; i < 4; i++) {
+        spends.push_back(Spend(COutPoint(m_coinbase_txns[i]->GetHash(), 0), /*valid_sig=*/true));
+    }
+    std::atomic<size_t> verified{0};
+    std::vector<std::thread> threads;
+    for (const CTransactionRef& tx : spends) {
+        threads.emplace_back([&, tx] {
+            if (PreVerifyTransactionScripts(chainstate, mempool, *tx)) ++verified;
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    BOOST_CHECK_EQUAL(verified, spends.size());
+
+    for (const CTransactionRef& tx : spends) {
+        BOOST_CHECK_EQUAL(ScriptChecksLeft(*tx), 0U);
+        const MempoolAcceptResult result = WITH_LOCK(cs_main, return m_node.chainman->ProcessTransaction(tx));
+        BOOST_CHECK(result.m_result_type == MempoolAcceptResult::ResultType::VALID);
+    }
+    BOOST_CHECK_EQUAL(mempool.size(), spends.size());
+    // Nothing is left to verify for a transaction already in the mempool.
+    BOOST_CHECK(!PreVerifyTransactionScripts(chainstate, mempool, *spends[0]));
+
+    // Fallback path: a bad signature is not cached, and acceptance reports it.
+    const CTransactionRef bad_sig = Spend(COutPoint(m_coinbase_txns[4]->GetHash(), 0), /*valid_sig=*/false);
+    BOOST_CHECK(!PreVerifyTransactionScripts(chainstate, mempool, *bad_sig));
+    BOOST_CHECK_EQUAL(ScriptChecksLeft(*bad_sig), 1U);
+    {
+        const MempoolAcceptResult result = WITH_LOCK(cs_main, return m_node.chainman->ProcessTransaction(bad_sig));
+        BOOST_CHECK(result.m_result_type == MempoolAcceptResult::ResultType::INVALID);
+        BOOST_CHECK(result.m_state.GetResult() == TxValidationResult::TX_CONSENSUS);
+        BOOST_CHECK(result.m_state.GetRejectReason().rfind("mandatory-script-verify-flag-failed", 0) == 0);
+    }
+
+    // Fallback path: unknown inputs are left to acceptance as well.
+    const CTransactionRef orphan = Spend(COutPoint(InsecureRand256(), 0), /*valid_sig=*/true);
+    BOOST_CHECK(!PreVerifyTransactionScripts(chainstate, mempool, *orphan));
+    {
+        const MempoolAcceptResult result = WITH_LOCK(cs_main, return m_node.chainman->ProcessTransaction(orphan));
+        BOOST_CHECK(result.m_result_type == MempoolAcceptResult::ResultType::INVALID);
+        BOOST_CHECK(result.m_state.GetResult() == TxValidationResult::TX_MISSING_INPUTS);
+    }
+    BOOST_CHECK_EQUAL(mempool.size(), spends.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
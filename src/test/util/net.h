@@ -26,6 +26,7 @@ struct ConnmanTestMsg : public CConnman {
 
     void AddTestNode(CNode& node)
     {
+        RegisterSocketEvents(node);
         LOCK(m_nodes_mutex);
         m_nodes.push_back(&node);
     }
@@ -40,6 +41,14 @@ struct ConnmanTestMsg : public CConnman {
 
     void ProcessMessagesOnce(CNode& node) { m_msgproc->ProcessMessages(&node, flagInterruptMsgProc); }
 
+    bool InitEpoll()
+    {
+        m_use_epoll = true;
+        return InitSocketEvents();
+    }
+
+    void SocketHandlerOnce() { SocketHandler(); }
+
     void NodeReceiveMsgBytes(CNode& node, Span<const uint8_t> msg_bytes, bool& complete) const;
 
     bool ReceiveMsgFrom(CNode& node, CSerializedNetMsg& ser_msg) const;
@@ -115,6 +124,13 @@ public:
 
     ssize_t Send(const void*, size_t len, int) const override { return len; }
 
+    ssize_t SendMany(Span<const Span<const unsigned char>> bufs, int) const override
+    {
+        ssize_t len{0};
+        for (const auto& buf : bufs) len += buf.size();
+        return len;
+    }
+
     ssize_t Recv(void* buf, size_t len, int flags) const override
     {
         const size_t consume_bytes{std::min(len, m_contents.size() - m_consumed)};
@@ -0,0 +1,129 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qtum/vmtrace.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+
+BOOST_FIXTURE_TEST_SUITE(vmtrace_tests, BasicTestingSetup)
+
+static VMTraceRecord MakeRecord(const uint256& txid, int height)
+{
+    VMTraceRecord record;
+    record.txid = txid;
+    record.block_hash = InsecureRand256();
+    record.height = height;
+    record.time = 1600000000 + height;
+    record.gas_used = 21000 + height;
+    VMTraceLog& log = record.logs.emplace_back();
+    log.topics = {InsecureRand256(), InsecureRand256()};
+    log.data = {1, 2, 3};
+    return record;
+}
+
+static std::vector<int> Heights(const std::vector<VMTraceRecord>& records)
+{
+    std::vector<int> heights;
+    for (const VMTraceRecord& record : records) {
+        heights.push_back(record.height);
+    }
+    return heights;
+}
+
+BOOST_AUTO_TEST_CASE(append_and_read)
+{
+    const fs::path dir = m_args.GetDataDirBase() / "vmtrace";
+    const uint256 txid = InsecureRand256();
+    {
+        VMTrace trace(dir);
+        BOOST_REQUIRE(trace.Open());
+        trace.Start();
+        trace.Add({MakeRecord(txid, 10), MakeRecord(InsecureRand256(), 11)});
+        trace.Add({MakeRecord(txid, 12)});
+        trace.Flush();
+        BOOST_CHECK_EQUAL(trace.Size(), 3U);
+        BOOST_CHECK(Heights(trace.ReadTx(txid)) == std::vector<int>({10, 12}));
+        trace.Stop();
+        // Without the thread records are appended directly
+        trace.Add({MakeRecord(uint256(), 13)});
+        BOOST_CHECK_EQUAL(trace.Size(), 4U);
+    }
+
+    VMTrace trace(dir);
+    BOOST_REQUIRE(trace.Open(/*read_only=*/true));
+    BOOST_CHECK(Heights(trace.ReadRange(11, 13, 10)) == std::vector<int>({11, 12, 13}));
+    BOOST_CHECK(Heights(trace.ReadRange(0, 100, 2)) == std::vector<int>({10, 11}));
+    const std::vector<VMTraceRecord> records = trace.ReadTx(txid);
+    BOOST_REQUIRE_EQUAL(records.size(), 2U);
+    BOOST_CHECK_EQUAL(records[1].gas_used, 21012U);
+    BOOST_CHECK(records[1].logs[0].data == std::vector<unsigned char>({1, 2, 3}));
+    BOOST_CHECK(trace.ReadTx(InsecureRand256()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(flush_while_adding)
+{
+    constexpr int THREADS{4};
+    constexpr int RECORDS{50};
+    std::vector<uint256> txids;
+    std::vector<std::vector<VMTraceRecord>> records(THREADS);
+    for (int t = 0; t < THREADS; ++t) {
+        txids.push_back(InsecureRand256());
+        for (int i = 0; i < RECORDS; ++i) {
+            records[t].push_back(MakeRecord(txids[t], i));
+        }
+    }
+
+    VMTrace trace(m_args.GetDataDirBase() / "vmtrace");
+    BOOST_REQUIRE(trace.Open());
+    trace.Start();
+    // Each thread waits for its own records while the others keep adding theirs
+    std::atomic<int> missing{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < RECORDS; ++i) {
+                trace.Add({records[t][i]});
+                trace.Flush();
+                if (trace.ReadTx(txids[t]).size() != size_t(i + 1)) ++missing;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    BOOST_CHECK_EQUAL(missing.load(), 0);
+    BOOST_CHECK_EQUAL(trace.Size(), size_t{THREADS * RECORDS});
+}
+
+BOOST_AUTO_TEST_CASE(repair)
+{
+    const fs::path dir = m_args.GetDataDirBase() / "vmtrace";
+    {
+        VMTrace trace(dir);
+        BOOST_REQUIRE(trace.Open());
+        trace.Add({MakeRecord(InsecureRand256(), 1), MakeRecord(InsecureRand256(), 2), MakeRecord(InsecureRand256(), 3)});
+    }
+
+    // A write interrupted in the last record and before its index entry
+    fs::resize_file(dir / "trace.dat", fs::file_size(dir / "trace.dat") - 1);
+    fs::resize_file(dir / "trace.idx", fs::file_size(dir / "trace.idx") - 1);
+    {
+        VMTrace trace(dir);
+        BOOST_REQUIRE(trace.Open());
+        BOOST_CHECK(Heights(trace.ReadRange(0, 10, 10)) == std::vector<int>({1, 2}));
+        trace.Add({MakeRecord(InsecureRand256(), 4)});
+    }
+
+    // Records without index entries are indexed again
+    fs::resize_file(dir / "trace.idx", 0);
+    VMTrace trace(dir);
+    BOOST_REQUIRE(trace.Open());
+    BOOST_CHECK(Heights(trace.ReadRange(0, 10, 10)) == std::vector<int>({1, 2, 4}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -702,7 +702,7 @@ bool CBlockTreeDB::blockOnchainActive(const uint256 &hash, ChainstateManager &ch
 }
 ///////////////////////////////////////////////////////
 
-bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
+bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex, BlockSigArena& sig_arena)
 {
     AssertLockHeld(::cs_main);
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
@@ -734,7 +734,7 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
                 pindexNew->hashUTXORoot   = diskindex.hashUTXORoot; // qtum
                 pindexNew->nStakeModifier = diskindex.nStakeModifier;
                 pindexNew->prevoutStake   = diskindex.prevoutStake;
-                pindexNew->vchBlockSigDlgt    = diskindex.vchBlockSigDlgt; // qtum
+                pindexNew->SetBlockSigDlgt(diskindex.vchBlockSigDlgt, sig_arena); // qtum
 
                 if (!CheckIndexProof(*pindexNew, consensusParams)) {
                     return error("%s: CheckIndexProof failed: %s", __func__, pindexNew->ToString());
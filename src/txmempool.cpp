@@ -496,6 +496,7 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, setEntries &setAnces
     // Used by AcceptToMemoryPool(), which DOES do
     // all the appropriate checks.
     indexed_transaction_set::iterator newit = mapTx.insert(entry).first;
+    if (m_cluster_mode) m_unclustered.insert(newit);
 
     // Update transaction for any feeDelta created by PrioritiseTransaction
     // TODO: refactor so that the fee delta is calculated before inserting
@@ -676,6 +677,8 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
         }
     }
     cachedInnerUsage -= memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
+    InvalidateCluster(it);
+    m_unclustered.erase(it);
     mapTx.erase(it);
     nTransactionsUpdated++;
     if (minerPolicyEstimator) {minerPolicyEstimator->removeTx(hash, false);}
@@ -711,6 +714,177 @@ void CTxMemPool::CalculateDescendants(txiter entryit, setEntries& setDescendants
     }
 }
 
+void CTxMemPool::CalculateCluster(txiter entryit, std::vector<txiter>& cluster) const
+{
+    AssertLockHeld(cs);
+    WITH_FRESH_EPOCH(m_epoch);
+    cluster.clear();
+    cluster.push_back(entryit);
+    visited(entryit);
+    // The cluster doubles as the work queue: walk the parents and children of
+    // every entry found so far until no new entries are discovered.
+    for (size_t i = 0; i < cluster.size(); ++i) {
+        for (const CTxMemPoolEntry& parent : cluster[i]->GetMemPoolParentsConst()) {
+            txiter parentiter = mapTx.iterator_to(parent);
+            if (!visited(parentiter)) cluster.push_back(parentiter);
+        }
+        for (const CTxMemPoolEntry& child : cluster[i]->GetMemPoolChildrenConst()) {
+            txiter childiter = mapTx.iterator_to(child);
+            if (!visited(childiter)) cluster.push_back(childiter);
+        }
+    }
+}
+
+std::vector<CTxMemPool::ClusterChunk> CTxMemPool::LinearizeCluster(std::vector<txiter> cluster) const
+{
+    AssertLockHeld(cs);
+
+    // An entry has more in-mempool ancestors than any of its ancestors, so
+    // this order is valid for block inclusion.
+    std::sort(cluster.begin(), cluster.end(), [](const txiter& a, const txiter& b) {
+        if (a->GetCountWithAncestors() != b->GetCountWithAncestors()) {
+            return a->GetCountWithAncestors() < b->GetCountWithAncestors();
+        }
+        return CompareIteratorByHash()(a, b);
+    });
+
+    std::vector<txiter> order;
+    const size_t n = cluster.size();
+    if (n > MAX_CLUSTER_LINEARIZE_COUNT) {
+        order = std::move(cluster);
+    } else {
+        order.reserve(n);
+        std::map<txiter, size_t, CompareIteratorByHash> position;
+        for (size_t i = 0; i < n; ++i) {
+            position.emplace(cluster[i], i);
+        }
+
+        // ancestors[i][j] is true if cluster[j] is cluster[i] or one of its ancestors.
+        // The fees and sizes of the not yet linearized ancestors are kept per entry and
+        // updated incrementally as entries are moved into the linearization.
+        std::vector<std::vector<bool>> ancestors(n, std::vector<bool>(n, false));
+        std::vector<CAmount> anc_fee(n, 0);
+        std::vector<int64_t> anc_size(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            ancestors[i][i] = true;
+            for (const CTxMemPoolEntry& parent : cluster[i]->GetMemPoolParentsConst()) {
+                // Parents sort before their children, so their ancestor sets are complete
+                const size_t p = position.at(mapTx.iterator_to(parent));
+                for (size_t j = 0; j <= p; ++j) {
+                    if (ancestors[p][j]) ancestors[i][j] = true;
+                }
+            }
+            for (size_t j = 0; j <= i; ++j) {
+                if (!ancestors[i][j]) continue;
+                anc_fee[i] += cluster[j]->GetModifiedFee();
+                anc_size[i] += cluster[j]->GetTxSize();
+            }
+        }
+
+        std::vector<bool> done(n, false);
+        while (order.size() < n) {
+            // Pick the entry with the highest feerate including its remaining ancestors
+            size_t best = n;
+            for (size_t i = 0; i < n; ++i) {
+                if (done[i]) continue;
+                if (best == n || (double)anc_fee[i] * anc_size[best] > (double)anc_fee[best] * anc_size[i]) {
+                    best = i;
+                }
+            }
+            // Move it and its remaining ancestors into the linearization, in topological order
+            for (size_t j = 0; j <= best; ++j) {
+                if (done[j] || !ancestors[best][j]) continue;
+                done[j] = true;
+                order.push_back(cluster[j]);
+                for (size_t i = j + 1; i < n; ++i) {
+                    if (done[i] || !ancestors[i][j]) continue;
+                    anc_fee[i] -= cluster[j]->GetModifiedFee();
+                    anc_size[i] -= cluster[j]->GetTxSize();
+                }
+            }
+        }
+    }
+
+    // Merge each entry into the chunk before it while that chunk has a lower feerate,
+    // so that chunk feerates never increase along the linearization.
+    std::vector<ClusterChunk> chunks;
+    for (const txiter& it : order) {
+        ClusterChunk chunk;
+        chunk.txs.push_back(it);
+        chunk.fee = it->GetModifiedFee();
+        chunk.size = it->GetTxSize();
+        chunk.sigop_cost = it->GetSigOpCost();
+        while (!chunks.empty() && (double)chunk.fee * chunks.back().size > (double)chunks.back().fee * chunk.size) {
+            ClusterChunk& prev = chunks.back();
+            prev.txs.insert(prev.txs.end(), chunk.txs.begin(), chunk.txs.end());
+            prev.fee += chunk.fee;
+            prev.size += chunk.size;
+            prev.sigop_cost += chunk.sigop_cost;
+            chunk = std::move(prev);
+            chunks.pop_back();
+        }
+        chunks.push_back(std::move(chunk));
+    }
+    return chunks;
+}
+
+void CTxMemPool::InvalidateCluster(txiter it)
+{
+    AssertLockHeld(cs);
+    if (!m_cluster_mode || it->m_cluster_id == 0) return;
+    auto cluster = m_clusters.find(it->m_cluster_id);
+    assert(cluster != m_clusters.end());
+    for (const ClusterChunk& chunk : cluster->second) {
+        for (txiter member : chunk.txs) {
+            member->m_cluster_id = 0;
+            m_unclustered.insert(member);
+        }
+    }
+    m_clusters.erase(cluster);
+}
+
+void CTxMemPool::UpdateClusters() const
+{
+    AssertLockHeld(cs);
+    // All entries connected to an entry without a linearization are without
+    // one too, as any change to the links drops the clusters on both ends.
+    while (!m_unclustered.empty()) {
+        std::vector<txiter> cluster;
+        CalculateCluster(*m_unclustered.begin(), cluster);
+        const uint64_t id = m_next_cluster_id++;
+        for (txiter member : cluster) {
+            member->m_cluster_id = id;
+            m_unclustered.erase(member);
+        }
+        m_clusters.emplace(id, LinearizeCluster(std::move(cluster)));
+    }
+}
+
+std::vector<const std::vector<CTxMemPool::ClusterChunk>*> CTxMemPool::GetLinearizedClusters() const
+{
+    AssertLockHeld(cs);
+    std::vector<const std::vector<ClusterChunk>*> clusters;
+    if (!m_cluster_mode) return clusters;
+    UpdateClusters();
+    clusters.reserve(m_clusters.size());
+    for (const auto& [id, chunks] : m_clusters) {
+        clusters.push_back(&chunks);
+    }
+    return clusters;
+}
+
+void CTxMemPool::SetClusterMode(bool cluster_mode)
+{
+    LOCK(cs);
+    m_cluster_mode = cluster_mode;
+    m_clusters.clear();
+    m_unclustered.clear();
+    for (txiter it = mapTx.begin(); it != mapTx.end(); ++it) {
+        it->m_cluster_id = 0;
+        if (m_cluster_mode) m_unclustered.insert(it);
+    }
+}
+
 void CTxMemPool::removeRecursive(const CTransaction &origTx, MemPoolRemovalReason reason)
 {
     // Remove transaction from memory pool
@@ -978,6 +1152,8 @@ void CTxMemPool::removeForBlock(const std::vector<CTransactionRef>& vtx, unsigne
 
 void CTxMemPool::_clear()
 {
+    m_clusters.clear();
+    m_unclustered.clear();
     mapTx.clear();
     mapNextTx.clear();
     totalTxSize = 0;
@@ -1101,6 +1277,18 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
     assert(innerUsage == cachedInnerUsage);
+
+    // Every entry has a linearized cluster that lists it, or waits for one
+    size_t clustered{0};
+    for (const auto& [id, chunks] : m_clusters) {
+        for (const ClusterChunk& chunk : chunks) {
+            for (txiter member : chunk.txs) {
+                assert(member->m_cluster_id == id);
+                ++clustered;
+            }
+        }
+    }
+    assert(clustered + m_unclustered.size() == (m_cluster_mode ? mapTx.size() : 0));
 }
 
 bool CTxMemPool::CompareDepthAndScore(const uint256& hasha, const uint256& hashb, bool wtxid)
@@ -1297,6 +1485,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
+            InvalidateCluster(it);
             // Now update all ancestors' modified fees with descendants
             setEntries setAncestors;
             uint64_t nNoLimit = std::numeric_limits<uint64_t>::max();
@@ -1453,6 +1642,8 @@ void CTxMemPool::addUnchecked(const CTxMemPoolEntry &entry, bool validFeeEstimat
 void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add)
 {
     AssertLockHeld(cs);
+    InvalidateCluster(entry);
+    InvalidateCluster(child);
     CTxMemPoolEntry::Children s;
     if (add && entry->GetMemPoolChildren().insert(*child).second) {
         cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
@@ -1464,6 +1655,8 @@ void CTxMemPool::UpdateChild(txiter entry, txiter child, bool add)
 void CTxMemPool::UpdateParent(txiter entry, txiter parent, bool add)
 {
     AssertLockHeld(cs);
+    InvalidateCluster(entry);
+    InvalidateCluster(parent);
     CTxMemPoolEntry::Parents s;
     if (add && entry->GetMemPoolParents().insert(*parent).second) {
         cachedInnerUsage += memusage::IncrementalDynamicUsage(s);
@@ -1516,13 +1709,23 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
         // "minimum reasonable fee rate" (ie some value under which we consider txn
         // to have 0 fee). This way, we don't allow txn to enter mempool with feerate
         // equal to txn which were removed with no block in between.
-        CFeeRate removed(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+        CFeeRate removed;
+        setEntries stage;
+        if (m_cluster_mode) {
+            // Evict the lowest feerate chunk of the cluster of the worst package. It is
+            // the tail of the cluster's linearization, so it contains all its descendants.
+            UpdateClusters();
+            const ClusterChunk& worst = m_clusters.at(it->m_cluster_id).back();
+            removed = CFeeRate(worst.fee, worst.size);
+            stage.insert(worst.txs.begin(), worst.txs.end());
+        } else {
+            removed = CFeeRate(it->GetModFeesWithDescendants(), it->GetSizeWithDescendants());
+            CalculateDescendants(mapTx.project<0>(it), stage);
+        }
         removed += incrementalRelayFee;
         trackPackageRemoved(removed);
         maxFeeRateRemoved = std::max(maxFeeRateRemoved, removed);
 
-        setEntries stage;
-        CalculateDescendants(mapTx.project<0>(it), stage);
         nTxnRemoved += stage.size();
 
         std::vector<CTransaction> txn;
@@ -248,6 +248,7 @@ public:
 
     mutable size_t vTxHashesIdx; //!< Index in mempool's vTxHashes
     mutable Epoch::Marker m_epoch_marker; //!< epoch when last touched, useful for graph algorithms
+    mutable uint64_t m_cluster_id{0}; //!< Linearized cluster in cluster mode, 0 if it must be linearized again
 };
 
 // extracts a transaction hash from CTxMemPoolEntry or CTransactionRef
@@ -588,10 +589,17 @@ protected:
 
     bool m_is_loaded GUARDED_BY(cs){false};
 
+    //! Mine and evict by linearized clusters instead of ancestor and descendant packages
+    bool m_cluster_mode{false};
+
 public:
 
     static const int ROLLING_FEE_HALFLIFE = 60 * 60 * 12; // public only for testing
 
+    /** Clusters larger than this are not searched for the best chunks, they are chunked in
+     *  topological order instead. */
+    static const size_t MAX_CLUSTER_LINEARIZE_COUNT = 100;
+
     typedef boost::multi_index_container<
         CTxMemPoolEntry,
         boost::multi_index::indexed_by<
@@ -665,10 +673,32 @@ public:
 
     typedef std::set<txiter, CompareIteratorByHash> setEntries;
 
+    /** A group of transactions of one cluster that is mined or evicted together,
+     *  in an order that is valid for block inclusion. */
+    struct ClusterChunk {
+        std::vector<txiter> txs;
+        CAmount fee{0};
+        int64_t size{0};
+        int64_t sigop_cost{0};
+    };
+
     uint64_t CalculateDescendantMaximum(txiter entry) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 private:
     typedef std::map<txiter, setEntries, CompareIteratorByHash> cacheMap;
 
+    /** Linearizations of the clusters in cluster mode, by id. They are kept
+     *  across block templates and dropped when a transaction of the cluster
+     *  is added, removed or reprioritised; its entries then move to
+     *  m_unclustered until the next UpdateClusters(). */
+    mutable std::map<uint64_t, std::vector<ClusterChunk>> m_clusters GUARDED_BY(cs);
+    mutable setEntries m_unclustered GUARDED_BY(cs);
+    mutable uint64_t m_next_cluster_id GUARDED_BY(cs){1};
+
+    /** Drop the linearization of the cluster of it, if there is one. */
+    void InvalidateCluster(txiter it) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Linearize the clusters of all entries of m_unclustered. */
+    void UpdateClusters() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
 
     //////////////////////////////////////////////////////////////// // qtum
     typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
@@ -873,6 +903,23 @@ public:
      *  already in it.  */
     void CalculateDescendants(txiter it, setEntries& setDescendants) const EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** Populate cluster with all in-mempool transactions connected to it through any
+     *  chain of parent and child relationships, including it. */
+    void CalculateCluster(txiter it, std::vector<txiter>& cluster) const EXCLUSIVE_LOCKS_REQUIRED(cs) LOCKS_EXCLUDED(m_epoch);
+
+    /** Order a complete cluster for block inclusion and split it into chunks of
+     *  non-increasing feerate. Each chunk together with the chunks before it is
+     *  closed under ancestors, so the last chunk can be evicted on its own. */
+    std::vector<ClusterChunk> LinearizeCluster(std::vector<txiter> cluster) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    /** The linearization of every cluster in the mempool, in cluster mode. Only the
+     *  clusters changed since the last call are linearized again. The chunks are
+     *  valid until the mempool is modified. */
+    std::vector<const std::vector<ClusterChunk>*> GetLinearizedClusters() const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    bool IsClusterMode() const { return m_cluster_mode; }
+    void SetClusterMode(bool cluster_mode);
+
     /** The minimum fee to get into the mempool, which may itself not be enough
       *  for larger-sized transactions.
       *  The incrementalRelayFee policy variable is used to bound the time it
@@ -13,6 +13,11 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
 
 #ifdef WIN32
 #include <codecvt>
@@ -64,6 +69,24 @@ ssize_t Sock::Send(const void* data, size_t len, int flags) const
     return send(m_socket, static_cast<const char*>(data), len, flags);
 }
 
+ssize_t Sock::SendMany(Span<const Span<const unsigned char>> bufs, int flags) const
+{
+    if (bufs.empty()) return 0;
+#ifdef WIN32
+    return Send(bufs[0].data(), bufs[0].size(), flags);
+#else
+    std::vector<struct iovec> iov(bufs.size());
+    for (size_t i = 0; i < bufs.size(); ++i) {
+        iov[i].iov_base = const_cast<unsigned char*>(bufs[i].data());
+        iov[i].iov_len = bufs[i].size();
+    }
+    struct msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = iov.size();
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void* buf, size_t len, int flags) const
 {
     return recv(m_socket, static_cast<char*>(buf), len, flags);
@@ -6,6 +6,7 @@
 #define BITCOIN_UTIL_SOCK_H
 
 #include <compat.h>
+#include <span.h>
 #include <threadinterrupt.h>
 #include <util/time.h>
 
@@ -85,6 +86,15 @@ public:
      */
     [[nodiscard]] virtual ssize_t Send(const void* data, size_t len, int flags) const;
 
+    /**
+     * sendmsg(2) wrapper that hands several buffers to the kernel in one call, like writev(2)
+     * but with send(2) flags. Where scatter/gather is not available only the first buffer is
+     * sent. Code that uses this wrapper can be unit tested if this method is overridden by a
+     * mock Sock implementation.
+     * @return the total number of bytes sent, or -1 on error
+     */
+    [[nodiscard]] virtual ssize_t SendMany(Span<const Span<const unsigned char>> bufs, int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(this->Get(), buf, len, flags);`. Code that uses this
      * wrapper can be unit tested if this method is overridden by a mock Sock implementation.
@@ -27,6 +27,7 @@
 #include <llmq/quorums_chainlocks.h>
 #include <node/blockstorage.h>
 #include <node/coinstats.h>
+#include <node/mempool_journal.h>
 #include <node/ui_interface.h>
 #include <node/utxo_snapshot.h>
 #include <node/transaction.h>
@@ -119,7 +120,7 @@ const std::vector<std::string> CHECKLEVEL_DOC {
 std::unique_ptr<QtumState> globalState;
 std::shared_ptr<dev::eth::SealEngineFace> globalSealEngine;
 bool fRecordLogOpcodes = false;
-bool fIsVMlogFile = false;
+std::unique_ptr<VMTrace> g_vm_trace;
 bool fGettingValuesDGP = false;
 std::set<std::pair<COutPoint, unsigned int>> setStakeSeen;
 
@@ -1839,6 +1840,15 @@ void InitScriptExecutionCache() {
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+/** Key of a transaction's entry in the script execution cache for the given flags */
+static uint256 ScriptExecutionCacheEntry(const CTransaction& tx, unsigned int flags)
+{
+    uint256 entry;
+    CSHA256 hasher = g_scriptExecutionCacheHasher;
+    hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(entry.begin());
+    return entry;
+}
+
 /**
  * Check whether all of this transaction's input scripts succeed.
  *
@@ -1874,9 +1884,7 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     // correct (ie that the transaction hash which is in tx's prevouts
     // properly commits to the scriptPubKey in the inputs view of that
     // transaction).
-    uint256 hashCacheEntry;
-    CSHA256 hasher = g_scriptExecutionCacheHasher;
-    hasher.Write(tx.GetWitnessHash().begin(), 32).Write((unsigned char*)&flags, sizeof(flags)).Finalize(hashCacheEntry.begin());
+    const uint256 hashCacheEntry{ScriptExecutionCacheEntry(tx, flags)};
     AssertLockHeld(cs_main); //TODO: Remove this requirement by making CuckooCache not require external locks
     if (g_scriptExecutionCache.contains(hashCacheEntry, !cacheFullScriptStore)) {
         return true;
@@ -1960,6 +1968,62 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     return true;
 }
 
+bool PreVerifyTransactionScripts(CChainState& active_chainstate, const CTxMemPool& pool, const CTransaction& tx)
+{
+    // Contract transactions are verified together with their execution.
+    if (tx.IsCoinBase() || tx.vin.empty() || tx.HasCreateOrCall() || tx.HasOpSpend()) return false;
+
+    PrecomputedTransactionData txdata;
+    std::vector<CScriptCheck> policy_checks;
+    std::vector<CScriptCheck> consensus_checks;
+    unsigned int consensus_flags{0};
+    {
+        LOCK2(cs_main, pool.cs);
+        if (pool.exists(GenTxid::Wtxid(tx.GetWitnessHash()))) return false;
+
+        CCoinsViewCache& coins_tip = active_chainstate.CoinsTip();
+        CCoinsView dummy;
+        CCoinsViewCache view(&dummy);
+        CCoinsViewMemPool view_mempool(&coins_tip, pool);
+        view.SetBackend(view_mempool);
+
+        std::vector<COutPoint> coins_to_uncache;
+        bool have_inputs{true};
+        for (const CTxIn& txin : tx.vin) {
+            if (!coins_tip.HaveCoinInCache(txin.prevout)) coins_to_uncache.push_back(txin.prevout);
+            if (!view.HaveCoin(txin.prevout)) {
+                have_inputs = false;
+                break;
+            }
+        }
+        if (have_inputs) {
+            consensus_flags = GetBlockScriptFlags(active_chainstate.m_chain.Tip(), active_chainstate.m_params.GetConsensus());
+            TxValidationState state_dummy;
+            CheckInputScripts(tx, state_dummy, view, STANDARD_SCRIPT_VERIFY_FLAGS, true, true, txdata, &policy_checks);
+            CheckInputScripts(tx, state_dummy, view, consensus_flags, true, true, txdata, &consensus_checks);
+        }
+        // The checks own copies of the spent outputs, so the coins can go now.
+        for (const COutPoint& outpoint : coins_to_uncache) {
+            coins_tip.Uncache(outpoint);
+        }
+        if (!have_inputs) return false;
+    }
+
+    // The expensive part runs without any lock. The policy pass fills the
+    // signature cache, so the consensus pass is mostly cache hits.
+    for (CScriptCheck& check : policy_checks) {
+        if (!check()) return false;
+    }
+    for (CScriptCheck& check : consensus_checks) {
+        if (!check()) return false;
+    }
+
+    LOCK(cs_main);
+    g_scriptExecutionCache.insert(ScriptExecutionCacheEntry(tx, STANDARD_SCRIPT_VERIFY_FLAGS));
+    g_scriptExecutionCache.insert(ScriptExecutionCacheEntry(tx, consensus_flags));
+    return true;
+}
+
 bool AbortNode(BlockValidationState& state, const std::string& strMessage, const bilingual_str& userMessage)
 {
     AbortNode(strMessage, userMessage);
@@ -2399,11 +2463,15 @@ bool CheckSenderScript(const CCoinsViewCache& view, const CTransaction& tx){
     return true;
 }
 
-std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, CChainState& chainstate, const dev::Address& sender, uint64_t gasLimit, CAmount nAmount){
-    CBlock block;
-    CMutableTransaction tx;
+ContractCallContext::ContractCallContext(const dev::Address& _addrContract, std::vector<unsigned char> _opcode, CChainState& chainstate, const dev::Address& sender, CAmount _nAmount) :
+    chain(chainstate.m_chain),
+    addrContract(_addrContract),
+    opcode(std::move(_opcode)),
+    nAmount(_nAmount)
+{
+    AssertLockHeld(cs_main);
 
-    CBlockIndex* pblockindex = chainstate.m_blockman.m_block_index[chainstate.m_chain.Tip()->GetBlockHash()];
+    pblockindex = chainstate.m_blockman.m_block_index[chain.Tip()->GetBlockHash()];
     ReadBlockFromDisk(block, pblockindex, Params().GetConsensus());
     block.nTime = GetAdjustedTime();
 
@@ -2413,16 +2481,20 @@ std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::v
     	block.vtx.erase(block.vtx.begin()+1,block.vtx.end());
 
     QtumDGP qtumDGP(globalState.get(), chainstate, fGettingValuesDGP);
-    uint64_t blockGasLimit = qtumDGP.getBlockGasLimit(chainstate.m_chain.Tip()->nHeight + 1);
+    blockGasLimit = qtumDGP.getBlockGasLimit(chain.Tip()->nHeight + 1);
 
-    if(gasLimit == 0){
-        gasLimit = blockGasLimit - 1;
-    }
-    dev::Address senderAddress = sender == dev::Address() ? dev::Address("ffffffffffffffffffffffffffffffffffffffff") : sender;
+    senderAddress = sender == dev::Address() ? dev::Address("ffffffffffffffffffffffffffffffffffffffff") : sender;
+    CMutableTransaction tx;
     tx.vout.push_back(CTxOut(nAmount, CScript() << OP_DUP << OP_HASH160 << senderAddress.asBytes() << OP_EQUALVERIFY << OP_CHECKSIG));
     block.vtx.push_back(MakeTransactionRef(CTransaction(tx)));
+}
+
+std::vector<ResultExecute> ContractCallContext::execute(uint64_t gasLimit)
+{
+    AssertLockHeld(cs_main);
+
     dev::u256 nonce = globalState->getNonce(senderAddress);
- 
+
     QtumTransaction callTransaction;
     if(addrContract == dev::Address())
     {
@@ -2435,12 +2507,65 @@ std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::v
     callTransaction.forceSender(senderAddress);
     callTransaction.setVersion(VersionVM::GetEVMDefault());
 
-    
-    ByteCodeExec exec(block, std::vector<QtumTransaction>(1, callTransaction), blockGasLimit, pblockindex, chainstate.m_chain);
+    ByteCodeExec exec(block, std::vector<QtumTransaction>(1, callTransaction), blockGasLimit, pblockindex, chain);
     exec.performByteCode(dev::eth::Permanence::Reverted);
     return exec.getResult();
 }
 
+std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, CChainState& chainstate, const dev::Address& sender, uint64_t gasLimit, CAmount nAmount){
+    LOCK(cs_main);
+    ContractCallContext context(addrContract, std::move(opcode), chainstate, sender, nAmount);
+    if(gasLimit == 0){
+        gasLimit = context.getBlockGasLimit() - 1;
+    }
+    return context.execute(gasLimit);
+}
+
+//! Gas a call with value passes on to the callee on top of the forwarded gas
+static const uint64_t CALL_STIPEND_GAS = 2300;
+
+bool EstimateContractGas(ContractCallContext& context, ContractGasEstimate& estimate)
+{
+    auto succeeds = [&](uint64_t gasLimit, std::vector<ResultExecute>* result = nullptr) {
+        std::vector<ResultExecute> execResults = context.execute(gasLimit);
+        estimate.executions++;
+        bool success = !execResults.empty() && execResults[0].execRes.excepted == dev::eth::TransactionException::None;
+        if (result) *result = std::move(execResults);
+        return success;
+    };
+
+    const uint64_t maxGasLimit = context.getBlockGasLimit() - 1;
+    if (!succeeds(maxGasLimit, &estimate.result)) return false;
+
+    // The gas used is net of the refunds, which are capped at half of the gas used before them
+    const dev::eth::ExecutionResult& execRes = estimate.result[0].execRes;
+    const uint64_t gasUsed = uint64_t(execRes.gasUsed);
+    const uint64_t gasRefunded = execRes.gasRefunded > dev::u256(gasUsed) ? gasUsed : uint64_t(execRes.gasRefunded);
+    const uint64_t highWater = std::min(gasUsed + gasRefunded, std::min(2 * gasUsed, maxGasLimit));
+
+    // Most calls do not depend on the gas limit and need exactly the gas they used
+    if (succeeds(highWater)) {
+        estimate.gasLimit = highWater;
+        return true;
+    }
+
+    // Calls forward at most 63/64 of the remaining gas, so first try enough for one nested call
+    estimate.bisected = true;
+    uint64_t lo = highWater, hi = maxGasLimit;
+    const uint64_t nestedCall = (highWater + CALL_STIPEND_GAS) * 64 / 63;
+    if (nestedCall < hi) {
+        if (succeeds(nestedCall)) hi = nestedCall;
+        else lo = nestedCall;
+    }
+    while (hi - lo > 1) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        if (succeeds(mid)) hi = mid;
+        else lo = mid;
+    }
+    estimate.gasLimit = hi;
+    return true;
+}
+
 bool CheckMinGasPrice(std::vector<EthTransactionParams>& etps, const uint64_t& minGasPrice){
     for(EthTransactionParams& etp : etps){
         if(etp.gasPrice < dev::u256(minGasPrice))
@@ -2587,66 +2712,31 @@ valtype GetSenderAddress(const CTransaction& tx, const CCoinsViewCache* coinsVie
     return valtype();
 }
 
-UniValue vmLogToJSON(const ResultExecute& execRes, const CTransaction& tx, const CBlock& block, CChain& chain){
-    UniValue result(UniValue::VOBJ);
-    if(tx != CTransaction())
-        result.pushKV("txid", tx.GetHash().GetHex());
-    result.pushKV("address", execRes.execRes.newAddress.hex());
-    if(block.GetHash() != CBlock().GetHash()){
-        result.pushKV("time", block.GetBlockTime());
-        result.pushKV("blockhash", block.GetHash().GetHex());
-        result.pushKV("blockheight", chain.Tip()->nHeight + 1);
-    } else {
-        result.pushKV("time", GetAdjustedTime());
-        result.pushKV("blockheight", chain.Tip()->nHeight);
-    }
-    UniValue logEntries(UniValue::VARR);
-    dev::eth::LogEntries logs = execRes.txRec.log();
-    for(dev::eth::LogEntry log : logs){
-        UniValue logEntrie(UniValue::VOBJ);
-        logEntrie.pushKV("address", log.address.hex());
-        UniValue topics(UniValue::VARR);
-        for(dev::h256 l : log.topics){
-            UniValue topicPair(UniValue::VOBJ);
-            topicPair.pushKV("raw", l.hex());
-            topics.push_back(topicPair);
-            //TODO add "pretty" field for human readable data
-        }
-        UniValue dataPair(UniValue::VOBJ);
-        dataPair.pushKV("raw", HexStr(log.data));
-        logEntrie.pushKV("data", dataPair);
-        logEntrie.pushKV("topics", topics);
-        logEntries.push_back(logEntrie);
-    }
-    result.pushKV("entries", logEntries);
-    return result;
-}
-
-void writeVMlog(const std::vector<ResultExecute>& res, CChain& chain, const CTransaction& tx, const CBlock& block){
-    fs::path qtumDir = gArgs.GetDataDirNet() / "vmExecLogs.json";
-    std::stringstream ss;
-    if(fIsVMlogFile){
-        ss << ",";
-    } else {
-        std::ofstream file(PathToString(qtumDir), std::ios::out | std::ios::app);
-        file << "{\"logs\":[]}";
-        file.close();
-    }
-
-    for(size_t i = 0; i < res.size(); i++){
-        ss << vmLogToJSON(res[i], tx, block, chain).write();
-        if(i != res.size() - 1){
-            ss << ",";
-        } else {
-            ss << "]}";
+void RecordVMTrace(const std::vector<ResultExecute>& res, int height, int64_t time, const uint256& txid, const uint256& block_hash)
+{
+    if (!g_vm_trace) return;
+
+    std::vector<VMTraceRecord> records;
+    records.reserve(res.size());
+    for (const ResultExecute& result : res) {
+        VMTraceRecord& record = records.emplace_back();
+        record.txid = txid;
+        record.block_hash = block_hash;
+        record.height = height;
+        record.time = time;
+        record.gas_used = (uint64_t) result.execRes.gasUsed;
+        record.exception = static_cast<uint32_t>(result.execRes.excepted);
+        std::copy(result.execRes.newAddress.begin(), result.execRes.newAddress.end(), record.created_address.begin());
+        for (const dev::eth::LogEntry& log : result.txRec.log()) {
+            VMTraceLog& entry = record.logs.emplace_back();
+            std::copy(log.address.begin(), log.address.end(), entry.address.begin());
+            for (const dev::h256& topic : log.topics) {
+                std::copy(topic.begin(), topic.end(), entry.topics.emplace_back().begin());
+            }
+            entry.data = log.data;
         }
     }
-    
-    std::ofstream file(PathToString(qtumDir), std::ios::in | std::ios::out);
-    file.seekp(-2, std::ios::end);
-    file << ss.str();
-    file.close();
-    fIsVMlogFile = true;
+    g_vm_trace->Add(std::move(records));
 }
 
 LastHashes::LastHashes()
@@ -3448,7 +3538,7 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 checkBlock.vtx.push_back(MakeTransactionRef(std::move(t)));
             }
             if(fRecordLogOpcodes && !fJustCheck){
-                writeVMlog(resultExec, m_chain, tx, block);
+                RecordVMTrace(resultExec, pindex->nHeight, block.GetBlockTime(), tx.GetHash(), pindex->GetBlockHash());
             }
 
             for(ResultExecute& re: resultExec){
@@ -3632,13 +3722,14 @@ bool CChainState::ConnectBlock(const CBlock& block, BlockValidationState& state,
                 m_blockman.m_block_tree_db->WriteStakeIndex(pindex->nHeight, uint160());
             }
 
+            uint160 address;
+            uint8_t fee = 0;
             if(block.HasProofOfDelegation())
             {
-                uint160 address;
-                uint8_t fee = 0;
                 GetBlockDelegation(block, pkh, address, fee, view, *this);
                 m_blockman.m_block_tree_db->WriteDelegateIndex(pindex->nHeight, address, fee);
             }
+            CacheMPoSScript(pindex, pkh, block.HasProofOfDelegation(), address, fee);
         }else{
             m_blockman.m_block_tree_db->WriteStakeIndex(pindex->nHeight, uint160());
         }
@@ -5674,6 +5765,7 @@ bool TestBlockValidity(BlockValidationState& state,
         return state.Invalid(BlockValidationResult::BLOCK_CHAINLOCK, "bad-chainlock");
     }
     CBlockIndex indexDummy(block);
+    indexDummy.RefBlockSigDlgt(block.vchBlockSigDlgt);
     indexDummy.pprev = pindexPrev;
     indexDummy.nHeight = pindexPrev->nHeight + 1;
     indexDummy.phashBlock = &block_hash;
@@ -5714,7 +5806,13 @@ void CChainState::LoadMempool(const ArgsManager& args)
 {
     if (!m_mempool) return;
     if (args.GetBoolArg("-persistmempool", DEFAULT_PERSIST_MEMPOOL)) {
-        ::LoadMempool(*m_mempool, *this);
+        // Always apply a journal that is present, so that turning off
+        // -mempooljournal does not lose what was only recorded there.
+        ::LoadMempool(*m_mempool, *this, fsbridge::fopen, /*use_journal=*/true);
+        if (!args.GetBoolArg("-mempooljournal", node::DEFAULT_MEMPOOL_JOURNAL) && !ShutdownRequested()) {
+            std::error_code ec;
+            fs::remove(node::MempoolJournalPath(), ec);
+        }
     }
     m_mempool->SetIsLoaded(!ShutdownRequested());
 }
@@ -6508,12 +6606,17 @@ bool CChainState::RemoveBlockIndex(CBlockIndex *pindex)
 
 static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
-bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mockable_fopen_function)
+bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mockable_fopen_function, bool use_journal)
 {
     int64_t nExpiryTimeout = gArgs.GetIntArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60;
+
+    // Changes recorded since mempool.dat was written take precedence over it.
+    node::MempoolJournalReplay journal;
+    const bool has_journal = use_journal && node::ReadMempoolJournal(node::MempoolJournalPath(), journal);
+
     FILE* filestr{mockable_fopen_function(gArgs.GetDataDirNet() / "mempool.dat", "rb")};
     CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
-    if (file.IsNull()) {
+    if (file.IsNull() && !has_journal) {
         LogPrintf("Failed to open mempool file from disk. Continuing anyway.\n");
         return false;
     }
@@ -6523,72 +6626,110 @@ bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mocka
     int64_t failed = 0;
     int64_t already_there = 0;
     int64_t unbroadcast = 0;
+    int64_t journal_removed = 0;
+    int64_t journal_replayed = 0;
     int64_t nNow = GetTime();
 
-    try {
-        uint64_t version;
-        file >> version;
-        if (version != MEMPOOL_DUMP_VERSION) {
-            return false;
+    // A journal commit record carries the complete set of fee deltas, which
+    // replaces the per-transaction deltas and mapDeltas from mempool.dat.
+    if (journal.deltas) {
+        for (const auto& i : *journal.deltas) {
+            pool.PrioritiseTransaction(i.first, i.second);
         }
-        uint64_t num;
-        file >> num;
-        while (num) {
-            --num;
-            CTransactionRef tx;
-            int64_t nTime;
-            int64_t nFeeDelta;
-            file >> tx;
-            file >> nTime;
-            file >> nFeeDelta;
-
-            CAmount amountdelta = nFeeDelta;
-            if (amountdelta) {
-                pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
-            }
-            if (nTime > nNow - nExpiryTimeout) {
-                LOCK(cs_main);
-                const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
-                if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
-                    ++count;
+    }
+
+    const auto accept = [&](const CTransactionRef& tx, int64_t nTime, int64_t nFeeDelta) {
+        CAmount amountdelta = nFeeDelta;
+        if (amountdelta && !journal.deltas) {
+            pool.PrioritiseTransaction(tx->GetHash(), amountdelta);
+        }
+        if (nTime > nNow - nExpiryTimeout) {
+            LOCK(cs_main);
+            const auto& accepted = AcceptToMemoryPool(active_chainstate, tx, nTime, /*bypass_limits=*/false, /*test_accept=*/false);
+            if (accepted.m_result_type == MempoolAcceptResult::ResultType::VALID) {
+                ++count;
+            } else {
+                // mempool may contain the transaction already, e.g. from
+                // wallet(s) having loaded it while we were processing
+                // mempool transactions; consider these as valid, instead of
+                // failed, but mark them as 'already there'
+                if (pool.exists(GenTxid::Txid(tx->GetHash()))) {
+                    ++already_there;
                 } else {
-                    // mempool may contain the transaction already, e.g. from
-                    // wallet(s) having loaded it while we were processing
-                    // mempool transactions; consider these as valid, instead of
-                    // failed, but mark them as 'already there'
-                    if (pool.exists(GenTxid::Txid(tx->GetHash()))) {
-                        ++already_there;
-                    } else {
-                        ++failed;
-                    }
+                    ++failed;
                 }
-            } else {
-                ++expired;
             }
-            if (ShutdownRequested())
-                return false;
+        } else {
+            ++expired;
         }
-        std::map<uint256, CAmount> mapDeltas;
-        file >> mapDeltas;
+    };
 
-        for (const auto& i : mapDeltas) {
-            pool.PrioritiseTransaction(i.first, i.second);
-        }
+    std::set<uint256> unbroadcast_txids;
+    if (!file.IsNull()) {
+        try {
+            uint64_t version;
+            file >> version;
+            if (version != MEMPOOL_DUMP_VERSION) {
+                return false;
+            }
+            uint64_t num;
+            file >> num;
+            while (num) {
+                --num;
+                CTransactionRef tx;
+                int64_t nTime;
+                int64_t nFeeDelta;
+                file >> tx;
+                file >> nTime;
+                file >> nFeeDelta;
+
+                if (journal.removed.count(tx->GetHash())) {
+                    ++journal_removed;
+                } else {
+                    // Accept it here rather than at its journal position so
+                    // that descendants further down mempool.dat find it.
+                    journal.Consume(tx->GetHash());
+                    accept(tx, nTime, nFeeDelta);
+                }
+                if (ShutdownRequested())
+                    return false;
+            }
+            std::map<uint256, CAmount> mapDeltas;
+            file >> mapDeltas;
+
+            if (!journal.deltas) {
+                for (const auto& i : mapDeltas) {
+                    pool.PrioritiseTransaction(i.first, i.second);
+                }
+            }
 
-        std::set<uint256> unbroadcast_txids;
-        file >> unbroadcast_txids;
-        unbroadcast = unbroadcast_txids.size();
-        for (const auto& txid : unbroadcast_txids) {
-            // Ensure transactions were accepted to mempool then add to
-            // unbroadcast set.
-            if (pool.get(txid) != nullptr) pool.AddUnbroadcastTx(txid);
+            file >> unbroadcast_txids;
+        } catch (const std::exception& e) {
+            LogPrintf("Failed to deserialize mempool data on disk: %s. Continuing anyway.\n", e.what());
+            return false;
         }
-    } catch (const std::exception& e) {
-        LogPrintf("Failed to deserialize mempool data on disk: %s. Continuing anyway.\n", e.what());
-        return false;
+    }
+
+    for (const auto& entry : journal.added) {
+        if (!journal.IsPending(entry.tx->GetHash())) continue;
+        ++journal_replayed;
+        accept(entry.tx, entry.nTime, entry.nFeeDelta);
+        if (ShutdownRequested())
+            return false;
+    }
+
+    if (journal.unbroadcast_txids) unbroadcast_txids = std::move(*journal.unbroadcast_txids);
+    unbroadcast = unbroadcast_txids.size();
+    for (const auto& txid : unbroadcast_txids) {
+        // Ensure transactions were accepted to mempool then add to
+        // unbroadcast set.
+        if (pool.get(txid) != nullptr) pool.AddUnbroadcastTx(txid);
     }
 
     LogPrintf("Imported mempool transactions from disk: %i succeeded, %i failed, %i expired, %i already there, %i waiting for initial broadcast\n", count, failed, expired, already_there, unbroadcast);
+    if (has_journal) {
+        LogPrintf("Applied mempool journal: %i replayed, %i removed since last dump\n", journal_replayed, journal_removed);
+    }
     return true;
 }
 
@@ -48,12 +48,14 @@
 #include <libethashseal/GenesisInfo.h>
 #include <script/standard.h>
 #include <qtum/storageresults.h>
+#include <qtum/vmtrace.h>
 
 
 extern std::unique_ptr<QtumState> globalState;
 extern std::shared_ptr<dev::eth::SealEngineFace> globalSealEngine;
 extern bool fRecordLogOpcodes;
-extern bool fIsVMlogFile;
+//! Where contract executions are recorded with -record-log-opcodes
+extern std::unique_ptr<VMTrace> g_vm_trace;
 extern bool fGettingValuesDGP;
 
 struct EthTransactionParams;
@@ -320,6 +322,20 @@ MempoolAcceptResult AcceptToMemoryPool(CChainState& active_chainstate, const CTr
                                        int64_t accept_time, bool bypass_limits, bool test_accept)
     EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+/**
+ * Verify the scripts of a transaction before it is submitted to the mempool,
+ * without holding cs_main or the mempool lock while they run. Only the input
+ * lookup and the cache update take the locks, so independent transactions can
+ * be verified concurrently. On success the script execution cache remembers the
+ * transaction, and the serial AcceptToMemoryPool call skips script execution.
+ *
+ * @returns false if the scripts were not verified: the transaction is a contract
+ * transaction, already in the mempool, spends unknown inputs or has an invalid
+ * script. Acceptance then checks the scripts itself and reports the reason.
+ */
+bool PreVerifyTransactionScripts(CChainState& active_chainstate, const CTxMemPool& pool, const CTransaction& tx)
+    LOCKS_EXCLUDED(cs_main);
+
 /**
 * Validate (and maybe submit) a package to the mempool. See doc/policy/packages.md for full details
 * on package validation rules.
@@ -480,15 +496,63 @@ bool GetSpentCoinFromMainChain(const CBlockIndex* pforkPrev, COutPoint prevoutSt
 
 unsigned int GetContractScriptFlags(int nHeight, const Consensus::Params& consensusparams);
 
+/**
+ * Execute a contract call, or a contract creation when addrContract is null,
+ * on top of the chain tip without changing the state. The tip block is read
+ * once, so the call can be executed with several gas limits against the same
+ * block and state, as long as cs_main stays held.
+ */
+class ContractCallContext
+{
+public:
+    ContractCallContext(const dev::Address& addrContract, std::vector<unsigned char> opcode, CChainState& chainstate, const dev::Address& sender, CAmount nAmount) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    std::vector<ResultExecute> execute(uint64_t gasLimit) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    uint64_t getBlockGasLimit() const { return blockGasLimit; }
+
+private:
+    CChain& chain;
+    CBlock block;
+    CBlockIndex* pblockindex;
+    uint64_t blockGasLimit;
+    dev::Address addrContract;
+    std::vector<unsigned char> opcode;
+    dev::Address senderAddress;
+    CAmount nAmount;
+};
+
 std::vector<ResultExecute> CallContract(const dev::Address& addrContract, std::vector<unsigned char> opcode, CChainState& chainstate, const dev::Address& sender = dev::Address(), uint64_t gasLimit=0, CAmount nAmount=0);
 
+struct ContractGasEstimate
+{
+    //! Lowest gas limit the execution succeeds with
+    uint64_t gasLimit = 0;
+    //! Execution with the block gas limit
+    std::vector<ResultExecute> result;
+    //! Number of executions needed for the estimate
+    int executions = 0;
+    //! Whether the execution depends on the gas limit, so it was bisected
+    bool bisected = false;
+};
+
+/**
+ * Estimate the gas limit of a contract call. The call is executed once with
+ * the block gas limit, which gives the gas used before refunds. Only when the
+ * call fails with that much gas (e.g. because calls forward 63/64 of the
+ * remaining gas) is the gas limit bisected. Returns false if the call fails
+ * with the block gas limit.
+ */
+bool EstimateContractGas(ContractCallContext& context, ContractGasEstimate& estimate) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
 bool CheckOpSender(const CTransaction& tx, const CChainParams& chainparams, int nHeight);
 
 bool CheckSenderScript(const CCoinsViewCache& view, const CTransaction& tx);
 
 bool CheckMinGasPrice(std::vector<EthTransactionParams>& etps, const uint64_t& minGasPrice);
 
-void writeVMlog(const std::vector<ResultExecute>& res, CChain& chain, const CTransaction& tx = CTransaction(), const CBlock& block = CBlock());
+/** Record contract executions in g_vm_trace. The txid and block hash are null for executions outside a transaction or block. */
+void RecordVMTrace(const std::vector<ResultExecute>& res, int height, int64_t time, const uint256& txid = uint256(), const uint256& block_hash = uint256());
 
 std::string exceptedMessage(const dev::eth::TransactionException& excepted, const dev::bytes& output);
 
@@ -1225,8 +1289,8 @@ using FopenFn = std::function<FILE*(const fs::path&, const char*)>;
 /** Dump the mempool to disk. */
 bool DumpMempool(const CTxMemPool& pool, FopenFn mockable_fopen_function = fsbridge::fopen, bool skip_file_commit = false);
 
-/** Load the mempool from disk. */
-bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mockable_fopen_function = fsbridge::fopen);
+/** Load the mempool from disk, applying the mempool journal on top of it if use_journal is set. */
+bool LoadMempool(CTxMemPool& pool, CChainState& active_chainstate, FopenFn mockable_fopen_function = fsbridge::fopen, bool use_journal = false);
 
 //! Get transaction gas fee
 CAmount GetTxGasFee(const CMutableTransaction& tx, const CTxMemPool& mempool, CChainState& active_chainstate);
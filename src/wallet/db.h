@@ -14,6 +14,7 @@
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 
 struct bilingual_str;
@@ -146,6 +147,14 @@ public:
 
     virtual std::string Format() = 0;
 
+    /** Start grouping writes into a single database transaction. Groups may be
+     * nested; writes are committed when the outermost group ends.
+     * Databases that do not support grouping write through as usual. */
+    virtual void BeginWriteGroup() {}
+    /** End the write group started by the matching BeginWriteGroup().
+     * Returns false if the outermost group failed to commit its writes. */
+    virtual bool EndWriteGroup() { return true; }
+
     std::atomic<unsigned int> nUpdateCounter;
     unsigned int nLastSeen;
     unsigned int nLastFlushed;
@@ -155,6 +164,35 @@ public:
     virtual std::unique_ptr<DatabaseBatch> MakeBatch(bool flush_on_close = true) = 0;
 };
 
+/** RAII class that groups all writes made to a database during its lifetime
+ * into a single transaction, so that e.g. processing a block or refilling the
+ * keypool costs one commit instead of one per record. */
+class DatabaseWriteGroup
+{
+private:
+    WalletDatabase& m_database;
+    bool m_ended{false};
+
+public:
+    explicit DatabaseWriteGroup(WalletDatabase& database) : m_database(database) { m_database.BeginWriteGroup(); }
+    //! A group left without Commit(), e.g. by an exception, still ends here but can't report a failure.
+    ~DatabaseWriteGroup() { if (!m_ended) m_database.EndWriteGroup(); }
+
+    /** End the group, committing its writes if it is the outermost one.
+     * Throws if the writes could not be committed, like the other wallet
+     * write failures, rather than carrying on with records only in memory. */
+    void Commit()
+    {
+        m_ended = true;
+        if (!m_database.EndWriteGroup()) {
+            throw std::runtime_error(std::string(__func__) + ": committing the wallet write group failed");
+        }
+    }
+
+    DatabaseWriteGroup(const DatabaseWriteGroup&) = delete;
+    DatabaseWriteGroup& operator=(const DatabaseWriteGroup&) = delete;
+};
+
 /** RAII class that provides access to a DummyDatabase. Never fails. */
 class DummyBatch : public DatabaseBatch
 {
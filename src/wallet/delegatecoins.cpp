@@ -0,0 +1,109 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/delegatecoins.h>
+
+#include <primitives/block.h>
+#include <script/standard.h>
+
+namespace wallet {
+void DelegateCoinTracker::SetDelegators(const std::set<uint160>& delegators)
+{
+    for (auto it = m_delegators.begin(); it != m_delegators.end();) {
+        if (delegators.count(it->first)) {
+            ++it;
+            continue;
+        }
+        EraseCoins(it->first);
+        m_stale.erase(it->first);
+        it = m_delegators.erase(it);
+    }
+    for (const uint160& delegator : delegators) {
+        if (m_delegators.emplace(delegator, std::set<COutPoint>()).second) {
+            m_stale.insert(delegator);
+        }
+    }
+}
+
+void DelegateCoinTracker::SetCoins(const uint160& delegator, const std::vector<std::pair<COutPoint, Coin>>& coins)
+{
+    if (!IsTracked(delegator)) return;
+    EraseCoins(delegator);
+    for (const auto& [outpoint, coin] : coins) {
+        AddCoin(outpoint, coin);
+    }
+}
+
+void DelegateCoinTracker::AddCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    const auto delegator = m_delegators.find(coin.delegator);
+    if (delegator == m_delegators.end()) return;
+
+    auto [it, inserted] = m_coins.emplace(outpoint, coin);
+    if (!inserted) {
+        m_by_value.erase({it->second.value, outpoint});
+        m_delegators[it->second.delegator].erase(outpoint);
+        it->second = coin;
+    }
+    delegator->second.insert(outpoint);
+    m_by_value.emplace(coin.value, outpoint);
+}
+
+void DelegateCoinTracker::RemoveCoin(const COutPoint& outpoint)
+{
+    const auto it = m_coins.find(outpoint);
+    if (it == m_coins.end()) return;
+    m_by_value.erase({it->second.value, outpoint});
+    m_delegators[it->second.delegator].erase(outpoint);
+    m_coins.erase(it);
+}
+
+void DelegateCoinTracker::BlockConnected(const CBlock& block, int height)
+{
+    if (m_delegators.empty()) return;
+
+    for (const CTransactionRef& tx : block.vtx) {
+        if (!tx->IsCoinBase()) {
+            for (const CTxIn& txin : tx->vin) {
+                RemoveCoin(txin.prevout);
+            }
+        }
+        // Match outputs to delegators the way the address index keys them
+        for (uint32_t n = 0; n < tx->vout.size(); n++) {
+            const COutPoint outpoint(tx->GetHash(), n);
+            CTxDestination dest;
+            if (!ExtractDestination(outpoint, tx->vout[n].scriptPubKey, dest)) continue;
+            const PKHash* keyid = std::get_if<PKHash>(&dest);
+            if (!keyid) continue;
+            AddCoin(outpoint, {ToKeyID(*keyid), tx->vout[n].nValue, height});
+        }
+    }
+}
+
+void DelegateCoinTracker::BlockDisconnected()
+{
+    for (const auto& [delegator, outpoints] : m_delegators) {
+        m_stale.insert(delegator);
+    }
+}
+
+std::set<uint160> DelegateCoinTracker::TakeStaleDelegators()
+{
+    std::set<uint160> stale;
+    stale.swap(m_stale);
+    return stale;
+}
+
+void DelegateCoinTracker::EraseCoins(const uint160& delegator)
+{
+    const auto it = m_delegators.find(delegator);
+    if (it == m_delegators.end()) return;
+    for (const COutPoint& outpoint : it->second) {
+        const auto coin = m_coins.find(outpoint);
+        m_by_value.erase({coin->second.value, outpoint});
+        m_coins.erase(coin);
+    }
+    it->second.clear();
+}
+} // namespace wallet
@@ -0,0 +1,75 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_DELEGATECOINS_H
+#define QTUM_WALLET_DELEGATECOINS_H
+
+#include <consensus/amount.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+class CBlock;
+
+namespace wallet {
+/**
+ * The unspent outputs of the addresses that delegate to the super stakers of
+ * the wallet, ordered by decreasing value as the staker tries them.
+ *
+ * The coins of a delegator are loaded from the address index once, when the
+ * delegator is first seen, and then kept up to date from the blocks the
+ * wallet connects. A disconnected block marks every delegator stale, so their
+ * coins are loaded again from the index.
+ */
+class DelegateCoinTracker
+{
+public:
+    struct Coin {
+        uint160 delegator;
+        CAmount value;
+        //! Height of the block that created the coin
+        int height;
+    };
+    using CoinsByValue = std::set<std::pair<CAmount, COutPoint>, std::greater<std::pair<CAmount, COutPoint>>>;
+
+    /** Track exactly these delegators. Delegators that were not tracked yet are stale. */
+    void SetDelegators(const std::set<uint160>& delegators);
+    /** Replace the coins of a delegator with the ones loaded from the address index. */
+    void SetCoins(const uint160& delegator, const std::vector<std::pair<COutPoint, Coin>>& coins);
+    /** Add or update a coin of a tracked delegator. */
+    void AddCoin(const COutPoint& outpoint, const Coin& coin);
+    void RemoveCoin(const COutPoint& outpoint);
+
+    /** Remove the coins spent by a connected block and add the ones it pays to tracked delegators. */
+    void BlockConnected(const CBlock& block, int height);
+    /** Load the coins of all delegators again, as a disconnected block may revive spent coins. */
+    void BlockDisconnected();
+
+    bool IsTracked(const uint160& delegator) const { return m_delegators.count(delegator) > 0; }
+    /** Return the delegators whose coins have to be loaded from the address index. */
+    std::set<uint160> TakeStaleDelegators();
+    /** Load the coins of a tracked delegator again on next use. */
+    void MarkStale(const uint160& delegator) { if (IsTracked(delegator)) m_stale.insert(delegator); }
+
+    const CoinsByValue& GetCoinsByValue() const { return m_by_value; }
+    const Coin& GetCoin(const COutPoint& outpoint) const { return m_coins.at(outpoint); }
+    size_t CoinCount() const { return m_coins.size(); }
+
+private:
+    void EraseCoins(const uint160& delegator);
+
+    //! Outpoints of the coins of each tracked delegator
+    std::map<uint160, std::set<COutPoint>> m_delegators;
+    std::map<COutPoint, Coin> m_coins;
+    CoinsByValue m_by_value;
+    std::set<uint160> m_stale;
+};
+} // namespace wallet
+
+#endif // QTUM_WALLET_DELEGATECOINS_H
@@ -0,0 +1,59 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/dirtytxs.h>
+
+#include <wallet/wallet.h>
+
+namespace wallet {
+std::set<uint256> DirtyTxTracker::TakeDirtyTxs()
+{
+    std::set<uint256> dirty_txs;
+    dirty_txs.swap(m_dirty_txs);
+    return dirty_txs;
+}
+
+void DirtyTxTracker::Clear()
+{
+    ClearCoins();
+    m_dirty_txs.clear();
+    m_stale = false;
+}
+
+void UpdateFromWallet(const CWallet& wallet, DirtyTxTracker& tracker, const std::function<void(const CWalletTx& wtx, unsigned int n)>& update_coin)
+{
+    AssertLockHeld(wallet.cs_wallet);
+
+    if (tracker.IsStale()) {
+        tracker.Clear();
+        for (const auto& [wtxid, wtx] : wallet.mapWallet) {
+            for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+                update_coin(wtx, i);
+            }
+        }
+        return;
+    }
+
+    for (const uint256& hash : tracker.TakeDirtyTxs()) {
+        auto it = wallet.mapWallet.find(hash);
+        if (it == wallet.mapWallet.end()) {
+            tracker.RemoveTx(hash);
+            continue;
+        }
+
+        const CWalletTx& wtx = it->second;
+        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
+            update_coin(wtx, i);
+        }
+
+        // The coins the transaction spends are spent or released with it
+        for (const CTxIn& txin : wtx.tx->vin) {
+            auto prev = wallet.mapWallet.find(txin.prevout.hash);
+            if (prev != wallet.mapWallet.end() && txin.prevout.n < prev->second.tx->vout.size()) {
+                update_coin(prev->second, txin.prevout.n);
+            }
+        }
+    }
+}
+} // namespace wallet
@@ -0,0 +1,61 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_DIRTYTXS_H
+#define QTUM_WALLET_DIRTYTXS_H
+
+#include <uint256.h>
+
+#include <functional>
+#include <set>
+
+namespace wallet {
+class CWallet;
+class CWalletTx;
+
+/**
+ * Base of the sets of coins that are derived from the wallet transactions,
+ * like the StakeWeightTracker and the UtxoPool.
+ *
+ * Such a set is updated from the transactions that changed since it was last
+ * used, and rebuilt from the whole wallet when a change affects every coin,
+ * see UpdateFromWallet().
+ */
+class DirtyTxTracker
+{
+public:
+    virtual ~DirtyTxTracker() = default;
+
+    /** Remember that a transaction changed, so its outputs and inputs are re-evaluated. */
+    void MarkTxDirty(const uint256& hash) { if (!m_stale) m_dirty_txs.insert(hash); }
+    /** Forget all coins, so the set is rebuilt from the wallet on next use. */
+    void MarkStale() { m_stale = true; m_dirty_txs.clear(); }
+    bool IsStale() const { return m_stale; }
+    /** Return the transactions changed since the last call. */
+    std::set<uint256> TakeDirtyTxs();
+
+    /** Remove all coins before rebuilding the set from the wallet. */
+    void Clear();
+    /** Remove all coins created by a transaction. */
+    virtual void RemoveTx(const uint256& hash) = 0;
+
+protected:
+    virtual void ClearCoins() = 0;
+
+private:
+    std::set<uint256> m_dirty_txs;
+    bool m_stale{true};
+};
+
+/**
+ * Bring a set of coins up to date with the wallet. A stale set is rebuilt by
+ * calling update_coin for every wallet output; otherwise it is called for the
+ * outputs of the changed transactions and the outputs they spend, and the
+ * coins of transactions no longer in the wallet are removed.
+ * Requires wallet.cs_wallet.
+ */
+void UpdateFromWallet(const CWallet& wallet, DirtyTxTracker& tracker, const std::function<void(const CWalletTx& wtx, unsigned int n)>& update_coin);
+} // namespace wallet
+
+#endif // QTUM_WALLET_DIRTYTXS_H
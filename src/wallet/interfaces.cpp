@@ -1266,6 +1266,14 @@ public:
     {
         return m_wallet->CleanTokenTxEntries();
     }
+    bool getTokenBalance(const uint256& id, std::string& balance) override
+    {
+        return m_wallet->GetTokenBalance(id, balance);
+    }
+    bool setTokenBalance(const uint256& id, const std::string& balance, int height) override
+    {
+        return m_wallet->SetTokenBalance(id, balance, height);
+    }
     void setEnabledStaking(bool enabled) override
     {
         m_wallet->m_enabled_staking = enabled;
@@ -362,6 +362,53 @@ Balance GetBalance(const CWallet& wallet, const int min_depth, bool avoid_reuse)
     return ret;
 }
 
+std::shared_ptr<const BalanceSnapshot> PublishBalanceSnapshot(const CWallet& wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    const uint64_t generation{wallet.m_balance_generation};
+    {
+        LOCK(wallet.m_balance_snapshot_mutex);
+        if (wallet.m_balance_snapshot && wallet.m_balance_snapshot->generation == generation) {
+            return wallet.m_balance_snapshot;
+        }
+    }
+
+    auto snapshot = std::make_shared<BalanceSnapshot>();
+    snapshot->generation = generation;
+    snapshot->block_hash = wallet.GetLastBlockHash();
+    snapshot->block_height = wallet.GetLastBlockHeight();
+    snapshot->balance = GetBalance(wallet);
+    if (wallet.IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE)) {
+        snapshot->full_balance = GetBalance(wallet, 0, false);
+    }
+    auto spk_man = wallet.GetLegacyScriptPubKeyMan();
+    snapshot->have_watch_only = spk_man && spk_man->HaveWatchOnly();
+
+    LOCK(wallet.m_balance_snapshot_mutex);
+    wallet.m_balance_snapshot = snapshot;
+    return snapshot;
+}
+
+void RefreshBalanceSnapshot(const CWallet& wallet)
+{
+    LOCK(wallet.cs_wallet);
+    if (WITH_LOCK(wallet.m_balance_snapshot_mutex, return wallet.m_balance_snapshot == nullptr)) return;
+    PublishBalanceSnapshot(wallet);
+}
+
+std::shared_ptr<const BalanceSnapshot> GetBalanceSnapshot(const CWallet& wallet)
+{
+    auto snapshot = WITH_LOCK(wallet.m_balance_snapshot_mutex, return wallet.m_balance_snapshot);
+    if (snapshot && snapshot->generation == wallet.m_balance_generation) return snapshot;
+    // A rescan changes the wallet with every block it scans and may hold it for
+    // long. Serve the balances as of the last completed wallet event meanwhile;
+    // the wallet's own sends and abandons republish the snapshot as they commit.
+    if (snapshot && wallet.IsScanning()) return snapshot;
+
+    LOCK(wallet.cs_wallet);
+    return PublishBalanceSnapshot(wallet);
+}
+
 std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet)
 {
     std::map<CTxDestination, CAmount> balances;
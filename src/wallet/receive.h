@@ -10,6 +10,9 @@
 #include <wallet/transaction.h>
 #include <wallet/wallet.h>
 
+#include <memory>
+#include <optional>
+
 namespace wallet {
 isminetype InputIsMine(const CWallet& wallet, const CTxIn& txin) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
 
@@ -63,6 +66,36 @@ struct Balance {
 };
 Balance GetBalance(const CWallet& wallet, int min_depth = 0, bool avoid_reuse = true);
 
+/** The wallet's default balances at one point in time. Snapshots are immutable
+ * once published, so they can be read without holding cs_wallet.
+ *
+ * Only the balances are published. Transaction history and the coins the
+ * staker selects hand out CWalletTx pointers into mapWallet, so they are
+ * still read under cs_wallet. */
+struct BalanceSnapshot {
+    //! CWallet::m_balance_generation the balances were computed at
+    uint64_t generation{0};
+    uint256 block_hash;
+    int block_height{-1};
+    //! GetBalance(wallet), i.e. with min_depth 0 and avoid_reuse
+    Balance balance;
+    //! GetBalance(wallet, 0, false), only computed for wallets with the avoid_reuse flag
+    std::optional<Balance> full_balance;
+    bool have_watch_only{false};
+};
+
+/** Compute and publish the balances if they changed since the last published snapshot */
+std::shared_ptr<const BalanceSnapshot> PublishBalanceSnapshot(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+/** Republish the balances at the end of a wallet event, if a snapshot was ever requested */
+void RefreshBalanceSnapshot(const CWallet& wallet);
+/**
+ * Return the wallet's current balances, taking cs_wallet only when the published
+ * snapshot is out of date. While a rescan is in progress the last published
+ * snapshot is returned without waiting for the wallet; transactions committed
+ * or abandoned by the wallet itself republish it, so they are reflected there.
+ */
+std::shared_ptr<const BalanceSnapshot> GetBalanceSnapshot(const CWallet& wallet);
+
 std::map<CTxDestination, CAmount> GetAddressBalances(const CWallet& wallet);
 std::set<std::set<CTxDestination>> GetAddressGroupings(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
 } // namespace wallet
@@ -52,10 +52,18 @@ static CAmount GetReceived(const CWallet& wallet, const UniValue& params, bool b
         throw JSONRPCError(RPC_INVALID_PARAMETER, "include_immature_coinbase is incompatible with deprecated exclude_coinbase");
     }
 
+    // Only the transactions paying to the addresses are tallied
+    std::set<uint256> txids;
+    for (const CTxDestination& dest : address_set) {
+        for (const uint256& txid : wallet.m_tx_index.GetTxsPayingTo(dest)) {
+            txids.insert(txid);
+        }
+    }
+
     // Tally
     CAmount amount = 0;
-    for (const std::pair<const uint256, CWalletTx>& wtx_pair : wallet.mapWallet) {
-        const CWalletTx& wtx = wtx_pair.second;
+    for (const uint256& txid : txids) {
+        const CWalletTx& wtx = wallet.mapWallet.at(txid);
         int depth{wallet.GetTxDepthInMainChain(wtx)};
         if (depth < min_depth
             // Coinbase with less than 1 confirmation is no longer in the main chain
@@ -191,8 +199,6 @@ RPCHelpMan getbalance()
     // the user could have gotten from another RPC command prior to now
     pwallet->BlockUntilSyncedToCurrentChain();
 
-    LOCK(pwallet->cs_wallet);
-
     const UniValue& dummy_value = request.params[0];
     if (!dummy_value.isNull() && dummy_value.get_str() != "*") {
         throw JSONRPCError(RPC_METHOD_DEPRECATED, "dummy first argument must be excluded or set to \"*\".");
@@ -207,7 +213,14 @@ RPCHelpMan getbalance()
 
     bool avoid_reuse = GetAvoidReuseFlag(*pwallet, request.params[3]);
 
-    const auto bal = GetBalance(*pwallet, min_depth, avoid_reuse);
+    Balance bal;
+    if (min_depth == 0) {
+        // The published balances are computed with min_depth 0
+        const auto snapshot = GetBalanceSnapshot(*pwallet);
+        bal = avoid_reuse || !snapshot->full_balance ? snapshot->balance : *snapshot->full_balance;
+    } else {
+        bal = GetBalance(*pwallet, min_depth, avoid_reuse);
+    }
 
     return ValueFromAmount(bal.m_mine_trusted + (include_watchonly ? bal.m_watchonly_trusted : 0));
 },
@@ -230,9 +243,7 @@ RPCHelpMan getunconfirmedbalance()
     // the user could have gotten from another RPC command prior to now
     pwallet->BlockUntilSyncedToCurrentChain();
 
-    LOCK(pwallet->cs_wallet);
-
-    return ValueFromAmount(GetBalance(*pwallet).m_mine_untrusted_pending);
+    return ValueFromAmount(GetBalanceSnapshot(*pwallet)->balance.m_mine_untrusted_pending);
 },
     };
 }
@@ -469,9 +480,8 @@ RPCHelpMan getbalances()
     // the user could have gotten from another RPC command prior to now
     wallet.BlockUntilSyncedToCurrentChain();
 
-    LOCK(wallet.cs_wallet);
-
-    const auto bal = GetBalance(wallet);
+    const auto snapshot = GetBalanceSnapshot(wallet);
+    const Balance& bal = snapshot->balance;
     UniValue balances{UniValue::VOBJ};
     {
         UniValue balances_mine{UniValue::VOBJ};
@@ -479,16 +489,15 @@ RPCHelpMan getbalances()
         balances_mine.pushKV("untrusted_pending", ValueFromAmount(bal.m_mine_untrusted_pending));
         balances_mine.pushKV("immature", ValueFromAmount(bal.m_mine_immature));
         balances_mine.pushKV("stake", ValueFromAmount(bal.m_mine_stake));
-        if (wallet.IsWalletFlagSet(WALLET_FLAG_AVOID_REUSE)) {
+        if (snapshot->full_balance) {
             // If the AVOID_REUSE flag is set, bal has been set to just the un-reused address balance. Get
             // the total balance, and then subtract bal to get the reused address balance.
-            const auto full_bal = GetBalance(wallet, 0, false);
+            const Balance& full_bal = *snapshot->full_balance;
             balances_mine.pushKV("used", ValueFromAmount(full_bal.m_mine_trusted + full_bal.m_mine_untrusted_pending - bal.m_mine_trusted - bal.m_mine_untrusted_pending));
         }
         balances.pushKV("mine", balances_mine);
     }
-    auto spk_man = wallet.GetLegacyScriptPubKeyMan();
-    if (spk_man && spk_man->HaveWatchOnly()) {
+    if (snapshot->have_watch_only) {
         UniValue balances_watchonly{UniValue::VOBJ};
         balances_watchonly.pushKV("trusted", ValueFromAmount(bal.m_watchonly_trusted));
         balances_watchonly.pushKV("untrusted_pending", ValueFromAmount(bal.m_watchonly_untrusted_pending));
@@ -105,18 +105,16 @@ static UniValue ListReceived(const CWallet& wallet, const UniValue& params, cons
 
     // Tally
     std::map<CTxDestination, tallyitem> mapTally;
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : wallet.mapWallet) {
-        const CWalletTx& wtx = pairWtx.second;
-
+    auto tally_tx = [&](const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet) {
         int nDepth = wallet.GetTxDepthInMainChain(wtx);
         if (nDepth < nMinDepth)
-            continue;
+            return;
 
         // Coinbase with less than 1 confirmation is no longer in the main chain
         if (((wtx.IsCoinBase() || wtx.IsCoinStake()) && (nDepth < 1 || !include_coinbase))
             || (wallet.IsTxImmature(wtx) && !include_immature_coinbase))
         {
-            continue;
+            return;
         }
 
         for (const CTxOut& txout : wtx.tx->vout)
@@ -140,6 +138,15 @@ static UniValue ListReceived(const CWallet& wallet, const UniValue& params, cons
             if (mine & ISMINE_WATCH_ONLY)
                 item.fIsWatchonly = true;
         }
+    };
+    if (has_filtered_address) {
+        for (const uint256& txid : wallet.m_tx_index.GetTxsPayingTo(filtered_address)) {
+            tally_tx(wallet.mapWallet.at(txid));
+        }
+    } else {
+        for (const std::pair<const uint256, CWalletTx>& pairWtx : wallet.mapWallet) {
+            tally_tx(pairWtx.second);
+        }
     }
 
     // Reply
@@ -538,33 +545,49 @@ RPCHelpMan listtransactions()
     if (nFrom < 0)
         throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative from");
 
-    UniValue ret(UniValue::VARR);
-
-    {
-        LOCK(pwallet->cs_wallet);
+    LOCK(pwallet->cs_wallet);
 
-        const CWallet::TxItems & txOrdered = pwallet->wtxOrdered;
+    const CWallet::TxItems & txOrdered = pwallet->wtxOrdered;
 
-        // iterate backwards until we have nCount items to return:
-        for (CWallet::TxItems::const_reverse_iterator it = txOrdered.rbegin(); it != txOrdered.rend(); ++it)
-        {
-            CWalletTx *const pwtx = (*it).second;
-            ListTransactions(*pwallet, *pwtx, 0, true, ret, filter, filter_label);
-            if ((int)ret.size() >= (nCount+nFrom)) break;
-        }
+    // iterate backwards until we have nCount items to return, only counting them
+    int nTotal = 0;
+    CWallet::TxItems::const_iterator oldest = txOrdered.end();
+    for (CWallet::TxItems::const_reverse_iterator it = txOrdered.rbegin(); it != txOrdered.rend(); ++it)
+    {
+        UniValue entries(UniValue::VARR);
+        ListTransactions(*pwallet, *it->second, 0, true, entries, filter, filter_label);
+        nTotal += entries.size();
+        oldest = std::prev(it.base());
+        if (nTotal >= (nCount+nFrom)) break;
     }
 
-    // ret is newest to oldest
-
-    if (nFrom > (int)ret.size())
-        nFrom = ret.size();
-    if ((nFrom + nCount) > (int)ret.size())
-        nCount = ret.size() - nFrom;
-
-    const std::vector<UniValue>& txs = ret.getValues();
-    UniValue result{UniValue::VARR};
-    result.push_backV({ txs.rend() - nFrom - nCount, txs.rend() - nFrom }); // Return oldest to newest
-    return result;
+    // the entries are counted newest to oldest
+
+    if (nFrom > nTotal)
+        nFrom = nTotal;
+    if ((nFrom + nCount) > nTotal)
+        nCount = nTotal - nFrom;
+
+    // Stream the page oldest to newest while walking forward again, without holding it in memory
+    return StreamResult(request, [&](JSONStreamWriter& writer) EXCLUSIVE_LOCKS_REQUIRED(pwallet->cs_wallet) {
+        int nSkip = nTotal - nFrom - nCount;
+        int nWritten = 0;
+        writer.BeginArray();
+        for (auto it = oldest; it != txOrdered.end() && nWritten < nCount; ++it) {
+            UniValue entries(UniValue::VARR);
+            ListTransactions(*pwallet, *it->second, 0, true, entries, filter, filter_label);
+            const std::vector<UniValue>& values = entries.getValues();
+            for (auto entry = values.rbegin(); entry != values.rend() && nWritten < nCount; ++entry) {
+                if (nSkip > 0) {
+                    --nSkip;
+                    continue;
+                }
+                writer.Push(*entry);
+                ++nWritten;
+            }
+        }
+        writer.EndArray();
+    });
 },
     };
 }
@@ -666,11 +689,14 @@ RPCHelpMan listsinceblock()
 
     UniValue transactions(UniValue::VARR);
 
-    for (const std::pair<const uint256, CWalletTx>& pairWtx : wallet.mapWallet) {
-        const CWalletTx& tx = pairWtx.second;
-
-        if (depth == -1 || abs(wallet.GetTxDepthInMainChain(tx)) < depth) {
-            ListTransactions(wallet, tx, 0, true, transactions, filter, nullptr /* filter_label */);
+    if (depth == -1) {
+        for (const std::pair<const uint256, CWalletTx>& pairWtx : wallet.mapWallet) {
+            ListTransactions(wallet, pairWtx.second, 0, true, transactions, filter, nullptr /* filter_label */);
+        }
+    } else {
+        // The transactions with abs(depth) < depth are those not in a block, or in (or conflicting with) a block above height
+        for (const uint256& txid : wallet.m_tx_index.GetTxsAbove(*height)) {
+            ListTransactions(wallet, wallet.mapWallet.at(txid), 0, true, transactions, filter, nullptr /* filter_label */);
         }
     }
 
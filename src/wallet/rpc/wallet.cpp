@@ -485,6 +485,9 @@ static RPCHelpMan getwalletinfo()
                         {
                             {RPCResult::Type::NUM, "duration", "elapsed seconds since scan start"},
                             {RPCResult::Type::NUM, "progress", "scanning progress percentage [0.0, 1.0]"},
+                            {RPCResult::Type::NUM, "blocks", "number of blocks scanned so far"},
+                            {RPCResult::Type::NUM, "filtered_blocks", "number of scanned blocks skipped because their block filter did not match the wallet"},
+                            {RPCResult::Type::NUM, "blocks_per_second", "average scanning throughput"},
                         }},
                         {RPCResult::Type::BOOL, "descriptors", "whether this wallet uses descriptors for scriptPubKey management"},
                         {RPCResult::Type::BOOL, "external_signer", "whether this wallet is configured to use an external signer such as a hardware wallet"},
@@ -556,6 +559,11 @@ static RPCHelpMan getwalletinfo()
         UniValue scanning(UniValue::VOBJ);
         scanning.pushKV("duration", pwallet->ScanningDuration() / 1000);
         scanning.pushKV("progress", pwallet->ScanningProgress());
+        const int64_t scanning_blocks = pwallet->ScanningBlocks();
+        const int64_t scanning_duration = pwallet->ScanningDuration();
+        scanning.pushKV("blocks", scanning_blocks);
+        scanning.pushKV("filtered_blocks", pwallet->ScanningFilteredBlocks());
+        scanning.pushKV("blocks_per_second", scanning_duration > 0 ? scanning_blocks * 1000.0 / scanning_duration : 0.0);
         obj.pushKV("scanning", scanning);
     } else {
         obj.pushKV("scanning", false);
@@ -15,7 +15,9 @@
 #include <util/translation.h>
 #include <wallet/scriptpubkeyman.h>
 
+#include <algorithm>
 #include <optional>
+#include <thread>
 
 namespace wallet {
 //! Value for the first BIP 32 hardened derivation. Can be used as a bit mask and as a value. See BIP 32 for more details.
@@ -1805,6 +1807,57 @@ std::map<CKeyID, CKey> DescriptorScriptPubKeyMan::GetKeys() const
     return m_map_keys;
 }
 
+namespace {
+//! The scripts and keys of one index of a ranged descriptor
+struct ExpandedIndex
+{
+    std::vector<CScript> scripts;
+    FlatSigningProvider keys;
+    //! Items to add to the descriptor cache, set when the index could not be expanded from it
+    DescriptorCache new_cache;
+    bool expanded{false};
+};
+} // namespace
+
+//! Minimum number of indexes derived by each thread of ExpandDescriptorRange()
+static constexpr size_t MIN_INDEXES_PER_THREAD{250};
+//! Number of indexes expanded at once by TopUp() and SetCache(), bounding the memory used
+static constexpr int32_t EXPAND_BATCH_SIZE{10000};
+
+/**
+ * Expand the indexes [start, start + expanded.size()) of a descriptor, from the cache
+ * if possible and otherwise from the keys in provider, if any. Each index is derived
+ * from the cached parent xpub independently of the others, so large ranges are spread
+ * over threads.
+ */
+static void ExpandDescriptorRange(const Descriptor& descriptor, const DescriptorCache& cache, const SigningProvider* provider, int32_t start, std::vector<ExpandedIndex>& expanded)
+{
+    const auto expand = [&](size_t from, size_t to) {
+        for (size_t n = from; n < to; ++n) {
+            ExpandedIndex& index = expanded[n];
+            const int pos = start + n;
+            index.expanded = descriptor.ExpandFromCache(pos, cache, index.scripts, index.keys) ||
+                             (provider && descriptor.Expand(pos, *provider, index.scripts, index.keys, &index.new_cache));
+        }
+    };
+
+    const size_t num_threads = std::min<size_t>(GetNumCores(), expanded.size() / MIN_INDEXES_PER_THREAD);
+    if (num_threads < 2) {
+        expand(0, expanded.size());
+        return;
+    }
+    std::vector<std::thread> threads;
+    const size_t chunk = expanded.size() / num_threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        const size_t from = t * chunk;
+        const size_t to = t + 1 == num_threads ? expanded.size() : from + chunk;
+        threads.emplace_back(expand, from, to);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
 bool DescriptorScriptPubKeyMan::TopUp(unsigned int size)
 {
     LOCK(cs_desc_man);
@@ -1830,33 +1883,38 @@ bool DescriptorScriptPubKeyMan::TopUp(unsigned int size)
 
     WalletBatch batch(m_storage.GetDatabase());
     uint256 id = GetID();
-    for (int32_t i = m_max_cached_index + 1; i < new_range_end; ++i) {
-        FlatSigningProvider out_keys;
-        std::vector<CScript> scripts_temp;
-        DescriptorCache temp_cache;
-        // Maybe we have a cached xpub and we can expand from the cache first
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
-            if (!m_wallet_descriptor.descriptor->Expand(i, provider, scripts_temp, out_keys, &temp_cache)) return false;
-        }
-        // Add all of the scriptPubKeys to the scriptPubKey set
-        for (const CScript& script : scripts_temp) {
-            m_map_script_pub_keys[script] = i;
-        }
-        for (const auto& pk_pair : out_keys.pubkeys) {
-            const CPubKey& pubkey = pk_pair.second;
-            if (m_map_pubkeys.count(pubkey) != 0) {
-                // We don't need to give an error here.
-                // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
-                continue;
+    const int32_t first_index = m_max_cached_index + 1;
+    for (int32_t start = first_index; start < new_range_end;) {
+        // Expand the first index on its own, as it may cache the derivation parent
+        // that the other indexes are then derived from
+        const int32_t count = start == first_index ? 1 : std::min(EXPAND_BATCH_SIZE, new_range_end - start);
+        std::vector<ExpandedIndex> expanded(count);
+        ExpandDescriptorRange(*m_wallet_descriptor.descriptor, m_wallet_descriptor.cache, &provider, start, expanded);
+        for (int32_t n = 0; n < count; ++n) {
+            const int32_t i = start + n;
+            const ExpandedIndex& index = expanded[n];
+            if (!index.expanded) return false;
+            // Add all of the scriptPubKeys to the scriptPubKey set
+            for (const CScript& script : index.scripts) {
+                m_map_script_pub_keys[script] = i;
             }
-            m_map_pubkeys[pubkey] = i;
-        }
-        // Merge and write the cache
-        DescriptorCache new_items = m_wallet_descriptor.cache.MergeAndDiff(temp_cache);
-        if (!batch.WriteDescriptorCacheItems(id, new_items)) {
-            throw std::runtime_error(std::string(__func__) + ": writing cache items failed");
+            for (const auto& pk_pair : index.keys.pubkeys) {
+                const CPubKey& pubkey = pk_pair.second;
+                if (m_map_pubkeys.count(pubkey) != 0) {
+                    // We don't need to give an error here.
+                    // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
+                    continue;
+                }
+                m_map_pubkeys[pubkey] = i;
+            }
+            // Merge and write the cache
+            DescriptorCache new_items = m_wallet_descriptor.cache.MergeAndDiff(index.new_cache);
+            if (!batch.WriteDescriptorCacheItems(id, new_items)) {
+                throw std::runtime_error(std::string(__func__) + ": writing cache items failed");
+            }
+            m_max_cached_index++;
         }
-        m_max_cached_index++;
+        start += count;
     }
     m_wallet_descriptor.range_end = new_range_end;
     batch.WriteDescriptor(GetID(), m_wallet_descriptor);
@@ -2243,29 +2301,35 @@ void DescriptorScriptPubKeyMan::SetCache(const DescriptorCache& cache)
 {
     LOCK(cs_desc_man);
     m_wallet_descriptor.cache = cache;
-    for (int32_t i = m_wallet_descriptor.range_start; i < m_wallet_descriptor.range_end; ++i) {
-        FlatSigningProvider out_keys;
-        std::vector<CScript> scripts_temp;
-        if (!m_wallet_descriptor.descriptor->ExpandFromCache(i, m_wallet_descriptor.cache, scripts_temp, out_keys)) {
-            throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
-        }
-        // Add all of the scriptPubKeys to the scriptPubKey set
-        for (const CScript& script : scripts_temp) {
-            if (m_map_script_pub_keys.count(script) != 0) {
-                throw std::runtime_error(strprintf("Error: Already loaded script at index %d as being at index %d", i, m_map_script_pub_keys[script]));
+    const int32_t range_end = m_wallet_descriptor.range_end;
+    m_map_script_pub_keys.reserve(m_map_script_pub_keys.size() + std::max(range_end - m_wallet_descriptor.range_start, 0));
+    for (int32_t start = m_wallet_descriptor.range_start; start < range_end; start += EXPAND_BATCH_SIZE) {
+        std::vector<ExpandedIndex> expanded(std::min(EXPAND_BATCH_SIZE, range_end - start));
+        ExpandDescriptorRange(*m_wallet_descriptor.descriptor, m_wallet_descriptor.cache, /*provider=*/nullptr, start, expanded);
+        for (size_t n = 0; n < expanded.size(); ++n) {
+            const int32_t i = start + n;
+            const ExpandedIndex& index = expanded[n];
+            if (!index.expanded) {
+                throw std::runtime_error("Error: Unable to expand wallet descriptor from cache");
+            }
+            // Add all of the scriptPubKeys to the scriptPubKey set
+            for (const CScript& script : index.scripts) {
+                if (m_map_script_pub_keys.count(script) != 0) {
+                    throw std::runtime_error(strprintf("Error: Already loaded script at index %d as being at index %d", i, m_map_script_pub_keys[script]));
+                }
+                m_map_script_pub_keys[script] = i;
             }
-            m_map_script_pub_keys[script] = i;
-        }
-        for (const auto& pk_pair : out_keys.pubkeys) {
-            const CPubKey& pubkey = pk_pair.second;
-            if (m_map_pubkeys.count(pubkey) != 0) {
-                // We don't need to give an error here.
-                // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
-                continue;
+            for (const auto& pk_pair : index.keys.pubkeys) {
+                const CPubKey& pubkey = pk_pair.second;
+                if (m_map_pubkeys.count(pubkey) != 0) {
+                    // We don't need to give an error here.
+                    // It doesn't matter which of many valid indexes the pubkey has, we just need an index where we can derive it and it's private key
+                    continue;
+                }
+                m_map_pubkeys[pubkey] = i;
             }
-            m_map_pubkeys[pubkey] = i;
+            m_max_cached_index++;
         }
-        m_max_cached_index++;
     }
 }
 
@@ -2307,18 +2371,26 @@ const WalletDescriptor DescriptorScriptPubKeyMan::GetWalletDescriptor() const
     return m_wallet_descriptor;
 }
 
-const std::vector<CScript> DescriptorScriptPubKeyMan::GetScriptPubKeys() const
+const std::vector<CScript> DescriptorScriptPubKeyMan::GetScriptPubKeys(int32_t minimum_index) const
 {
     LOCK(cs_desc_man);
     std::vector<CScript> script_pub_keys;
     script_pub_keys.reserve(m_map_script_pub_keys.size());
 
     for (auto const& script_pub_key: m_map_script_pub_keys) {
-        script_pub_keys.push_back(script_pub_key.first);
+        if (script_pub_key.second >= minimum_index) script_pub_keys.push_back(script_pub_key.first);
     }
+    // Keep the scripts in a stable order, callers may pick the first one
+    std::sort(script_pub_keys.begin(), script_pub_keys.end());
     return script_pub_keys;
 }
 
+int32_t DescriptorScriptPubKeyMan::GetEndRange() const
+{
+    LOCK(cs_desc_man);
+    return m_max_cached_index + 1;
+}
+
 bool DescriptorScriptPubKeyMan::GetDescriptorString(std::string& out, const bool priv) const
 {
     LOCK(cs_desc_man);
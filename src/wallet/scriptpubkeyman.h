@@ -10,6 +10,7 @@
 #include <script/signingprovider.h>
 #include <script/standard.h>
 #include <util/error.h>
+#include <util/hasher.h>
 #include <util/message.h>
 #include <util/time.h>
 #include <wallet/crypter.h>
@@ -536,7 +537,7 @@ public:
 class DescriptorScriptPubKeyMan : public ScriptPubKeyMan
 {
 private:
-    using ScriptPubKeyMap = std::map<CScript, int32_t>; // Map of scripts to descriptor range index
+    using ScriptPubKeyMap = std::unordered_map<CScript, int32_t, SaltedSipHasher>; // Map of scripts to descriptor range index
     using PubKeyMap = std::map<CPubKey, int32_t>; // Map of pubkeys involved in scripts to descriptor range index
     using CryptedKeyMap = std::map<CKeyID, std::pair<CPubKey, std::vector<unsigned char>>>;
     using KeyMap = std::map<CKeyID, CKey>;
@@ -639,7 +640,10 @@ public:
     void WriteDescriptor();
 
     const WalletDescriptor GetWalletDescriptor() const EXCLUSIVE_LOCKS_REQUIRED(cs_desc_man);
-    const std::vector<CScript> GetScriptPubKeys() const;
+    //! Return the scripts of the descriptor, leaving out range items below minimum_index
+    const std::vector<CScript> GetScriptPubKeys(int32_t minimum_index = 0) const;
+    //! Return the end of the range of cached scripts, see WalletDescriptor::range_end
+    int32_t GetEndRange() const;
 
     bool GetDescriptorString(std::string& out, const bool priv) const;
 
@@ -86,6 +86,43 @@ TxSize CalculateMaximumSignedTxSize(const CTransaction &tx, const CWallet *walle
     return CalculateMaximumSignedTxSize(tx, wallet, txouts, coin_control);
 }
 
+//! the output type of a script, if it pays a standard destination.
+static std::optional<OutputType> GetScriptOutputType(const CScript& script)
+{
+    CTxDestination dest;
+    if (!ExtractDestination(script, dest)) return std::nullopt;
+    return OutputTypeFromDestination(dest);
+}
+
+//! re-evaluate an output of a wallet transaction for the UTXO pool.
+static void UpdatePoolCoin(const CWallet& wallet, const CWalletTx& wtx, unsigned int i) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    const COutPoint outpoint(wtx.GetHash(), i);
+    const CTxOut& txout = wtx.tx->vout[i];
+    const isminetype mine = wallet.IsMine(txout);
+    if (mine == ISMINE_NO || wallet.IsSpent(outpoint.hash, i)) {
+        wallet.m_utxo_pool.RemoveCoin(outpoint);
+        return;
+    }
+
+    std::unique_ptr<SigningProvider> provider = wallet.GetSolvingProvider(txout.scriptPubKey);
+    UtxoPool::Coin coin;
+    coin.value = txout.nValue;
+    coin.type = GetScriptOutputType(txout.scriptPubKey);
+    coin.mine = mine;
+    coin.solvable = provider ? IsSolvable(*provider, txout.scriptPubKey) : false;
+    coin.input_bytes = (mine & ISMINE_SPENDABLE) != ISMINE_NO ? CalculateMaximumSignedInputSize(txout, provider.get(), /*use_max_sig=*/false) : -1;
+    wallet.m_utxo_pool.AddCoin(outpoint, coin);
+}
+
+void UpdateUtxoPool(const CWallet& wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+    UpdateFromWallet(wallet, wallet.m_utxo_pool, [&wallet](const CWalletTx& wtx, unsigned int n) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet) {
+        UpdatePoolCoin(wallet, wtx, n);
+    });
+}
+
 void AvailableCoins(const CWallet& wallet, std::vector<COutput>& vCoins, const CCoinControl* coinControl, const CAmount& nMinimumAmount, const CAmount& nMaximumAmount, const CAmount& nMinimumSumAmount, const uint64_t nMaximumCount)
 {
     AssertLockHeld(wallet.cs_wallet);
@@ -98,114 +135,132 @@ void AvailableCoins(const CWallet& wallet, std::vector<COutput>& vCoins, const C
     const int min_depth = {coinControl ? coinControl->m_min_depth : DEFAULT_MIN_DEPTH};
     const int max_depth = {coinControl ? coinControl->m_max_depth : DEFAULT_MAX_DEPTH};
     const bool only_safe = {coinControl ? !coinControl->m_include_unsafe_inputs : true};
+    const bool allow_watch_only = coinControl && coinControl->fAllowWatchOnly;
+
+    UpdateUtxoPool(wallet);
+    const UtxoPool& pool = wallet.m_utxo_pool;
 
     std::set<uint256> trusted_parents;
-    for (const auto& entry : wallet.mapWallet)
-    {
-        const uint256& wtxid = entry.first;
-        const CWalletTx& wtx = entry.second;
-
-        if (wallet.IsTxImmature(wtx))
-            continue;
-
-        int nDepth = wallet.GetTxDepthInMainChain(wtx);
-        if (nDepth < 0)
-            continue;
-
-        // We should not consider coins which aren't at least in our mempool
-        // It's possible for these to be conflicted via ancestors which we may never be able to detect
-        if (nDepth == 0 && !wtx.InMempool())
-            continue;
-
-        bool safeTx = CachedTxIsTrusted(wallet, wtx, trusted_parents);
-
-        // We should not consider coins from transactions that are replacing
-        // other transactions.
-        //
-        // Example: There is a transaction A which is replaced by bumpfee
-        // transaction B. In this case, we want to prevent creation of
-        // a transaction B' which spends an output of B.
-        //
-        // Reason: If transaction A were initially confirmed, transactions B
-        // and B' would no longer be valid, so the user would have to create
-        // a new transaction C to replace B'. However, in the case of a
-        // one-block reorg, transactions B' and C might BOTH be accepted,
-        // when the user only wanted one of them. Specifically, there could
-        // be a 1-block reorg away from the chain where transactions A and C
-        // were accepted to another chain where B, B', and C were all
-        // accepted.
-        if (nDepth == 0 && wtx.mapValue.count("replaces_txid")) {
-            safeTx = false;
-        }
+    // The transaction of the previous coin, as the coins of a transaction are visited together
+    const CWalletTx* pcoin = nullptr;
+    bool usable = false;
+    int nDepth = 0;
+    bool safeTx = false;
+
+    // Returns true once enough coins are found
+    auto add_coin = [&](const COutPoint& outpoint, const UtxoPool::Coin& coin) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet) {
+        if (!pcoin || pcoin->GetHash() != outpoint.hash) {
+            pcoin = &wallet.mapWallet.at(outpoint.hash);
+            const CWalletTx& wtx = *pcoin;
+            usable = false;
+
+            if (wallet.IsTxImmature(wtx))
+                return false;
+
+            nDepth = wallet.GetTxDepthInMainChain(wtx);
+            if (nDepth < 0)
+                return false;
+
+            // We should not consider coins which aren't at least in our mempool
+            // It's possible for these to be conflicted via ancestors which we may never be able to detect
+            if (nDepth == 0 && !wtx.InMempool())
+                return false;
+
+            safeTx = CachedTxIsTrusted(wallet, wtx, trusted_parents);
+
+            // We should not consider coins from transactions that are replacing
+            // other transactions.
+            //
+            // Example: There is a transaction A which is replaced by bumpfee
+            // transaction B. In this case, we want to prevent creation of
+            // a transaction B' which spends an output of B.
+            //
+            // Reason: If transaction A were initially confirmed, transactions B
+            // and B' would no longer be valid, so the user would have to create
+            // a new transaction C to replace B'. However, in the case of a
+            // one-block reorg, transactions B' and C might BOTH be accepted,
+            // when the user only wanted one of them. Specifically, there could
+            // be a 1-block reorg away from the chain where transactions A and C
+            // were accepted to another chain where B, B', and C were all
+            // accepted.
+            if (nDepth == 0 && wtx.mapValue.count("replaces_txid")) {
+                safeTx = false;
+            }
 
-        // Similarly, we should not consider coins from transactions that
-        // have been replaced. In the example above, we would want to prevent
-        // creation of a transaction A' spending an output of A, because if
-        // transaction B were initially confirmed, conflicting with A and
-        // A', we wouldn't want to the user to create a transaction D
-        // intending to replace A', but potentially resulting in a scenario
-        // where A, A', and D could all be accepted (instead of just B and
-        // D, or just A and A' like the user would want).
-        if (nDepth == 0 && wtx.mapValue.count("replaced_by_txid")) {
-            safeTx = false;
-        }
+            // Similarly, we should not consider coins from transactions that
+            // have been replaced. In the example above, we would want to prevent
+            // creation of a transaction A' spending an output of A, because if
+            // transaction B were initially confirmed, conflicting with A and
+            // A', we wouldn't want to the user to create a transaction D
+            // intending to replace A', but potentially resulting in a scenario
+            // where A, A', and D could all be accepted (instead of just B and
+            // D, or just A and A' like the user would want).
+            if (nDepth == 0 && wtx.mapValue.count("replaced_by_txid")) {
+                safeTx = false;
+            }
 
-        if (only_safe && !safeTx) {
-            continue;
+            if (only_safe && !safeTx) {
+                return false;
+            }
+
+            if (nDepth < min_depth || nDepth > max_depth) {
+                return false;
+            }
+            usable = true;
         }
+        if (!usable) return false;
 
-        if (nDepth < min_depth || nDepth > max_depth) {
-            continue;
+        // Only consider selected coins if add_inputs is false
+        if (coinControl && !coinControl->m_add_inputs && !coinControl->IsSelected(outpoint)) {
+            return false;
         }
 
-        for (unsigned int i = 0; i < wtx.tx->vout.size(); i++) {
-            // Only consider selected coins if add_inputs is false
-            if (coinControl && !coinControl->m_add_inputs && !coinControl->IsSelected(COutPoint(entry.first, i))) {
-                continue;
-            }
+        if (coin.value < nMinimumAmount || coin.value > nMaximumAmount)
+            return false;
 
-            if (wtx.tx->vout[i].nValue < nMinimumAmount || wtx.tx->vout[i].nValue > nMaximumAmount)
-                continue;
+        if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(outpoint))
+            return false;
 
-            if (coinControl && coinControl->HasSelected() && !coinControl->fAllowOtherInputs && !coinControl->IsSelected(COutPoint(entry.first, i)))
-                continue;
+        if (wallet.IsLockedCoin(outpoint.hash, outpoint.n))
+            return false;
 
-            if (wallet.IsLockedCoin(entry.first, i))
-                continue;
+        if (!allow_used_addresses && wallet.IsSpentKey(outpoint.hash, outpoint.n)) {
+            return false;
+        }
 
-            if (wallet.IsSpent(wtxid, i))
-                continue;
+        bool spendable = ((coin.mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((coin.mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && (allow_watch_only && coin.solvable));
 
-            isminetype mine = wallet.IsMine(wtx.tx->vout[i]);
+        if (allow_watch_only) {
+            // The pool only knows the input size without the maximum signature size
+            vCoins.push_back(COutput(wallet, *pcoin, outpoint.n, nDepth, spendable, coin.solvable, safeTx, allow_watch_only));
+        } else {
+            vCoins.push_back(COutput(*pcoin, outpoint.n, nDepth, coin.input_bytes, spendable, coin.solvable, safeTx, allow_watch_only));
+        }
 
-            if (mine == ISMINE_NO) {
-                continue;
-            }
+        // Checks the sum amount of all UTXO's.
+        if (nMinimumSumAmount != MAX_MONEY) {
+            nTotal += coin.value;
 
-            if (!allow_used_addresses && wallet.IsSpentKey(wtxid, i)) {
-                continue;
+            if (nTotal >= nMinimumSumAmount) {
+                return true;
             }
+        }
 
-            std::unique_ptr<SigningProvider> provider = wallet.GetSolvingProvider(wtx.tx->vout[i].scriptPubKey);
-
-            bool solvable = provider ? IsSolvable(*provider, wtx.tx->vout[i].scriptPubKey) : false;
-            bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && (coinControl && coinControl->fAllowWatchOnly && solvable));
-
-            vCoins.push_back(COutput(wallet, wtx, i, nDepth, spendable, solvable, safeTx, (coinControl && coinControl->fAllowWatchOnly)));
-
-            // Checks the sum amount of all UTXO's.
-            if (nMinimumSumAmount != MAX_MONEY) {
-                nTotal += wtx.tx->vout[i].nValue;
-
-                if (nTotal >= nMinimumSumAmount) {
-                    return;
-                }
-            }
+        // Checks the maximum number of UTXO's.
+        if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
+            return true;
+        }
+        return false;
+    };
 
-            // Checks the maximum number of UTXO's.
-            if (nMaximumCount > 0 && vCoins.size() >= nMaximumCount) {
-                return;
-            }
+    if (nMinimumAmount > 1 || nMaximumAmount < MAX_MONEY) {
+        // Only visit the coins in the amount range
+        for (const COutPoint& outpoint : pool.GetCoinsInRange(nMinimumAmount, nMaximumAmount)) {
+            if (add_coin(outpoint, pool.GetCoins().at(outpoint))) return;
+        }
+    } else {
+        for (const auto& [outpoint, coin] : pool.GetCoins()) {
+            if (add_coin(outpoint, coin)) return;
         }
     }
 }
@@ -370,8 +425,24 @@ std::vector<OutputGroup> GroupOutputs(const CWallet& wallet, const std::vector<C
     return groups_out;
 }
 
-std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, std::vector<COutput> coins,
-                               const CoinSelectionParams& coin_selection_params)
+CoinsByType GroupCoinsByType(const CWallet& wallet, const std::vector<COutput>& coins)
+{
+    AssertLockHeld(wallet.cs_wallet);
+
+    CoinsByType coins_by_type;
+    const UtxoPool& pool = wallet.m_utxo_pool;
+    for (const COutput& coin : coins) {
+        // The coins from AvailableCoins are in the pool, which knows their type
+        const auto it = pool.IsStale() ? pool.GetCoins().end() : pool.GetCoins().find(COutPoint(coin.tx->GetHash(), coin.i));
+        const std::optional<OutputType> type = it != pool.GetCoins().end() ? it->second.type : GetScriptOutputType(coin.tx->tx->vout[coin.i].scriptPubKey);
+        coins_by_type[type].push_back(coin);
+    }
+    return coins_by_type;
+}
+
+//! run all coin selection algorithms on a set of coins and return the result with the least waste.
+static std::optional<SelectionResult> ChooseSelectionResult(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, const std::vector<COutput>& coins,
+                                                            const CoinSelectionParams& coin_selection_params)
 {
     // Vector of results. We will choose the best one based on waste.
     std::vector<SelectionResult> results;
@@ -411,6 +482,30 @@ std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAm
     return best_result;
 }
 
+std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, const std::vector<COutput>& coins,
+                                                const CoinsByType& coins_by_type, const CoinSelectionParams& coin_selection_params)
+{
+    // Fund the transaction from coins of a single output type if possible, choosing the type whose
+    // selection has the least waste, so that spending does not link addresses of different types
+    std::vector<SelectionResult> results;
+    for (const auto& [type, type_coins] : coins_by_type) {
+        if (auto result{ChooseSelectionResult(wallet, nTargetValue, eligibility_filter, type_coins, coin_selection_params)}) {
+            results.push_back(*result);
+        }
+    }
+    if (results.size() > 0) return *std::min_element(results.begin(), results.end());
+
+    // No single output type can fund the transaction, so select from all coins
+    if (coins_by_type.size() < 2) return std::nullopt;
+    return ChooseSelectionResult(wallet, nTargetValue, eligibility_filter, coins, coin_selection_params);
+}
+
+std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, std::vector<COutput> coins,
+                               const CoinSelectionParams& coin_selection_params)
+{
+    return AttemptSelection(wallet, nTargetValue, eligibility_filter, coins, GroupCoinsByType(wallet, coins), coin_selection_params);
+}
+
 std::optional<SelectionResult> SelectCoins(const CWallet& wallet, const std::vector<COutput>& vAvailableCoins, const CAmount& nTargetValue, const CCoinControl& coin_control, const CoinSelectionParams& coin_selection_params)
 {
     std::vector<COutput> vCoins(vAvailableCoins);
@@ -504,6 +599,7 @@ std::optional<SelectionResult> SelectCoins(const CWallet& wallet, const std::vec
         // explicitly shuffling the outputs before processing
         Shuffle(vCoins.begin(), vCoins.end(), FastRandomContext());
     }
+    const CoinsByType coins_by_type = GroupCoinsByType(wallet, vCoins);
 
     // Coin Selection attempts to select inputs from a pool of eligible UTXOs to fund the
     // transaction at a target feerate. If an attempt fails, more attempts may be made using a more
@@ -514,26 +610,26 @@ std::optional<SelectionResult> SelectCoins(const CWallet& wallet, const std::vec
 
         // If possible, fund the transaction with confirmed UTXOs only. Prefer at least six
         // confirmations on outputs received from other wallets and only spend confirmed change.
-        if (auto r1{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(1, 6, 0), vCoins, coin_selection_params)}) return r1;
-        if (auto r2{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(1, 1, 0), vCoins, coin_selection_params)}) return r2;
+        if (auto r1{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(1, 6, 0), vCoins, coins_by_type, coin_selection_params)}) return r1;
+        if (auto r2{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(1, 1, 0), vCoins, coins_by_type, coin_selection_params)}) return r2;
 
         // Fall back to using zero confirmation change (but with as few ancestors in the mempool as
         // possible) if we cannot fund the transaction otherwise.
         if (wallet.m_spend_zero_conf_change) {
-            if (auto r3{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(0, 1, 2), vCoins, coin_selection_params)}) return r3;
+            if (auto r3{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(0, 1, 2), vCoins, coins_by_type, coin_selection_params)}) return r3;
             if (auto r4{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(0, 1, std::min((size_t)4, max_ancestors/3), std::min((size_t)4, max_descendants/3)),
-                                   vCoins, coin_selection_params)}) {
+                                   vCoins, coins_by_type, coin_selection_params)}) {
                 return r4;
             }
             if (auto r5{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(0, 1, max_ancestors/2, max_descendants/2),
-                                   vCoins, coin_selection_params)}) {
+                                   vCoins, coins_by_type, coin_selection_params)}) {
                 return r5;
             }
             // If partial groups are allowed, relax the requirement of spending OutputGroups (groups
             // of UTXOs sent to the same address, which are obviously controlled by a single wallet)
             // in their entirety.
             if (auto r6{AttemptSelection(wallet, value_to_select, CoinEligibilityFilter(0, 1, max_ancestors-1, max_descendants-1, true /* include_partial_groups */),
-                                   vCoins, coin_selection_params)}) {
+                                   vCoins, coins_by_type, coin_selection_params)}) {
                 return r6;
             }
             // Try with unsafe inputs if they are allowed. This may spend unconfirmed outputs
@@ -541,7 +637,7 @@ std::optional<SelectionResult> SelectCoins(const CWallet& wallet, const std::vec
             if (coin_control.m_include_unsafe_inputs) {
                 if (auto r7{AttemptSelection(wallet, value_to_select,
                     CoinEligibilityFilter(0 /* conf_mine */, 0 /* conf_theirs */, max_ancestors-1, max_descendants-1, true /* include_partial_groups */),
-                    vCoins, coin_selection_params)}) {
+                    vCoins, coins_by_type, coin_selection_params)}) {
                     return r7;
                 }
             }
@@ -551,7 +647,7 @@ std::optional<SelectionResult> SelectCoins(const CWallet& wallet, const std::vec
             if (!fRejectLongChains) {
                 if (auto r8{AttemptSelection(wallet, value_to_select,
                                       CoinEligibilityFilter(0, 1, std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max(), true /* include_partial_groups */),
-                                      vCoins, coin_selection_params)}) {
+                                      vCoins, coins_by_type, coin_selection_params)}) {
                     return r8;
                 }
             }
@@ -6,10 +6,15 @@
 #define BITCOIN_WALLET_SPEND_H
 
 #include <consensus/amount.h>
+#include <outputtype.h>
 #include <wallet/coinselection.h>
 #include <wallet/transaction.h>
 #include <wallet/wallet.h>
 
+#include <map>
+#include <optional>
+#include <vector>
+
 namespace wallet {
 /** Get the marginal bytes if spending the specified output from this transaction */
 int GetTxSpendSize(const CWallet& wallet, const CWalletTx& wtx, unsigned int out, bool use_max_sig = false);
@@ -58,6 +63,12 @@ public:
         }
     }
 
+    /** Construct with the size of the output as a signed input already known, e.g. from the UtxoPool */
+    COutput(const CWalletTx& wtx, int iIn, int nDepthIn, int nInputBytesIn, bool fSpendableIn, bool fSolvableIn, bool fSafeIn, bool use_max_sig_in)
+    {
+        tx = &wtx; i = iIn; nDepth = nDepthIn; fSpendable = fSpendableIn; fSolvable = fSolvableIn; fSafe = fSafeIn; nInputBytes = fSpendable ? nInputBytesIn : -1; use_max_sig = use_max_sig_in;
+    }
+
     std::string ToString() const;
 
     inline CInputCoin GetInputCoin() const
@@ -82,8 +93,15 @@ struct TxSize {
 TxSize CalculateMaximumSignedTxSize(const CTransaction& tx, const CWallet* wallet, const std::vector<CTxOut>& txouts, const CCoinControl* coin_control = nullptr);
 TxSize CalculateMaximumSignedTxSize(const CTransaction& tx, const CWallet* wallet, const CCoinControl* coin_control = nullptr) EXCLUSIVE_LOCKS_REQUIRED(wallet->cs_wallet);
 
+/**
+ * Bring the UTXO pool of the wallet up to date with the wallet transactions.
+ */
+void UpdateUtxoPool(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
 /**
  * populate vCoins with vector of available COutputs.
+ * The coins are read from the UTXO pool, so only the outputs the wallet owns
+ * and has not spent are visited.
  */
 void AvailableCoins(const CWallet& wallet, std::vector<COutput>& vCoins, const CCoinControl* coinControl = nullptr, const CAmount& nMinimumAmount = 1, const CAmount& nMaximumAmount = MAX_MONEY, const CAmount& nMinimumSumAmount = MAX_MONEY, const uint64_t nMaximumCount = 0) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
 
@@ -101,6 +119,15 @@ std::map<CTxDestination, std::vector<COutput>> ListCoins(const CWallet& wallet)
 
 std::vector<OutputGroup> GroupOutputs(const CWallet& wallet, const std::vector<COutput>& outputs, const CoinSelectionParams& coin_sel_params, const CoinEligibilityFilter& filter, bool positive_only);
 
+/** Coins by output type. Coins that do not pay a standard destination have no type. */
+using CoinsByType = std::map<std::optional<OutputType>, std::vector<COutput>>;
+
+/**
+ * Split coins by output type. The type of the coins in the UTXO pool is
+ * read from the pool, other coins are looked at.
+ */
+CoinsByType GroupCoinsByType(const CWallet& wallet, const std::vector<COutput>& coins) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
 /**
  * Attempt to find a valid input set that meets the provided eligibility filter and target.
  * Multiple coin selection algorithms will be run and the input set that produces the least waste
@@ -115,7 +142,15 @@ std::vector<OutputGroup> GroupOutputs(const CWallet& wallet, const std::vector<C
  *                                    If failed, a nullopt
  */
 std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, std::vector<COutput> coins,
-                        const CoinSelectionParams& coin_selection_params);
+                        const CoinSelectionParams& coin_selection_params) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
+/**
+ * Like AttemptSelection() above, with the coins already split by GroupCoinsByType().
+ * The coins of each output type are tried on their own first, and all coins
+ * together only if no single type can fund the transaction.
+ */
+std::optional<SelectionResult> AttemptSelection(const CWallet& wallet, const CAmount& nTargetValue, const CoinEligibilityFilter& eligibility_filter, const std::vector<COutput>& coins,
+                        const CoinsByType& coins_by_type, const CoinSelectionParams& coin_selection_params);
 
 /**
  * Select a set of coins such that nTargetValue is met and at least
@@ -102,19 +102,18 @@ SQLiteDatabase::SQLiteDatabase(const fs::path& dir_path, const fs::path& file_pa
     }
 }
 
-void SQLiteBatch::SetupSQLStatements()
+void SQLiteDatabase::SetupSQLStatements()
 {
     const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
         {&m_read_stmt, "SELECT value FROM main WHERE key = ?"},
         {&m_insert_stmt, "INSERT INTO main VALUES(?, ?)"},
         {&m_overwrite_stmt, "INSERT or REPLACE into main values(?, ?)"},
         {&m_delete_stmt, "DELETE FROM main WHERE key = ?"},
-        {&m_cursor_stmt, "SELECT key, value FROM main"},
     };
 
     for (const auto& [stmt_prepared, stmt_text] : statements) {
         if (*stmt_prepared == nullptr) {
-            int res = sqlite3_prepare_v2(m_database.m_db, stmt_text, -1, stmt_prepared, nullptr);
+            int res = sqlite3_prepare_v2(m_db, stmt_text, -1, stmt_prepared, nullptr);
             if (res != SQLITE_OK) {
                 throw std::runtime_error(strprintf(
                     "SQLiteDatabase: Failed to setup SQL statements: %s\n", sqlite3_errstr(res)));
@@ -123,6 +122,25 @@ void SQLiteBatch::SetupSQLStatements()
     }
 }
 
+void SQLiteDatabase::FinalizeSQLStatements()
+{
+    const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
+        {&m_read_stmt, "read"},
+        {&m_insert_stmt, "insert"},
+        {&m_overwrite_stmt, "overwrite"},
+        {&m_delete_stmt, "delete"},
+    };
+
+    for (const auto& [stmt_prepared, stmt_description] : statements) {
+        int res = sqlite3_finalize(*stmt_prepared);
+        if (res != SQLITE_OK) {
+            LogPrintf("SQLiteDatabase: Could not finalize %s statement: %s\n",
+                      stmt_description, sqlite3_errstr(res));
+        }
+        *stmt_prepared = nullptr;
+    }
+}
+
 SQLiteDatabase::~SQLiteDatabase()
 {
     Cleanup();
@@ -239,10 +257,27 @@ void SQLiteDatabase::Open()
     // Enable fullfsync for the platforms that use it
     SetPragma(m_db, "fullfsync", "true", "Failed to enable fullfsync");
 
+    // The journal mode is stored in the database file, so always set it to
+    // switch a wallet that was opened with the write-ahead log back to the default.
+    // In memory databases only support their own journal mode.
+    if (!m_mock) {
+        const std::string journal_mode = gArgs.GetArg("-walletsqlitejournal", "delete");
+        if (journal_mode != "delete" && journal_mode != "wal") {
+            throw std::runtime_error(strprintf("SQLiteDatabase: Unknown -walletsqlitejournal value '%s'\n", journal_mode));
+        }
+        SetPragma(m_db, "journal_mode", ToUpper(journal_mode), "Failed to set the journal mode");
+    }
+
     if (gArgs.GetBoolArg("-unsafesqlitesync", false)) {
         // Use normal synchronous mode for the journal
         LogPrintf("WARNING SQLite is configured to not wait for data to be flushed to disk. Data loss and corruption may occur.\n");
         SetPragma(m_db, "synchronous", "OFF", "Failed to set synchronous mode to OFF");
+    } else {
+        const std::string sync_level = gArgs.GetArg("-walletsqlitesync", "full");
+        if (sync_level != "extra" && sync_level != "full" && sync_level != "normal") {
+            throw std::runtime_error(strprintf("SQLiteDatabase: Unknown -walletsqlitesync value '%s'\n", sync_level));
+        }
+        SetPragma(m_db, "synchronous", ToUpper(sync_level), "Failed to set the synchronous level");
     }
 
     // Make the table for our key-value pairs
@@ -319,6 +354,10 @@ bool SQLiteDatabase::Backup(const std::string& dest) const
 
 void SQLiteDatabase::Close()
 {
+    {
+        LOCK(m_statements_mutex);
+        FinalizeSQLStatements();
+    }
     int res = sqlite3_close(m_db);
     if (res != SQLITE_OK) {
         throw std::runtime_error(strprintf("SQLiteDatabase: Failed to close database: %s\n", sqlite3_errstr(res)));
@@ -326,6 +365,42 @@ void SQLiteDatabase::Close()
     m_db = nullptr;
 }
 
+void SQLiteDatabase::BeginWriteGroup()
+{
+    const std::thread::id self = std::this_thread::get_id();
+    WAIT_LOCK(m_write_group_mutex, lock);
+    m_write_group_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_write_group_mutex) {
+        return m_write_group_depth == 0 || m_write_group_owner == self;
+    });
+    m_write_group_owner = self;
+    if (m_write_group_depth++ > 0 || !m_db) return;
+    // A batch transaction that is already in progress groups the writes by itself
+    if (sqlite3_get_autocommit(m_db) == 0) return;
+    int res = sqlite3_exec(m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    if (res != SQLITE_OK) {
+        LogPrintf("SQLiteDatabase: Failed to begin the write group transaction: %s\n", sqlite3_errstr(res));
+        return;
+    }
+    m_write_group_txn = true;
+}
+
+bool SQLiteDatabase::EndWriteGroup()
+{
+    LOCK(m_write_group_mutex);
+    assert(m_write_group_depth > 0 && m_write_group_owner == std::this_thread::get_id());
+    if (--m_write_group_depth > 0) return true;
+    m_write_group_cv.notify_all();
+    if (!m_write_group_txn) return true;
+    m_write_group_txn = false;
+    int res = sqlite3_exec(m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+    if (res != SQLITE_OK) {
+        LogPrintf("SQLiteDatabase: Failed to commit the write group transaction: %s\n", sqlite3_errstr(res));
+        sqlite3_exec(m_db, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+        return false;
+    }
+    return true;
+}
+
 std::unique_ptr<DatabaseBatch> SQLiteDatabase::MakeBatch(bool flush_on_close)
 {
     // We ignore flush_on_close because we don't do manual flushing for SQLite
@@ -338,13 +413,15 @@ SQLiteBatch::SQLiteBatch(SQLiteDatabase& database)
     // Make sure we have a db handle
     assert(m_database.m_db);
 
-    SetupSQLStatements();
+    LOCK(m_database.m_statements_mutex);
+    m_database.SetupSQLStatements();
 }
 
 void SQLiteBatch::Close()
 {
-    // If m_db is in a transaction (i.e. not in autocommit mode), then abort the transaction in progress
-    if (m_database.m_db && sqlite3_get_autocommit(m_database.m_db) == 0) {
+    // If this batch began a transaction, then abort the transaction in progress.
+    // A transaction begun by a write group is left for the group to commit.
+    if (m_database.m_db && m_txn) {
         if (TxnAbort()) {
             LogPrintf("SQLiteBatch: Batch closed unexpectedly without the transaction being explicitly committed or aborted\n");
         } else {
@@ -352,68 +429,61 @@ void SQLiteBatch::Close()
         }
     }
 
-    // Free all of the prepared statements
-    const std::vector<std::pair<sqlite3_stmt**, const char*>> statements{
-        {&m_read_stmt, "read"},
-        {&m_insert_stmt, "insert"},
-        {&m_overwrite_stmt, "overwrite"},
-        {&m_delete_stmt, "delete"},
-        {&m_cursor_stmt, "cursor"},
-    };
-
-    for (const auto& [stmt_prepared, stmt_description] : statements) {
-        int res = sqlite3_finalize(*stmt_prepared);
-        if (res != SQLITE_OK) {
-            LogPrintf("SQLiteBatch: Batch closed but could not finalize %s statement: %s\n",
-                      stmt_description, sqlite3_errstr(res));
-        }
-        *stmt_prepared = nullptr;
+    // Free the cursor statement. The other statements are owned by the database.
+    int res = sqlite3_finalize(m_cursor_stmt);
+    if (res != SQLITE_OK) {
+        LogPrintf("SQLiteBatch: Batch closed but could not finalize cursor statement: %s\n",
+                  sqlite3_errstr(res));
     }
+    m_cursor_stmt = nullptr;
 }
 
 bool SQLiteBatch::ReadKey(CDataStream&& key, CDataStream& value)
 {
     if (!m_database.m_db) return false;
-    assert(m_read_stmt);
+    LOCK(m_database.m_statements_mutex);
+    sqlite3_stmt* stmt = m_database.m_read_stmt;
+    assert(stmt);
 
     // Bind: leftmost parameter in statement is index 1
-    int res = sqlite3_bind_blob(m_read_stmt, 1, key.data(), key.size(), SQLITE_STATIC);
+    int res = sqlite3_bind_blob(stmt, 1, key.data(), key.size(), SQLITE_STATIC);
     if (res != SQLITE_OK) {
         LogPrintf("%s: Unable to bind statement: %s\n", __func__, sqlite3_errstr(res));
-        sqlite3_clear_bindings(m_read_stmt);
-        sqlite3_reset(m_read_stmt);
+        sqlite3_clear_bindings(stmt);
+        sqlite3_reset(stmt);
         return false;
     }
-    res = sqlite3_step(m_read_stmt);
+    res = sqlite3_step(stmt);
     if (res != SQLITE_ROW) {
         if (res != SQLITE_DONE) {
             // SQLITE_DONE means "not found", don't log an error in that case.
             LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
         }
-        sqlite3_clear_bindings(m_read_stmt);
-        sqlite3_reset(m_read_stmt);
+        sqlite3_clear_bindings(stmt);
+        sqlite3_reset(stmt);
         return false;
     }
     // Leftmost column in result is index 0
-    const std::byte* data{BytePtr(sqlite3_column_blob(m_read_stmt, 0))};
-    size_t data_size(sqlite3_column_bytes(m_read_stmt, 0));
+    const std::byte* data{BytePtr(sqlite3_column_blob(stmt, 0))};
+    size_t data_size(sqlite3_column_bytes(stmt, 0));
     value.write({data, data_size});
 
-    sqlite3_clear_bindings(m_read_stmt);
-    sqlite3_reset(m_read_stmt);
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
     return true;
 }
 
 bool SQLiteBatch::WriteKey(CDataStream&& key, CDataStream&& value, bool overwrite)
 {
     if (!m_database.m_db) return false;
-    assert(m_insert_stmt && m_overwrite_stmt);
+    LOCK(m_database.m_statements_mutex);
+    assert(m_database.m_insert_stmt && m_database.m_overwrite_stmt);
 
     sqlite3_stmt* stmt;
     if (overwrite) {
-        stmt = m_overwrite_stmt;
+        stmt = m_database.m_overwrite_stmt;
     } else {
-        stmt = m_insert_stmt;
+        stmt = m_database.m_insert_stmt;
     }
 
     // Bind: leftmost parameter in statement is index 1
@@ -446,21 +516,23 @@ bool SQLiteBatch::WriteKey(CDataStream&& key, CDataStream&& value, bool overwrit
 bool SQLiteBatch::EraseKey(CDataStream&& key)
 {
     if (!m_database.m_db) return false;
-    assert(m_delete_stmt);
+    LOCK(m_database.m_statements_mutex);
+    sqlite3_stmt* stmt = m_database.m_delete_stmt;
+    assert(stmt);
 
     // Bind: leftmost parameter in statement is index 1
-    int res = sqlite3_bind_blob(m_delete_stmt, 1, key.data(), key.size(), SQLITE_STATIC);
+    int res = sqlite3_bind_blob(stmt, 1, key.data(), key.size(), SQLITE_STATIC);
     if (res != SQLITE_OK) {
         LogPrintf("%s: Unable to bind statement: %s\n", __func__, sqlite3_errstr(res));
-        sqlite3_clear_bindings(m_delete_stmt);
-        sqlite3_reset(m_delete_stmt);
+        sqlite3_clear_bindings(stmt);
+        sqlite3_reset(stmt);
         return false;
     }
 
     // Execute
-    res = sqlite3_step(m_delete_stmt);
-    sqlite3_clear_bindings(m_delete_stmt);
-    sqlite3_reset(m_delete_stmt);
+    res = sqlite3_step(stmt);
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
     if (res != SQLITE_DONE) {
         LogPrintf("%s: Unable to execute statement: %s\n", __func__, sqlite3_errstr(res));
     }
@@ -470,20 +542,22 @@ bool SQLiteBatch::EraseKey(CDataStream&& key)
 bool SQLiteBatch::HasKey(CDataStream&& key)
 {
     if (!m_database.m_db) return false;
-    assert(m_read_stmt);
+    LOCK(m_database.m_statements_mutex);
+    sqlite3_stmt* stmt = m_database.m_read_stmt;
+    assert(stmt);
 
     // Bind: leftmost parameter in statement is index 1
     bool ret = false;
-    int res = sqlite3_bind_blob(m_read_stmt, 1, key.data(), key.size(), SQLITE_STATIC);
+    int res = sqlite3_bind_blob(stmt, 1, key.data(), key.size(), SQLITE_STATIC);
     if (res == SQLITE_OK) {
-        res = sqlite3_step(m_read_stmt);
+        res = sqlite3_step(stmt);
         if (res == SQLITE_ROW) {
             ret = true;
         }
     }
 
-    sqlite3_clear_bindings(m_read_stmt);
-    sqlite3_reset(m_read_stmt);
+    sqlite3_clear_bindings(stmt);
+    sqlite3_reset(stmt);
     return ret;
 }
 
@@ -491,6 +565,13 @@ bool SQLiteBatch::StartCursor()
 {
     assert(!m_cursor_init);
     if (!m_database.m_db) return false;
+    if (m_cursor_stmt == nullptr) {
+        int res = sqlite3_prepare_v2(m_database.m_db, "SELECT key, value FROM main", -1, &m_cursor_stmt, nullptr);
+        if (res != SQLITE_OK) {
+            LogPrintf("SQLiteBatch::StartCursor: Failed to prepare cursor statement: %s\n", sqlite3_errstr(res));
+            return false;
+        }
+    }
     m_cursor_init = true;
     return true;
 }
@@ -529,31 +610,47 @@ void SQLiteBatch::CloseCursor()
 
 bool SQLiteBatch::TxnBegin()
 {
-    if (!m_database.m_db || sqlite3_get_autocommit(m_database.m_db) == 0) return false;
-    int res = sqlite3_exec(m_database.m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+    if (!m_database.m_db || m_txn) return false;
+    int res;
+    if (sqlite3_get_autocommit(m_database.m_db) == 0) {
+        // Nest inside the transaction of a write group or another batch, so that
+        // aborting only undoes this batch's writes. Ending that transaction
+        // also ends this one.
+        m_txn_savepoint = strprintf("batch%d", ++m_database.m_savepoint_count);
+        res = sqlite3_exec(m_database.m_db, ("SAVEPOINT " + m_txn_savepoint).c_str(), nullptr, nullptr, nullptr);
+    } else {
+        res = sqlite3_exec(m_database.m_db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+        m_txn_savepoint.clear();
+    }
     if (res != SQLITE_OK) {
         LogPrintf("SQLiteBatch: Failed to begin the transaction\n");
     }
-    return res == SQLITE_OK;
+    m_txn = res == SQLITE_OK;
+    return m_txn;
 }
 
 bool SQLiteBatch::TxnCommit()
 {
-    if (!m_database.m_db || sqlite3_get_autocommit(m_database.m_db) != 0) return false;
-    int res = sqlite3_exec(m_database.m_db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+    if (!m_database.m_db || !m_txn) return false;
+    const std::string sql = m_txn_savepoint.empty() ? "COMMIT TRANSACTION" : "RELEASE SAVEPOINT " + m_txn_savepoint;
+    int res = sqlite3_exec(m_database.m_db, sql.c_str(), nullptr, nullptr, nullptr);
     if (res != SQLITE_OK) {
         LogPrintf("SQLiteBatch: Failed to commit the transaction\n");
     }
+    m_txn = false;
     return res == SQLITE_OK;
 }
 
 bool SQLiteBatch::TxnAbort()
 {
-    if (!m_database.m_db || sqlite3_get_autocommit(m_database.m_db) != 0) return false;
-    int res = sqlite3_exec(m_database.m_db, "ROLLBACK TRANSACTION", nullptr, nullptr, nullptr);
+    if (!m_database.m_db || !m_txn) return false;
+    // Rolling back to a savepoint keeps it open, so release it afterwards
+    const std::string sql = m_txn_savepoint.empty() ? "ROLLBACK TRANSACTION" : "ROLLBACK TO SAVEPOINT " + m_txn_savepoint + "; RELEASE SAVEPOINT " + m_txn_savepoint;
+    int res = sqlite3_exec(m_database.m_db, sql.c_str(), nullptr, nullptr, nullptr);
     if (res != SQLITE_OK) {
         LogPrintf("SQLiteBatch: Failed to abort the transaction\n");
     }
+    m_txn = false;
     return res == SQLITE_OK;
 }
 
@@ -5,10 +5,16 @@
 #ifndef BITCOIN_WALLET_SQLITE_H
 #define BITCOIN_WALLET_SQLITE_H
 
+#include <sync.h>
 #include <wallet/db.h>
 
 #include <sqlite3.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <string>
+#include <thread>
+
 struct bilingual_str;
 
 namespace wallet {
@@ -22,13 +28,12 @@ private:
 
     bool m_cursor_init = false;
 
-    sqlite3_stmt* m_read_stmt{nullptr};
-    sqlite3_stmt* m_insert_stmt{nullptr};
-    sqlite3_stmt* m_overwrite_stmt{nullptr};
-    sqlite3_stmt* m_delete_stmt{nullptr};
-    sqlite3_stmt* m_cursor_stmt{nullptr};
+    //! Whether this batch has a transaction in progress, and the name of the
+    //! savepoint it is if it is nested inside a transaction that was open already
+    bool m_txn{false};
+    std::string m_txn_savepoint;
 
-    void SetupSQLStatements();
+    sqlite3_stmt* m_cursor_stmt{nullptr};
 
     bool ReadKey(CDataStream&& key, CDataStream& value) override;
     bool WriteKey(CDataStream&& key, CDataStream&& value, bool overwrite = true) override;
@@ -57,12 +62,38 @@ public:
 class SQLiteDatabase : public WalletDatabase
 {
 private:
+    friend class SQLiteBatch;
+
     const bool m_mock{false};
 
     const std::string m_dir_path;
 
     const std::string m_file_path;
 
+    /** Statements shared by all batches. They are prepared once when the first
+     * batch is made and finalized when the database is closed. */
+    Mutex m_statements_mutex;
+    sqlite3_stmt* m_read_stmt GUARDED_BY(m_statements_mutex){nullptr};
+    sqlite3_stmt* m_insert_stmt GUARDED_BY(m_statements_mutex){nullptr};
+    sqlite3_stmt* m_overwrite_stmt GUARDED_BY(m_statements_mutex){nullptr};
+    sqlite3_stmt* m_delete_stmt GUARDED_BY(m_statements_mutex){nullptr};
+
+    /** The thread whose write groups are open, their nesting depth, and whether
+     * the outermost one began the transaction that is committed when it ends.
+     * A group of another thread waits for them to end, so one owner never
+     * commits the writes of another's group halfway. */
+    Mutex m_write_group_mutex;
+    std::condition_variable m_write_group_cv;
+    std::thread::id m_write_group_owner GUARDED_BY(m_write_group_mutex);
+    int m_write_group_depth GUARDED_BY(m_write_group_mutex){0};
+    bool m_write_group_txn GUARDED_BY(m_write_group_mutex){false};
+
+    //! Numbers the savepoints of batch transactions, whose names must differ while they are nested
+    std::atomic<uint64_t> m_savepoint_count{0};
+
+    void SetupSQLStatements() EXCLUSIVE_LOCKS_REQUIRED(m_statements_mutex);
+    void FinalizeSQLStatements() EXCLUSIVE_LOCKS_REQUIRED(m_statements_mutex);
+
     void Cleanup() noexcept;
 
 public:
@@ -92,11 +123,17 @@ public:
      */
     bool Backup(const std::string& dest) const override;
 
+    /** Group all writes until the matching EndWriteGroup() of the same thread
+     * into one transaction. Batch transactions begun inside a group become
+     * savepoints. */
+    void BeginWriteGroup() override;
+    bool EndWriteGroup() override;
+
     /** No-ops
      *
      * SQLite always flushes everything to the database file after each transaction
      * (each Read/Write/Erase that we do is its own transaction unless we called
-     * TxnBegin) so there is no need to have Flush or Periodic Flush.
+     * TxnBegin or are in a write group) so there is no need to have Flush or Periodic Flush.
      *
      * There is no DB env to reload, so ReloadDbEnv has nothing to do
      */
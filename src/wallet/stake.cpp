@@ -490,118 +490,83 @@ bool CreateCoinStake(CWallet& wallet, unsigned int nBits, const CAmount& nTotalF
     return false;
 }
 
+//! the kind of outputs the wallet stakes with, watch-only ones only for legacy wallets without private keys.
+static isminetype StakingIsMineFilter(const CWallet& wallet)
+{
+    const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
+    return include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
+}
+
+//! check if a wallet output can be used for staking, regardless of its maturity.
+static bool IsCoinAvailableForStaking(const CWallet& wallet, const CWalletTx& wtx, unsigned int i, std::map<COutPoint, CScriptCache>* insertScriptCache, bool isDescriptorWallet, std::map<uint160, bool>* insertAddressStake)
+{
+    const uint256& wtxid = wtx.GetHash();
+    isminetype mine = isminetype(wallet.IsMine(wtx.tx->vout[i]) & StakingIsMineFilter(wallet));
+    if (wallet.IsSpent(wtxid, i) || mine == ISMINE_NO ||
+        wallet.IsLockedCoin(wtxid, i) || wtx.tx->vout[i].nValue <= 0 ||
+        // Check if the staking coin is dust
+        wtx.tx->vout[i].nValue < wallet.m_staker_min_utxo_size)
+        return false;
+
+    // Get the script data for the coin
+    COutPoint prevout = COutPoint(wtxid, i);
+    const CScriptCache& scriptCache = wallet.GetScriptCache(prevout, wtx.tx->vout[i].scriptPubKey, insertScriptCache);
+
+    // Check that the script is not a contract script
+    if(scriptCache.contract || !scriptCache.keyIdOk)
+        return false;
+
+    // Check that the address is not delegated to other staker
+    if(wallet.m_my_delegations.find(scriptCache.keyId) != wallet.m_my_delegations.end())
+        return false;
+
+    // Check that both pkh and pk descriptors are present
+    if(isDescriptorWallet && !wallet.HasAddressStakeScripts(scriptCache.keyId, insertAddressStake))
+        return false;
+
+    // Check if script is spendable
+    return ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && scriptCache.solvable);
+}
+
 void AvailableCoinsForStaking(const CWallet& wallet, const std::vector<uint256>& maturedTx, size_t from, size_t to, const std::map<COutPoint, uint32_t>& immatureStakes, std::vector<std::pair<const CWalletTx *, unsigned int> >& vCoins, std::map<COutPoint, CScriptCache>* insertScriptCache, bool isDescriptorWallet, std::map<uint160, bool>* insertAddressStake)
 {
     for(size_t i = from; i < to; i++)
     {
         std::map<uint256, CWalletTx>::const_iterator it = wallet.mapWallet.find(maturedTx[i]);
         if(it == wallet.mapWallet.end()) continue;
-        const uint256& wtxid = it->first;
         const CWalletTx* pcoin = &(*it).second;
         for (unsigned int i = 0; i < pcoin->tx->vout.size(); i++) {
-            isminetype mine = wallet.IsMine(pcoin->tx->vout[i]);
-            if (!(wallet.IsSpent(wtxid, i)) && mine != ISMINE_NO &&
-                !wallet.IsLockedCoin((*it).first, i) && (pcoin->tx->vout[i].nValue > 0) &&
-                // Check if the staking coin is dust
-                pcoin->tx->vout[i].nValue >= wallet.m_staker_min_utxo_size)
-            {
-                // Get the script data for the coin
-                COutPoint prevout = COutPoint(pcoin->GetHash(), i);
-                const CScriptCache& scriptCache = wallet.GetScriptCache(prevout, pcoin->tx->vout[i].scriptPubKey, insertScriptCache);
-
-                // Check that the script is not a contract script
-                if(scriptCache.contract || !scriptCache.keyIdOk)
-                    continue;
-
-                // Check that the address is not delegated to other staker
-                if(wallet.m_my_delegations.find(scriptCache.keyId) != wallet.m_my_delegations.end())
-                    continue;
-
-                // Check that both pkh and pk descriptors are present
-                if(isDescriptorWallet && !wallet.HasAddressStakeScripts(scriptCache.keyId, insertAddressStake))
-                    continue;
+            // Check prevout maturity
+            if(immatureStakes.find(COutPoint(pcoin->GetHash(), i)) != immatureStakes.end())
+                continue;
 
-                // Check prevout maturity
-                if(immatureStakes.find(prevout) == immatureStakes.end())
-                {
-                    // Check if script is spendable
-                    bool spendable = ((mine & ISMINE_SPENDABLE) != ISMINE_NO) || (((mine & ISMINE_WATCH_ONLY) != ISMINE_NO) && scriptCache.solvable);
-                    if(spendable)
-                        vCoins.push_back(std::make_pair(pcoin, i));
-                }
-            }
+            if(IsCoinAvailableForStaking(wallet, *pcoin, i, insertScriptCache, isDescriptorWallet, insertAddressStake))
+                vCoins.push_back(std::make_pair(pcoin, i));
         }
     }
 }
 
-bool AvailableDelegateCoinsForStaking(const CWallet& wallet, const std::vector<uint160>& delegations, size_t from, size_t to, int32_t height, const std::map<COutPoint, uint32_t>& immatureStakes,  const std::map<uint256, CSuperStakerInfo>& mapStakers, std::vector<std::pair<COutPoint,CAmount>>& vUnsortedDelegateCoins, std::map<uint160, CAmount> &mDelegateWeight)
+bool LoadDelegateCoins(const CWallet& wallet, const std::vector<uint160>& delegators, size_t from, size_t to, std::vector<std::pair<uint160, std::vector<std::pair<COutPoint, DelegateCoinTracker::Coin>>>>& vLoaded)
 {
     for(size_t i = from; i < to; i++)
     {
-        std::map<uint160, Delegation>::const_iterator it = wallet.m_delegations_staker.find(delegations[i]);
-        if(it == wallet.m_delegations_staker.end()) continue;
-
-        const PKHash& keyid = PKHash(it->first);
-        const Delegation* delegation = &(*it).second;
-
-        // Set default delegate stake weight
-        CAmount weight = 0;
-        mDelegateWeight[it->first] = weight;
-
-        // Get super staker custom configuration
-        CAmount staking_min_utxo_value = wallet.m_staking_min_utxo_value;
-        uint8_t staking_min_fee = wallet.m_staking_min_fee;
-        for (std::map<uint256, CSuperStakerInfo>::const_iterator it=mapStakers.begin(); it!=mapStakers.end(); it++)
-        {
-            if(it->second.stakerAddress == delegation->staker)
-            {
-                CSuperStakerInfo info = it->second;
-                if(info.fCustomConfig)
-                {
-                    staking_min_utxo_value = info.nMinDelegateUtxo;
-                    staking_min_fee = info.nMinFee;
-                }
-            }
-        }
-
-        // Check for min staking fee
-        if(delegation->fee < staking_min_fee)
-            continue;
-
-        // Decode address
+        // Delegators are P2PKH addresses, which have type 1 in the address index
         uint256 hashBytes;
-        int type = 0;
-        if (!DecodeIndexKey(EncodeDestination(keyid), hashBytes, type)) {
-            return error("Invalid address");
-        }
+        std::copy(delegators[i].begin(), delegators[i].end(), hashBytes.begin());
+        int type = 1;
 
         // Get address utxos
         std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
         if (!GetAddressUnspent(hashBytes, type, unspentOutputs, wallet.chain().chainman().m_blockman)) {
-            throw error("No information available for address");
+            return error("No information available for address");
         }
 
-        // Add the utxos to the list if they are mature and at least the minimum value
-        int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(height + 1);
-        for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator i=unspentOutputs.begin(); i!=unspentOutputs.end(); i++) {
-
-            int nDepth = height - i->second.blockHeight + 1;
-            if (nDepth < coinbaseMaturity)
-                continue;
-
-            if(i->second.satoshis < staking_min_utxo_value)
-                continue;
-
-            COutPoint prevout = COutPoint(i->first.txhash, i->first.index);
-            if(immatureStakes.find(prevout) == immatureStakes.end())
-            {
-                vUnsortedDelegateCoins.push_back(std::make_pair(prevout, i->second.satoshis));
-                weight+= i->second.satoshis;
-            }
+        std::vector<std::pair<COutPoint, DelegateCoinTracker::Coin>> coins;
+        coins.reserve(unspentOutputs.size());
+        for (const auto& [key, value] : unspentOutputs) {
+            coins.emplace_back(COutPoint(key.txhash, key.index), DelegateCoinTracker::Coin{delegators[i], value.satoshis, value.blockHeight});
         }
-
-        // Update delegate stake weight
-        mDelegateWeight[it->first] = weight;
+        vLoaded.emplace_back(delegators[i], std::move(coins));
     }
 
     return true;
@@ -653,8 +618,7 @@ bool SelectCoinsForStaking(const CWallet& wallet, CAmount &nTargetValue, std::se
     int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
     std::map<COutPoint, uint32_t> immatureStakes = wallet.chain().getImmatureStakes();
     std::vector<uint256> maturedTx;
-    const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
-    const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
+    const isminetype is_mine_filter = StakingIsMineFilter(wallet);
     for (std::map<uint256, CWalletTx>::const_iterator it = wallet.mapWallet.begin(); it != wallet.mapWallet.end(); ++it)
     {
         // Check the cached data for available coins for the tx
@@ -758,38 +722,31 @@ bool SelectCoinsForStaking(const CWallet& wallet, CAmount &nTargetValue, std::se
     return true;
 }
 
-bool valueUtxoSort(const std::pair<COutPoint,CAmount>& a,
-                const std::pair<COutPoint,CAmount>& b) {
-    return a.second > b.second;
-}
-
-bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint> &setDelegateCoinsRet, std::map<uint160, CAmount> &mDelegateWeight)
+bool UpdateDelegateCoins(const CWallet& wallet)
 {
     AssertLockHeld(wallet.cs_wallet);
 
-    setDelegateCoinsRet.clear();
-
-    std::vector<std::pair<COutPoint,CAmount>> vUnsortedDelegateCoins;
-
-    int32_t const height = wallet.chain().getHeight().value_or(-1);
-    if (height == -1) {
-        return error("Invalid blockchain height");
-    }
-
-    std::map<COutPoint, uint32_t> immatureStakes = wallet.chain().getImmatureStakes();
-    std::map<uint256, CSuperStakerInfo> mapStakers = wallet.mapSuperStaker;
-
-    std::vector<uint160> delegations;
+    DelegateCoinTracker& tracker = wallet.m_delegate_coins;
+    std::set<uint160> delegators;
     for (std::map<uint160, Delegation>::const_iterator it = wallet.m_delegations_staker.begin(); it != wallet.m_delegations_staker.end(); ++it)
     {
-        delegations.push_back(it->first);
+        delegators.insert(it->first);
     }
-    size_t listSize = delegations.size();
+    tracker.SetDelegators(delegators);
+
+    // Only delegators that are new or affected by a disconnected block are read from the address index
+    std::set<uint160> stale = tracker.TakeStaleDelegators();
+    if(stale.empty())
+        return true;
+
+    std::vector<uint160> vStale(stale.begin(), stale.end());
+    std::vector<std::pair<uint160, std::vector<std::pair<COutPoint, DelegateCoinTracker::Coin>>>> vLoaded;
+    size_t listSize = vStale.size();
     int numThreads = std::min(wallet.m_num_threads, (int)listSize);
     bool ret = true;
     if(numThreads < 2)
     {
-        ret = AvailableDelegateCoinsForStaking(wallet, delegations, 0, listSize, height, immatureStakes, mapStakers, vUnsortedDelegateCoins, mDelegateWeight);
+        ret = LoadDelegateCoins(wallet, vStale, 0, listSize, vLoaded);
     }
     else
     {
@@ -798,27 +755,99 @@ bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint>
         {
             size_t from = i * chunk;
             size_t to = i == (numThreads -1) ? listSize : from + chunk;
-            wallet.threads.create_thread([&wallet, from, to, height, &delegations, &immatureStakes, &mapStakers, &ret, &vUnsortedDelegateCoins, &mDelegateWeight]{
-                std::vector<std::pair<COutPoint,CAmount>> tmpUnsortedDelegateCoins;
-                std::map<uint160, CAmount> tmpDelegateWeight;
-                bool tmpRet = AvailableDelegateCoinsForStaking(wallet, delegations, from, to, height, immatureStakes, mapStakers, tmpUnsortedDelegateCoins, tmpDelegateWeight);
+            wallet.threads.create_thread([&wallet, from, to, &vStale, &ret, &vLoaded]{
+                std::vector<std::pair<uint160, std::vector<std::pair<COutPoint, DelegateCoinTracker::Coin>>>> tmpLoaded;
+                bool tmpRet = LoadDelegateCoins(wallet, vStale, from, to, tmpLoaded);
 
                 LOCK(wallet.cs_worker);
                 ret &= tmpRet;
-                vUnsortedDelegateCoins.insert(vUnsortedDelegateCoins.end(), tmpUnsortedDelegateCoins.begin(), tmpUnsortedDelegateCoins.end());
-                mDelegateWeight.insert(tmpDelegateWeight.begin(), tmpDelegateWeight.end());
+                std::move(tmpLoaded.begin(), tmpLoaded.end(), std::back_inserter(vLoaded));
             });
         }
         wallet.threads.join_all();
     }
 
-    std::sort(vUnsortedDelegateCoins.begin(), vUnsortedDelegateCoins.end(), valueUtxoSort);
+    for(const auto& [delegator, coins] : vLoaded)
+    {
+        tracker.SetCoins(delegator, coins);
+        stale.erase(delegator);
+    }
 
-    for(auto utxo : vUnsortedDelegateCoins){
-        setDelegateCoinsRet.push_back(utxo.first);
+    // Try again on the next round for the delegators that could not be loaded
+    for(const uint160& delegator : stale)
+    {
+        tracker.MarkStale(delegator);
     }
 
-    vUnsortedDelegateCoins.clear();
+    return ret;
+}
+
+bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint> &setDelegateCoinsRet, std::map<uint160, CAmount> &mDelegateWeight)
+{
+    AssertLockHeld(wallet.cs_wallet);
+
+    setDelegateCoinsRet.clear();
+
+    int32_t const height = wallet.chain().getHeight().value_or(-1);
+    if (height == -1) {
+        return error("Invalid blockchain height");
+    }
+
+    bool ret = UpdateDelegateCoins(wallet);
+
+    std::map<COutPoint, uint32_t> immatureStakes = wallet.chain().getImmatureStakes();
+
+    // Get super staker custom configuration
+    std::map<uint160, const CSuperStakerInfo*> mapCustomConfig;
+    for (std::map<uint256, CSuperStakerInfo>::const_iterator it=wallet.mapSuperStaker.begin(); it!=wallet.mapSuperStaker.end(); it++)
+    {
+        if(it->second.fCustomConfig)
+            mapCustomConfig[it->second.stakerAddress] = &(it->second);
+    }
+
+    // Minimum utxo value for each delegation that pays at least the minimum staking fee
+    std::map<uint160, CAmount> mapMinUtxoValue;
+    for (std::map<uint160, Delegation>::const_iterator it = wallet.m_delegations_staker.begin(); it != wallet.m_delegations_staker.end(); ++it)
+    {
+        // Set default delegate stake weight
+        mDelegateWeight[it->first] = 0;
+
+        CAmount staking_min_utxo_value = wallet.m_staking_min_utxo_value;
+        uint8_t staking_min_fee = wallet.m_staking_min_fee;
+        std::map<uint160, const CSuperStakerInfo*>::const_iterator config = mapCustomConfig.find(it->second.staker);
+        if(config != mapCustomConfig.end())
+        {
+            staking_min_utxo_value = config->second->nMinDelegateUtxo;
+            staking_min_fee = config->second->nMinFee;
+        }
+
+        // Check for min staking fee
+        if(it->second.fee < staking_min_fee)
+            continue;
+
+        mapMinUtxoValue[it->first] = staking_min_utxo_value;
+    }
+
+    // The tracker keeps the coins by decreasing value, so no sorting is needed
+    int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(height + 1);
+    const DelegateCoinTracker& tracker = wallet.m_delegate_coins;
+    for(const auto& [value, prevout] : tracker.GetCoinsByValue())
+    {
+        const DelegateCoinTracker::Coin& coin = tracker.GetCoin(prevout);
+        std::map<uint160, CAmount>::const_iterator minValue = mapMinUtxoValue.find(coin.delegator);
+        if(minValue == mapMinUtxoValue.end() || value < minValue->second)
+            continue;
+
+        int nDepth = height - coin.height + 1;
+        if (nDepth < coinbaseMaturity)
+            continue;
+
+        if(immatureStakes.find(prevout) != immatureStakes.end())
+            continue;
+
+        setDelegateCoinsRet.push_back(prevout);
+        mDelegateWeight[coin.delegator] += value;
+    }
 
     return ret;
 }
@@ -826,8 +855,7 @@ bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint>
 void SelectAddress(const CWallet& wallet, std::map<uint160, bool> &mapAddress)
 {
     std::vector<uint256> maturedTx;
-    const bool include_watch_only = wallet.GetLegacyScriptPubKeyMan() && wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS);
-    const isminetype is_mine_filter = include_watch_only ? ISMINE_WATCH_ONLY : ISMINE_SPENDABLE;
+    const isminetype is_mine_filter = StakingIsMineFilter(wallet);
     for (std::map<uint256, CWalletTx>::const_iterator it = wallet.mapWallet.begin(); it != wallet.mapWallet.end(); ++it)
     {
         // Check the cached data for available coins for the tx
@@ -896,6 +924,51 @@ void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<
     }
 }
 
+//! re-evaluate an output of a wallet transaction for the stake weight tracker.
+static void UpdateStakingCoin(const CWallet& wallet, const CWalletTx& wtx, unsigned int i, bool isDescriptorWallet)
+{
+    COutPoint prevout(wtx.GetHash(), i);
+    const TxStateConfirmed* conf = wtx.state<TxStateConfirmed>();
+    if(conf && IsCoinAvailableForStaking(wallet, wtx, i, nullptr, isDescriptorWallet, nullptr))
+    {
+        // Coinbase and coinstake outputs mature one block later, see CWallet::GetTxBlocksToMaturity
+        int matureHeight = conf->confirmed_block_height + ((wtx.IsCoinBase() || wtx.IsCoinStake()) ? 1 : 0);
+        wallet.m_stake_weight.AddCoin(prevout, wtx.tx->vout[i].nValue, matureHeight);
+    }
+    else
+    {
+        wallet.m_stake_weight.RemoveCoin(prevout);
+    }
+}
+
+void UpdateStakeWeight(const CWallet& wallet)
+{
+    AssertLockHeld(wallet.cs_wallet);
+
+    StakeWeightTracker& tracker = wallet.m_stake_weight;
+    bool isDescriptorWallet = wallet.IsWalletFlagSet(WALLET_FLAG_DESCRIPTORS);
+
+    // Settings that apply to every coin require a rebuild when they change
+    std::set<uint160> delegations;
+    for(const auto& item : wallet.m_my_delegations)
+        delegations.insert(item.first);
+    if(wallet.m_stake_weight_min_utxo_size != wallet.m_staker_min_utxo_size || wallet.m_stake_weight_delegations != delegations)
+    {
+        wallet.m_stake_weight_min_utxo_size = wallet.m_staker_min_utxo_size;
+        wallet.m_stake_weight_delegations = std::move(delegations);
+        tracker.MarkStale();
+    }
+
+    UpdateFromWallet(wallet, tracker, [&wallet, isDescriptorWallet](const CWalletTx& wtx, unsigned int n) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet) {
+        UpdateStakingCoin(wallet, wtx, n, isDescriptorWallet);
+    });
+
+    // Coins are mature at the depth SelectCoinsForStaking requires for the next block
+    int nHeight = wallet.GetLastBlockHeight() + 1;
+    int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
+    tracker.SetMaturityBoundary(nHeight - std::max(1, coinbaseMaturity));
+}
+
 uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight, uint64_t* pDelegateWeight)
 {
     uint64_t nWeight = 0;
@@ -904,57 +977,84 @@ uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight, uint64_t
     if(pStakerWeight) *pStakerWeight = nStakerWeight;
     if(pDelegateWeight) *pDelegateWeight = nDelegateWeight;
 
-    // Choose coins to use
-    const auto bal = GetBalance(wallet);
-    CAmount nBalance = bal.m_mine_trusted;
-    if(wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS))
-        nBalance += bal.m_watchonly_trusted;
+    bool canSuperStake = false;
+    if(wallet.m_reserve_balance == 0)
+    {
+        // Without a reserve balance all mature staking coins are selected, so use the tracked totals,
+        // bounded like the selection by the trusted balance
+        const Balance bal = PublishBalanceSnapshot(wallet)->balance;
+        CAmount nBalance = bal.m_mine_trusted;
+        if(wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS))
+            nBalance += bal.m_watchonly_trusted;
+
+        if (nBalance <= 0)
+            return nWeight;
+
+        UpdateStakeWeight(wallet);
+        nStakerWeight = std::min<uint64_t>(wallet.m_stake_weight.GetMatureAmount(), nBalance);
+        canSuperStake = wallet.m_stake_weight.HasSuperStakerCoin();
+    }
+    else
+    {
+        // Choose coins to use
+        const auto bal = GetBalance(wallet);
+        CAmount nBalance = bal.m_mine_trusted;
+        if(wallet.IsWalletFlagSet(WALLET_FLAG_DISABLE_PRIVATE_KEYS))
+            nBalance += bal.m_watchonly_trusted;
 
-    if (nBalance <= wallet.m_reserve_balance)
-        return nWeight;
+        if (nBalance <= wallet.m_reserve_balance)
+            return nWeight;
 
-    std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
-    CAmount nValueIn = 0;
+        std::set<std::pair<const CWalletTx*,unsigned int> > setCoins;
+        CAmount nValueIn = 0;
 
-    CAmount nTargetValue = nBalance - wallet.m_reserve_balance;
-    if (!SelectCoinsForStaking(wallet, nTargetValue, setCoins, nValueIn))
-        return nWeight;
+        CAmount nTargetValue = nBalance - wallet.m_reserve_balance;
+        if (!SelectCoinsForStaking(wallet, nTargetValue, setCoins, nValueIn))
+            return nWeight;
 
-    if (setCoins.empty())
-        return nWeight;
+        if (setCoins.empty())
+            return nWeight;
 
-    int nHeight = wallet.GetLastBlockHeight() + 1;
-    int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
-    bool canSuperStake = false;
-    for(std::pair<const CWalletTx*,unsigned int> pcoin : setCoins)
-    {
-        if (wallet.GetTxDepthInMainChain(*pcoin.first) >= coinbaseMaturity)
+        int nHeight = wallet.GetLastBlockHeight() + 1;
+        int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(nHeight);
+        for(std::pair<const CWalletTx*,unsigned int> pcoin : setCoins)
         {
-            // Compute staker weight
-            CAmount nValue = pcoin.first->tx->vout[pcoin.second].nValue;
-            nStakerWeight += nValue;
+            if (wallet.GetTxDepthInMainChain(*pcoin.first) >= coinbaseMaturity)
+            {
+                // Compute staker weight
+                CAmount nValue = pcoin.first->tx->vout[pcoin.second].nValue;
+                nStakerWeight += nValue;
 
-            // Check if the staker can super stake
-            if(!canSuperStake && nValue >= DEFAULT_STAKING_MIN_UTXO_VALUE)
-                canSuperStake = true;
+                // Check if the staker can super stake
+                if(!canSuperStake && nValue >= DEFAULT_STAKING_MIN_UTXO_VALUE)
+                    canSuperStake = true;
+            }
         }
     }
 
     if(canSuperStake)
     {
-        // Get the weight of the delegated coins
-        std::vector<COutPoint> vDelegateCoins;
-        std::map<uint160, CAmount> mDelegateWeight;
-        SelectDelegateCoinsForStaking(wallet, vDelegateCoins, mDelegateWeight);
-        for(const COutPoint &prevout : vDelegateCoins)
+        // The delegated coins only change with the chain, so compute their weight once per block
+        uint256 hashTip = wallet.GetLastBlockHash();
+        if(!wallet.m_delegate_stake_weight || wallet.m_delegate_stake_weight->first != hashTip)
         {
-            Coin coinPrev;
-            if(!wallet.chain().getUnspentOutput(prevout, coinPrev)){
-                continue;
-            }
+            // Get the weight of the delegated coins
+            uint64_t nDelegateCoinsWeight = 0;
+            std::vector<COutPoint> vDelegateCoins;
+            std::map<uint160, CAmount> mDelegateWeight;
+            SelectDelegateCoinsForStaking(wallet, vDelegateCoins, mDelegateWeight);
+            for(const COutPoint &prevout : vDelegateCoins)
+            {
+                Coin coinPrev;
+                if(!wallet.chain().getUnspentOutput(prevout, coinPrev)){
+                    continue;
+                }
 
-            nDelegateWeight += coinPrev.out.nValue;
+                nDelegateCoinsWeight += coinPrev.out.nValue;
+            }
+            wallet.m_delegate_stake_weight = std::make_pair(hashTip, nDelegateCoinsWeight);
         }
+        nDelegateWeight = wallet.m_delegate_stake_weight->second;
     }
 
     nWeight = nStakerWeight + nDelegateWeight;
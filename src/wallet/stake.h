@@ -18,7 +18,10 @@ bool CreateCoinStake(CWallet& wallet, unsigned int nBits, const CAmount& nTotalF
 //! select coins for staking from the available coins for staking.
 bool SelectCoinsForStaking(const CWallet& wallet, CAmount& nTargetValue, std::set<std::pair<const CWalletTx*,unsigned int> >& setCoinsRet, CAmount& nValueRet);
 
-//! select delegated coins for staking from other users.
+//! bring the delegated coin tracker up to date with the staker delegations, reading new delegators from the address index.
+bool UpdateDelegateCoins(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
+//! select delegated coins for staking from other users, by decreasing value.
 bool SelectDelegateCoinsForStaking(const CWallet& wallet, std::vector<COutPoint>& setDelegateCoinsRet, std::map<uint160, CAmount>& mDelegateWeight);
 
 //! select list of address with coins.
@@ -27,6 +30,9 @@ void SelectAddress(const CWallet& wallet, std::map<uint160, bool>& mapAddress);
 //! update miner stake cache.
 void UpdateMinerStakeCache(CWallet& wallet, bool fStakeCache, const std::vector<COutPoint>& prevouts, CBlockIndex* pindexPrev);
 
+//! bring the wallet stake weight tracker up to date with the wallet transactions and the chain tip.
+void UpdateStakeWeight(const CWallet& wallet) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet);
+
 //! get stake weight.
 uint64_t GetStakeWeight(const CWallet& wallet, uint64_t* pStakerWeight = nullptr, uint64_t* pDelegateWeight = nullptr);
 
@@ -0,0 +1,86 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/stakeweight.h>
+
+#include <algorithm>
+
+namespace wallet {
+void StakeWeightTracker::Totals::Add(const Totals& other, int sign)
+{
+    if (sign > 0) {
+        coins += other.coins;
+        amount += other.amount;
+        super_staker_coins += other.super_staker_coins;
+    } else {
+        coins -= other.coins;
+        amount -= other.amount;
+        super_staker_coins -= other.super_staker_coins;
+    }
+}
+
+void StakeWeightTracker::Account(const Coin& coin, int sign)
+{
+    Totals delta;
+    delta.coins = 1;
+    delta.amount = coin.value;
+    delta.super_staker_coins = coin.value >= m_super_staker_value ? 1 : 0;
+
+    auto bucket = m_by_height.emplace(coin.mature_height, Totals{}).first;
+    bucket->second.Add(delta, sign);
+    if (bucket->second.coins == 0) m_by_height.erase(bucket);
+
+    m_total.Add(delta, sign);
+    if (coin.mature_height <= m_boundary) m_mature.Add(delta, sign);
+}
+
+void StakeWeightTracker::AddCoin(const COutPoint& prevout, CAmount value, int mature_height)
+{
+    const Coin coin{value, mature_height};
+    auto [it, inserted] = m_coins.emplace(prevout, coin);
+    if (!inserted) {
+        if (it->second.value == value && it->second.mature_height == mature_height) return;
+        Account(it->second, -1);
+        it->second = coin;
+    }
+    Account(coin, 1);
+}
+
+void StakeWeightTracker::RemoveCoin(const COutPoint& prevout)
+{
+    const auto it = m_coins.find(prevout);
+    if (it == m_coins.end()) return;
+    Account(it->second, -1);
+    m_coins.erase(it);
+}
+
+void StakeWeightTracker::RemoveTx(const uint256& hash)
+{
+    auto it = m_coins.lower_bound(COutPoint(hash, 0));
+    while (it != m_coins.end() && it->first.hash == hash) {
+        Account(it->second, -1);
+        it = m_coins.erase(it);
+    }
+}
+
+void StakeWeightTracker::ClearCoins()
+{
+    m_coins.clear();
+    m_by_height.clear();
+    m_total = Totals{};
+    m_mature = Totals{};
+}
+
+void StakeWeightTracker::SetMaturityBoundary(int boundary)
+{
+    // Only the heights between the old and the new boundary change state.
+    const int sign = boundary > m_boundary ? 1 : -1;
+    const int low = std::min(boundary, m_boundary);
+    const int high = std::max(boundary, m_boundary);
+    for (auto it = m_by_height.upper_bound(low); it != m_by_height.end() && it->first <= high; ++it) {
+        m_mature.Add(it->second, sign);
+    }
+    m_boundary = boundary;
+}
+} // namespace wallet
@@ -0,0 +1,75 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_STAKEWEIGHT_H
+#define QTUM_WALLET_STAKEWEIGHT_H
+
+#include <consensus/amount.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+#include <wallet/dirtytxs.h>
+
+#include <limits>
+#include <map>
+
+namespace wallet {
+/**
+ * The wallet coins that can be used for staking, keyed by the height from
+ * which they are mature, with running totals of the mature and immature
+ * amounts.
+ *
+ * Coins are updated when the wallet transactions that create or spend them
+ * change, and the maturity boundary follows the chain tip. Moving the
+ * boundary only visits the heights it passes over, so keeping the totals up
+ * to date costs O(changes) instead of a scan of the whole wallet.
+ */
+class StakeWeightTracker : public DirtyTxTracker
+{
+public:
+    /** Coins of at least super_staker_value allow a super staker to stake delegated coins. */
+    explicit StakeWeightTracker(CAmount super_staker_value) : m_super_staker_value(super_staker_value) {}
+
+    /** Add or update a coin that is mature from mature_height on. */
+    void AddCoin(const COutPoint& prevout, CAmount value, int mature_height);
+    void RemoveCoin(const COutPoint& prevout);
+    void RemoveTx(const uint256& hash) override;
+
+    /** Coins with a mature height up to and including boundary are mature. */
+    void SetMaturityBoundary(int boundary);
+
+    CAmount GetMatureAmount() const { return m_mature.amount; }
+    CAmount GetImmatureAmount() const { return m_total.amount - m_mature.amount; }
+    /** Whether a mature coin is large enough to stake delegated coins. */
+    bool HasSuperStakerCoin() const { return m_mature.super_staker_coins > 0; }
+    size_t CoinCount() const { return m_coins.size(); }
+
+protected:
+    void ClearCoins() override;
+
+private:
+    struct Totals {
+        size_t coins{0};
+        CAmount amount{0};
+        size_t super_staker_coins{0};
+
+        void Add(const Totals& other, int sign);
+    };
+    struct Coin {
+        CAmount value;
+        int mature_height;
+    };
+
+    /** Add (sign 1) or subtract (sign -1) a coin to/from the totals. */
+    void Account(const Coin& coin, int sign);
+
+    const CAmount m_super_staker_value;
+    std::map<COutPoint, Coin> m_coins;
+    std::map<int, Totals> m_by_height;
+    Totals m_total;
+    Totals m_mature;
+    int m_boundary{std::numeric_limits<int>::min()};
+};
+} // namespace wallet
+
+#endif // QTUM_WALLET_STAKEWEIGHT_H
@@ -69,7 +69,7 @@ static void add_coin(const CAmount& nValue, int nInput, CoinSet& set, CAmount fe
     set.insert(coin);
 }
 
-static void add_coin(std::vector<COutput>& coins, CWallet& wallet, const CAmount& nValue, int nAge = 6*24, bool fIsFromMe = false, int nInput=0, bool spendable = false)
+static void add_coin(std::vector<COutput>& coins, CWallet& wallet, const CAmount& nValue, int nAge = 6*24, bool fIsFromMe = false, int nInput=0, bool spendable = false, OutputType type = OutputType::BECH32)
 {
     CMutableTransaction tx;
     tx.nLockTime = nextLockTime++;        // so all transactions get different hashes
@@ -78,7 +78,7 @@ static void add_coin(std::vector<COutput>& coins, CWallet& wallet, const CAmount
     if (spendable) {
         CTxDestination dest;
         bilingual_str error;
-        const bool destination_ok = wallet.GetNewDestination(OutputType::BECH32, "", dest, error);
+        const bool destination_ok = wallet.GetNewDestination(type, "", dest, error);
         assert(destination_ok);
         tx.vout[nInput].scriptPubKey = GetScriptForDestination(dest);
     }
@@ -735,6 +735,56 @@ BOOST_AUTO_TEST_CASE(SelectCoins_test)
     }
 }
 
+static std::set<std::optional<OutputType>> InputTypes(const SelectionResult& result)
+{
+    std::set<std::optional<OutputType>> types;
+    for (const CInputCoin& coin : result.GetInputSet()) {
+        CTxDestination dest;
+        BOOST_CHECK(ExtractDestination(coin.txout.scriptPubKey, dest));
+        types.insert(OutputTypeFromDestination(dest));
+    }
+    return types;
+}
+
+// Tests that the coin selector funds a transaction from a single output type when it can
+BOOST_AUTO_TEST_CASE(SelectCoins_output_types)
+{
+    std::unique_ptr<CWallet> wallet = std::make_unique<CWallet>(m_node.chain.get(), "", m_args, CreateMockWalletDatabase());
+    wallet->LoadWallet();
+    LOCK(wallet->cs_wallet);
+    wallet->SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+    wallet->SetupDescriptorScriptPubKeyMans();
+
+    std::vector<COutput> coins;
+    add_coin(coins, *wallet, 4 * CENT, 6 * 24, false, 0, true, OutputType::LEGACY);
+    add_coin(coins, *wallet, 3 * CENT, 6 * 24, false, 0, true, OutputType::LEGACY);
+    add_coin(coins, *wallet, 5 * CENT, 6 * 24, false, 0, true, OutputType::BECH32);
+    add_coin(coins, *wallet, 1 * CENT, 6 * 24, false, 0, true, OutputType::BECH32);
+
+    const CoinsByType coins_by_type = GroupCoinsByType(*wallet, coins);
+    BOOST_CHECK_EQUAL(coins_by_type.size(), 2U);
+    BOOST_CHECK_EQUAL(coins_by_type.at(OutputType::LEGACY).size(), 2U);
+    BOOST_CHECK_EQUAL(coins_by_type.at(OutputType::BECH32).size(), 2U);
+
+    CoinSelectionParams cs_params(/* change_output_size= */ 34,
+                                  /* change_spend_size= */ 148, /* effective_feerate= */ CFeeRate(0),
+                                  /* long_term_feerate= */ CFeeRate(0), /* discard_feerate= */ CFeeRate(0),
+                                  /* tx_noinputs_size= */ 0, /* avoid_partial= */ false);
+    CCoinControl cc;
+
+    // Either type alone can pay 6 CENT, so the inputs are not mixed
+    const auto single = SelectCoins(*wallet, coins, 6 * CENT, cc, cs_params);
+    BOOST_REQUIRE(single);
+    BOOST_CHECK_GE(single->GetSelectedValue(), 6 * CENT);
+    BOOST_CHECK_EQUAL(InputTypes(*single).size(), 1U);
+
+    // Only both types together can pay 10 CENT
+    const auto mixed = SelectCoins(*wallet, coins, 10 * CENT, cc, cs_params);
+    BOOST_REQUIRE(mixed);
+    BOOST_CHECK_GE(mixed->GetSelectedValue(), 10 * CENT);
+    BOOST_CHECK_EQUAL(InputTypes(*mixed).size(), 2U);
+}
+
 BOOST_AUTO_TEST_CASE(waste_test)
 {
     CoinSet selection;
@@ -0,0 +1,100 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block.h>
+#include <script/standard.h>
+#include <test/util/setup_common.h>
+#include <wallet/delegatecoins.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(delegatecoins_tests, BasicTestingSetup)
+
+static std::vector<COutPoint> CoinsByValue(const DelegateCoinTracker& tracker)
+{
+    std::vector<COutPoint> coins;
+    for (const auto& [value, outpoint] : tracker.GetCoinsByValue()) {
+        coins.push_back(outpoint);
+    }
+    return coins;
+}
+
+BOOST_AUTO_TEST_CASE(delegators)
+{
+    DelegateCoinTracker tracker;
+    const uint160 alice = uint160(g_insecure_rand_ctx.randbytes(20));
+    const uint160 bob = uint160(g_insecure_rand_ctx.randbytes(20));
+
+    // New delegators are stale until their coins are loaded
+    tracker.SetDelegators({alice, bob});
+    BOOST_CHECK(tracker.TakeStaleDelegators() == std::set<uint160>({alice, bob}));
+    BOOST_CHECK(tracker.TakeStaleDelegators().empty());
+
+    const COutPoint a(InsecureRand256(), 0);
+    const COutPoint b(InsecureRand256(), 1);
+    const COutPoint c(InsecureRand256(), 0);
+    tracker.SetCoins(alice, {{a, {alice, 2 * COIN, 10}}, {b, {alice, 7 * COIN, 11}}});
+    tracker.SetCoins(bob, {{c, {bob, 5 * COIN, 12}}});
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 3U);
+    BOOST_CHECK(CoinsByValue(tracker) == std::vector<COutPoint>({b, c, a}));
+    BOOST_CHECK(tracker.GetCoin(c).delegator == bob);
+
+    // Reloading a delegator replaces its coins
+    tracker.SetCoins(alice, {{a, {alice, 2 * COIN, 10}}});
+    BOOST_CHECK(CoinsByValue(tracker) == std::vector<COutPoint>({c, a}));
+
+    // Dropped delegators lose their coins, kept ones are not reloaded
+    tracker.SetDelegators({bob});
+    BOOST_CHECK(CoinsByValue(tracker) == std::vector<COutPoint>({c}));
+    BOOST_CHECK(tracker.TakeStaleDelegators().empty());
+
+    // Coins of untracked delegators are ignored
+    tracker.AddCoin(a, {alice, 2 * COIN, 10});
+    tracker.SetCoins(alice, {{a, {alice, 2 * COIN, 10}}});
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 1U);
+
+    tracker.MarkStale(alice);
+    tracker.MarkStale(bob);
+    BOOST_CHECK(tracker.TakeStaleDelegators() == std::set<uint160>({bob}));
+}
+
+BOOST_AUTO_TEST_CASE(blocks)
+{
+    DelegateCoinTracker tracker;
+    const uint160 alice = uint160(g_insecure_rand_ctx.randbytes(20));
+    const uint160 other = uint160(g_insecure_rand_ctx.randbytes(20));
+    tracker.SetDelegators({alice});
+    tracker.TakeStaleDelegators();
+
+    const COutPoint a(InsecureRand256(), 0);
+    const COutPoint b(InsecureRand256(), 0);
+    tracker.SetCoins(alice, {{a, {alice, 3 * COIN, 10}}, {b, {alice, 4 * COIN, 10}}});
+
+    // The block spends a and pays alice twice and someone else once
+    CMutableTransaction mtx;
+    mtx.vin.emplace_back(a);
+    mtx.vout.emplace_back(1 * COIN, GetScriptForDestination(PKHash(alice)));
+    mtx.vout.emplace_back(6 * COIN, GetScriptForDestination(PKHash(other)));
+    mtx.vout.emplace_back(9 * COIN, GetScriptForDestination(PKHash(alice)));
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(mtx));
+    const uint256 hash = block.vtx[0]->GetHash();
+
+    tracker.BlockConnected(block, 20);
+    BOOST_CHECK(CoinsByValue(tracker) == std::vector<COutPoint>({COutPoint(hash, 2), b, COutPoint(hash, 0)}));
+    BOOST_CHECK_EQUAL(tracker.GetCoin(COutPoint(hash, 2)).height, 20);
+    BOOST_CHECK(tracker.TakeStaleDelegators().empty());
+
+    // Connecting a block again does not change the coins
+    tracker.BlockConnected(block, 20);
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 3U);
+
+    // A disconnected block forces a reload from the address index
+    tracker.BlockDisconnected();
+    BOOST_CHECK(tracker.TakeStaleDelegators() == std::set<uint160>({alice}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
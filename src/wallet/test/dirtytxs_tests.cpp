@@ -0,0 +1,101 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/context.h>
+#include <test/util/setup_common.h>
+#include <wallet/dirtytxs.h>
+#include <wallet/wallet.h>
+#include <wallet/walletdb.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(dirtytxs_tests, TestingSetup)
+
+//! Records what UpdateFromWallet asks of it
+class TestTracker : public DirtyTxTracker
+{
+public:
+    std::set<COutPoint> updated;
+    std::set<uint256> removed;
+    int clears{0};
+
+    void RemoveTx(const uint256& hash) override { removed.insert(hash); }
+
+protected:
+    void ClearCoins() override { ++clears; }
+};
+
+static CTransactionRef MakeTx(const std::vector<COutPoint>& prevouts, size_t outputs)
+{
+    CMutableTransaction tx;
+    tx.nLockTime = InsecureRand32(); // so all transactions get different hashes
+    for (const COutPoint& prevout : prevouts) {
+        tx.vin.emplace_back(prevout);
+    }
+    for (size_t i = 0; i < outputs; i++) {
+        tx.vout.emplace_back(COIN, CScript() << OP_TRUE);
+    }
+    return MakeTransactionRef(tx);
+}
+
+BOOST_AUTO_TEST_CASE(dirty_and_stale)
+{
+    TestTracker tracker;
+    const uint256 hash = InsecureRand256();
+
+    // A stale set is rebuilt anyway, so changes are not recorded
+    BOOST_CHECK(tracker.IsStale());
+    tracker.MarkTxDirty(hash);
+    BOOST_CHECK(tracker.TakeDirtyTxs().empty());
+
+    tracker.Clear();
+    BOOST_CHECK(!tracker.IsStale());
+    BOOST_CHECK_EQUAL(tracker.clears, 1);
+    tracker.MarkTxDirty(hash);
+    BOOST_CHECK(tracker.TakeDirtyTxs() == std::set<uint256>({hash}));
+    BOOST_CHECK(tracker.TakeDirtyTxs().empty());
+
+    tracker.MarkTxDirty(hash);
+    tracker.MarkStale();
+    BOOST_CHECK(tracker.IsStale());
+    BOOST_CHECK(tracker.TakeDirtyTxs().empty());
+}
+
+BOOST_AUTO_TEST_CASE(update_from_wallet)
+{
+    CWallet wallet(m_node.chain.get(), "", m_args, CreateDummyWalletDatabase());
+    LOCK(wallet.cs_wallet);
+    const CTransactionRef parent = MakeTx({COutPoint(InsecureRand256(), 0)}, 2);
+    BOOST_REQUIRE(wallet.AddToWallet(parent, TxStateInactive{}));
+
+    TestTracker tracker;
+    auto update_coin = [&tracker](const CWalletTx& wtx, unsigned int n) { tracker.updated.emplace(wtx.GetHash(), n); };
+
+    // A stale set is rebuilt from every wallet output
+    UpdateFromWallet(wallet, tracker, update_coin);
+    BOOST_CHECK_EQUAL(tracker.clears, 1);
+    BOOST_CHECK(!tracker.IsStale());
+    BOOST_CHECK(tracker.updated == std::set<COutPoint>({COutPoint(parent->GetHash(), 0), COutPoint(parent->GetHash(), 1)}));
+
+    // A changed transaction re-evaluates its outputs and the wallet outputs it spends
+    tracker.updated.clear();
+    const CTransactionRef child = MakeTx({COutPoint(parent->GetHash(), 1), COutPoint(InsecureRand256(), 0)}, 1);
+    BOOST_REQUIRE(wallet.AddToWallet(child, TxStateInactive{}));
+    tracker.MarkTxDirty(child->GetHash());
+    UpdateFromWallet(wallet, tracker, update_coin);
+    BOOST_CHECK_EQUAL(tracker.clears, 1);
+    BOOST_CHECK(tracker.updated == std::set<COutPoint>({COutPoint(parent->GetHash(), 1), COutPoint(child->GetHash(), 0)}));
+
+    // The coins of a transaction that left the wallet are removed
+    tracker.updated.clear();
+    const uint256 removed = InsecureRand256();
+    tracker.MarkTxDirty(removed);
+    UpdateFromWallet(wallet, tracker, update_coin);
+    BOOST_CHECK(tracker.updated.empty());
+    BOOST_CHECK(tracker.removed == std::set<uint256>({removed}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
@@ -3,6 +3,8 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <key.h>
+#include <key_io.h>
+#include <script/descriptor.h>
 #include <script/standard.h>
 #include <test/util/setup_common.h>
 #include <wallet/scriptpubkeyman.h>
@@ -39,5 +41,44 @@ BOOST_AUTO_TEST_CASE(CanProvide)
     BOOST_CHECK(keyman.CanProvide(p2sh_script, data));
 }
 
+// Test that DescriptorScriptPubKeyMan derives the same scripts when a large
+// range is topped up or loaded in parallel as when each index is expanded alone.
+BOOST_AUTO_TEST_CASE(DescriptorTopUpAndLoad)
+{
+    CWallet wallet(m_node.chain.get(), "", m_args, CreateDummyWalletDatabase());
+    wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+
+    CExtKey master;
+    master.SetSeed(std::vector<uint8_t>(32, 0x02));
+    FlatSigningProvider keys;
+    std::string error;
+    std::shared_ptr<Descriptor> descriptor = Parse("pkh(" + EncodeExtPubKey(master.Neuter()) + "/0/*)", keys, error, /*require_checksum=*/false);
+    BOOST_REQUIRE(descriptor);
+
+    // Enough indexes for the derivation to be spread over threads
+    const int32_t num_indexes{2000};
+    WalletDescriptor w_desc(descriptor, /*creation_time=*/0, /*range_start=*/0, /*range_end=*/0, /*next_index=*/0);
+    DescriptorScriptPubKeyMan spk_man(wallet, w_desc);
+    BOOST_REQUIRE(spk_man.TopUp(num_indexes));
+    BOOST_CHECK_EQUAL(spk_man.GetEndRange(), num_indexes);
+
+    const std::vector<CScript> script_pub_keys = spk_man.GetScriptPubKeys();
+    BOOST_CHECK_EQUAL(script_pub_keys.size(), (size_t)num_indexes);
+    BOOST_CHECK(std::is_sorted(script_pub_keys.begin(), script_pub_keys.end()));
+    for (int32_t i : {0, 1, 999, 1000, num_indexes - 1}) {
+        std::vector<CScript> scripts;
+        FlatSigningProvider out;
+        BOOST_REQUIRE(descriptor->Expand(i, keys, scripts, out));
+        BOOST_CHECK(spk_man.IsMine(scripts.at(0)) != ISMINE_NO);
+    }
+
+    // Loading the descriptor from its cache derives the same scripts
+    WalletDescriptor loaded_desc = spk_man.GetWalletDescriptor();
+    DescriptorScriptPubKeyMan loaded_spk_man(wallet, loaded_desc);
+    loaded_spk_man.SetCache(loaded_desc.cache);
+    BOOST_CHECK_EQUAL(loaded_spk_man.GetEndRange(), num_indexes);
+    BOOST_CHECK(loaded_spk_man.GetScriptPubKeys() == script_pub_keys);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 } // namespace wallet
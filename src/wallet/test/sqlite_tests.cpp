@@ -0,0 +1,175 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/time.h>
+#include <wallet/db.h>
+#include <wallet/sqlite.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(sqlite_tests, BasicTestingSetup)
+
+static bool InTransaction(const SQLiteDatabase& database)
+{
+    return sqlite3_get_autocommit(database.m_db) == 0;
+}
+
+BOOST_AUTO_TEST_CASE(batch_transactions)
+{
+    SQLiteDatabase database("", "", /*mock=*/true);
+    auto batch = database.MakeBatch();
+    auto other_batch = database.MakeBatch();
+
+    BOOST_CHECK(!batch->TxnCommit());
+    BOOST_CHECK(batch->TxnBegin());
+    BOOST_CHECK(!batch->TxnBegin());
+    BOOST_CHECK(batch->Write(std::string{"a"}, 1));
+
+    // A transaction begun while another is open nests in it, and aborting it only undoes its own writes
+    BOOST_CHECK(other_batch->TxnBegin());
+    BOOST_CHECK(other_batch->Write(std::string{"c"}, 3));
+    BOOST_CHECK(other_batch->TxnAbort());
+    BOOST_CHECK(InTransaction(database));
+    BOOST_CHECK(batch->Exists(std::string{"a"}));
+    BOOST_CHECK(!batch->Exists(std::string{"c"}));
+
+    BOOST_CHECK(batch->TxnAbort());
+    BOOST_CHECK(!InTransaction(database));
+    BOOST_CHECK(!batch->Exists(std::string{"a"}));
+
+    // Closing a batch aborts its transaction
+    BOOST_CHECK(other_batch->TxnBegin());
+    BOOST_CHECK(other_batch->Write(std::string{"b"}, 2));
+    other_batch.reset();
+    BOOST_CHECK(!InTransaction(database));
+    BOOST_CHECK(!batch->Exists(std::string{"b"}));
+}
+
+BOOST_AUTO_TEST_CASE(write_group)
+{
+    SQLiteDatabase database("", "", /*mock=*/true);
+    {
+        DatabaseWriteGroup group(database);
+        BOOST_CHECK(InTransaction(database));
+        {
+            DatabaseWriteGroup nested_group(database);
+            BOOST_CHECK(database.MakeBatch()->Write(std::string{"a"}, 1));
+            nested_group.Commit();
+        }
+        // Only the outermost group commits
+        BOOST_CHECK(InTransaction(database));
+
+        // A batch transaction inside the group only undoes its own writes
+        auto batch = database.MakeBatch();
+        BOOST_CHECK(batch->TxnBegin());
+        BOOST_CHECK(batch->Write(std::string{"b"}, 2));
+        BOOST_CHECK(batch->TxnAbort());
+        BOOST_CHECK(InTransaction(database));
+        BOOST_CHECK(batch->Exists(std::string{"a"}));
+        BOOST_CHECK(!batch->Exists(std::string{"b"}));
+
+        BOOST_CHECK(batch->TxnBegin());
+        BOOST_CHECK(batch->Write(std::string{"c"}, 3));
+        BOOST_CHECK(batch->TxnCommit());
+
+        // Closing a batch without a transaction of its own leaves the group's transaction open
+        BOOST_CHECK(database.MakeBatch()->Write(std::string{"d"}, 4));
+        BOOST_CHECK(InTransaction(database));
+        group.Commit();
+    }
+    BOOST_CHECK(!InTransaction(database));
+
+    auto batch = database.MakeBatch();
+    int value{0};
+    BOOST_CHECK(batch->Read(std::string{"a"}, value) && value == 1);
+    BOOST_CHECK(!batch->Exists(std::string{"b"}));
+    BOOST_CHECK(batch->Read(std::string{"c"}, value) && value == 3);
+    BOOST_CHECK(batch->Read(std::string{"d"}, value) && value == 4);
+}
+
+BOOST_AUTO_TEST_CASE(write_group_commit_failure)
+{
+    SQLiteDatabase database("", "", /*mock=*/true);
+    // A deferred foreign key violation is only reported by COMMIT
+    BOOST_REQUIRE_EQUAL(sqlite3_exec(database.m_db,
+        "PRAGMA foreign_keys = ON;"
+        "CREATE TABLE parent (id INTEGER PRIMARY KEY);"
+        "CREATE TABLE child (parent_id INTEGER REFERENCES parent(id) DEFERRABLE INITIALLY DEFERRED);",
+        nullptr, nullptr, nullptr), SQLITE_OK);
+    {
+        DatabaseWriteGroup group(database);
+        BOOST_CHECK(database.MakeBatch()->Write(std::string{"a"}, 1));
+        BOOST_REQUIRE_EQUAL(sqlite3_exec(database.m_db, "INSERT INTO child VALUES (1)", nullptr, nullptr, nullptr), SQLITE_OK);
+        BOOST_CHECK_THROW(group.Commit(), std::runtime_error);
+    }
+    // The failed group is rolled back rather than left open
+    BOOST_CHECK(!InTransaction(database));
+    BOOST_CHECK(!database.MakeBatch()->Exists(std::string{"a"}));
+}
+
+BOOST_AUTO_TEST_CASE(write_group_joins_batch_transaction)
+{
+    SQLiteDatabase database("", "", /*mock=*/true);
+    auto batch = database.MakeBatch();
+    BOOST_CHECK(batch->TxnBegin());
+    {
+        // The batch transaction already groups the writes, so the group leaves it alone
+        DatabaseWriteGroup group(database);
+        BOOST_CHECK(batch->Write(std::string{"a"}, 1));
+
+        // Batch transactions inside the group still nest, in the batch transaction
+        auto other_batch = database.MakeBatch();
+        BOOST_CHECK(other_batch->TxnBegin());
+        BOOST_CHECK(other_batch->Write(std::string{"b"}, 2));
+        BOOST_CHECK(other_batch->TxnAbort());
+        BOOST_CHECK(other_batch->TxnBegin());
+        BOOST_CHECK(other_batch->Write(std::string{"c"}, 3));
+        BOOST_CHECK(other_batch->TxnCommit());
+    }
+    BOOST_CHECK(InTransaction(database));
+    BOOST_CHECK(batch->TxnCommit());
+    BOOST_CHECK(!InTransaction(database));
+    BOOST_CHECK(batch->Exists(std::string{"a"}));
+    BOOST_CHECK(!batch->Exists(std::string{"b"}));
+    BOOST_CHECK(batch->Exists(std::string{"c"}));
+}
+
+BOOST_AUTO_TEST_CASE(write_group_per_thread)
+{
+    SQLiteDatabase database("", "", /*mock=*/true);
+    std::atomic<bool> other_group{false};
+    std::thread thread;
+    {
+        DatabaseWriteGroup group(database);
+        BOOST_CHECK(database.MakeBatch()->Write(std::string{"a"}, 1));
+        thread = std::thread([&] {
+            DatabaseWriteGroup group(database);
+            other_group = true;
+            BOOST_CHECK(database.MakeBatch()->Write(std::string{"b"}, 2));
+            group.Commit();
+        });
+        // The group of the other thread waits for this one to end rather than joining it
+        UninterruptibleSleep(std::chrono::milliseconds{100});
+        BOOST_CHECK(!other_group);
+        group.Commit();
+    }
+    thread.join();
+    BOOST_CHECK(other_group);
+    BOOST_CHECK(!InTransaction(database));
+    auto batch = database.MakeBatch();
+    BOOST_CHECK(batch->Exists(std::string{"a"}));
+    BOOST_CHECK(batch->Exists(std::string{"b"}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
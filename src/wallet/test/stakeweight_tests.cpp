@@ -0,0 +1,149 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <key.h>
+#include <node/context.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+#include <wallet/stake.h>
+#include <wallet/stakeweight.h>
+#include <wallet/wallet.h>
+#include <wallet/walletdb.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(stakeweight_tests, BasicTestingSetup)
+
+static const CAmount SUPER_STAKER_VALUE = 100 * COIN;
+
+BOOST_AUTO_TEST_CASE(maturity_boundary)
+{
+    StakeWeightTracker tracker(SUPER_STAKER_VALUE);
+    const uint256 hash = InsecureRand256();
+    tracker.AddCoin(COutPoint(hash, 0), 1 * COIN, 10);
+    tracker.AddCoin(COutPoint(hash, 1), 2 * COIN, 20);
+    tracker.AddCoin(COutPoint(InsecureRand256(), 0), 4 * COIN, 20);
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 3U);
+
+    tracker.SetMaturityBoundary(9);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 0);
+    BOOST_CHECK_EQUAL(tracker.GetImmatureAmount(), 7 * COIN);
+
+    tracker.SetMaturityBoundary(10);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 1 * COIN);
+    tracker.SetMaturityBoundary(25);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 7 * COIN);
+    BOOST_CHECK_EQUAL(tracker.GetImmatureAmount(), 0);
+
+    // A reorg moves the boundary back.
+    tracker.SetMaturityBoundary(15);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 1 * COIN);
+    BOOST_CHECK_EQUAL(tracker.GetImmatureAmount(), 6 * COIN);
+
+    // Coins added below the boundary are mature right away.
+    tracker.AddCoin(COutPoint(InsecureRand256(), 0), 8 * COIN, 5);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 9 * COIN);
+}
+
+BOOST_AUTO_TEST_CASE(update_and_remove)
+{
+    StakeWeightTracker tracker(SUPER_STAKER_VALUE);
+    tracker.SetMaturityBoundary(100);
+    const uint256 hash = InsecureRand256();
+    const COutPoint other(InsecureRand256(), 0);
+    tracker.AddCoin(COutPoint(hash, 0), 1 * COIN, 50);
+    tracker.AddCoin(COutPoint(hash, 1), 2 * COIN, 50);
+    tracker.AddCoin(other, 4 * COIN, 50);
+
+    // Updating a coin replaces it; a reorg can confirm it at another height.
+    tracker.AddCoin(other, 4 * COIN, 150);
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 3U);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 3 * COIN);
+    BOOST_CHECK_EQUAL(tracker.GetImmatureAmount(), 4 * COIN);
+
+    tracker.RemoveCoin(COutPoint(hash, 0));
+    tracker.RemoveCoin(COutPoint(hash, 0));
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 2 * COIN);
+
+    tracker.RemoveTx(hash);
+    BOOST_CHECK_EQUAL(tracker.CoinCount(), 1U);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 0);
+
+    tracker.SetMaturityBoundary(200);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 4 * COIN);
+    tracker.RemoveCoin(other);
+    BOOST_CHECK_EQUAL(tracker.GetMatureAmount(), 0);
+    BOOST_CHECK_EQUAL(tracker.GetImmatureAmount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(super_staker_coin)
+{
+    StakeWeightTracker tracker(SUPER_STAKER_VALUE);
+    const COutPoint small(InsecureRand256(), 0);
+    const COutPoint large(InsecureRand256(), 0);
+    tracker.AddCoin(small, SUPER_STAKER_VALUE - 1, 10);
+    tracker.AddCoin(large, SUPER_STAKER_VALUE, 20);
+
+    tracker.SetMaturityBoundary(10);
+    BOOST_CHECK(!tracker.HasSuperStakerCoin());
+    tracker.SetMaturityBoundary(20);
+    BOOST_CHECK(tracker.HasSuperStakerCoin());
+    tracker.RemoveCoin(large);
+    BOOST_CHECK(!tracker.HasSuperStakerCoin());
+}
+
+BOOST_FIXTURE_TEST_CASE(tracked_weight_matches_selection, TestChain100Setup)
+{
+    // Pay a coinbase to a key the wallet only watches and let it mature with the first coinbases.
+    CKey watch_key;
+    watch_key.MakeNewKey(true);
+    const CScript watch_script{GetScriptForRawPubKey(watch_key.GetPubKey())};
+    const CTransactionRef watch_coinbase{CreateAndProcessBlock({}, watch_script).vtx[0]};
+    mineBlocks(Params().GetConsensus().CoinbaseMaturity(0) + 1);
+
+    CWallet wallet(m_node.chain.get(), "", m_args, CreateDummyWalletDatabase());
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SetLastBlockProcessed(m_node.chainman->ActiveChain().Height(), m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+        LegacyScriptPubKeyMan* spk_man = wallet.GetOrCreateLegacyScriptPubKeyMan();
+        LOCK(spk_man->cs_KeyStore);
+        BOOST_CHECK(spk_man->AddKeyPubKey(coinbaseKey, coinbaseKey.GetPubKey()));
+        BOOST_CHECK(spk_man->AddWatchOnly(watch_script, /*nCreateTime=*/1));
+    }
+    {
+        WalletRescanReserver reserver(wallet);
+        reserver.reserve();
+        CWallet::ScanResult result = wallet.ScanForWalletTransactions(m_node.chainman->ActiveChain().Genesis()->GetBlockHash(), 0 /* start_height */, {} /* max_height */, reserver, false /* update */);
+        BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+    }
+
+    LOCK(wallet.cs_wallet);
+    const CWalletTx* watch_wtx = wallet.GetWalletTx(watch_coinbase->GetHash());
+    BOOST_REQUIRE(watch_wtx);
+    BOOST_CHECK_EQUAL(wallet.GetTxBlocksToMaturity(*watch_wtx), 0);
+
+    // The full scan stakes the mature spendable coins only, not the watch-only one.
+    std::set<std::pair<const CWalletTx*, unsigned int>> setCoins;
+    CAmount nTargetValue = MAX_MONEY;
+    CAmount nValueIn = 0;
+    BOOST_CHECK(SelectCoinsForStaking(wallet, nTargetValue, setCoins, nValueIn));
+    const int coinbaseMaturity = Params().GetConsensus().CoinbaseMaturity(wallet.GetLastBlockHeight() + 1);
+    uint64_t selected_weight = 0;
+    for (const auto& [wtx, n] : setCoins) {
+        BOOST_CHECK(wtx != watch_wtx);
+        if (wallet.GetTxDepthInMainChain(*wtx) >= coinbaseMaturity) selected_weight += wtx->tx->vout[n].nValue;
+    }
+    BOOST_CHECK(selected_weight > 0);
+
+    // The tracked weight agrees with it.
+    BOOST_REQUIRE_EQUAL(wallet.m_reserve_balance, 0);
+    uint64_t staker_weight = 0;
+    GetStakeWeight(wallet, &staker_weight);
+    BOOST_CHECK_EQUAL(staker_weight, selected_weight);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
@@ -0,0 +1,181 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <wallet/tokentracker.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(tokentracker_tests, BasicTestingSetup)
+
+static const uint160 CONTRACT{ParseHex("00000000000000000000000000000000000000aa")};
+static const uint160 ALICE{ParseHex("00000000000000000000000000000000000000a1")};
+static const uint160 BOB{ParseHex("00000000000000000000000000000000000000b0")};
+static const uint160 CAROL{ParseHex("00000000000000000000000000000000000000c0")};
+
+static uint256 Value(uint64_t value)
+{
+    std::vector<unsigned char> bytes(32, 0);
+    for (int i = 31; value; --i, value >>= 8) bytes[i] = value & 0xff;
+    return uint256(bytes);
+}
+
+static TokenTransfer Transfer(const uint160& from, const uint160& to, uint64_t value)
+{
+    TokenTransfer transfer;
+    transfer.tx_hash = InsecureRand256();
+    transfer.contract = CONTRACT;
+    transfer.from = from;
+    transfer.to = to;
+    transfer.value = Value(value);
+    return transfer;
+}
+
+static TokenTransfer Burn(const uint160& from, uint64_t value)
+{
+    TokenTransfer transfer = Transfer(from, uint160(), value);
+    transfer.burn = true;
+    return transfer;
+}
+
+BOOST_AUTO_TEST_CASE(decode_transfer)
+{
+    interfaces::ContractLog log;
+    log.tx_hash = InsecureRand256();
+    log.address = CONTRACT;
+    log.topics.push_back(uint256(ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef")));
+    log.topics.push_back(uint256(ParseHex("00000000000000000000000000000000000000000000000000000000000000a1")));
+    log.topics.push_back(uint256(ParseHex("00000000000000000000000000000000000000000000000000000000000000b0")));
+    log.data = ParseHex("0000000000000000000000000000000000000000000000000000000000000100");
+
+    std::optional<TokenTransfer> transfer = DecodeTokenTransfer(log);
+    BOOST_REQUIRE(transfer);
+    BOOST_CHECK(transfer->tx_hash == log.tx_hash);
+    BOOST_CHECK(transfer->contract == CONTRACT);
+    BOOST_CHECK(transfer->from == ALICE);
+    BOOST_CHECK(transfer->to == BOB);
+    BOOST_CHECK(transfer->value == Value(256));
+    BOOST_CHECK(!transfer->burn);
+
+    // Burn(address,uint256) has no receiver
+    log.topics[0] = uint256(ParseHex("cc16f5dbb4873280815c1ee09dbd06736cffcc184412cf7a71a0fdb75d397ca5"));
+    log.topics.pop_back();
+    transfer = DecodeTokenTransfer(log);
+    BOOST_REQUIRE(transfer);
+    BOOST_CHECK(transfer->burn);
+    BOOST_CHECK(transfer->from == ALICE);
+
+    // Other events are ignored
+    log.topics[0] = InsecureRand256();
+    BOOST_CHECK(!DecodeTokenTransfer(log));
+
+    // A Transfer without an indexed receiver affects holders that are not known
+    log.topics[0] = uint256(ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef"));
+    transfer = DecodeTokenTransfer(log);
+    BOOST_REQUIRE(transfer);
+    BOOST_CHECK(transfer->undecodable);
+    BOOST_CHECK(!transfer->holders_known);
+    BOOST_CHECK(TokenTransferAffects(*transfer, CAROL));
+
+    // A value that is not the payload is not known
+    log.topics.push_back(uint256(ParseHex("00000000000000000000000000000000000000000000000000000000000000b0")));
+    log.data.resize(16);
+    transfer = DecodeTokenTransfer(log);
+    BOOST_REQUIRE(transfer);
+    BOOST_CHECK(transfer->undecodable);
+    BOOST_CHECK(transfer->holders_known);
+    BOOST_CHECK(transfer->from == ALICE);
+    BOOST_CHECK(transfer->to == BOB);
+    BOOST_CHECK(!TokenTransferAffects(*transfer, CAROL));
+}
+
+BOOST_AUTO_TEST_CASE(balance_follows_blocks)
+{
+    TokenTracker tracker;
+    tracker.TrackToken(CONTRACT, ALICE);
+
+    // History is recorded before the balance is known
+    const std::vector<TokenTransfer> other{Transfer(BOB, CAROL, 5)};
+    BOOST_CHECK(tracker.BlockConnected(InsecureRand256(), 10, other).empty());
+    BOOST_CHECK_EQUAL(tracker.BlockConnected(InsecureRand256(), 11, {Transfer(BOB, ALICE, 7)}).size(), 1U);
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, ALICE));
+
+    // Blocks up to the height the balance was set at are included already
+    tracker.SetBalance(CONTRACT, ALICE, Value(100), 12);
+    tracker.BlockConnected(InsecureRand256(), 12, {Transfer(BOB, ALICE, 7)});
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(100));
+
+    tracker.BlockConnected(InsecureRand256(), 13, {Transfer(BOB, ALICE, 50), Transfer(ALICE, BOB, 30)});
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(120));
+    tracker.BlockConnected(InsecureRand256(), 14, {Transfer(ALICE, ALICE, 120), Burn(ALICE, 20)});
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(100));
+
+    // Spending more than the balance means the token does not follow its events
+    tracker.BlockConnected(InsecureRand256(), 15, {Transfer(ALICE, BOB, 101)});
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, ALICE));
+
+    tracker.UntrackToken(CONTRACT, ALICE);
+    BOOST_CHECK(tracker.Empty());
+    BOOST_CHECK(tracker.BlockConnected(InsecureRand256(), 16, {Transfer(BOB, ALICE, 1)}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(undecodable_transfer)
+{
+    TokenTracker tracker;
+    tracker.TrackToken(CONTRACT, ALICE);
+    tracker.TrackToken(CONTRACT, BOB);
+    tracker.SetBalance(CONTRACT, ALICE, Value(100), 30);
+    tracker.SetBalance(CONTRACT, BOB, Value(50), 30);
+
+    // The balance of the holder is queried again, the other holders keep theirs
+    TokenTransfer transfer = Transfer(ALICE, CAROL, 0);
+    transfer.undecodable = true;
+    BOOST_CHECK_EQUAL(tracker.BlockConnected(InsecureRand256(), 31, {transfer}).size(), 1U);
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, ALICE));
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, BOB) == Value(50));
+
+    // Without the holders every balance of the contract is queried again
+    tracker.SetBalance(CONTRACT, ALICE, Value(100), 31);
+    transfer.holders_known = false;
+    const uint256 block_32 = InsecureRand256();
+    BOOST_CHECK_EQUAL(tracker.BlockConnected(block_32, 32, {transfer}).size(), 1U);
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, ALICE));
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, BOB));
+    BOOST_CHECK_EQUAL(tracker.BlockDisconnected(block_32, 32).size(), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(reorg)
+{
+    TokenTracker tracker;
+    tracker.TrackToken(CONTRACT, ALICE);
+    tracker.TrackToken(CONTRACT, BOB);
+    tracker.SetBalance(CONTRACT, ALICE, Value(100), 20);
+    tracker.SetBalance(CONTRACT, BOB, Value(50), 21);
+
+    const uint256 block_21 = InsecureRand256();
+    const uint256 block_22 = InsecureRand256();
+    tracker.BlockConnected(block_21, 21, {Transfer(ALICE, BOB, 40)});
+    tracker.BlockConnected(block_22, 22, {Transfer(BOB, ALICE, 15), Burn(ALICE, 5)});
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(70));
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, BOB) == Value(35));
+
+    // The history of the block is returned, so its transactions become unconfirmed
+    BOOST_CHECK_EQUAL(tracker.BlockDisconnected(block_22, 22).size(), 2U);
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(60));
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, BOB) == Value(50));
+
+    // The balance of BOB was set at block 21, which can not be undone
+    BOOST_CHECK_EQUAL(tracker.BlockDisconnected(block_21, 21).size(), 1U);
+    BOOST_CHECK(*tracker.GetBalance(CONTRACT, ALICE) == Value(100));
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, BOB));
+
+    // Without undo data for a block, the balances that included it are forgotten
+    BOOST_CHECK(tracker.BlockDisconnected(InsecureRand256(), 20).empty());
+    BOOST_CHECK(!tracker.GetBalance(CONTRACT, ALICE));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
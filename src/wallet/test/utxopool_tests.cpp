@@ -0,0 +1,48 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <wallet/utxopool.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(utxopool_tests, BasicTestingSetup)
+
+static UtxoPool::Coin MakeCoin(CAmount value)
+{
+    return UtxoPool::Coin{value, ISMINE_SPENDABLE, true, 68, OutputType::BECH32};
+}
+
+BOOST_AUTO_TEST_CASE(value_index)
+{
+    UtxoPool pool;
+    const COutPoint a(InsecureRand256(), 0);
+    const COutPoint b(InsecureRand256(), 1);
+    const COutPoint c(InsecureRand256(), 0);
+    pool.AddCoin(a, MakeCoin(5 * COIN));
+    pool.AddCoin(b, MakeCoin(1 * COIN));
+    pool.AddCoin(c, MakeCoin(3 * COIN));
+    BOOST_CHECK_EQUAL(pool.CoinCount(), 3U);
+
+    // A range is returned in the order of the outpoints
+    std::vector<COutPoint> expected{a, c};
+    std::sort(expected.begin(), expected.end());
+    BOOST_CHECK(pool.GetCoinsInRange(3 * COIN, 5 * COIN) == expected);
+    BOOST_CHECK(pool.GetCoinsInRange(2 * COIN, 2 * COIN).empty());
+
+    // Updating a coin moves it in the value index
+    pool.AddCoin(a, MakeCoin(2 * COIN));
+    BOOST_CHECK(pool.GetCoinsInRange(2 * COIN, 2 * COIN) == std::vector<COutPoint>({a}));
+    BOOST_CHECK(pool.GetCoinsInRange(4 * COIN, MAX_MONEY).empty());
+    BOOST_CHECK_EQUAL(pool.GetCoins().at(a).value, 2 * COIN);
+
+    pool.RemoveCoin(b);
+    pool.RemoveTx(c.hash);
+    BOOST_CHECK_EQUAL(pool.CoinCount(), 1U);
+    BOOST_CHECK(pool.GetCoinsInRange(0, MAX_MONEY) == std::vector<COutPoint>({a}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
@@ -197,6 +197,58 @@ BOOST_FIXTURE_TEST_CASE(scan_for_wallet_transactions, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(balance_snapshot, TestChain100Setup)
+{
+    CWallet wallet(m_node.chain.get(), "", m_args, CreateDummyWalletDatabase());
+    {
+        LOCK(wallet.cs_wallet);
+        wallet.SetWalletFlag(WALLET_FLAG_DESCRIPTORS);
+        wallet.SetLastBlockProcessed(m_node.chainman->ActiveChain().Height(), m_node.chainman->ActiveChain().Tip()->GetBlockHash());
+    }
+    AddKey(wallet, coinbaseKey);
+
+    // The published snapshot is reused while the wallet does not change
+    const auto empty_snapshot = GetBalanceSnapshot(wallet);
+    BOOST_CHECK_EQUAL(empty_snapshot->balance.m_mine_immature, 0);
+    BOOST_CHECK_EQUAL(empty_snapshot->block_height, m_node.chainman->ActiveChain().Height());
+    BOOST_CHECK(GetBalanceSnapshot(wallet) == empty_snapshot);
+
+    std::shared_ptr<const BalanceSnapshot> scanned_snapshot;
+    {
+        WalletRescanReserver reserver(wallet);
+        reserver.reserve();
+
+        // During a rescan the last published snapshot is served even if it is out of date
+        wallet.MarkDirty();
+        BOOST_CHECK(GetBalanceSnapshot(wallet) == empty_snapshot);
+
+        // The rescan publishes the balances it found when it completes
+        CWallet::ScanResult result = wallet.ScanForWalletTransactions(m_node.chainman->ActiveChain().Genesis()->GetBlockHash(), 0 /* start_height */, {} /* max_height */, reserver, false /* update */);
+        BOOST_CHECK_EQUAL(result.status, CWallet::ScanResult::SUCCESS);
+        scanned_snapshot = GetBalanceSnapshot(wallet);
+        BOOST_CHECK(scanned_snapshot != empty_snapshot);
+        BOOST_CHECK(scanned_snapshot->balance.m_mine_immature > 0);
+        BOOST_CHECK_EQUAL(scanned_snapshot->balance.m_mine_immature, GetBalance(wallet).m_mine_immature);
+        BOOST_CHECK_EQUAL(scanned_snapshot->balance.m_mine_trusted, GetBalance(wallet).m_mine_trusted);
+
+        // The wallet's own transactions republish the snapshot even during a rescan
+        CMutableTransaction spend;
+        spend.vin.emplace_back(m_coinbase_txns[0]->GetHash(), 0);
+        spend.vout.emplace_back(1 * COIN, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+        wallet.CommitTransaction(MakeTransactionRef(spend), {}, {});
+        const auto committed_snapshot = GetBalanceSnapshot(wallet);
+        BOOST_CHECK(committed_snapshot != scanned_snapshot);
+        BOOST_CHECK_EQUAL(committed_snapshot->generation, wallet.m_balance_generation.load());
+        scanned_snapshot = committed_snapshot;
+    }
+
+    // Outside of a rescan an out of date snapshot is recomputed
+    wallet.MarkDirty();
+    const auto snapshot = GetBalanceSnapshot(wallet);
+    BOOST_CHECK(snapshot != scanned_snapshot);
+    BOOST_CHECK_EQUAL(snapshot->balance.m_mine_immature, scanned_snapshot->balance.m_mine_immature);
+}
+
 BOOST_FIXTURE_TEST_CASE(importmulti_rescan, TestChain100Setup)
 {
     // Cap last block file size, and mine new block in a new block file.
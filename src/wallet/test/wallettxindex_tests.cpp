@@ -0,0 +1,95 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <test/util/setup_common.h>
+#include <wallet/transaction.h>
+#include <wallet/wallettxindex.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace wallet {
+BOOST_FIXTURE_TEST_SUITE(wallettxindex_tests, BasicTestingSetup)
+
+static CTransactionRef MakeTx(const std::vector<CScript>& scripts)
+{
+    CMutableTransaction tx;
+    tx.nLockTime = InsecureRand32(); // so all transactions get different hashes
+    for (const CScript& script : scripts) {
+        tx.vout.emplace_back(COIN, script);
+    }
+    return MakeTransactionRef(tx);
+}
+
+static std::vector<uint256> Sorted(std::vector<uint256> hashes)
+{
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
+BOOST_AUTO_TEST_CASE(by_height)
+{
+    WalletTxIndex index;
+    const CScript script = CScript() << OP_TRUE;
+    CWalletTx confirmed(MakeTx({script}), TxStateConfirmed{InsecureRand256(), 10, 0, false});
+    CWalletTx conflicted(MakeTx({script}), TxStateConflicted{InsecureRand256(), 20});
+    CWalletTx mempool(MakeTx({script}), TxStateInMempool{});
+    index.AddTx(confirmed);
+    index.AddTx(conflicted);
+    index.AddTx(mempool);
+    BOOST_CHECK_EQUAL(index.TxCount(), 3U);
+
+    // Transactions not in a block are always included
+    BOOST_CHECK(index.GetTxsAbove(5) == Sorted({confirmed.GetHash(), conflicted.GetHash(), mempool.GetHash()}));
+    BOOST_CHECK(index.GetTxsAbove(10) == Sorted({conflicted.GetHash(), mempool.GetHash()}));
+    BOOST_CHECK(index.GetTxsAbove(20) == Sorted({mempool.GetHash()}));
+
+    // A change of state moves the transaction
+    mempool.m_state = TxStateConfirmed{InsecureRand256(), 30, 1, false};
+    index.AddTx(mempool);
+    confirmed.m_state = TxStateInactive{};
+    index.AddTx(confirmed);
+    BOOST_CHECK_EQUAL(index.TxCount(), 3U);
+    BOOST_CHECK(index.GetTxsAbove(20) == Sorted({confirmed.GetHash(), mempool.GetHash()}));
+    BOOST_CHECK(index.GetTxsAbove(30) == Sorted({confirmed.GetHash()}));
+
+    index.RemoveTx(confirmed);
+    BOOST_CHECK(index.GetTxsAbove(0) == Sorted({conflicted.GetHash(), mempool.GetHash()}));
+    index.Clear();
+    BOOST_CHECK_EQUAL(index.TxCount(), 0U);
+    BOOST_CHECK(index.GetTxsAbove(0).empty());
+}
+
+BOOST_AUTO_TEST_CASE(by_destination)
+{
+    WalletTxIndex index;
+    CKey key, other_key;
+    key.MakeNewKey(true);
+    other_key.MakeNewKey(true);
+    const PKHash pkhash(key.GetPubKey());
+    const CScript p2pkh = GetScriptForDestination(pkhash);
+    const CScript p2pk = GetScriptForRawPubKey(key.GetPubKey());
+    const CScript other = GetScriptForDestination(PKHash(other_key.GetPubKey()));
+
+    CWalletTx a(MakeTx({p2pkh, other}), TxStateInactive{});
+    CWalletTx b(MakeTx({other}), TxStateInactive{});
+    // Pay to pubkey outputs, like those of coinstakes, are found by the key hash
+    CWalletTx c(MakeTx({p2pk}), TxStateInactive{});
+    CWalletTx d(MakeTx({CScript() << OP_RETURN}), TxStateInactive{});
+    for (const CWalletTx* wtx : {&a, &b, &c, &d}) {
+        index.AddTx(*wtx);
+    }
+
+    BOOST_CHECK(index.GetTxsPayingTo(pkhash) == Sorted({a.GetHash(), c.GetHash()}));
+    CTxDestination dest;
+    BOOST_CHECK(ExtractDestination(other, dest));
+    BOOST_CHECK(index.GetTxsPayingTo(dest) == Sorted({a.GetHash(), b.GetHash()}));
+    BOOST_CHECK(index.GetTxsPayingTo(CNoDestination()).empty());
+
+    index.RemoveTx(a);
+    BOOST_CHECK(index.GetTxsPayingTo(pkhash) == Sorted({c.GetHash()}));
+    BOOST_CHECK(index.GetTxsPayingTo(dest) == Sorted({b.GetHash()}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+} // namespace wallet
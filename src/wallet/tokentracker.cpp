@@ -0,0 +1,198 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/tokentracker.h>
+
+#include <arith_uint256.h>
+#include <util/strencodings.h>
+
+#include <algorithm>
+
+namespace wallet {
+namespace {
+//! keccak256("Transfer(address,address,uint256)")
+const uint256 TRANSFER_TOPIC{ParseHex("ddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef")};
+//! keccak256("Burn(address,uint256)")
+const uint256 BURN_TOPIC{ParseHex("cc16f5dbb4873280815c1ee09dbd06736cffcc184412cf7a71a0fdb75d397ca5")};
+
+/** An address topic is the address left padded to 32 bytes. */
+uint160 TopicToAddress(const uint256& topic)
+{
+    return uint160(std::vector<unsigned char>(topic.begin() + 12, topic.end()));
+}
+
+arith_uint256 ToArith(const uint256& value)
+{
+    uint256 little_endian;
+    std::reverse_copy(value.begin(), value.end(), little_endian.begin());
+    return UintToArith256(little_endian);
+}
+
+uint256 FromArith(const arith_uint256& value)
+{
+    const uint256 little_endian = ArithToUint256(value);
+    uint256 big_endian;
+    std::reverse_copy(little_endian.begin(), little_endian.end(), big_endian.begin());
+    return big_endian;
+}
+} // namespace
+
+std::optional<TokenTransfer> DecodeTokenTransfer(const interfaces::ContractLog& log)
+{
+    if (log.topics.empty()) return std::nullopt;
+
+    TokenTransfer transfer;
+    if (log.topics[0] == BURN_TOPIC) {
+        transfer.burn = true;
+    } else if (log.topics[0] != TRANSFER_TOPIC) {
+        return std::nullopt;
+    }
+    transfer.tx_hash = log.tx_hash;
+    transfer.contract = log.address;
+
+    // The addresses are indexed and the value is the payload
+    const size_t topics = transfer.burn ? 2 : 3;
+    if (log.topics.size() < topics) {
+        transfer.undecodable = true;
+        transfer.holders_known = false;
+        return transfer;
+    }
+    transfer.from = TopicToAddress(log.topics[1]);
+    if (!transfer.burn) transfer.to = TopicToAddress(log.topics[2]);
+    if (log.topics.size() > topics || log.data.size() < 32) {
+        transfer.undecodable = true;
+        return transfer;
+    }
+    transfer.value = uint256(std::vector<unsigned char>(log.data.begin(), log.data.begin() + 32));
+    return transfer;
+}
+
+bool TokenTransferAffects(const TokenTransfer& transfer, const uint160& holder)
+{
+    if (!transfer.holders_known) return true;
+    return transfer.from == holder || (!transfer.burn && transfer.to == holder);
+}
+
+void TokenTracker::TrackToken(const uint160& contract, const uint160& holder)
+{
+    m_tokens.try_emplace({contract, holder});
+}
+
+void TokenTracker::UntrackToken(const uint160& contract, const uint160& holder)
+{
+    m_tokens.erase({contract, holder});
+}
+
+void TokenTracker::SetBalance(const uint160& contract, const uint160& holder, const uint256& balance, int height)
+{
+    auto it = m_tokens.find({contract, holder});
+    if (it == m_tokens.end()) return;
+    it->second.balance = balance;
+    it->second.height = height;
+}
+
+std::optional<uint256> TokenTracker::GetBalance(const uint160& contract, const uint160& holder) const
+{
+    auto it = m_tokens.find({contract, holder});
+    if (it == m_tokens.end()) return std::nullopt;
+    return it->second.balance;
+}
+
+void TokenTracker::ForgetBalances()
+{
+    for (auto& [key, token] : m_tokens) {
+        token.balance.reset();
+    }
+}
+
+void TokenTracker::Apply(Token& token, const uint160& holder, const TokenTransfer& transfer, bool undo)
+{
+    if (!token.balance) return;
+
+    // The value is not known, so the balance has to be queried again
+    if (transfer.undecodable) {
+        token.balance.reset();
+        return;
+    }
+
+    const arith_uint256 value = ToArith(transfer.value);
+    arith_uint256 received = !transfer.burn && transfer.to == holder ? value : arith_uint256();
+    arith_uint256 sent = transfer.from == holder ? value : arith_uint256();
+    if (undo) std::swap(received, sent);
+
+    // A token that does not follow its events can not be tracked
+    arith_uint256 balance = ToArith(*token.balance) + received;
+    if (balance < received || balance < sent) {
+        token.balance.reset();
+        return;
+    }
+    token.balance = FromArith(balance - sent);
+}
+
+std::vector<TokenTransfer> TokenTracker::BlockConnected(const uint256& block_hash, int height, const std::vector<TokenTransfer>& transfers)
+{
+    BlockUndo& undo = m_undo[height];
+    undo = BlockUndo{block_hash, {}, {}};
+    for (auto& [key, token] : m_tokens) {
+        if (token.balance && token.height < height) {
+            token.height = height;
+            undo.applied.push_back(key);
+        }
+    }
+
+    for (const TokenTransfer& transfer : transfers) {
+        std::vector<uint160> holders;
+        if (transfer.holders_known) {
+            // A transfer to self is applied once, for a net change of zero
+            holders.push_back(transfer.from);
+            if (!transfer.burn && transfer.to != transfer.from) holders.push_back(transfer.to);
+        } else {
+            // Any holder of the contract may be affected
+            for (auto it = m_tokens.lower_bound({transfer.contract, uint160()}); it != m_tokens.end() && it->first.first == transfer.contract; ++it) {
+                holders.push_back(it->first.second);
+            }
+        }
+
+        bool tracked = false;
+        for (const uint160& holder : holders) {
+            const TokenKey key{transfer.contract, holder};
+            auto it = m_tokens.find(key);
+            if (it == m_tokens.end()) continue;
+            tracked = true;
+            if (std::find(undo.applied.begin(), undo.applied.end(), key) != undo.applied.end()) {
+                Apply(it->second, holder, transfer, /*undo=*/false);
+            }
+        }
+        if (tracked) undo.transfers.push_back(transfer);
+    }
+
+    m_undo.erase(m_undo.begin(), m_undo.lower_bound(height - TOKEN_UNDO_BLOCKS + 1));
+    return undo.transfers;
+}
+
+std::vector<TokenTransfer> TokenTracker::BlockDisconnected(const uint256& block_hash, int height)
+{
+    std::vector<TokenTransfer> transfers;
+    auto undo = m_undo.find(height);
+    if (undo != m_undo.end() && undo->second.block_hash == block_hash) {
+        for (const TokenKey& key : undo->second.applied) {
+            auto it = m_tokens.find(key);
+            if (it == m_tokens.end()) continue;
+            for (auto transfer = undo->second.transfers.rbegin(); transfer != undo->second.transfers.rend(); ++transfer) {
+                if (transfer->contract != key.first || !TokenTransferAffects(*transfer, key.second)) continue;
+                Apply(it->second, key.second, *transfer, /*undo=*/true);
+            }
+            it->second.height = height - 1;
+        }
+        transfers = std::move(undo->second.transfers);
+        m_undo.erase(undo);
+    }
+
+    // Balances set at or above the disconnected block no longer match the chain
+    for (auto& [key, token] : m_tokens) {
+        if (token.height >= height) token.balance.reset();
+    }
+    return transfers;
+}
+} // namespace wallet
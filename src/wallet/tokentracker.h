@@ -0,0 +1,94 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_TOKENTRACKER_H
+#define QTUM_WALLET_TOKENTRACKER_H
+
+#include <interfaces/chain.h>
+#include <uint256.h>
+
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace wallet {
+//! Number of blocks for which the token transfers are kept to undo a reorg
+static constexpr int TOKEN_UNDO_BLOCKS{500};
+
+/** A QRC20 Transfer or Burn event. Addresses and value are in EVM byte order. */
+struct TokenTransfer
+{
+    uint256 tx_hash;
+    uint160 contract;
+    uint160 from;
+    //! Null for burns
+    uint160 to;
+    //! Big endian, like CTokenTx::nValue
+    uint256 value;
+    bool burn{false};
+    //! The log has the topic of a Transfer or Burn event but not its layout, e.g. an
+    //! indexed value or a short payload, so the balances it changes can not follow it
+    bool undecodable{false};
+    //! Whether from and to are known. Only an undecodable transfer may not know them.
+    bool holders_known{true};
+};
+
+/** Decode a QRC20 Transfer or Burn event from a contract log, possibly as an undecodable transfer. */
+std::optional<TokenTransfer> DecodeTokenTransfer(const interfaces::ContractLog& log);
+/** Whether a transfer may change the balance of holder, not checking the contract. */
+bool TokenTransferAffects(const TokenTransfer& transfer, const uint160& holder);
+
+/**
+ * The balances and transfers of the wallet tokens, updated from the
+ * Transfer and Burn events of each connected block.
+ *
+ * A balance is known once it was set at some height, e.g. from a balanceOf
+ * call. The transfers of each later block are then applied to it, and undone
+ * when the block is disconnected. A balance that cannot be updated, because a
+ * block it was set at is disconnected or an undecodable transfer may change it,
+ * becomes unknown again.
+ */
+class TokenTracker
+{
+public:
+    /** Track the tokens of contract held by holder. */
+    void TrackToken(const uint160& contract, const uint160& holder);
+    void UntrackToken(const uint160& contract, const uint160& holder);
+    bool Empty() const { return m_tokens.empty(); }
+
+    /** Set the balance of a token as of the block at height. */
+    void SetBalance(const uint160& contract, const uint160& holder, const uint256& balance, int height);
+    std::optional<uint256> GetBalance(const uint160& contract, const uint160& holder) const;
+    /** Forget all balances, when the transfers of a block are not available. */
+    void ForgetBalances();
+
+    /** Apply the transfers of a connected block and return those of tracked tokens. */
+    std::vector<TokenTransfer> BlockConnected(const uint256& block_hash, int height, const std::vector<TokenTransfer>& transfers);
+    /** Undo a disconnected block and return the transfers of tracked tokens it contained. */
+    std::vector<TokenTransfer> BlockDisconnected(const uint256& block_hash, int height);
+
+private:
+    using TokenKey = std::pair<uint160, uint160>;
+    struct Token {
+        std::optional<uint256> balance;
+        //! Height of the last block included in the balance
+        int height{-1};
+    };
+    struct BlockUndo {
+        uint256 block_hash;
+        std::vector<TokenTransfer> transfers;
+        //! Tokens whose balance included the block
+        std::vector<TokenKey> applied;
+    };
+
+    /** Add (or with undo, subtract) a transfer to the balance of a token. */
+    static void Apply(Token& token, const uint160& holder, const TokenTransfer& transfer, bool undo);
+
+    std::map<TokenKey, Token> m_tokens;
+    std::map<int, BlockUndo> m_undo;
+};
+} // namespace wallet
+
+#endif // QTUM_WALLET_TOKENTRACKER_H
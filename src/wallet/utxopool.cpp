@@ -0,0 +1,52 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/utxopool.h>
+
+#include <algorithm>
+
+namespace wallet {
+void UtxoPool::AddCoin(const COutPoint& outpoint, const Coin& coin)
+{
+    auto [it, inserted] = m_coins.emplace(outpoint, coin);
+    if (!inserted) {
+        m_by_value.erase({it->second.value, outpoint});
+        it->second = coin;
+    }
+    m_by_value.emplace(coin.value, outpoint);
+}
+
+void UtxoPool::RemoveCoin(const COutPoint& outpoint)
+{
+    const auto it = m_coins.find(outpoint);
+    if (it == m_coins.end()) return;
+    m_by_value.erase({it->second.value, outpoint});
+    m_coins.erase(it);
+}
+
+void UtxoPool::RemoveTx(const uint256& hash)
+{
+    auto it = m_coins.lower_bound(COutPoint(hash, 0));
+    while (it != m_coins.end() && it->first.hash == hash) {
+        m_by_value.erase({it->second.value, it->first});
+        it = m_coins.erase(it);
+    }
+}
+
+void UtxoPool::ClearCoins()
+{
+    m_coins.clear();
+    m_by_value.clear();
+}
+
+std::vector<COutPoint> UtxoPool::GetCoinsInRange(CAmount min_value, CAmount max_value) const
+{
+    std::vector<COutPoint> outpoints;
+    for (auto it = m_by_value.lower_bound({min_value, COutPoint(uint256(), 0)}); it != m_by_value.end() && it->first <= max_value; ++it) {
+        outpoints.push_back(it->second);
+    }
+    std::sort(outpoints.begin(), outpoints.end());
+    return outpoints;
+}
+} // namespace wallet
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_UTXOPOOL_H
+#define QTUM_WALLET_UTXOPOOL_H
+
+#include <consensus/amount.h>
+#include <outputtype.h>
+#include <primitives/transaction.h>
+#include <uint256.h>
+#include <wallet/dirtytxs.h>
+#include <wallet/ismine.h>
+
+#include <map>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace wallet {
+/**
+ * The unspent outputs of the wallet transactions that belong to the wallet,
+ * with what AvailableCoins needs to know about them that does not depend on
+ * the chain: the ownership, solvability, signed input size and output type.
+ * Coin selection splits the coins by the output type recorded here.
+ *
+ * The coins are also indexed by value, so that AvailableCoins only visits the
+ * coins in the requested amount range.
+ *
+ * The pool is rebuilt from the whole wallet when the keys of the wallet change.
+ */
+class UtxoPool : public DirtyTxTracker
+{
+public:
+    struct Coin {
+        CAmount value;
+        isminetype mine;
+        bool solvable;
+        //! Size of the output as a fully signed input without the maximum signature size, or -1
+        int input_bytes;
+        //! Output type of the script, if it pays a standard destination
+        std::optional<OutputType> type;
+    };
+
+    /** Add or update an unspent output of the wallet. */
+    void AddCoin(const COutPoint& outpoint, const Coin& coin);
+    void RemoveCoin(const COutPoint& outpoint);
+    void RemoveTx(const uint256& hash) override;
+
+    /** All coins, in the order of the wallet transactions and their outputs. */
+    const std::map<COutPoint, Coin>& GetCoins() const { return m_coins; }
+    /** The coins with a value in [min_value, max_value], in the order of GetCoins(). */
+    std::vector<COutPoint> GetCoinsInRange(CAmount min_value, CAmount max_value) const;
+    size_t CoinCount() const { return m_coins.size(); }
+
+protected:
+    void ClearCoins() override;
+
+private:
+    std::map<COutPoint, Coin> m_coins;
+    std::set<std::pair<CAmount, COutPoint>> m_by_value;
+};
+} // namespace wallet
+
+#endif // QTUM_WALLET_UTXOPOOL_H
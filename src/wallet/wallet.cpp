@@ -27,23 +27,29 @@
 #include <txmempool.h>
 #include <util/bip32.h>
 #include <util/check.h>
+#include <util/convert.h>
 #include <util/error.h>
 #include <util/fees.h>
 #include <util/moneystr.h>
 #include <util/rbf.h>
 #include <util/string.h>
+#include <util/thread.h>
 #include <util/translation.h>
 #include <wallet/coincontrol.h>
 #include <wallet/context.h>
 #include <wallet/fees.h>
 #include <wallet/external_signer_scriptpubkeyman.h>
+#include <wallet/receive.h>
 #include <evo/deterministicmns.h>
 
 #include <univalue.h>
 
 #include <algorithm>
 #include <assert.h>
+#include <condition_variable>
+#include <deque>
 #include <optional>
+#include <thread>
 
 #include <boost/algorithm/string/replace.hpp>
 
@@ -877,9 +883,21 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (std::pair<const uint256, CWalletTx>& item : mapWallet)
             item.second.MarkDirty();
+        m_stake_weight.MarkStale();
+        m_utxo_pool.MarkStale();
+        ++m_balance_generation;
     }
 }
 
+void CWallet::TxStateChanged(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+    m_stake_weight.MarkTxDirty(wtx.GetHash());
+    m_utxo_pool.MarkTxDirty(wtx.GetHash());
+    m_tx_index.AddTx(wtx);
+    ++m_balance_generation;
+}
+
 bool CWallet::MarkReplaced(const uint256& originalHash, const uint256& newHash)
 {
     LOCK(cs_wallet);
@@ -1068,6 +1086,7 @@ CWalletTx* CWallet::AddToWallet(CTransactionRef tx, const TxState& state, const
 
     // Break debit/credit balance caches:
     wtx.MarkDirty();
+    TxStateChanged(wtx);
 
     // Notify UI of new or updated transaction
     NotifyTransactionChanged(hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -1135,6 +1154,7 @@ bool CWallet::LoadToWallet(const uint256& hash, const UpdateWalletTxFn& fill_wtx
     if (/* insertion took place */ ins.second) {
         wtx.m_it_wtxOrdered = wtxOrdered.insert(std::make_pair(wtx.nOrderPos, &wtx));
     }
+    m_tx_index.AddTx(wtx);
     AddToSpends(hash);
     for (const CTxIn& txin : wtx.tx->vin) {
         auto it = mapWallet.find(txin.prevout.hash);
@@ -1260,6 +1280,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             assert(!wtx.InMempool());
             wtx.m_state = TxStateInactive{/*abandoned=*/true};
             wtx.MarkDirty();
+            TxStateChanged(wtx);
             batch.WriteTx(wtx);
             NotifyTransactionChanged(wtx.GetHash(), CT_UPDATED);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them abandoned too
@@ -1275,6 +1296,7 @@ bool CWallet::AbandonTransaction(const uint256& hashTx)
             MarkInputsDirty(wtx.tx);
         }
     }
+    RefreshBalanceSnapshot(*this);
 
     return true;
 }
@@ -1312,6 +1334,7 @@ void CWallet::MarkConflicted(const uint256& hashBlock, int conflicting_height, c
             // Mark transaction as conflicted with this block.
             wtx.m_state = TxStateConflicted{hashBlock, conflicting_height};
             wtx.MarkDirty();
+            TxStateChanged(wtx);
             batch.WriteTx(wtx);
             // Iterate over all its outputs, and mark transactions in the wallet that spend them conflicted too
             TxSpends::const_iterator iter = mapTxSpends.lower_bound(COutPoint(now, 0));
@@ -1358,7 +1381,9 @@ void CWallet::transactionAddedToMempool(const CTransactionRef& tx, uint64_t memp
     auto it = mapWallet.find(tx->GetHash());
     if (it != mapWallet.end()) {
         RefreshMempoolStatus(it->second, chain());
+        ++m_balance_generation;
     }
+    RefreshBalanceSnapshot(*this);
 }
 
 void CWallet::transactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRemovalReason reason, uint64_t mempool_sequence) {
@@ -1366,6 +1391,7 @@ void CWallet::transactionRemovedFromMempool(const CTransactionRef& tx, MemPoolRe
     auto it = mapWallet.find(tx->GetHash());
     if (it != mapWallet.end()) {
         RefreshMempoolStatus(it->second, chain());
+        ++m_balance_generation;
     }
     // Handle transactions that were removed from the mempool because they
     // conflict with transactions in a newly connected block.
@@ -1403,18 +1429,26 @@ void CWallet::blockConnected(const CBlock& block, int height)
     const uint256& block_hash = block.GetHash();
     bool hasDelegation = block.HasProofOfDelegation();
     LOCK(cs_wallet);
+    DatabaseWriteGroup write_group(GetDatabase());
 
     m_last_block_processed_height = height;
     m_last_block_processed = block_hash;
+    ++m_balance_generation;
     for (size_t index = 0; index < block.vtx.size(); index++) {
         SyncTransaction(block.vtx[index], TxStateConfirmed{block_hash, height, static_cast<int>(index), hasDelegation});
         transactionRemovedFromMempool(block.vtx[index], MemPoolRemovalReason::BLOCK, 0 /* mempool_sequence */);
     }
+
+    m_delegate_coins.BlockConnected(block, height);
+    SyncTokenTransfers(block, height);
+    write_group.Commit();
+    RefreshBalanceSnapshot(*this);
 }
 
 void CWallet::blockDisconnected(const CBlock& block, int height)
 {
     LOCK(cs_wallet);
+    DatabaseWriteGroup write_group(GetDatabase());
 
     // At block disconnection, this will change an abandoned transaction to
     // be unconfirmed, whether or not the transaction is added back to the mempool.
@@ -1422,9 +1456,15 @@ void CWallet::blockDisconnected(const CBlock& block, int height)
     // future with a stickier abandoned state or even removing abandontransaction call.
     m_last_block_processed_height = height - 1;
     m_last_block_processed = block.hashPrevBlock;
+    ++m_balance_generation;
     for (const CTransactionRef& ptx : block.vtx) {
         SyncTransaction(ptx, TxStateInactive{false, ptx->IsCoinStake()});
     }
+
+    m_delegate_coins.BlockDisconnected();
+    UndoTokenTransfers(block, height);
+    write_group.Commit();
+    RefreshBalanceSnapshot(*this);
 }
 
 void CWallet::updatedBlockTip()
@@ -1534,6 +1574,7 @@ void CWallet::SetWalletFlag(uint64_t flags)
 {
     LOCK(cs_wallet);
     m_wallet_flags |= flags;
+    ++m_balance_generation;
     if (!WalletBatch(GetDatabase()).WriteWalletFlags(m_wallet_flags))
         throw std::runtime_error(std::string(__func__) + ": writing wallet flags failed");
 }
@@ -1548,6 +1589,7 @@ void CWallet::UnsetWalletFlagWithDB(WalletBatch& batch, uint64_t flag)
 {
     LOCK(cs_wallet);
     m_wallet_flags &= ~flag;
+    ++m_balance_generation;
     if (!batch.WriteWalletFlags(m_wallet_flags))
         throw std::runtime_error(std::string(__func__) + ": writing wallet flags failed");
 }
@@ -1758,6 +1800,188 @@ int64_t CWallet::RescanFromTime(int64_t startTime, const WalletRescanReserver& r
     return startTime;
 }
 
+namespace {
+/**
+ * Tells a rescan which blocks can be skipped, using the BIP 157 block
+ * filters of the scripts of a descriptor wallet. Filters match spends too,
+ * since they contain the scripts of the outputs a block spends.
+ */
+class FastWalletRescanFilter
+{
+public:
+    explicit FastWalletRescanFilter(const CWallet& wallet) : m_wallet(wallet)
+    {
+        // Legacy wallets may have keys without a known set of scripts
+        assert(!m_wallet.IsLegacy());
+
+        for (ScriptPubKeyMan* spkm : m_wallet.GetAllScriptPubKeyMans()) {
+            auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(spkm)};
+            assert(desc_spkm != nullptr);
+            AddScriptPubKeys(desc_spkm);
+            // Remember the end of ranged descriptors, to add the scripts of a top-up during the scan
+            if (desc_spkm->IsHDEnabled()) {
+                m_last_range_ends.emplace(desc_spkm->GetID(), desc_spkm->GetEndRange());
+            }
+        }
+    }
+
+    /** Add the scripts of descriptors that were topped up since the last call. */
+    void UpdateIfNeeded()
+    {
+        for (auto& [desc_spkm_id, last_range_end] : m_last_range_ends) {
+            auto desc_spkm{dynamic_cast<DescriptorScriptPubKeyMan*>(m_wallet.GetScriptPubKeyMan(desc_spkm_id))};
+            assert(desc_spkm != nullptr);
+            const int32_t current_range_end{desc_spkm->GetEndRange()};
+            if (current_range_end > last_range_end) {
+                AddScriptPubKeys(desc_spkm, last_range_end);
+                last_range_end = current_range_end;
+            }
+        }
+    }
+
+    /** Whether the block may involve the wallet, or std::nullopt if its filter is not available. */
+    std::optional<bool> MatchesBlock(const uint256& block_hash) const
+    {
+        return m_wallet.chain().blockFilterMatchesAny(BlockFilterType::BASIC, block_hash, m_filter_set);
+    }
+
+private:
+    const CWallet& m_wallet;
+    std::map<uint256, int32_t> m_last_range_ends;
+    GCSFilter::ElementSet m_filter_set;
+
+    void AddScriptPubKeys(const DescriptorScriptPubKeyMan* desc_spkm, int32_t minimum_index = 0)
+    {
+        for (const CScript& script_pub_key : desc_spkm->GetScriptPubKeys(minimum_index)) {
+            m_filter_set.emplace(script_pub_key.begin(), script_pub_key.end());
+        }
+    }
+};
+
+/**
+ * Reads the blocks ahead of a rescan on a pool of threads, so that reading
+ * and deserializing the next blocks overlaps with applying the current one
+ * to the wallet. Blocks are still handed out, and applied, in chain order.
+ */
+class RescanBlockPrefetcher
+{
+public:
+    RescanBlockPrefetcher(interfaces::Chain& chain, int threads)
+        : m_chain(chain), m_window(threads * BLOCKS_PER_THREAD)
+    {
+        for (int i = 0; i < threads; ++i) {
+            m_threads.emplace_back(&util::TraceThread, "rescan", [this] { ThreadRead(); });
+        }
+    }
+
+    ~RescanBlockPrefetcher()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv_queue.notify_all();
+        for (std::thread& thread : m_threads) thread.join();
+    }
+
+    /**
+     * Read the block at the given height, and queue the blocks after it on
+     * the chain ending in tip_hash. A block that was not read ahead, for
+     * example after a reorg, is read on the calling thread.
+     */
+    void ReadBlock(const uint256& block_hash, int block_height, const uint256& tip_hash, CBlock& block)
+    {
+        std::shared_ptr<CBlock> prefetched;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            auto it = m_blocks.find(block_height);
+            if (it != m_blocks.end() && it->second.hash != block_hash) {
+                // The chain changed, so drop what was queued along the old one
+                m_blocks.erase(it, m_blocks.end());
+                m_next_height = block_height;
+                it = m_blocks.end();
+            }
+            if (it != m_blocks.end()) {
+                m_cv_read.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return it->second.block != nullptr; });
+                prefetched = std::move(it->second.block);
+            }
+            m_blocks.erase(m_blocks.begin(), m_blocks.upper_bound(block_height));
+        }
+        Enqueue(block_height, tip_hash);
+
+        if (prefetched) {
+            block = std::move(*prefetched);
+        } else {
+            m_chain.findBlock(block_hash, FoundBlock().data(block));
+        }
+    }
+
+private:
+    //! Blocks each thread may have read ahead of the scan
+    static constexpr int BLOCKS_PER_THREAD{8};
+
+    struct PendingBlock {
+        uint256 hash;
+        //! Set once a reader thread has read the block; null block data if it could not be read
+        std::shared_ptr<CBlock> block;
+    };
+
+    interfaces::Chain& m_chain;
+    const int m_window;
+    std::vector<std::thread> m_threads;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv_queue;
+    std::condition_variable m_cv_read;
+    std::map<int, PendingBlock> m_blocks GUARDED_BY(m_mutex);
+    std::deque<int> m_queue GUARDED_BY(m_mutex);
+    int m_next_height GUARDED_BY(m_mutex){-1};
+    bool m_stop GUARDED_BY(m_mutex){false};
+
+    /** Queue the blocks up to m_window past block_height that are not queued yet. */
+    void Enqueue(int block_height, const uint256& tip_hash) LOCKS_EXCLUDED(m_mutex)
+    {
+        int height = std::max(block_height + 1, WITH_LOCK(m_mutex, return m_next_height));
+        for (; height <= block_height + m_window; ++height) {
+            uint256 hash;
+            if (!m_chain.findAncestorByHeight(tip_hash, height, FoundBlock().hash(hash))) break;
+            {
+                LOCK(m_mutex);
+                m_blocks[height].hash = hash;
+                m_queue.push_back(height);
+                m_next_height = height + 1;
+            }
+            m_cv_queue.notify_one();
+        }
+    }
+
+    void ThreadRead() LOCKS_EXCLUDED(m_mutex)
+    {
+        while (true) {
+            int height;
+            uint256 hash;
+            {
+                WAIT_LOCK(m_mutex, lock);
+                m_cv_queue.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+                if (m_stop) return;
+                height = m_queue.front();
+                m_queue.pop_front();
+                const auto it = m_blocks.find(height);
+                if (it == m_blocks.end()) continue;
+                hash = it->second.hash;
+            }
+
+            auto block = std::make_shared<CBlock>();
+            m_chain.findBlock(hash, FoundBlock().data(*block));
+            {
+                LOCK(m_mutex);
+                const auto it = m_blocks.find(height);
+                if (it == m_blocks.end() || it->second.hash != hash) continue;
+                it->second.block = std::move(block);
+            }
+            m_cv_read.notify_all();
+        }
+    }
+};
+} // namespace
+
 /**
  * Scan the block chain (starting in start_block) for transactions
  * from or to us. If fUpdate is true, found transactions that already
@@ -1789,7 +2013,18 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
     uint256 block_hash = start_block;
     ScanResult result;
 
-    WalletLogPrintf("Rescan started from block %s...\n", start_block.ToString());
+    // Skip blocks by their block filter when possible, otherwise read blocks ahead on other threads
+    std::unique_ptr<FastWalletRescanFilter> fast_rescan_filter;
+    std::unique_ptr<RescanBlockPrefetcher> prefetcher;
+    if (!IsLegacy() && chain().hasBlockFilterIndex(BlockFilterType::BASIC)) {
+        fast_rescan_filter = std::make_unique<FastWalletRescanFilter>(*this);
+    } else if (m_rescan_threads > 0) {
+        prefetcher = std::make_unique<RescanBlockPrefetcher>(chain(), m_rescan_threads);
+    }
+
+    WalletLogPrintf("Rescan started from block %s... (%s)\n", start_block.ToString(),
+                    fast_rescan_filter ? "skipping blocks using block filters" :
+                    prefetcher ? strprintf("reading blocks on %d threads", m_rescan_threads) : "reading all blocks");
 
     fAbortRescan = false;
     ShowProgress(strprintf("%s " + _("Rescanning…").translated, GetDisplayName()), 0); // show rescan progress in GUI as dialog or on splashscreen, if rescan required on startup (e.g. due to corruption)
@@ -1814,9 +2049,28 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
             WalletLogPrintf("Still rescanning. At block %d. Progress=%f\n", block_height, progress_current);
         }
 
+        bool fetch_block = true;
+        if (fast_rescan_filter) {
+            fast_rescan_filter->UpdateIfNeeded();
+            // Without a filter for the block, for example while the index is still syncing, read it
+            if (fast_rescan_filter->MatchesBlock(block_hash) == false) {
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+                ++m_scanning_filtered;
+                fetch_block = false;
+            }
+        }
+        ++m_scanning_blocks;
+
         // Read block data
         CBlock block;
-        chain().findBlock(block_hash, FoundBlock().data(block));
+        if (fetch_block) {
+            if (prefetcher) {
+                prefetcher->ReadBlock(block_hash, block_height, tip_hash, block);
+            } else {
+                chain().findBlock(block_hash, FoundBlock().data(block));
+            }
+        }
 
         // Find next block separately from reading data above, because reading
         // is slow and there might be a reorg while it is read.
@@ -1825,26 +2079,30 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         uint256 next_block_hash;
         chain().findBlock(block_hash, FoundBlock().inActiveChain(block_still_active).nextBlock(FoundBlock().inActiveChain(next_block).hash(next_block_hash)));
 
-        if (!block.IsNull()) {
-            LOCK(cs_wallet);
-            if (!block_still_active) {
-                // Abort scan if current block is no longer active, to prevent
-                // marking transactions as coming from the wrong block.
+        if (fetch_block) {
+            if (!block.IsNull()) {
+                LOCK(cs_wallet);
+                if (!block_still_active) {
+                    // Abort scan if current block is no longer active, to prevent
+                    // marking transactions as coming from the wrong block.
+                    result.last_failed_block = block_hash;
+                    result.status = ScanResult::FAILURE;
+                    break;
+                }
+                bool hasDelegation = block.HasProofOfDelegation();
+                DatabaseWriteGroup write_group(GetDatabase());
+                for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
+                    SyncTransaction(block.vtx[posInBlock], TxStateConfirmed{block_hash, block_height, static_cast<int>(posInBlock), hasDelegation}, fUpdate, /*rescanning_old_block=*/true);
+                }
+                write_group.Commit();
+                // scan succeeded, record block as most recent successfully scanned
+                result.last_scanned_block = block_hash;
+                result.last_scanned_height = block_height;
+            } else {
+                // could not scan block, keep scanning but record this block as the most recent failure
                 result.last_failed_block = block_hash;
                 result.status = ScanResult::FAILURE;
-                break;
             }
-            bool hasDelegation = block.HasProofOfDelegation();
-            for (size_t posInBlock = 0; posInBlock < block.vtx.size(); ++posInBlock) {
-                SyncTransaction(block.vtx[posInBlock], TxStateConfirmed{block_hash, block_height, static_cast<int>(posInBlock), hasDelegation}, fUpdate, /*rescanning_old_block=*/true);
-            }
-            // scan succeeded, record block as most recent successfully scanned
-            result.last_scanned_block = block_hash;
-            result.last_scanned_height = block_height;
-        } else {
-            // could not scan block, keep scanning but record this block as the most recent failure
-            result.last_failed_block = block_hash;
-            result.status = ScanResult::FAILURE;
         }
         if (max_height && block_height >= *max_height) {
             break;
@@ -1878,8 +2136,10 @@ CWallet::ScanResult CWallet::ScanForWalletTransactions(const uint256& start_bloc
         WalletLogPrintf("Rescan interrupted by shutdown request at block %d. Progress=%f\n", block_height, progress_current);
         result.status = ScanResult::USER_ABORT;
     } else {
-        WalletLogPrintf("Rescan completed in %15dms\n", GetTimeMillis() - start_time);
+        WalletLogPrintf("Rescan completed in %15dms, %d blocks of which %d skipped by block filters\n", GetTimeMillis() - start_time,
+                        m_scanning_blocks.load(), m_scanning_filtered.load());
     }
+    RefreshBalanceSnapshot(*this);
     return result;
 }
 
@@ -2090,6 +2350,8 @@ bool CWallet::HasAddressStakeScripts(const uint160& keyId, std::map<uint160, boo
 
 void CWallet::RefreshAddressStakeCache()
 {
+    AssertLockHeld(cs_wallet);
+    m_stake_weight.MarkStale();
     std::map<uint160, bool> tmpAddressStakeCache = addressStakeCache;
     addressStakeCache.clear();
     for(std::map<uint160, bool>::iterator it = tmpAddressStakeCache.begin(); it != tmpAddressStakeCache.end(); ++it)
@@ -2337,6 +2599,8 @@ void CWallet::CommitTransaction(CTransactionRef tx, mapValue_t mapValue, std::ve
         coin.MarkDirty();
         NotifyTransactionChanged(coin.GetHash(), CT_UPDATED);
     }
+    // Publish the spend right away, also while a rescan serves the last snapshot
+    RefreshBalanceSnapshot(*this);
 
     // Get the inserted-CWalletTx from mapWallet so that the
     // wtx cached mempool state is updated correctly
@@ -2475,9 +2739,14 @@ DBErrors CWallet::ZapSelectTx(std::vector<uint256>& vHashIn, std::vector<uint256
         wtxOrdered.erase(it->second.m_it_wtxOrdered);
         for (const auto& txin : it->second.tx->vin)
             mapTxSpends.erase(txin.prevout);
+        m_tx_index.RemoveTx(it->second);
         mapWallet.erase(it);
         NotifyTransactionChanged(hash, CT_DELETED);
     }
+    // The inputs of the removed transactions are no longer spent
+    m_stake_weight.MarkStale();
+    m_utxo_pool.MarkStale();
+    ++m_balance_generation;
 
     if (nZapSelectTxRet == DBErrors::NEED_REWRITE)
     {
@@ -2583,10 +2852,12 @@ unsigned int CWallet::GetKeyPoolSize() const
 bool CWallet::TopUpKeyPool(unsigned int kpSize)
 {
     LOCK(cs_wallet);
+    DatabaseWriteGroup write_group(GetDatabase());
     bool res = true;
     for (auto spk_man : GetActiveScriptPubKeyMans()) {
         res &= spk_man->TopUp(kpSize);
     }
+    write_group.Commit();
     return res;
 }
 
@@ -2688,6 +2959,7 @@ void CWallet::DisableTransaction(const CTransaction &tx)
         }
         CWalletTx& wtx = mapWallet.at(hash);
         wtx.MarkDirty();
+        TxStateChanged(wtx);
         NotifyTransactionChanged(hash, CT_DELETED);
     }
 }
@@ -2751,6 +3023,7 @@ bool CWallet::LockCoin(const COutPoint& output, WalletBatch* batch)
 {
     AssertLockHeld(cs_wallet);
     setLockedCoins.insert(output);
+    m_stake_weight.MarkTxDirty(output.hash);
     if (batch) {
         return batch->WriteLockedUTXO(output);
     }
@@ -2761,6 +3034,7 @@ bool CWallet::UnlockCoin(const COutPoint& output, WalletBatch* batch)
 {
     AssertLockHeld(cs_wallet);
     bool was_locked = setLockedCoins.erase(output);
+    m_stake_weight.MarkTxDirty(output.hash);
     if (batch && was_locked) {
         return batch->EraseLockedUTXO(output);
     }
@@ -2774,6 +3048,7 @@ bool CWallet::UnlockAllCoins()
     WalletBatch batch(GetDatabase());
     for (auto it = setLockedCoins.begin(); it != setLockedCoins.end(); ++it) {
         success &= batch.EraseLockedUTXO(*it);
+        m_stake_weight.MarkTxDirty(it->hash);
     }
     setLockedCoins.clear();
     return success;
@@ -3279,6 +3554,7 @@ std::shared_ptr<CWallet> CWallet::Create(WalletContext& context, const std::stri
     walletInstance->m_staker_max_utxo_script_cache = gArgs.GetIntArg("-maxstakerutxoscriptcache", DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE);
     walletInstance->m_num_threads = gArgs.GetIntArg("-stakerthreads", GetNumCores());
     walletInstance->m_num_threads = std::max(1, walletInstance->m_num_threads);
+    walletInstance->m_rescan_threads = std::max(0, (int)gArgs.GetIntArg("-rescanthreads", DEFAULT_RESCAN_THREADS));
     walletInstance->m_ledger_id = gArgs.GetArg("-stakerledgerid", "");
 
     walletInstance->WalletLogPrintf("Wallet completed loading in %15dms\n", GetTimeMillis() - nStart);
@@ -3474,11 +3750,43 @@ std::vector<const CGovernanceObject*> CWallet::GetGovernanceObjects()
     return vecObjects;
 }
 
+/** Get the contract and holder of a token in EVM byte order. */
+static bool GetTokenKey(const CTokenInfo& token, uint160& contract, uint160& holder)
+{
+    if (token.strContractAddress.size() != 40 || !IsHex(token.strContractAddress)) return false;
+    const CTxDestination dest = DecodeDestination(token.strSenderAddress);
+    if (!std::holds_alternative<PKHash>(dest)) return false;
+    contract = uint160(ParseHex(token.strContractAddress));
+    holder = ToKeyID(std::get<PKHash>(dest));
+    return true;
+}
+
+static CTokenTx MakeTokenTx(const TokenTransfer& transfer, const uint256& block_hash, int height)
+{
+    CTokenTx tokenTx;
+    tokenTx.strContractAddress = HexStr(transfer.contract);
+    tokenTx.strSenderAddress = EncodeDestination(PKHash(transfer.from));
+    if (!transfer.burn) {
+        tokenTx.strReceiverAddress = EncodeDestination(PKHash(transfer.to));
+    }
+    tokenTx.nValue = transfer.value;
+    tokenTx.transactionHash = transfer.tx_hash;
+    tokenTx.blockHash = block_hash;
+    tokenTx.blockNumber = height;
+    return tokenTx;
+}
+
 bool CWallet::LoadToken(const CTokenInfo &token)
 {
+    AssertLockHeld(cs_wallet);
     uint256 hash = token.GetHash();
     mapToken[hash] = token;
 
+    uint160 contract, holder;
+    if (GetTokenKey(token, contract, holder)) {
+        m_token_tracker.TrackToken(contract, holder);
+    }
+
     return true;
 }
 
@@ -3522,6 +3830,11 @@ bool CWallet::AddTokenEntry(const CTokenInfo &token, bool fFlushOnClose)
 
     mapToken[hash] = wtoken;
 
+    uint160 contract, holder;
+    if (GetTokenKey(wtoken, contract, holder)) {
+        m_token_tracker.TrackToken(contract, holder);
+    }
+
     NotifyTokenChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
     // Refresh token tx
@@ -4014,6 +4327,10 @@ ScriptPubKeyMan* CWallet::AddWalletDescriptor(WalletDescriptor& desc, const Flat
     // Save the descriptor to DB
     spk_man->WriteDescriptor();
 
+    // Outputs of known transactions may belong to the new scripts
+    m_utxo_pool.MarkStale();
+    ++m_balance_generation;
+
     return spk_man;
 }
 
@@ -4109,6 +4426,10 @@ bool CWallet::RemoveTokenEntry(const uint256 &tokenHash, bool fFlushOnClose)
         if (!batch.EraseToken(tokenHash))
             return false;
 
+        uint160 contract, holder;
+        if (GetTokenKey(it->second, contract, holder)) {
+            m_token_tracker.UntrackToken(contract, holder);
+        }
         mapToken.erase(it);
 
         NotifyTokenChanged(this, tokenHash, CT_DELETED);
@@ -4187,6 +4508,104 @@ bool CWallet::CleanTokenTxEntries(bool fFlushOnClose)
     return true;
 }
 
+bool CWallet::GetTokenBalance(const uint256& tokenHash, std::string& balance) const
+{
+    LOCK(cs_wallet);
+
+    uint160 contract, holder;
+    auto it = mapToken.find(tokenHash);
+    if (it == mapToken.end() || !GetTokenKey(it->second, contract, holder)) return false;
+
+    const std::optional<uint256> value = m_token_tracker.GetBalance(contract, holder);
+    if (!value) return false;
+    balance = uintTou256(*value).str();
+    return true;
+}
+
+bool CWallet::SetTokenBalance(const uint256& tokenHash, const std::string& balance, int height)
+{
+    LOCK(cs_wallet);
+
+    // The transfers after height are applied when their blocks are connected
+    if (height < GetLastBlockHeight()) return false;
+    if (balance.empty() || !std::all_of(balance.begin(), balance.end(), IsDigit)) return false;
+
+    uint160 contract, holder;
+    auto it = mapToken.find(tokenHash);
+    if (it == mapToken.end() || !GetTokenKey(it->second, contract, holder)) return false;
+
+    m_token_tracker.SetBalance(contract, holder, u256Touint(dev::u256(balance)), height);
+    return true;
+}
+
+/**
+ * Keep the tokens whose transactions are known up to from_hash up to date at to_hash, and notify the tokens with transfers.
+ * Only the tokens with transfers are written; the others are brought up to date in memory, and after a restart
+ * the token transactions are looked up again from the block last written.
+ */
+static void UpdateTokenEntries(CWallet& wallet, const std::vector<TokenTransfer>& transfers, const uint256& from_hash, int from_height, const uint256& to_hash, int to_height) EXCLUSIVE_LOCKS_REQUIRED(wallet.cs_wallet)
+{
+    WalletBatch batch(wallet.GetDatabase(), false);
+    for (auto& [hash, token] : wallet.mapToken) {
+        const bool up_to_date = token.blockNumber == from_height && token.blockHash == from_hash;
+        if (up_to_date) {
+            token.blockNumber = to_height;
+            token.blockHash = to_hash;
+        }
+
+        uint160 contract, holder;
+        if (!GetTokenKey(token, contract, holder)) continue;
+        const bool changed = std::any_of(transfers.begin(), transfers.end(), [&](const TokenTransfer& transfer) {
+            return transfer.contract == contract && TokenTransferAffects(transfer, holder);
+        });
+        if (changed) {
+            if (up_to_date) batch.WriteToken(token);
+            wallet.NotifyTokenChanged(&wallet, hash, CT_UPDATED);
+        }
+    }
+}
+
+void CWallet::SyncTokenTransfers(const CBlock& block, int height)
+{
+    if (m_token_tracker.Empty()) return;
+
+    std::vector<interfaces::ContractLog> logs;
+    if (!chain().getBlockContractLogs(block, logs)) {
+        // Without -logevents the balances can not follow the chain
+        m_token_tracker.ForgetBalances();
+        return;
+    }
+
+    std::vector<TokenTransfer> transfers;
+    for (const interfaces::ContractLog& log : logs) {
+        if (std::optional<TokenTransfer> transfer = DecodeTokenTransfer(log)) {
+            transfers.push_back(*transfer);
+        }
+    }
+
+    const uint256 block_hash = block.GetHash();
+    transfers = m_token_tracker.BlockConnected(block_hash, height, transfers);
+    for (const TokenTransfer& transfer : transfers) {
+        if (transfer.undecodable) continue;
+        AddTokenTxEntry(MakeTokenTx(transfer, block_hash, height), false);
+    }
+    UpdateTokenEntries(*this, transfers, block.hashPrevBlock, height - 1, block_hash, height);
+}
+
+void CWallet::UndoTokenTransfers(const CBlock& block, int height)
+{
+    if (m_token_tracker.Empty()) return;
+
+    const uint256 block_hash = block.GetHash();
+    const std::vector<TokenTransfer> transfers = m_token_tracker.BlockDisconnected(block_hash, height);
+    for (const TokenTransfer& transfer : transfers) {
+        if (transfer.undecodable) continue;
+        // Unconfirmed until the transaction is included in a block again
+        AddTokenTxEntry(MakeTokenTx(transfer, uint256(), -1), false);
+    }
+    UpdateTokenEntries(*this, transfers, block_hash, height, block.hashPrevBlock, height - 1);
+}
+
 bool CWallet::SetContractBook(const std::string &strAddress, const std::string &strName, const std::string &strAbi)
 {
     bool fUpdated = false;
@@ -4358,6 +4777,7 @@ bool CWallet::AddSuperStakerEntry(const CSuperStakerInfo& superStaker, bool fFlu
         return false;
 
     mapSuperStaker[hash] = wsuperStaker;
+    m_delegate_stake_weight.reset();
 
     NotifySuperStakerChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
 
@@ -4394,6 +4814,7 @@ bool CWallet::RemoveSuperStakerEntry(const uint256& superStakerHash, bool fFlush
             return false;
 
         mapSuperStaker.erase(it);
+        m_delegate_stake_weight.reset();
 
         NotifySuperStakerChanged(this, superStakerHash, CT_DELETED);
     }
@@ -4437,6 +4858,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
         {
             it = m_delegations_staker.erase(it);
             m_delegations_weight.erase(addressDelegate);
+            m_delegate_stake_weight.reset();
             NotifyDelegationsStakerChanged(this, addressDelegate, CT_DELETED);
         }
         else
@@ -4444,6 +4866,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
             if(delegation->second != it->second)
             {
                 it->second = delegation->second;
+                m_delegate_stake_weight.reset();
                 NotifyDelegationsStakerChanged(this, addressDelegate, CT_UPDATED);
             }
             it++;
@@ -4456,6 +4879,7 @@ void CWallet::updateDelegationsStaker(const std::map<uint160, Delegation> &deleg
         if(m_delegations_staker.find(it->first) == m_delegations_staker.end())
         {
             m_delegations_staker[it->first] = it->second;
+            m_delegate_stake_weight.reset();
             NotifyDelegationsStakerChanged(this, it->first, CT_NEW);
         }
     }
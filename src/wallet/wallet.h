@@ -22,9 +22,14 @@
 #include <validationinterface.h>
 #include <wallet/coinselection.h>
 #include <wallet/crypter.h>
+#include <wallet/delegatecoins.h>
 #include <wallet/scriptpubkeyman.h>
+#include <wallet/stakeweight.h>
+#include <wallet/tokentracker.h>
 #include <wallet/transaction.h>
+#include <wallet/utxopool.h>
 #include <wallet/walletdb.h>
+#include <wallet/wallettxindex.h>
 #include <wallet/walletutil.h>
 #include <consensus/params.h>
 #include <pos.h>
@@ -129,6 +134,9 @@ static const CAmount DEFAULT_STAKER_MIN_UTXO_SIZE{COIN/10};
 //! -maxstakerutxoscriptcache default
 static const int32_t DEFAULT_STAKER_MAX_UTXO_SCRIPT_CACHE = 200000;
 
+//! -rescanthreads default
+static const int DEFAULT_RESCAN_THREADS = 4;
+
 //! -signpsbtwithhwitool default
 static const bool DEFAULT_SIGN_PSBT_WITH_HWI_TOOL = true;
 
@@ -141,6 +149,7 @@ class CContractBookData;
 class CDelegationInfo;
 class CSuperStakerInfo;
 class CTokenInfo;
+struct BalanceSnapshot;
 
 //! Default for -addresstype
 constexpr OutputType DEFAULT_ADDRESS_TYPE{OutputType::LEGACY};
@@ -273,6 +282,8 @@ private:
     std::atomic<bool> fScanningWallet{false}; // controlled by WalletRescanReserver
     std::atomic<int64_t> m_scanning_start{0};
     std::atomic<double> m_scanning_progress{0};
+    std::atomic<int64_t> m_scanning_blocks{0};
+    std::atomic<int64_t> m_scanning_filtered{0};
     friend class WalletRescanReserver;
 
     //! the current wallet version: clients below this version are not able to load the wallet
@@ -298,6 +309,9 @@ private:
     void AddToSpends(const uint256& wtxid, WalletBatch* batch = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     void RemoveFromSpends(const uint256& wtxid) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /** Bring the stake weight, UTXO pool, transaction indexes and balances up to date with a changed wallet transaction. */
+    void TxStateChanged(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /**
      * Add a transaction to the wallet, or update it.  confirm.block_* should
      * be set when the transaction was known to be included in a block.  When
@@ -326,6 +340,11 @@ private:
 
     void SyncTransaction(const CTransactionRef& tx, const SyncTxState& state, bool update_tx = true, bool rescanning_old_block = false) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
+    /** Update the token balances and transactions from the Transfer and Burn events of a connected block. */
+    void SyncTokenTransfers(const CBlock& block, int height) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+    /** Undo the token transfers of a disconnected block. */
+    void UndoTokenTransfers(const CBlock& block, int height) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
     /** WalletFlags set on this wallet. */
     std::atomic<uint64_t> m_wallet_flags{0};
 
@@ -531,6 +550,9 @@ public:
     bool IsScanning() const { return fScanningWallet; }
     int64_t ScanningDuration() const { return fScanningWallet ? GetTimeMillis() - m_scanning_start : 0; }
     double ScanningProgress() const { return fScanningWallet ? (double) m_scanning_progress : 0; }
+    //! Blocks inspected by the current scan, and how many of them were skipped because their block filter did not match
+    int64_t ScanningBlocks() const { return fScanningWallet ? (int64_t) m_scanning_blocks : 0; }
+    int64_t ScanningFilteredBlocks() const { return fScanningWallet ? (int64_t) m_scanning_filtered : 0; }
 
     //! Upgrade stored CKeyMetadata objects to store key origin info as KeyOriginInfo
     void UpgradeKeyMetadata() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
@@ -555,7 +577,7 @@ public:
     void GetKeyBirthTimes(std::map<CKeyID, int64_t> &mapKeyBirth) const EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     unsigned int ComputeTimeSmart(const CWalletTx& wtx, bool rescanning_old_block) const;
 
-    bool LoadToken(const CTokenInfo &token);
+    bool LoadToken(const CTokenInfo &token) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
 
     bool LoadTokenTx(const CTokenTx &tokenTx);
 
@@ -662,7 +684,7 @@ public:
     const CWalletTx* GetCoinSuperStaker(const std::set<std::pair<const CWalletTx*,unsigned int> >& setCoins, const PKHash& superStaker, COutPoint& prevout, CAmount& nValueRet);
     const CScriptCache& GetScriptCache(const COutPoint& prevout, const CScript& scriptPubKey, std::map<COutPoint, CScriptCache>* insertScriptCache = nullptr) const;
     bool HasAddressStakeScripts(const uint160& keyId, std::map<uint160, bool>* insertAddressStake = nullptr) const;
-    void RefreshAddressStakeCache();
+    void RefreshAddressStakeCache() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
     bool GetSuperStaker(CSuperStakerInfo &info, const uint160& stakerAddress) const;
     void GetStakerAddressBalance(const PKHash& staker, CAmount& balance, CAmount& stake, CAmount& weight) const;
     void RefreshDelegates(bool myDelegates, bool stakerDelegates);
@@ -1058,6 +1080,12 @@ public:
     /* Clean token transaction entries in the wallet */
     bool CleanTokenTxEntries(bool fFlushOnClose=true);
 
+    /* Get the token balance kept up to date from the token transfers, if known */
+    bool GetTokenBalance(const uint256& tokenHash, std::string& balance) const;
+
+    /* Set the token balance as of the block at height, so the token transfers of the next blocks update it */
+    bool SetTokenBalance(const uint256& tokenHash, const std::string& balance, int height);
+
     /* Load delegation entry into the wallet */
     bool LoadDelegation(const CDelegationInfo &delegation);
 
@@ -1097,6 +1125,8 @@ public:
     std::map<uint160, Delegation> m_my_delegations;
     std::map<uint160, bool> m_have_coin_superstaker;
     int m_num_threads = 1;
+    //! Threads reading blocks ahead of a rescan, see -rescanthreads
+    int m_rescan_threads{DEFAULT_RESCAN_THREADS};
     mutable boost::thread_group threads;
     std::string m_ledger_id;
     boost::thread_group* stakeThread = nullptr;
@@ -1106,6 +1136,26 @@ public:
     mutable std::map<COutPoint, CScriptCache> prevoutScriptCache;
     mutable std::map<uint160, bool> addressStakeCache;
     std::atomic<bool> fCleanCoinStake = true;
+    //! Coins available for staking and their weight, brought up to date by UpdateStakeWeight()
+    mutable StakeWeightTracker m_stake_weight GUARDED_BY(cs_wallet){DEFAULT_STAKING_MIN_UTXO_VALUE};
+    //! m_staker_min_utxo_size and m_my_delegations as of the last m_stake_weight update
+    mutable CAmount m_stake_weight_min_utxo_size GUARDED_BY(cs_wallet){0};
+    mutable std::set<uint160> m_stake_weight_delegations GUARDED_BY(cs_wallet);
+    //! Unspent outputs of the wallet for coin selection, brought up to date by UpdateUtxoPool()
+    mutable UtxoPool m_utxo_pool GUARDED_BY(cs_wallet);
+    //! The wallet transactions by block height and by the scripts they pay to
+    WalletTxIndex m_tx_index GUARDED_BY(cs_wallet);
+    //! Unspent outputs of the delegators of this wallet's super stakers, brought up to date by UpdateDelegateCoins()
+    mutable DelegateCoinTracker m_delegate_coins GUARDED_BY(cs_wallet);
+    //! Weight of the coins delegated to this wallet, and the tip it was computed at
+    mutable std::optional<std::pair<uint256, uint64_t>> m_delegate_stake_weight GUARDED_BY(cs_wallet);
+    //! Balances and transfers of the tokens in mapToken, fed from the receipts of connected blocks
+    TokenTracker m_token_tracker GUARDED_BY(cs_wallet);
+    //! Bumped under cs_wallet by every change that may change the balances, see GetBalanceSnapshot()
+    std::atomic<uint64_t> m_balance_generation{0};
+    //! The balances last published by PublishBalanceSnapshot(), readable without cs_wallet. Nothing else of the wallet is published this way.
+    mutable Mutex m_balance_snapshot_mutex;
+    mutable std::shared_ptr<const BalanceSnapshot> m_balance_snapshot GUARDED_BY(m_balance_snapshot_mutex);
 };
 
 /**
@@ -1131,6 +1181,8 @@ public:
         }
         m_wallet.m_scanning_start = GetTimeMillis();
         m_wallet.m_scanning_progress = 0;
+        m_wallet.m_scanning_blocks = 0;
+        m_wallet.m_scanning_filtered = 0;
         m_could_reserve = true;
         return true;
     }
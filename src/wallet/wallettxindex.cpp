@@ -0,0 +1,97 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <wallet/wallettxindex.h>
+
+#include <wallet/transaction.h>
+
+#include <algorithm>
+
+namespace wallet {
+namespace {
+std::optional<int> BlockHeight(const CWalletTx& wtx)
+{
+    if (auto* conf = wtx.state<TxStateConfirmed>()) return conf->confirmed_block_height;
+    if (auto* conf = wtx.state<TxStateConflicted>()) return conf->conflicting_block_height;
+    return std::nullopt;
+}
+} // namespace
+
+void WalletTxIndex::Unlink(const uint256& hash, const std::optional<int>& height)
+{
+    if (!height) {
+        m_not_in_block.erase(hash);
+        return;
+    }
+    auto it = m_by_height.find(*height);
+    if (it == m_by_height.end()) return;
+    it->second.erase(hash);
+    if (it->second.empty()) m_by_height.erase(it);
+}
+
+void WalletTxIndex::AddTx(const CWalletTx& wtx)
+{
+    const uint256& hash = wtx.GetHash();
+    const std::optional<int> height = BlockHeight(wtx);
+    auto [it, inserted] = m_heights.emplace(hash, height);
+    if (!inserted) {
+        // The outputs of a transaction do not change, only its block
+        if (it->second == height) return;
+        Unlink(hash, it->second);
+        it->second = height;
+    } else {
+        for (const CTxOut& txout : wtx.tx->vout) {
+            CTxDestination dest;
+            if (ExtractDestination(txout.scriptPubKey, dest)) m_by_dest[dest].insert(hash);
+        }
+    }
+    if (height) {
+        m_by_height[*height].insert(hash);
+    } else {
+        m_not_in_block.insert(hash);
+    }
+}
+
+void WalletTxIndex::RemoveTx(const CWalletTx& wtx)
+{
+    const uint256& hash = wtx.GetHash();
+    auto it = m_heights.find(hash);
+    if (it == m_heights.end()) return;
+    Unlink(hash, it->second);
+    m_heights.erase(it);
+    for (const CTxOut& txout : wtx.tx->vout) {
+        CTxDestination dest;
+        if (!ExtractDestination(txout.scriptPubKey, dest)) continue;
+        auto it_dest = m_by_dest.find(dest);
+        if (it_dest == m_by_dest.end()) continue;
+        it_dest->second.erase(hash);
+        if (it_dest->second.empty()) m_by_dest.erase(it_dest);
+    }
+}
+
+void WalletTxIndex::Clear()
+{
+    m_heights.clear();
+    m_by_height.clear();
+    m_not_in_block.clear();
+    m_by_dest.clear();
+}
+
+std::vector<uint256> WalletTxIndex::GetTxsAbove(int height) const
+{
+    std::vector<uint256> hashes(m_not_in_block.begin(), m_not_in_block.end());
+    for (auto it = m_by_height.upper_bound(height); it != m_by_height.end(); ++it) {
+        hashes.insert(hashes.end(), it->second.begin(), it->second.end());
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+}
+
+std::vector<uint256> WalletTxIndex::GetTxsPayingTo(const CTxDestination& dest) const
+{
+    auto it = m_by_dest.find(dest);
+    if (it == m_by_dest.end()) return {};
+    return {it->second.begin(), it->second.end()};
+}
+} // namespace wallet
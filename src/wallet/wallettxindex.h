@@ -0,0 +1,57 @@
+// Copyright (c) 2022 The Qtum Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef QTUM_WALLET_WALLETTXINDEX_H
+#define QTUM_WALLET_WALLETTXINDEX_H
+
+#include <script/standard.h>
+#include <uint256.h>
+
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace wallet {
+class CWalletTx;
+
+/**
+ * Secondary indexes of the wallet transactions, kept next to mapWallet so
+ * that RPCs looking for the transactions of a block range or an address do
+ * not need to visit every wallet transaction.
+ *
+ * Transactions are indexed by the height of the block that confirms them, or
+ * of the block that conflicts with them, and by the destinations their
+ * outputs pay to, as ExtractDestination finds them. The index is updated
+ * whenever the state of a transaction changes.
+ */
+class WalletTxIndex
+{
+public:
+    /** Add a transaction, or update it after its state changed. */
+    void AddTx(const CWalletTx& wtx);
+    void RemoveTx(const CWalletTx& wtx);
+    void Clear();
+
+    /**
+     * The transactions that are not in a block, or whose confirming or
+     * conflicting block is above height, ordered by hash.
+     */
+    std::vector<uint256> GetTxsAbove(int height) const;
+    /** The transactions with an output paying to dest, ordered by hash. */
+    std::vector<uint256> GetTxsPayingTo(const CTxDestination& dest) const;
+    size_t TxCount() const { return m_heights.size(); }
+
+private:
+    void Unlink(const uint256& hash, const std::optional<int>& height);
+
+    //! Height each transaction is indexed at, none when it is not in a block
+    std::map<uint256, std::optional<int>> m_heights;
+    std::map<int, std::set<uint256>> m_by_height;
+    std::set<uint256> m_not_in_block;
+    std::map<CTxDestination, std::set<uint256>> m_by_dest;
+};
+} // namespace wallet
+
+#endif // QTUM_WALLET_WALLETTXINDEX_H
@@ -4,10 +4,25 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Tests some generic aspects of the RPC interface."""
 
+from decimal import Decimal
+import http.client
+import json
 import os
+import socket
+import struct
+import urllib.parse
 from test_framework.authproxy import JSONRPCException
+from test_framework.blocktools import COINBASE_MATURITY
+from test_framework.messages import COIN
 from test_framework.test_framework import BitcoinTestFramework
-from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than,
+    assert_greater_than_or_equal,
+    gen_return_txouts,
+    str_to_b64str,
+)
+from test_framework.wallet import MiniWallet
 from threading import Thread
 import subprocess
 
@@ -48,6 +63,22 @@ class RPCInterfaceTest(BitcoinTestFramework):
         assert_greater_than_or_equal(command['duration'], 0)
         assert_equal(info['logpath'], os.path.join(self.nodes[0].datadir, self.chain, 'debug.log'))
 
+        default_queue, slow_queue = info['work_queues']
+        assert_equal(default_queue['name'], 'default')
+        assert_equal(default_queue['active'], 1)
+        assert_equal(slow_queue['name'], 'slow')
+        assert_equal(slow_queue['threads'], 2)
+
+        self.nodes[0].gettxoutsetinfo()
+        slow_queue = self.nodes[0].getrpcinfo()['work_queues'][1]
+        assert_equal(slow_queue['processed'], 1)
+        assert_greater_than_or_equal(slow_queue['max_duration'], slow_queue['avg_duration'])
+
+        # Batches are scanned for slow methods too, but bodies too large to scan run on the default queue
+        self.nodes[0].batch([{"method": "getblockcount", "id": 1}, {"method": "gettxoutsetinfo", "id": 2}])
+        self.nodes[0].batch([{"method": "gettxoutsetinfo", "id": "x" * (256 << 10)}])
+        assert_equal(self.nodes[0].getrpcinfo()['work_queues'][1]['processed'], 2)
+
     def test_batch_request(self):
         self.log.info("Testing basic JSON-RPC batch request...")
 
@@ -92,11 +123,72 @@ class RPCInterfaceTest(BitcoinTestFramework):
         for t in threads:
             t.join()
 
+    def test_slow_work_queue(self):
+        self.log.info("Testing slow calls do not hold up other calls...")
+        self.restart_node(0, ['-rpcthreads=1', '-rpcslowthreads=1', '-rpcslowmethod=waitfornewblock'])
+        node = self.nodes[0]
+        t = Thread(target=lambda: node.cli('waitfornewblock', 10000).send_cli())
+        t.start()
+        self.wait_until(lambda: node.getrpcinfo()['work_queues'][1]['active'] == 1)
+        # The only default worker is free while the slow one waits
+        assert_equal(node.getblockcount(), 0)
+        self.generate(node, 1)
+        t.join()
+
+    def test_streamed_reply(self):
+        self.log.info("Testing large replies are streamed...")
+        self.restart_node(0, ['-acceptnonstdtxn=1'])
+        node = self.nodes[0]
+        miniwallet = MiniWallet(node)
+        self.generate(miniwallet, 1)
+        self.generate(node, COINBASE_MATURITY)
+
+        # A block with a large transaction, whose verbose JSON outgrows the 64 KiB the reply is buffered in
+        tx = miniwallet.create_self_transfer(from_node=node, fee_rate=0, mempool_valid=False)['tx']
+        tx.vout.extend(gen_return_txouts())
+        tx.vout[0].nValue -= int(node.getnetworkinfo()['relayfee'] * 130 * COIN)
+        miniwallet.sendrawtransaction(from_node=node, tx_hex=tx.serialize().hex())
+        blockhash = self.generate(node, 1)[0]
+
+        url = urllib.parse.urlparse(node.url)
+        headers = {"Authorization": "Basic " + str_to_b64str(f"{url.username}:{url.password}")}
+        request = json.dumps({"method": "getblock", "params": [blockhash, 2], "id": 1})
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        # The connection stays open after a streamed reply, so it can be sent twice
+        for _ in range(2):
+            conn.request('POST', '/', request, headers)
+            response = conn.getresponse()
+            assert_equal(response.status, 200)
+            assert_equal(response.getheader('Transfer-Encoding'), 'chunked')
+            body = response.read()
+            assert_greater_than(len(body), 64 << 10)
+            reply = json.loads(body, parse_float=Decimal)
+            assert_equal(reply['error'], None)
+            assert_equal(reply['id'], 1)
+        conn.close()
+
+        # Batches are not streamed, and get the same result
+        assert_equal(node.batch([{"method": "getblock", "params": [blockhash, 2], "id": 1}])[0]['result'], reply['result'])
+
+        self.log.info("Testing clients can go away while a reply is streamed...")
+        body = f"POST / HTTP/1.1\r\nHost: {url.hostname}\r\nAuthorization: {headers['Authorization']}\r\nContent-Type: application/json\r\nContent-Length: {len(request)}\r\n\r\n{request}"
+        for _ in range(10):
+            sock = socket.create_connection((url.hostname, url.port))
+            sock.sendall(body.encode())
+            assert sock.recv(1024).startswith(b'HTTP/1.1 200')
+            # Reset the connection rather than closing it, so the next write of the reply fails
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack('ii', 1, 0))
+            sock.close()
+        # The node keeps serving requests, streamed ones too
+        assert_equal(node.getblock(blockhash, 2), reply['result'])
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_request()
         self.test_http_status_codes()
+        self.test_slow_work_queue()
         self.test_work_queue_exceeded()
+        self.test_streamed_reply()
 
 
 if __name__ == '__main__':
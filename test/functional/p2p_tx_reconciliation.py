@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Simulate transaction relay over a local network, with and without -txreconciliation.
+
+The same set of transactions is broadcast from random nodes of a small,
+well-connected network, first with plain INV flooding and then with set
+reconciliation (BIP330). For both runs the bandwidth spent on transaction
+announcement and the time until every mempool has every transaction are
+logged, so the two relay modes can be compared.
+
+The network size and number of transactions can be changed with --nodes and
+--txs to use the test as a benchmark.
+"""
+
+import random
+import time
+
+from test_framework.blocktools import COINBASE_MATURITY
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+ANNOUNCEMENT_MSGS = ['inv', 'getdata', 'notfound', 'reqrecon', 'sketch', 'reconcildiff']
+RECONCILIATION_MSGS = ['sendtxrcncl', 'reqrecon', 'sketch', 'reconcildiff']
+
+
+class TxReconciliationTest(BitcoinTestFramework):
+    def add_options(self, parser):
+        parser.add_argument("--nodes", dest="sim_nodes", type=int, default=6,
+                            help="Number of nodes in the simulated network (default: %(default)s)")
+        parser.add_argument("--txs", dest="sim_txs", type=int, default=40,
+                            help="Number of transactions to relay per run (default: %(default)s)")
+
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = max(3, self.options.sim_nodes)
+
+    def setup_network(self):
+        self.setup_nodes()
+        self.connect_network()
+
+    def connect_network(self):
+        # A ring with chords, so that every node has both inbound and
+        # outbound peers and transactions reach nodes over several paths.
+        for i in range(self.num_nodes):
+            self.connect_nodes(i, (i + 1) % self.num_nodes)
+            self.connect_nodes(i, (i + 2) % self.num_nodes)
+
+    def restart_network(self, extra_args):
+        self.stop_nodes()
+        self.start_nodes(extra_args=[extra_args] * self.num_nodes)
+        self.connect_network()
+        self.sync_blocks()
+
+    def announcement_bytes(self):
+        total = 0
+        for node in self.nodes:
+            for peer in node.getpeerinfo():
+                total += sum(peer['bytessent_per_msg'].get(msg, 0) for msg in ANNOUNCEMENT_MSGS)
+        return total
+
+    def reconciliation_bytes(self):
+        return sum(peer['bytessent_per_msg'].get(msg, 0)
+                   for node in self.nodes for peer in node.getpeerinfo() for msg in RECONCILIATION_MSGS)
+
+    def relay(self, mode):
+        start_bytes = self.announcement_bytes()
+        wtxids = set()
+        start = time.time()
+        for _ in range(self.options.sim_txs):
+            node = random.choice(self.nodes)
+            wtxids.add(self.wallet.send_self_transfer(from_node=node, utxo_to_spend=self.utxos.pop())['wtxid'])
+
+        # Time until every node has every transaction.
+        def all_relayed():
+            return all(wtxids <= {entry['wtxid'] for entry in node.getrawmempool(verbose=True).values()} for node in self.nodes)
+        self.wait_until(all_relayed, timeout=120)
+        delay = time.time() - start
+        used = self.announcement_bytes() - start_bytes
+
+        self.log.info(f"{mode}: {len(wtxids)} transactions reached {self.num_nodes} nodes in {delay:.1f}s, "
+                      f"using {used} bytes of announcements ({used / len(wtxids):.0f} per transaction)")
+        # Clear the mempools for the next run.
+        self.generate(self.nodes[0], 1)
+        return used, delay
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.generate(self.wallet, 2 * self.options.sim_txs)
+        self.generate(self.nodes[0], COINBASE_MATURITY)
+        self.wallet.rescan_utxos()
+        self.utxos = [self.wallet.get_utxo() for _ in range(2 * self.options.sim_txs)]
+
+        self.log.info("Relay transactions by flooding")
+        self.restart_network([])
+        flood_bytes, flood_delay = self.relay("flooding")
+        assert_equal(self.reconciliation_bytes(), 0)
+
+        self.log.info("Relay transactions by set reconciliation")
+        self.restart_network(["-txreconciliation"])
+        for node in self.nodes:
+            for peer in node.getpeerinfo():
+                assert peer['bytesrecv_per_msg'].get('sendtxrcncl', 0) > 0
+        recon_bytes, recon_delay = self.relay("reconciliation")
+        assert self.reconciliation_bytes() > 0
+
+        self.log.info(f"Reconciliation used {100 * recon_bytes / flood_bytes:.0f}% of the flooding bandwidth "
+                      f"with {recon_delay - flood_delay:+.1f}s propagation delay")
+
+
+if __name__ == '__main__':
+    TxReconciliationTest().main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the estimategas RPC.
+
+The estimated gas limit must be enough to execute the call, and for calls
+which do not depend on the gas limit, one gas less must not be.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_raises_rpc_error
+from test_framework.qtum import *
+from test_framework.qtumconfig import *
+
+"""
+contract test {
+    uint a;
+
+    function test() payable {
+        a = 13;
+    }
+
+    function add() payable returns (uint){
+        a += 13;
+        return a;
+    }
+
+    function () payable {}
+}
+"""
+CONTRACT_CODE = "60606040525b600d6000819055505b5b60a98061001d6000396000f30060606040523615603d576000357c0100000000000000000000000000000000000000000000000000000000900463ffffffff1680634f2be91f146045575b60435b5b565b005b604b6061565b6040518082815260200191505060405180910390f35b6000600d60006000828254019250508190555060005490505b905600a165627a7a72305820fd0deb11ff6c6a06f612b5fb04e7312f22eacec75d677c0fbc0194d86772d2d70029"
+ADD_DATA = "4f2be91f"
+
+
+class EstimateGasTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [['-londonheight=1000000']]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def check_estimate(self, address, data):
+        node = self.nodes[0]
+        ret = node.estimategas(address, data)
+        assert_equal(ret['address'], address)
+        assert_equal(ret['bisected'], False)
+        assert_equal(ret['executions'], 2)
+        assert_equal(ret['gasLimit'], ret['gasUsed'])
+        ok = node.callcontract(address, data, None, ret['gasLimit'])
+        assert_equal(ok['executionResult']['excepted'], "None")
+        assert_equal(ok['executionResult']['gasUsed'], ret['gasUsed'])
+        out_of_gas = node.callcontract(address, data, None, ret['gasLimit'] - 1)
+        assert_equal(out_of_gas['executionResult']['excepted'], "OutOfGas")
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(COINBASE_MATURITY + 100)
+
+        self.log.info("Estimate the gas to deploy a contract")
+        self.check_estimate("", CONTRACT_CODE)
+
+        contract_address = node.createcontract(CONTRACT_CODE, 1000000, QTUM_MIN_GAS_PRICE_STR)['address']
+        node.generate(1)
+
+        self.log.info("Estimate the gas to call a contract method")
+        self.check_estimate(contract_address, ADD_DATA)
+
+        self.log.info("Estimate the gas of a call with a value")
+        ret = node.estimategas(contract_address, ADD_DATA, None, 0.1)
+        call = node.callcontract(contract_address, ADD_DATA, None, ret['gasLimit'], 0.1)
+        assert_equal(call['executionResult']['excepted'], "None")
+
+        self.log.info("Calls which fail with the block gas limit can not be estimated")
+        assert_raises_rpc_error(-1, "Contract execution failed with the block gas limit", node.estimategas, "", "fe")
+        assert_raises_rpc_error(-5, "Incorrect address", node.estimategas, "00", ADD_DATA)
+        assert_raises_rpc_error(-5, "Address does not exist", node.estimategas, "00" * 20, ADD_DATA)
+        assert_raises_rpc_error(-3, "Invalid data (data not hex)", node.estimategas, contract_address, "0")
+
+
+if __name__ == '__main__':
+    EstimateGasTest().main()
@@ -110,6 +110,7 @@ BASE_SCRIPTS = [
     'p2p_segwit.py',
     'p2p_timeouts.py',
     'p2p_tx_download.py',
+    'p2p_tx_reconciliation.py',
     'mempool_updatefromblock.py',
     'wallet_dump.py --legacy-wallet',
     'feature_taproot.py --previous_release',
@@ -199,6 +200,7 @@ BASE_SCRIPTS = [
     'wallet_keypool.py --legacy-wallet',
     'wallet_keypool.py --descriptors',
     'wallet_descriptor.py --descriptors',
+    'wallet_fast_rescan.py',
     'feature_maxtipage.py',
     'p2p_nobloomfilter_messages.py',
     'p2p_filter.py',
@@ -348,6 +350,7 @@ BASE_SCRIPTS = [
     'qtum_waitforlogs.py',
     'qtum_block_header.py',
     'qtum_callcontract.py',
+    'qtum_estimategas.py',
     'qtum_spend_op_call.py',
     'qtum_condensing_txs.py',
     'qtum_createcontract.py',
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 The Qtum Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test that the rescan variants find the same wallet transactions.
+
+A descriptor wallet receives coins over a range of blocks. Its descriptors
+are then imported into fresh wallets, which rescan the chain:
+- skipping blocks by their BIP 157 block filters (-blockfilterindex),
+- reading blocks ahead on several threads (-rescanthreads), and
+- reading every block on the rescan thread (-rescanthreads=0).
+All of them must find the transactions of the original wallet.
+"""
+
+import re
+from threading import Thread
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_greater_than,
+    assert_greater_than_or_equal,
+    get_rpc_proxy,
+)
+
+NUM_DESCRIPTORS = 4
+NUM_BLOCKS = 6
+
+
+class WalletFastRescanTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [['-blockfilterindex=1', '-keypool=100']]
+
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+        self.skip_if_no_sqlite()
+
+    def rescanned_txids(self, wallet_name, descriptors, expected_log):
+        node = self.nodes[0]
+        node.createwallet(wallet_name=wallet_name, descriptors=True, blank=True)
+        wallet = node.get_wallet_rpc(wallet_name)
+        requests = []
+        for d in descriptors:
+            request = {'desc': d['desc'], 'timestamp': 0, 'active': d['active'], 'internal': d.get('internal', False)}
+            if 'range' in d:
+                request['range'] = d['range']
+                request['next_index'] = d['next']
+            requests.append(request)
+        with node.assert_debug_log(expected_msgs=[expected_log]):
+            result = wallet.importdescriptors(requests)
+        assert all(r['success'] for r in result)
+        txids = sorted(tx['txid'] for tx in wallet.listtransactions(count=1000))
+        node.unloadwallet(wallet_name)
+        return txids
+
+    def last_rescan_counts(self, wallet_name):
+        """Return the blocks scanned and skipped by block filters in the wallet's last rescan, from the debug log."""
+        with open(self.nodes[0].debug_log_path, encoding='utf-8') as log:
+            counts = re.findall(rf"\[{wallet_name}\] Rescan completed in +\d+ms, (\d+) blocks of which (\d+) skipped by block filters", log.read())
+        assert counts
+        return tuple(int(c) for c in counts[-1])
+
+    def watch_rescan(self, wallet_name):
+        """Rescan on a second connection and return the scanning details getwalletinfo reports meanwhile."""
+        node = self.nodes[0]
+        wallet = node.get_wallet_rpc(wallet_name)
+        rescan_rpc = get_rpc_proxy(f"{node.url}/wallet/{wallet_name}", node.index, timeout=node.rpc_timeout, coveragedir=node.coverage_dir)
+        # A rescan may finish before the first poll, so try a few times.
+        for _ in range(10):
+            thread = Thread(target=rescan_rpc.rescanblockchain)
+            thread.start()
+            scanning = False
+            while thread.is_alive() and not scanning:
+                scanning = wallet.getwalletinfo()['scanning']
+            thread.join()
+            if scanning:
+                return scanning
+        raise AssertionError("getwalletinfo never reported a rescan in progress")
+
+    def run_test(self):
+        node = self.nodes[0]
+        funder = node.get_wallet_rpc(self.default_wallet_name)
+
+        self.log.info("Send coins to a descriptor wallet over a range of blocks")
+        node.createwallet(wallet_name='receiver', descriptors=True)
+        receiver = node.get_wallet_rpc('receiver')
+        for _ in range(NUM_BLOCKS):
+            for _ in range(NUM_DESCRIPTORS):
+                funder.sendtoaddress(receiver.getnewaddress(), 1)
+            # Blocks without wallet transactions are skipped by the block filter
+            self.generate(node, 1)
+            self.generatetoaddress(node, 2, funder.getnewaddress())
+        descriptors = receiver.listdescriptors(True)['descriptors']
+        expected_txids = sorted(tx['txid'] for tx in receiver.listtransactions(count=1000))
+        assert_equal(len(expected_txids), NUM_BLOCKS * NUM_DESCRIPTORS)
+        self.wait_until(lambda: all(i['synced'] for i in node.getindexinfo().values()))
+
+        self.log.info("Rescan using block filters")
+        txids = self.rescanned_txids('filter', descriptors, 'skipping blocks using block filters')
+        assert_equal(txids, expected_txids)
+        blocks, filtered_blocks = self.last_rescan_counts('filter')
+        assert_greater_than(filtered_blocks, 0)
+        assert_greater_than(blocks, filtered_blocks)
+
+        self.log.info("Check the scanning details reported while a rescan runs")
+        node.loadwallet('filter')
+        scanning = self.watch_rescan('filter')
+        assert_equal(set(scanning), {'duration', 'progress', 'blocks', 'filtered_blocks', 'blocks_per_second'})
+        assert 0 <= scanning['progress'] <= 1
+        assert_greater_than_or_equal(scanning['blocks'], scanning['filtered_blocks'])
+        assert_greater_than_or_equal(scanning['blocks_per_second'], 0)
+        assert_equal(node.get_wallet_rpc('filter').getwalletinfo()['scanning'], False)
+        node.unloadwallet('filter')
+
+        self.log.info("Rescan reading blocks ahead on several threads")
+        self.restart_node(0, ['-rescanthreads=3'])
+        txids = self.rescanned_txids('prefetch', descriptors, 'reading blocks on 3 threads')
+        assert_equal(txids, expected_txids)
+
+        self.log.info("Rescan reading blocks on the rescan thread")
+        self.restart_node(0, ['-rescanthreads=0'])
+        txids = self.rescanned_txids('sequential', descriptors, 'reading all blocks')
+        assert_equal(txids, expected_txids)
+        assert_equal(self.last_rescan_counts('sequential')[1], 0)
+
+
+if __name__ == '__main__':
+    WalletFastRescanTest().main()